@@ -0,0 +1,229 @@
+/**
+ * @file audio_aec.c
+ * @brief NLMS acoustic echo canceller implementation
+ */
+
+#include "audio_aec.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define AEC_DELTA               (1.0e-3f)   // Regularization (normalized scale)
+#define AEC_REF_SILENT          (8.0f / 32768.0f)
+#define AEC_FAST_ALPHA          (1.0f / 128.0f)     // ~8ms power tracker
+#define AEC_SLOW_ALPHA          (1.0f / 8192.0f)    // ~0.5s power tracker
+#define AEC_DT_RESIDUAL         0.25f       // Short-term ERLE < 6dB
+#define AEC_DT_CONVERGED        8.0f        // Long-term ERLE > 9dB
+#define AEC_DT_HOLD_SAMPLES     480         // 30ms hold after double-talk
+#define AEC_DT_MAX_SAMPLES      32000       // 2s: assume echo path change
+#define AEC_POWER_SMOOTH        0.05f       // ERLE power smoothing per block
+#define AEC_ENERGY_RESYNC       4096        // Recompute ‖x‖² every N samples
+
+// ============================================================================
+// State
+// ============================================================================
+
+struct audio_aec {
+    uint16_t taps;
+    float mu;
+
+    float *weights;             // ŵ[k], k = 0 newest
+    float *hist;                // x history, 2·taps (mirrored for contiguity)
+    uint16_t pos;               // Newest sample index into hist
+
+    float energy;               // ‖x‖² over the history window
+    uint32_t energy_age;
+    float pd_fast, pe_fast;     // Short-term mic / residual power
+    float pd_slow, pe_slow;     // Long-term mic / residual power
+    uint16_t silent_run;        // Consecutive silent reference samples
+    uint16_t dt_hold;
+    uint32_t dt_run;            // Consecutive frozen samples
+
+    float pow_mic;              // Smoothed mic power (ERLE numerator)
+    float pow_err;              // Smoothed residual power
+    uint32_t adapt_samples;
+    uint32_t dt_samples;
+};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static void recompute_energy(audio_aec_t *aec)
+{
+    const float *x = &aec->hist[aec->pos];
+    float sum = 0.0f;
+    for (uint16_t k = 0; k < aec->taps; k++) {
+        sum += x[k] * x[k];
+    }
+    aec->energy = sum;
+    aec->energy_age = 0;
+}
+
+static inline int16_t to_pcm(float v)
+{
+    v *= 32768.0f;
+    if (v > 32767.0f) return INT16_MAX;
+    if (v < -32768.0f) return INT16_MIN;
+    return (int16_t)lrintf(v);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+audio_aec_t *audio_aec_create(uint16_t taps, float mu)
+{
+    if (taps == 0) return NULL;
+
+    audio_aec_t *aec = calloc(1, sizeof(audio_aec_t));
+    if (!aec) return NULL;
+
+    aec->weights = calloc(taps, sizeof(float));
+    aec->hist = calloc((size_t)taps * 2, sizeof(float));
+    if (!aec->weights || !aec->hist) {
+        audio_aec_destroy(aec);
+        return NULL;
+    }
+
+    aec->taps = taps;
+    aec->mu = mu;
+    audio_aec_reset(aec);
+    return aec;
+}
+
+void audio_aec_destroy(audio_aec_t *aec)
+{
+    if (!aec) return;
+    free(aec->weights);
+    free(aec->hist);
+    free(aec);
+}
+
+void audio_aec_reset(audio_aec_t *aec)
+{
+    memset(aec->weights, 0, aec->taps * sizeof(float));
+    memset(aec->hist, 0, (size_t)aec->taps * 2 * sizeof(float));
+    aec->pos = 0;
+    aec->energy = 0.0f;
+    aec->energy_age = 0;
+    aec->pd_fast = aec->pe_fast = 0.0f;
+    aec->pd_slow = aec->pe_slow = 0.0f;
+    aec->silent_run = aec->taps;
+    aec->dt_hold = 0;
+    aec->dt_run = 0;
+    aec->pow_mic = 0.0f;
+    aec->pow_err = 0.0f;
+    aec->adapt_samples = 0;
+    aec->dt_samples = 0;
+}
+
+void audio_aec_process(audio_aec_t *aec, const int16_t *mic, const int16_t *ref,
+                       int16_t *out, size_t n)
+{
+    const uint16_t taps = aec->taps;
+    float sum_mic = 0.0f;
+    float sum_err = 0.0f;
+    bool active = false;
+
+    for (size_t i = 0; i < n; i++) {
+        const float xn = ref[i] * (1.0f / 32768.0f);
+        const float dn = mic[i] * (1.0f / 32768.0f);
+
+        // Push reference: newest first, mirrored so hist[pos..pos+taps) is contiguous
+        aec->pos = aec->pos ? aec->pos - 1 : taps - 1;
+        const float oldest = aec->hist[aec->pos];
+        aec->hist[aec->pos] = xn;
+        aec->hist[aec->pos + taps] = xn;
+        aec->energy += xn * xn - oldest * oldest;
+        if (++aec->energy_age >= AEC_ENERGY_RESYNC) {
+            recompute_energy(aec);
+        }
+
+        if (fabsf(xn) < AEC_REF_SILENT) {
+            if (aec->silent_run < taps) aec->silent_run++;
+        } else {
+            aec->silent_run = 0;
+        }
+
+        // No reference in the whole window: nothing to cancel
+        if (aec->silent_run >= taps) {
+            out[i] = mic[i];
+            continue;
+        }
+        active = true;
+
+        // Echo estimate ŷ = ŵ·x
+        const float *x = &aec->hist[aec->pos];
+        const float *w = aec->weights;
+        float y = 0.0f;
+        for (uint16_t k = 0; k < taps; k++) {
+            y += w[k] * x[k];
+        }
+        const float e = dn - y;
+
+        // Double-talk: once converged, a residual that suddenly rises to
+        // the mic level is near-end speech (or echo path change) on top of
+        // the echo. Level-independent, unlike Geigel, which misfires when
+        // the speaker sits closer to the mic than the echo-loss assumption.
+        // The long-term trackers hold while frozen; a freeze that outlasts
+        // any utterance is taken as an echo path change and re-converges.
+        aec->pd_fast += AEC_FAST_ALPHA * (dn * dn - aec->pd_fast);
+        aec->pe_fast += AEC_FAST_ALPHA * (e * e - aec->pe_fast);
+        if (aec->dt_hold == 0) {
+            aec->pd_slow += AEC_SLOW_ALPHA * (dn * dn - aec->pd_slow);
+            aec->pe_slow += AEC_SLOW_ALPHA * (e * e - aec->pe_slow);
+        }
+        if (aec->pe_fast > AEC_DT_RESIDUAL * aec->pd_fast &&
+            aec->pd_slow > AEC_DT_CONVERGED * aec->pe_slow) {
+            aec->dt_hold = AEC_DT_HOLD_SAMPLES;
+        } else if (aec->dt_hold) {
+            aec->dt_hold--;
+        }
+        if (aec->dt_hold) {
+            if (++aec->dt_run >= AEC_DT_MAX_SAMPLES) {
+                aec->pe_slow = aec->pd_slow;
+                aec->dt_hold = 0;
+                aec->dt_run = 0;
+            }
+        } else {
+            aec->dt_run = 0;
+        }
+
+        if (aec->dt_hold == 0) {
+            const float g = aec->mu * e / (aec->energy + AEC_DELTA);
+            float *wm = aec->weights;
+            for (uint16_t k = 0; k < taps; k++) {
+                wm[k] += g * x[k];
+            }
+            aec->adapt_samples++;
+        } else {
+            aec->dt_samples++;
+        }
+
+        sum_mic += dn * dn;
+        sum_err += e * e;
+        out[i] = to_pcm(e);
+    }
+
+    // ERLE only tracks single-talk echo blocks
+    if (active && aec->dt_hold == 0 && sum_mic > 0.0f) {
+        aec->pow_mic += AEC_POWER_SMOOTH * (sum_mic - aec->pow_mic);
+        aec->pow_err += AEC_POWER_SMOOTH * (sum_err - aec->pow_err);
+    }
+}
+
+void audio_aec_get_metrics(const audio_aec_t *aec, audio_aec_metrics_t *metrics)
+{
+    metrics->erle_db = (aec->pow_err > 0.0f && aec->pow_mic > 0.0f)
+                           ? 10.0f * log10f(aec->pow_mic / aec->pow_err)
+                           : 0.0f;
+    metrics->ref_active = aec->silent_run < aec->taps;
+    metrics->double_talk = aec->dt_hold != 0;
+    metrics->adapt_samples = aec->adapt_samples;
+    metrics->dt_samples = aec->dt_samples;
+}
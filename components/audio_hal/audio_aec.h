@@ -0,0 +1,92 @@
+/**
+ * @file audio_aec.h
+ * @brief NLMS acoustic echo canceller (16kHz mono)
+ *
+ * Removes the speaker signal picked up by the microphone, using the
+ * post-volume DAC output as the far-end reference:
+ *
+ *   ref x[n] ──► [ adaptive FIR ŵ ] ──► ŷ[n] (echo estimate)
+ *                                         │
+ *   mic d[n] ─────────────────────────► (−) ──► e[n] (near-end speech)
+ *
+ *   - Normalized LMS, ŵ += μ·e·x / (‖x‖² + δ)
+ *   - Residual-ratio double-talk detector freezes adaptation while the
+ *     near-end talks over the echo, so barge-in speech is not cancelled
+ *   - Filter is skipped while the reference history is silent
+ *
+ * The reference must already be time-aligned with the mic stream (see
+ * audio_pipeline.c: DMA-accurate tap plus CONFIG_AUDIO_AEC_DELAY_MS).
+ *
+ * No ESP-IDF dependencies (host buildable).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+typedef struct audio_aec audio_aec_t;
+
+/**
+ * @brief Canceller metrics
+ */
+typedef struct {
+    float erle_db;              // Echo return loss enhancement (smoothed)
+    bool ref_active;            // Reference signal present in filter history
+    bool double_talk;           // Adaptation currently frozen
+    uint32_t adapt_samples;     // Samples with adaptation enabled
+    uint32_t dt_samples;        // Samples frozen by double-talk
+} audio_aec_metrics_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Create a canceller
+ *
+ * @param taps Filter length in samples (16 per ms of echo tail)
+ * @param mu   NLMS step size (0.1 - 0.5 typical)
+ * @return Instance, or NULL on allocation failure
+ */
+audio_aec_t *audio_aec_create(uint16_t taps, float mu);
+
+/**
+ * @brief Free a canceller
+ */
+void audio_aec_destroy(audio_aec_t *aec);
+
+/**
+ * @brief Clear filter weights and history
+ */
+void audio_aec_reset(audio_aec_t *aec);
+
+/**
+ * @brief Cancel echo from a block of samples
+ *
+ * @param aec Instance
+ * @param mic Microphone samples d[n]
+ * @param ref Time-aligned reference samples x[n]
+ * @param out Output e[n] (may alias mic)
+ * @param n   Sample count
+ */
+void audio_aec_process(audio_aec_t *aec, const int16_t *mic, const int16_t *ref,
+                       int16_t *out, size_t n);
+
+/**
+ * @brief Get canceller metrics
+ */
+void audio_aec_get_metrics(const audio_aec_t *aec, audio_aec_metrics_t *metrics);
+
+#ifdef __cplusplus
+}
+#endif
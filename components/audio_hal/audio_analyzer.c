@@ -0,0 +1,306 @@
+/**
+ * @file audio_analyzer.c
+ * @brief Level / spectrum tap implementation
+ */
+
+#include "audio_analyzer.h"
+#include "audio_vad.h"
+#include <string.h>
+#include <math.h>
+
+_Static_assert(sizeof(audio_analysis_t) % sizeof(uint32_t) == 0,
+               "audio_analysis_t is copied as whole words");
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define FFT_N                   AUDIO_ANALYZER_FFT_SIZE
+#define FFT_BINS                (FFT_N / 2)
+#define DB_PER_LOG2_Q8          771         // 10·log10(2) = 3.0103 dB (Q8)
+#define DB_FULL_SCALE_LOG2      4           // Hann'd full-scale sine: |X|² = 32767² / 16
+#define FLOOR_Q8                AUDIO_VAD_DB_Q8(AUDIO_ANALYZER_FLOOR_DB)
+
+// ============================================================================
+// Shared Tables (built once)
+// ============================================================================
+
+static int16_t s_cos[FFT_BINS];             // cos(2πk/N), Q15
+static int16_t s_sin[FFT_BINS];             // sin(2πk/N), Q15
+static int16_t s_window[FFT_N];             // Hann, Q15
+static uint8_t s_bitrev[FFT_N];
+static uint8_t s_band_edge[AUDIO_ANALYZER_BANDS + 1];  // First bin of each band
+static bool s_tables_ready;
+
+static int16_t to_q15(float v)
+{
+    int32_t q = (int32_t)lrintf(v * 32768.0f);
+    if (q > 32767) q = 32767;
+    if (q < -32768) q = -32768;
+    return (int16_t)q;
+}
+
+static void build_tables(void)
+{
+    for (int k = 0; k < FFT_BINS; k++) {
+        float a = 2.0f * (float)M_PI * k / FFT_N;
+        s_cos[k] = to_q15(cosf(a));
+        s_sin[k] = to_q15(sinf(a));
+    }
+    for (int n = 0; n < FFT_N; n++) {
+        s_window[n] = to_q15(0.5f - 0.5f * cosf(2.0f * (float)M_PI * n / FFT_N));
+
+        uint32_t r = 0;
+        for (int b = 0; b < AUDIO_ANALYZER_FFT_LOG2; b++) {
+            if (n & (1 << b)) r |= 1u << (AUDIO_ANALYZER_FFT_LOG2 - 1 - b);
+        }
+        s_bitrev[n] = (uint8_t)r;
+    }
+
+    // Log spaced over bins 1..N/2 (DC skipped), at least one bin per band
+    s_band_edge[0] = 1;
+    for (int b = 1; b < AUDIO_ANALYZER_BANDS; b++) {
+        int edge = (int)lrintf(powf((float)FFT_BINS, (float)b / AUDIO_ANALYZER_BANDS));
+        if (edge <= s_band_edge[b - 1]) edge = s_band_edge[b - 1] + 1;
+        s_band_edge[b] = (uint8_t)edge;
+    }
+    s_band_edge[AUDIO_ANALYZER_BANDS] = FFT_BINS + 1;
+
+    s_tables_ready = true;
+}
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static uint16_t isqrt32(uint32_t v)
+{
+    uint32_t r = 0;
+    for (uint32_t bit = 1u << 30; bit; bit >>= 2) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
+        } else {
+            r >>= 1;
+        }
+    }
+    return (uint16_t)r;
+}
+
+static void publish(audio_analyzer_t *an)
+{
+    uint32_t words[AUDIO_ANALYZER_SLOT_WORDS];
+    memcpy(words, &an->result, sizeof(words));
+
+    uint32_t seq = atomic_load_explicit(&an->seq, memory_order_relaxed);
+    atomic_store_explicit(&an->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (size_t i = 0; i < AUDIO_ANALYZER_SLOT_WORDS; i++) {
+        atomic_store_explicit(&an->slot[i], words[i], memory_order_relaxed);
+    }
+    atomic_store_explicit(&an->seq, seq + 2, memory_order_release);
+}
+
+static void release_bands(audio_analyzer_t *an)
+{
+    for (int b = 0; b < AUDIO_ANALYZER_BANDS; b++) {
+        uint8_t v = an->result.bands[b];
+        an->result.bands[b] = (v > AUDIO_ANALYZER_RELEASE) ? v - AUDIO_ANALYZER_RELEASE : 0;
+    }
+}
+
+// ============================================================================
+// Spectrum
+// ============================================================================
+
+/**
+ * @brief In-place radix-2 DIT FFT, input already in bit-reversed order
+ *
+ * Every stage halves its output, so the result is X[k] / N and never
+ * overflows Q15.
+ */
+static void fft_q15(int16_t *re, int16_t *im)
+{
+    for (int size = 2, step = FFT_BINS; size <= FFT_N; size <<= 1, step >>= 1) {
+        int half = size >> 1;
+        for (int base = 0; base < FFT_N; base += size) {
+            for (int j = 0; j < half; j++) {
+                int a = base + j, b = a + half;
+                int32_t c = s_cos[j * step], s = s_sin[j * step];
+
+                // t = x[b] · e^(-2πij/size)
+                int32_t tr = (re[b] * c + im[b] * s) >> 15;
+                int32_t ti = (im[b] * c - re[b] * s) >> 15;
+
+                int32_t ar = re[a], ai = im[a];
+                re[a] = (int16_t)((ar + tr) >> 1);
+                im[a] = (int16_t)((ai + ti) >> 1);
+                re[b] = (int16_t)((ar - tr) >> 1);
+                im[b] = (int16_t)((ai - ti) >> 1);
+            }
+        }
+    }
+}
+
+static void compute_spectrum(audio_analyzer_t *an)
+{
+    int16_t *re = an->frame, *im = an->imag;
+
+    // Window and find the headroom for block floating point
+    int32_t peak = 0;
+    for (int n = 0; n < FFT_N; n++) {
+        int32_t v = (re[n] * s_window[n]) >> 15;
+        re[n] = (int16_t)v;
+        if (v < 0) v = -v;
+        if (v > peak) peak = v;
+    }
+
+    uint8_t bands[AUDIO_ANALYZER_BANDS] = {0};
+
+    if (peak > 0) {
+        int shift = __builtin_clz((uint32_t)peak) - 17;
+        if (shift < 0) shift = 0;
+
+        for (int n = 0; n < FFT_N; n++) {
+            re[n] = (int16_t)(re[n] << shift);
+            im[n] = 0;
+        }
+        for (int n = 0; n < FFT_N; n++) {
+            int r = s_bitrev[n];
+            if (r > n) {
+                int16_t t = re[n];
+                re[n] = re[r];
+                re[r] = t;
+            }
+        }
+
+        fft_q15(re, im);
+
+        int32_t offset_q8 = (DB_FULL_SCALE_LOG2 - 2 * shift) * DB_PER_LOG2_Q8;
+        for (int b = 0; b < AUDIO_ANALYZER_BANDS; b++) {
+            uint64_t sum = 0;
+            for (int k = s_band_edge[b]; k < s_band_edge[b + 1]; k++) {
+                sum += (uint32_t)(re[k] * re[k]) + (uint32_t)(im[k] * im[k]);
+            }
+            if (sum == 0) continue;
+
+            int32_t db_q8 = audio_vad_energy_to_db_q8(sum > UINT32_MAX ? UINT32_MAX : (uint32_t)sum) +
+                            offset_q8;
+            int32_t v = ((db_q8 - FLOOR_Q8) * 255) / -FLOOR_Q8;
+            bands[b] = (v < 0) ? 0 : (v > 255) ? 255 : (uint8_t)v;
+        }
+    }
+
+    // Fast attack, slow release
+    release_bands(an);
+    for (int b = 0; b < AUDIO_ANALYZER_BANDS; b++) {
+        if (bands[b] > an->result.bands[b]) an->result.bands[b] = bands[b];
+    }
+    an->result.spectra++;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void audio_analyzer_init(audio_analyzer_t *an, uint32_t rate, uint8_t channels)
+{
+    if (!s_tables_ready) build_tables();
+
+    memset(an, 0, sizeof(*an));
+    an->channels = channels ? channels : 1;
+
+    uint32_t decim = (rate + AUDIO_ANALYZER_RATE / 2) / AUDIO_ANALYZER_RATE;
+    an->decim = (decim < 1) ? 1 : (decim > 255) ? 255 : (uint8_t)decim;
+
+    an->result.rms_db_q8 = AUDIO_VAD_DB_Q8(AUDIO_VAD_MIN_DB);
+    publish(an);
+}
+
+void audio_analyzer_process(audio_analyzer_t *an, const int16_t *samples, size_t frames)
+{
+    uint64_t sum_sq = 0;
+    uint32_t count = 0;
+    int32_t peak = 0;
+
+    for (size_t f = 0; f < frames; f++) {
+        const int16_t *in = &samples[f * an->channels];
+        int32_t mono = in[0];
+        for (int c = 1; c < an->channels; c++) mono += in[c];
+        an->decim_acc += mono;
+
+        if (++an->decim_fill < an->decim) continue;
+        int32_t s = an->decim_acc / (an->decim * an->channels);
+        an->decim_acc = 0;
+        an->decim_fill = 0;
+
+        int32_t mag = (s < 0) ? -s : s;
+        if (mag > peak) peak = mag;
+        sum_sq += (uint32_t)(s * s);
+        count++;
+
+        if (an->skip > 0) {
+            an->skip--;
+            continue;
+        }
+        an->frame[an->fill++] = (int16_t)s;
+        if (an->fill == FFT_N) {
+            compute_spectrum(an);
+            an->fill = 0;
+            an->skip = AUDIO_ANALYZER_HOP - FFT_N;
+        }
+    }
+
+    if (count == 0) return;
+
+    uint32_t mean_sq = (uint32_t)(sum_sq / count);
+    an->result.peak = (peak > 32767) ? 32767 : (uint16_t)peak;
+    an->result.rms = isqrt32(mean_sq);
+    an->result.rms_db_q8 = audio_vad_energy_to_db_q8(mean_sq);
+    an->gap = 0;
+    publish(an);
+}
+
+void audio_analyzer_silence(audio_analyzer_t *an, size_t frames)
+{
+    // A frame interrupted by the gap would mix old audio with new
+    an->fill = 0;
+    an->skip = 0;
+    an->decim_acc = 0;
+    an->decim_fill = 0;
+
+    bool changed = (an->result.peak != 0);
+    an->result.peak = 0;
+    an->result.rms = 0;
+    an->result.rms_db_q8 = AUDIO_VAD_DB_Q8(AUDIO_VAD_MIN_DB);
+
+    an->gap += frames / an->decim;
+    while (an->gap >= AUDIO_ANALYZER_HOP) {
+        an->gap -= AUDIO_ANALYZER_HOP;
+        for (int b = 0; b < AUDIO_ANALYZER_BANDS; b++) {
+            if (an->result.bands[b]) changed = true;
+        }
+        release_bands(an);
+    }
+
+    if (changed) publish(an);
+}
+
+void audio_analyzer_read(const audio_analyzer_t *an, audio_analysis_t *out)
+{
+    uint32_t words[AUDIO_ANALYZER_SLOT_WORDS];
+    uint32_t before, after;
+
+    // The writer is a higher priority audio task and never blocks while
+    // the sequence is odd, so a retry only happens when it is mid-copy
+    do {
+        before = atomic_load_explicit(&an->seq, memory_order_acquire);
+        for (size_t i = 0; i < AUDIO_ANALYZER_SLOT_WORDS; i++) {
+            words[i] = atomic_load_explicit(&an->slot[i], memory_order_relaxed);
+        }
+        atomic_thread_fence(memory_order_acquire);
+        after = atomic_load_explicit(&an->seq, memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    memcpy(out, words, sizeof(*out));
+}
@@ -0,0 +1,131 @@
+/**
+ * @file audio_analyzer.h
+ * @brief Level / spectrum tap for LED and display visualizers
+ *
+ * Sits on a pipeline block path and publishes the newest result into a
+ * latest-value slot that any task can read without a lock:
+ *
+ *   block ──► downmix/boxcar to ~16kHz ──► peak, Σx² ──► level (per block)
+ *                                      │
+ *                                      └─► 256-pt frame every hop (20ms)
+ *                                            │
+ *               Hann ─► block-float Q15 FFT ─► |X|² per log band ─► dBFS
+ *                                            │
+ *                       fast attack / slow release ─► bands (0-255)
+ *                                            │
+ *                                 seqlock slot ─► audio_analyzer_read()
+ *
+ *   - Twiddle, window, bit-reverse and band tables are built once
+ *   - Frames are normalized to full scale before the FFT (block floating
+ *     point), so quiet input keeps its resolution despite per-stage scaling
+ *   - Bands are log spaced from the first bin to Nyquist (62.5Hz - 8kHz
+ *     at 16kHz), low band first
+ *   - One writer (the block path) per analyzer; readers retry on a torn
+ *     copy, the writer never waits
+ *
+ * No ESP-IDF dependencies (host buildable).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define AUDIO_ANALYZER_FFT_LOG2     8
+#define AUDIO_ANALYZER_FFT_SIZE     (1 << AUDIO_ANALYZER_FFT_LOG2)  // 16ms at 16kHz
+#define AUDIO_ANALYZER_BANDS        16
+#define AUDIO_ANALYZER_RATE         16000       // Analysis rate after the boxcar
+#define AUDIO_ANALYZER_HOP          320         // One spectrum per 20ms
+#define AUDIO_ANALYZER_FLOOR_DB     (-60)       // Band value 0
+#define AUDIO_ANALYZER_RELEASE      8           // Band fall per spectrum (0-255)
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Published result (copied whole by audio_analyzer_read())
+ */
+typedef struct {
+    uint16_t peak;              // Last block peak |x| (Q15)
+    uint16_t rms;               // Last block RMS (Q15)
+    int32_t rms_db_q8;          // Last block RMS in dBFS (Q8)
+    uint8_t bands[AUDIO_ANALYZER_BANDS];    // AUDIO_ANALYZER_FLOOR_DB..0 dBFS
+    uint32_t spectra;           // Spectra computed so far (changes = new bands)
+} audio_analysis_t;
+
+#define AUDIO_ANALYZER_SLOT_WORDS   (sizeof(audio_analysis_t) / sizeof(uint32_t))
+
+/**
+ * @brief Analyzer state (one per tap, owned by its block path)
+ */
+typedef struct {
+    uint8_t channels;           // Interleaved input channels
+    uint8_t decim;              // Input frames per analysis sample
+    uint8_t decim_fill;
+    int32_t decim_acc;
+
+    int16_t frame[AUDIO_ANALYZER_FFT_SIZE];    // Samples, then FFT real part
+    int16_t imag[AUDIO_ANALYZER_FFT_SIZE];     // FFT imaginary part
+    uint16_t fill;              // Samples in frame
+    uint16_t skip;              // Samples to drop before the next frame
+    uint32_t gap;               // Silent samples not yet released
+
+    audio_analysis_t result;    // Writer's copy
+
+    // Latest-value slot (seqlock: odd while the writer is copying)
+    _Atomic uint32_t seq;
+    _Atomic uint32_t slot[AUDIO_ANALYZER_SLOT_WORDS];
+} audio_analyzer_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initialize an analyzer
+ *
+ * @param an       Instance
+ * @param rate     Input sample rate (boxcar-decimated to ~16kHz)
+ * @param channels Interleaved channels (averaged)
+ */
+void audio_analyzer_init(audio_analyzer_t *an, uint32_t rate, uint8_t channels);
+
+/**
+ * @brief Analyze one block and publish the result (writer side)
+ *
+ * @param an      Instance
+ * @param samples Interleaved 16-bit PCM
+ * @param frames  Frame count
+ */
+void audio_analyzer_process(audio_analyzer_t *an, const int16_t *samples, size_t frames);
+
+/**
+ * @brief Publish silence for a gap with no block (writer side)
+ *
+ * Levels drop to zero and the bands keep releasing at their normal rate,
+ * so visualizers fall back instead of freezing on the last note.
+ *
+ * @param an     Instance
+ * @param frames Input frames the gap lasted
+ */
+void audio_analyzer_silence(audio_analyzer_t *an, size_t frames);
+
+/**
+ * @brief Copy the newest published result (any task, lock-free)
+ */
+void audio_analyzer_read(const audio_analyzer_t *an, audio_analysis_t *out);
+
+#ifdef __cplusplus
+}
+#endif
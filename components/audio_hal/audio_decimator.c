@@ -0,0 +1,279 @@
+/**
+ * @file audio_decimator.c
+ * @brief Polyphase anti-aliasing decimator implementation
+ *
+ * Polyphase decomposition of y[m] = Σ h[j]·x[3m - j]:
+ *
+ *   j = 3k + p  →  y[m] = Σ_p Σ_k h[3k + p] · u_p[m - k],  u_p[m] = x[3m - p]
+ *
+ * Input samples are dealt round-robin into three phase buffers
+ * (x[3m] → u0, x[3m+1] → u2, x[3m+2] → u1). An output is produced each
+ * time u0 receives a sample, so only the retained 16kHz outputs are ever
+ * computed (24 MACs per phase, 72 per output sample).
+ */
+
+#include "audio_decimator.h"
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#include "esp_cpu.h"
+#include "sdkconfig.h"
+static const char *TAG = "audio_decim";
+#endif
+
+#if defined(CONFIG_AUDIO_DECIMATOR_ESP_DSP)
+#include "dsps_dotprod.h"
+#endif
+
+// ============================================================================
+// Filter Coefficients
+// ============================================================================
+
+/**
+ * 72-tap low-pass, fc = 7.3kHz @ 48kHz, Kaiser β=7, Q15, DC gain = 1.0.
+ * Stored per phase and time-reversed so each phase is a forward dot
+ * product over its contiguous history: s_coeffs[p][t] = h[3·(23 - t) + p].
+ * Σ|h| = 1.76, so the int32 accumulator cannot overflow.
+ */
+static const int16_t s_coeffs[AUDIO_DECIM_FACTOR][AUDIO_DECIM_PHASE_TAPS]
+    __attribute__((aligned(16))) = {
+    { 3, -12, 34, -72, 130, -202, 275, -321, 295, -103, -582, 9583,
+      2806, -1501, 980, -640, 394, -219, 105, -40, 9, 2, -3, 1 },
+    { 3, -11, 25, -41, 51, -40, -18, 156, -425, 929, -2015, 6848,
+      6848, -2015, 929, -425, 156, -18, -40, 51, -41, 25, -11, 3 },
+    { 1, -3, 2, 9, -40, 105, -219, 394, -640, 980, -1501, 2806,
+      9583, -582, -103, 295, -321, 275, -202, 130, -72, 34, -12, 3 },
+};
+
+// ============================================================================
+// Kernels
+// ============================================================================
+
+static inline int16_t saturate_q15(int32_t acc)
+{
+    acc = (acc + (1 << 14)) >> 15;
+    if (acc > INT16_MAX) return INT16_MAX;
+    if (acc < INT16_MIN) return INT16_MIN;
+    return (int16_t)acc;
+}
+
+#if defined(CONFIG_AUDIO_DECIMATOR_ESP_DSP)
+/**
+ * @brief One output sample via esp-dsp (PIE-accelerated on ESP32-P4)
+ *
+ * Each phase is accumulated at full precision inside the library and
+ * returned as Q15; the three phase partials are then summed with
+ * saturation. Per-phase Σ|h| < 1, so the partials themselves never clip.
+ */
+static inline int16_t decimate_one(const int16_t *u0, const int16_t *u1, const int16_t *u2)
+{
+    int16_t p0, p1, p2;
+    dsps_dotprod_s16(u0, s_coeffs[0], &p0, AUDIO_DECIM_PHASE_TAPS, 0);
+    dsps_dotprod_s16(u1, s_coeffs[1], &p1, AUDIO_DECIM_PHASE_TAPS, 0);
+    dsps_dotprod_s16(u2, s_coeffs[2], &p2, AUDIO_DECIM_PHASE_TAPS, 0);
+
+    int32_t sum = (int32_t)p0 + p1 + p2;
+    if (sum > INT16_MAX) return INT16_MAX;
+    if (sum < INT16_MIN) return INT16_MIN;
+    return (int16_t)sum;
+}
+#else
+/**
+ * @brief One output sample, portable fixed-point kernel
+ *
+ * Unrolled by 4 with independent accumulators so the RISC-V core can
+ * overlap loads and multiplies.
+ */
+static inline int16_t decimate_one(const int16_t *u0, const int16_t *u1, const int16_t *u2)
+{
+    const int16_t *h0 = s_coeffs[0];
+    const int16_t *h1 = s_coeffs[1];
+    const int16_t *h2 = s_coeffs[2];
+    int32_t a0 = 0, a1 = 0, a2 = 0, a3 = 0;
+
+    for (int t = 0; t < AUDIO_DECIM_PHASE_TAPS; t += 4) {
+        a0 += u0[t] * h0[t]         + u1[t] * h1[t]         + u2[t] * h2[t];
+        a1 += u0[t + 1] * h0[t + 1] + u1[t + 1] * h1[t + 1] + u2[t + 1] * h2[t + 1];
+        a2 += u0[t + 2] * h0[t + 2] + u1[t + 2] * h1[t + 2] + u2[t + 2] * h2[t + 2];
+        a3 += u0[t + 3] * h0[t + 3] + u1[t + 3] * h1[t + 3] + u2[t + 3] * h2[t + 3];
+    }
+
+    return saturate_q15(a0 + a1 + a2 + a3);
+}
+#endif
+
+/**
+ * @brief Mix one interleaved frame down to mono (or pick the selected channel)
+ */
+static inline int16_t mix_frame(const int16_t *frame, uint8_t channels, int8_t select)
+{
+    if (select >= 0) return frame[select];
+    if (channels == 1) return frame[0];
+    if (channels == 2) return (int16_t)(((int32_t)frame[0] + frame[1]) >> 1);
+
+    int32_t sum = 0;
+    for (uint8_t c = 0; c < channels; c++) {
+        sum += frame[c];
+    }
+    return (int16_t)(sum / channels);
+}
+
+/**
+ * @brief Decimate one chunk (≤ AUDIO_DECIM_CHUNK_FRAMES frames)
+ */
+static size_t process_chunk(audio_decimator_t *dec, const int16_t *input,
+                            size_t frames, int16_t *output)
+{
+    // 1. Commutator: deal mono samples into the phase buffers
+    uint8_t phase = dec->next_phase;
+    for (size_t i = 0; i < frames; i++) {
+        int16_t s = mix_frame(&input[i * dec->channels], dec->channels, dec->select);
+        uint8_t p = (phase == 0) ? 0 : (uint8_t)(AUDIO_DECIM_FACTOR - phase);
+        dec->phase_buf[p][dec->phase_fill[p]++] = s;
+        phase = (phase + 1 == AUDIO_DECIM_FACTOR) ? 0 : phase + 1;
+    }
+    dec->next_phase = phase;
+
+    // 2. One output per new u0 sample (u1/u2 always hold at least as many)
+    size_t out_count = dec->phase_fill[0] - (AUDIO_DECIM_PHASE_TAPS - 1);
+    for (size_t m = 0; m < out_count; m++) {
+        output[m] = decimate_one(&dec->phase_buf[0][m],
+                                 &dec->phase_buf[1][m],
+                                 &dec->phase_buf[2][m]);
+    }
+
+    // 3. Slide histories so the next call starts with taps-1 of context
+    if (out_count > 0) {
+        for (int p = 0; p < AUDIO_DECIM_FACTOR; p++) {
+            size_t keep = dec->phase_fill[p] - out_count;
+            memmove(dec->phase_buf[p], &dec->phase_buf[p][out_count], keep * sizeof(int16_t));
+            dec->phase_fill[p] = (uint16_t)keep;
+        }
+    }
+
+    return out_count;
+}
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+bool audio_decimator_init(audio_decimator_t *dec, uint8_t channels, uint8_t factor)
+{
+    if (!dec || channels == 0 || channels > AUDIO_DECIM_MAX_CHANNELS) return false;
+    if (factor != 1 && factor != AUDIO_DECIM_FACTOR) return false;
+
+    dec->channels = channels;
+    dec->factor = factor;
+    dec->select = -1;
+    audio_decimator_reset(dec);
+    return true;
+}
+
+bool audio_decimator_select_channel(audio_decimator_t *dec, int8_t channel)
+{
+    if (!dec || channel >= (int8_t)dec->channels) return false;
+
+    dec->select = (channel < 0) ? -1 : channel;
+    return true;
+}
+
+void audio_decimator_reset(audio_decimator_t *dec)
+{
+    if (!dec) return;
+
+    // u1/u2 carry one extra leading zero: u_p[0] = x[-p] precedes the
+    // first input sample, keeping all three histories index-aligned
+    memset(dec->phase_buf, 0, sizeof(dec->phase_buf));
+    dec->phase_fill[0] = AUDIO_DECIM_PHASE_TAPS - 1;
+    for (int p = 1; p < AUDIO_DECIM_FACTOR; p++) {
+        dec->phase_fill[p] = AUDIO_DECIM_PHASE_TAPS;
+    }
+    dec->next_phase = 0;
+}
+
+size_t audio_decimator_process(audio_decimator_t *dec, const int16_t *input,
+                               size_t frames, int16_t *output)
+{
+    if (!dec || !input || !output || frames == 0) return 0;
+
+    // Mix-only mode (input already at the processed rate)
+    if (dec->factor == 1) {
+        for (size_t i = 0; i < frames; i++) {
+            output[i] = mix_frame(&input[i * dec->channels], dec->channels, dec->select);
+        }
+        return frames;
+    }
+
+    size_t out_total = 0;
+    while (frames > 0) {
+        size_t chunk = (frames > AUDIO_DECIM_CHUNK_FRAMES) ? AUDIO_DECIM_CHUNK_FRAMES : frames;
+        out_total += process_chunk(dec, input, chunk, output + out_total);
+        input += chunk * dec->channels;
+        frames -= chunk;
+    }
+
+    return out_total;
+}
+
+// ============================================================================
+// Microbenchmark
+// ============================================================================
+
+#ifdef ESP_PLATFORM
+
+#define BENCH_BLOCK_FRAMES  240     // 5ms at 48kHz
+#define BENCH_CHANNELS      2
+
+uint32_t audio_decimator_benchmark(uint32_t iterations)
+{
+    static int16_t in[BENCH_BLOCK_FRAMES * BENCH_CHANNELS];
+    static int16_t out[BENCH_BLOCK_FRAMES / AUDIO_DECIM_FACTOR + 1];
+    static audio_decimator_t dec;
+
+    if (iterations == 0) iterations = 1;
+
+    // Deterministic broadband test signal (LCG noise)
+    uint32_t seed = 0x1234567u;
+    for (size_t i = 0; i < BENCH_BLOCK_FRAMES * BENCH_CHANNELS; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        in[i] = (int16_t)(seed >> 16) / 2;
+    }
+
+    audio_decimator_init(&dec, BENCH_CHANNELS, AUDIO_DECIM_FACTOR);
+
+    uint64_t total = 0;
+    uint32_t worst = 0;
+    size_t produced = 0;
+    for (uint32_t it = 0; it < iterations; it++) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        produced = audio_decimator_process(&dec, in, BENCH_BLOCK_FRAMES, out);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        total += cycles;
+        if (cycles > worst) worst = cycles;
+    }
+
+    uint32_t avg = (uint32_t)(total / iterations);
+    ESP_LOGI(TAG, "Decimator benchmark (%s): %lu cycles/5ms block avg, %lu worst, "
+             "%u frames -> %u samples, %lu iterations",
+#if defined(CONFIG_AUDIO_DECIMATOR_ESP_DSP)
+             "esp-dsp",
+#else
+             "C",
+#endif
+             (unsigned long)avg, (unsigned long)worst,
+             BENCH_BLOCK_FRAMES, (unsigned)produced, (unsigned long)iterations);
+
+    return avg;
+}
+
+#else
+
+uint32_t audio_decimator_benchmark(uint32_t iterations)
+{
+    (void)iterations;
+    return 0;
+}
+
+#endif  // ESP_PLATFORM
@@ -0,0 +1,81 @@
+/**
+ * @file audio_mixer.c
+ * @brief Fixed-point gain ramps and saturating mix kernels
+ */
+
+#include "audio_mixer.h"
+
+// ============================================================================
+// Gain Ramp
+// ============================================================================
+
+void audio_gain_init(audio_gain_t *gain, int16_t initial, uint16_t step)
+{
+    gain->current = initial;
+    gain->target = initial;
+    gain->step = step ? step : 1;
+}
+
+int16_t audio_gain_advance(audio_gain_t *gain)
+{
+    int32_t cur = gain->current;
+    int32_t tgt = gain->target;
+
+    if (cur < tgt) {
+        cur += gain->step;
+        if (cur > tgt) cur = tgt;
+    } else if (cur > tgt) {
+        cur -= gain->step;
+        if (cur < tgt) cur = tgt;
+    }
+
+    gain->current = (int16_t)cur;
+    return gain->current;
+}
+
+// ============================================================================
+// Mix Kernels
+// ============================================================================
+
+void audio_mix_accumulate(int32_t *acc, const int16_t *src, size_t n,
+                          int16_t g_start, int16_t g_end)
+{
+    if (n == 0) return;
+
+    // Constant gain: single vectorizable MAC loop
+    if (g_start == g_end) {
+        if (g_start == 0) return;
+        const int32_t g = g_start;
+        for (size_t i = 0; i < n; i++) {
+            acc[i] += (src[i] * g) >> 15;
+        }
+        return;
+    }
+
+    // Ramp: gain interpolated per AUDIO_MIX_LANES group (Q15.16)
+    size_t groups = (n + AUDIO_MIX_LANES - 1) / AUDIO_MIX_LANES;
+    // Scaled by multiplication: a fade-down's negative step must not be left-shifted
+    int32_t g_fx = (int32_t)g_start * 65536;
+    int32_t dg_fx = ((int32_t)g_end - g_start) * 65536 / (int32_t)groups;
+
+    size_t i = 0;
+    for (size_t grp = 0; grp < groups; grp++) {
+        const int32_t g = (g_fx + dg_fx / 2) >> 16;    // Gain at group centre
+        size_t end = i + AUDIO_MIX_LANES;
+        if (end > n) end = n;
+        for (; i < end; i++) {
+            acc[i] += (src[i] * g) >> 15;
+        }
+        g_fx += dg_fx;
+    }
+}
+
+void audio_mix_saturate(int16_t *dst, const int32_t *acc, size_t n)
+{
+    for (size_t i = 0; i < n; i++) {
+        int32_t v = acc[i];
+        if (v > INT16_MAX) v = INT16_MAX;
+        if (v < INT16_MIN) v = INT16_MIN;
+        dst[i] = (int16_t)v;
+    }
+}
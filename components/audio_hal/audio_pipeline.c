@@ -3,20 +3,28 @@
  * @brief Audio Pipeline Implementation with I2S/USB Mic + I2S DAC
  *
  * Audio Flow:
- *   [USB Audio] ReSpeaker USB (48kHz) --> usb_host_uac --> Dual Buffers
+ *   [USB Audio] ReSpeaker USB (48kHz) --> usb_host_uac --> queue --> drift
+ *               resampler (usb_mic task, local clock) --> Dual Buffers
  *       OR
  *   [I2S Audio] I2S1 Microphone (48kHz) --> I2S RX --> Dual Buffers
  *                                                        |
  *                                       ┌────────────────┴────────────────┐
  *                                       |                                 |
- *                                 RAW (48kHz)                    Processed (16kHz)
- *                                 Local LLM                      ESPHome/HA
+ *                                 RAW (48kHz)                Polyphase LPF + decimate
+ *                                 Local LLM                    Processed (16kHz)
+ *                                 (all channels,               ESPHome/HA
+ *                                  channel map)                (ASR beam or mix)
  *
- *   Output Buffer --> I2S0 --> ES9038Q2M DAC --> Peerless Speaker
+ *   Music/TTS/Chime rings --> Q15 mixer (ramped gains, ducking) --> I2S0
+ *       --> ES9038Q2M DAC --> Peerless Speaker
+ *                 |
+ *                 +--> 16kHz reference (DMA-aligned) --> NLMS echo
+ *                      canceller on the Processed path (CONFIG_AUDIO_AEC)
  *
  * Supported Microphones:
  *   USB (CONFIG_AUDIO_INPUT_USB):
- *     - ReSpeaker USB Mic Array v2.0 (with beamforming)
+ *     - ReSpeaker USB Mic Array v2.0 / XVF3800 (with beamforming; the
+ *       device's ASR channel feeds the Processed path, its DOA/VAD the VAD)
  *     - Any UAC 1.0 compatible USB microphone
  *
  *   I2S (CONFIG_AUDIO_INPUT_I2S):
@@ -27,7 +35,7 @@
 
 #include "audio_pipeline.h"
 #include <string.h>
-#include <math.h>
+#include <stdio.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
@@ -37,7 +45,23 @@
 #include "esp_log.h"
 #include "esp_check.h"
 #include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "esp_attr.h"
 #include "sdkconfig.h"
+#include "audio_decimator.h"
+#include "audio_ring.h"
+#include "audio_mixer.h"
+#include "audio_vad.h"
+#include "audio_analyzer.h"
+#include "audio_resampler.h"
+#include "mem_arena.h"
+#ifdef CONFIG_AUDIO_AEC
+#include "audio_aec.h"
+#endif
+#ifdef CONFIG_AUDIO_PIPELINE_BENCHMARK
+#include <stdlib.h>
+#include "esp_cpu.h"
+#endif
 
 // Include USB Audio Input when enabled
 #ifdef CONFIG_AUDIO_INPUT_USB
@@ -59,12 +83,72 @@ static const char *TAG = "audio_pipe";
 #endif
 #define DOWNSAMPLE_RATIO    (CONFIG_MIC_SAMPLE_RATE / CONFIG_PROCESSED_SAMPLE_RATE)
 
+#if !defined(CONFIG_AUDIO_INPUT_USB) && (DOWNSAMPLE_RATIO != AUDIO_DECIM_FACTOR || \
+    CONFIG_MIC_SAMPLE_RATE != DOWNSAMPLE_RATIO * CONFIG_PROCESSED_SAMPLE_RATE)
+#error "MIC_SAMPLE_RATE must be exactly 3x PROCESSED_SAMPLE_RATE (polyphase decimator)"
+#endif
+
 // Input channels (1=mono for INMP441, 2=stereo for ICS-43434)
 #ifndef CONFIG_MIC_CHANNELS
 #define CONFIG_MIC_CHANNELS     1
 #endif
 #define INPUT_CHANNELS      CONFIG_MIC_CHANNELS
 
+// DAC output engine (event-paced by I2S0 on_sent)
+#define DAC_CHANNELS            2
+#define DAC_BYTES_PER_SAMPLE    (CONFIG_I2S0_BIT_WIDTH / 8)
+#define DAC_DESC_SRC_BYTES      (AUDIO_DMA_FRAME_NUM * DAC_CHANNELS * sizeof(int16_t))
+#define DAC_DESC_DMA_BYTES      (AUDIO_DMA_FRAME_NUM * DAC_CHANNELS * DAC_BYTES_PER_SAMPLE)
+#define DAC_DESC_PERIOD_MS      ((AUDIO_DMA_FRAME_NUM * 1000 + CONFIG_I2S0_SAMPLE_RATE - 1) / CONFIG_I2S0_SAMPLE_RATE)
+#define DAC_TASK_STACK          4096
+#define DAC_TASK_PRIORITY       6       // Above mic task: output must never starve
+#define DAC_TASK_CORE           CONFIG_TASK_CORE_AUDIO
+#define MIC_TASK_CORE           CONFIG_TASK_CORE_AUDIO
+
+#ifndef CONFIG_AUDIO_OUTPUT_PRELOAD_DESC
+#define CONFIG_AUDIO_OUTPUT_PRELOAD_DESC    AUDIO_DMA_DESC_NUM
+#endif
+// Give up waiting for a full preload after this many descriptor periods
+#define DAC_PRELOAD_MAX_WAIT    20
+
+// Mixer ramps (full-scale 0 -> unity times)
+#define MIX_VOLUME_RAMP_MS      20      // set_volume / mute / stream gain default
+#define MIX_DUCK_ATTACK_MS      60
+#define MIX_DUCK_RELEASE_MS     400
+#define MIX_DUCK_HOLD_BLOCKS    (300 / DAC_DESC_PERIOD_MS)  // Between TTS chunks
+
+#ifndef CONFIG_AUDIO_MIXER_DUCK_LEVEL
+#define CONFIG_AUDIO_MIXER_DUCK_LEVEL   25
+#endif
+
+// Echo canceller (16kHz reference tapped from the DAC mix)
+#ifdef CONFIG_AUDIO_AEC
+#if CONFIG_I2S0_SAMPLE_RATE != CONFIG_PROCESSED_SAMPLE_RATE * AUDIO_DECIM_FACTOR
+#error "AUDIO_AEC needs I2S0_SAMPLE_RATE = 3x PROCESSED_SAMPLE_RATE (reference decimator)"
+#endif
+#define AEC_REF_BLOCK           (AUDIO_DMA_FRAME_NUM / AUDIO_DECIM_FACTOR)  // Samples per descriptor
+#define AEC_REF_BUFFER_SIZE     4096    // 128ms of 16kHz mono (power of two)
+#define AEC_TAPS                (CONFIG_AUDIO_AEC_TAIL_MS * CONFIG_PROCESSED_SAMPLE_RATE / 1000)
+#define AEC_STEP_SIZE           0.3f
+#define AEC_DELAY_SAMPLES       (CONFIG_AUDIO_AEC_DELAY_MS * CONFIG_PROCESSED_SAMPLE_RATE / 1000)
+#define AEC_ALIGN_TOLERANCE     (2 * CONFIG_PROCESSED_SAMPLE_RATE / 1000)   // 2ms
+#define AEC_FRAME_SAMPLES       (CONFIG_PROCESSED_SAMPLE_RATE / 100)        // 10ms
+#endif
+
+// Voice activity detection (Kconfig "Audio DSP")
+#ifndef CONFIG_AUDIO_VAD_THRESHOLD_DB
+#define CONFIG_AUDIO_VAD_THRESHOLD_DB   9
+#endif
+#ifndef CONFIG_AUDIO_VAD_FIXED_LEVEL_DB
+#define CONFIG_AUDIO_VAD_FIXED_LEVEL_DB (-40)
+#endif
+#ifndef CONFIG_AUDIO_VAD_ATTACK_MS
+#define CONFIG_AUDIO_VAD_ATTACK_MS      30
+#endif
+#ifndef CONFIG_AUDIO_VAD_HANGOVER_MS
+#define CONFIG_AUDIO_VAD_HANGOVER_MS    300
+#endif
+
 // I2S1 Microphone DMA configuration
 #define MIC_DMA_DESC_NUM    6
 #define MIC_DMA_FRAME_NUM   240     // ~5ms at 48kHz
@@ -73,16 +157,49 @@ static const char *TAG = "audio_pipe";
 // Buffer Size Configuration
 // ============================================================================
 
+// All ring sizes must be powers of two (see audio_ring.h)
+
+// Both capture rings also hold the pre-roll window while no session is
+// open, so they are sized for CONFIG_AUDIO_PREROLL_MS plus live slack
+
 // Raw buffer: 48kHz stereo (high quality for local LLM)
-#define RAW_BUFFER_SIZE         (64 * 1024)   // 64KB (~170ms at 48kHz stereo)
+#define RAW_BUFFER_SIZE         (256 * 1024)  // 256KB (~1.3s at 48kHz stereo)
 
 // Processed buffer: 16kHz mono (for ESPHome)
-#define PROCESSED_BUFFER_SIZE   (16 * 1024)   // 16KB (~500ms at 16kHz mono)
+#define PROCESSED_BUFFER_SIZE   (64 * 1024)   // 64KB (~2s at 16kHz mono)
+
+// Pre-roll (audio from before record_start handed to the new session)
+#ifndef CONFIG_AUDIO_PREROLL_MS
+#define CONFIG_AUDIO_PREROLL_MS 0       // Sessions off: nothing to hand over
+#endif
+#define PROCESSED_BYTES_PER_MS  (CONFIG_PROCESSED_SAMPLE_RATE / 1000 * sizeof(int16_t))
+#define PREROLL_RING_SHARE(sz)  ((sz) / 4 * 3)  // Leave >= 1/4 for live audio
+#define CAPTURE_ACK_TIMEOUT_MS  20              // ~4 mic blocks
 
 // ============================================================================
 // Internal State
 // ============================================================================
 
+/**
+ * @brief One mixer input stream
+ */
+typedef struct {
+    uint8_t *buffer;                    // Ring storage (PSRAM)
+    audio_ring_t ring;
+    audio_gain_t gain;                  // Per-stream gain
+    audio_gain_t duck;                  // Auto-duck (music only)
+    int16_t block_gain;                 // Effective gain at end of last block
+    uint8_t partial_wakes;              // Wakes spent holding a sub-block tail
+
+    // Flush request (audio_pipeline_stop/flush_stream), applied by the consumer
+    _Atomic bool flush_pending;
+    uint32_t flush_mark;
+} output_stream_t;
+
+// Mixer scratch (one descriptor of 16-bit stereo), internal RAM
+static int32_t s_mix_acc[AUDIO_DMA_FRAME_NUM * 2];
+static int16_t s_mix_src[AUDIO_DMA_FRAME_NUM * 2];
+
 typedef struct {
     // I2S handles
     i2s_chan_handle_t i2s0_tx_handle;   // Output to ES9038Q2M DAC
@@ -97,146 +214,697 @@ typedef struct {
     audio_state_t state;
     bool initialized;
     EventGroupHandle_t event_group;
-    SemaphoreHandle_t mutex;
+    SemaphoreHandle_t mutex;            // Control plane only, never on the audio path
 
     // Volume
     uint8_t volume;
     bool muted;
 
-    // Voice activity
+    // Voice activity (detector owned by the mic path; `vad` is the
+    // published snapshot, edges go out as AUDIO_VAD_*_BIT events)
+    audio_vad_t vad_detector;
     voice_activity_t vad;
-    float energy_threshold;
-    uint32_t voice_start_time;
 
-    // Statistics
+    // Statistics (each counter has a single writer: its ring's producer
+    // or consumer, so they count real capacity pressure only)
     uint32_t underruns;
     uint32_t overruns;
     uint32_t raw_overruns;
 
-    // Output buffer (to DAC)
-    uint8_t *output_buffer;
-    size_t output_write_pos;
-    size_t output_read_pos;
-
     // =========================================
-    // Dual Input Buffers (for different use cases)
+    // Lock-free SPSC rings (storage in PSRAM)
     // =========================================
 
-    // Raw buffer: 48kHz stereo (high quality)
+    // Output streams (to mixer -> DAC), one ring per stream
+    // Producer: audio_pipeline_write_stream()  Consumer: dac_output_task
+    output_stream_t streams[AUDIO_STREAM_COUNT];
+
+    // Mixer gains (targets written by control plane, ramped by the mixer)
+    audio_gain_t master_gain;           // set_volume() / set_mute()
+    uint8_t duck_level;                 // Music level while TTS/chime play (%)
+    bool duck_enabled;
+    uint32_t duck_hold;                 // Blocks left before releasing the duck
+
+    // DAC output engine
+    TaskHandle_t output_task_handle;
+    uint8_t *output_dma_buf;            // One descriptor in I2S0 format (internal RAM)
+    volatile bool output_running;
+    _Atomic bool output_prime_pending;  // Set by audio_pipeline_play()
+    volatile int64_t tx_sent_time_us;   // Last on_sent (ISR)
+    uint32_t output_starved;            // Current starvation burst (descriptors)
+    audio_output_stats_t output_stats;
+
+    // Raw ring: 48kHz stereo (high quality)
     // Use case: Local LLM (Qwen2.5), high-quality recording
+    // Producer: mic task / UAC callback  Consumer: audio_pipeline_read_raw()
     uint8_t *input_buffer_raw;
-    size_t raw_write_pos;
-    size_t raw_read_pos;
+    audio_ring_t raw_ring;
 
-    // Processed buffer: 16kHz mono (ESPHome compatible)
+    // Processed ring: 16kHz mono (ESPHome compatible)
     // Use case: ESPHome voice assistant, cloud STT
+    // Producer: mic task / UAC callback  Consumer: audio_pipeline_read()
     uint8_t *input_buffer_processed;
-    size_t processed_write_pos;
-    size_t processed_read_pos;
-
-    // Legacy alias (points to processed buffer for compatibility)
-    uint8_t *input_buffer;
-    size_t input_write_pos;
-    size_t input_read_pos;
+    audio_ring_t processed_ring;
+
+    // Anti-aliasing decimator (48kHz -> 16kHz mono)
+    audio_decimator_t decimator;
+
+    // Recording session. The tails stay with the consumers: outside a
+    // session the producer only moves a published floor per ring (the
+    // rolling pre-roll window) and writes against it; record_start() asks
+    // it to fix the floors N ms back, and each consumer skips its tail to
+    // the floor on its first access. The floors move only while no
+    // consumer call is in progress and no span is held (capture_readers).
+    _Atomic bool capture_request;       // Set by record_start/stop
+    _Atomic bool capture_active;        // Producer acknowledgement
+    _Atomic uint32_t capture_readers;   // Consumer calls in progress / spans held
+    _Atomic uint32_t raw_floor;         // Start of readable data (producer-published)
+    _Atomic uint32_t processed_floor;
+    _Atomic bool raw_span_held;         // acquire_raw() span awaiting release
+    _Atomic bool processed_span_held;
+    volatile uint32_t capture_preroll_ms;       // Requested for the next session
+    volatile uint32_t capture_preroll_actual_ms;
+
+#ifdef CONFIG_AUDIO_AEC
+    // Echo canceller reference: post-volume mix at 16kHz, pushed as each
+    // descriptor is reported played (not when queued), so the ring's newest
+    // sample is what the speaker is emitting now.
+    // Producer: dac_output_task  Consumer: mic task / UAC callback
+    audio_aec_t *aec;
+    uint8_t *aec_ref_buffer;
+    audio_ring_t aec_ref_ring;
+    audio_decimator_t aec_ref_decimator;
+    volatile int64_t aec_ref_stamp_us;  // on_sent time of the newest reference
+    uint8_t aec_inflight_head;          // Next slot to play
+    uint8_t aec_inflight_free;          // Slots played but not refilled
+    volatile bool aec_enabled;
+    _Atomic bool aec_reset_pending;     // Set by audio_pipeline_set_aec_enabled()
+    uint32_t aec_samples;
+    int64_t aec_cost_us;
+    audio_aec_stats_t aec_stats;
+#endif
 
-    // Downsampling state
-    uint32_t downsample_counter;
+#ifdef CONFIG_AUDIO_ANALYZER
+    // Visualizer taps: post-AEC mic and post-volume mix, each written by
+    // its block path and read lock-free by audio_pipeline_get_analysis()
+    audio_analyzer_t analyzer[AUDIO_TAP_COUNT];
+#endif
 
 } audio_pipeline_state_t;
 
 static audio_pipeline_state_t s_audio = {0};
 
+#ifdef CONFIG_AUDIO_AEC
+// Model of the I2S0 DMA ring: reference audio of every queued descriptor
+static int16_t s_aec_inflight[AUDIO_DMA_DESC_NUM][AEC_REF_BLOCK];
+#endif
+
 // Event bits
 #define AUDIO_READY_BIT     BIT0
 #define AUDIO_PLAYING_BIT   BIT1
 #define AUDIO_RECORDING_BIT BIT2
+#define AUDIO_VAD_START_BIT BIT3
+#define AUDIO_VAD_END_BIT   BIT4
 
 // Forward declarations
-static size_t stereo_to_mono_downsample(const int16_t *input, int16_t *output, size_t in_samples);
-static size_t mono_downsample(const int16_t *input, int16_t *output, size_t in_samples);
 static void update_vad(const int16_t *samples, size_t num_samples);
+static void capture_sync(uint32_t raw_bytes_per_sec, size_t raw_frame_bytes);
+static size_t capture_write(audio_ring_t *ring, _Atomic uint32_t *floor, const void *data, size_t len);
+#ifdef CONFIG_AUDIO_AEC
+static void aec_process_block(int16_t *samples, size_t num_samples);
+#endif
 
 // ============================================================================
 // Audio Data Processing (shared by both USB and I2S input)
 // ============================================================================
 
+// 16kHz mono scratch for one block (mic producer only), bounded here rather
+// than sized per call on the task stack. Longer inputs are cut into blocks.
+#define MIC_BLOCK_MAX_FRAMES    256     // >= MIC_DMA_FRAME_NUM and the USB worker chunk
+static int16_t s_mic_mono[MIC_BLOCK_MAX_FRAMES];
+_Static_assert(MIC_DMA_FRAME_NUM <= MIC_BLOCK_MAX_FRAMES, "I2S mic reads must fit one mic block");
+
+static void process_mic_block(audio_decimator_t *dec, uint32_t rate, const uint8_t *data, size_t len,
+                              size_t frames);
+
 /**
  * @brief Process incoming audio data from microphone (USB or I2S)
  *
- * Stores raw data to RAW buffer and processed (downsampled) data to Processed buffer.
+ * Stores raw data to RAW buffer, then low-pass filters and decimates it into
+ * the Processed buffer (16kHz mono), echo-cancelled when AEC is enabled.
+ * This is the sole producer of both rings, so no lock is taken.
+ *
+ * @param dec      Decimator for this input (channels/ratio of the source)
+ * @param rate     Source sample rate (raw ring format)
+ * @param data     Interleaved 16-bit PCM at the source rate
+ * @param len      Data length in bytes
  */
-static void process_mic_data(const uint8_t *data, size_t len)
+static void process_mic_data(audio_decimator_t *dec, uint32_t rate, const uint8_t *data, size_t len)
 {
     if (!s_audio.initialized || len == 0) return;
 
-    size_t samples_per_frame = (INPUT_CHANNELS == 2) ? 2 : 1;
-    size_t frames = len / (2 * samples_per_frame);  // 2 bytes per sample
-
-    if (xSemaphoreTake(s_audio.mutex, pdMS_TO_TICKS(5))) {
-        // ========================================
-        // 1. Store raw audio data (high quality)
-        // ========================================
-        size_t raw_space = (s_audio.raw_read_pos - s_audio.raw_write_pos - 1 + RAW_BUFFER_SIZE) % RAW_BUFFER_SIZE;
-        if (len <= raw_space) {
-            size_t first_chunk = RAW_BUFFER_SIZE - s_audio.raw_write_pos;
-            if (len <= first_chunk) {
-                memcpy(s_audio.input_buffer_raw + s_audio.raw_write_pos, data, len);
-            } else {
-                memcpy(s_audio.input_buffer_raw + s_audio.raw_write_pos, data, first_chunk);
-                memcpy(s_audio.input_buffer_raw, data + first_chunk, len - first_chunk);
-            }
-            s_audio.raw_write_pos = (s_audio.raw_write_pos + len) % RAW_BUFFER_SIZE;
-        } else {
-            s_audio.raw_overruns++;
+    const size_t frame_bytes = sizeof(int16_t) * dec->channels;
+    size_t frames = len / frame_bytes;
+
+    while (frames > 0) {
+        size_t n = (frames < MIC_BLOCK_MAX_FRAMES) ? frames : MIC_BLOCK_MAX_FRAMES;
+        process_mic_block(dec, rate, data, n * frame_bytes, n);
+        data += n * frame_bytes;
+        frames -= n;
+    }
+}
+
+/**
+ * @brief process_mic_data() for at most MIC_BLOCK_MAX_FRAMES frames
+ */
+static void process_mic_block(audio_decimator_t *dec, uint32_t rate, const uint8_t *data, size_t len,
+                              size_t frames)
+{
+    // ========================================
+    // 1. Filter & decimate to 16kHz mono (ESPHome compatible)
+    // ========================================
+    // Output never exceeds the input frame count (factor 1 or decimating)
+    int16_t *rx_buf_mono = s_mic_mono;
+    size_t mono_samples = audio_decimator_process(dec, (const int16_t *)data, frames, rx_buf_mono);
+    size_t mono_bytes = mono_samples * sizeof(int16_t);
+
+#ifdef CONFIG_AUDIO_AEC
+    // Remove speaker echo before anything downstream (STT, VAD) sees it
+    if (mono_samples > 0) {
+        aec_process_block(rx_buf_mono, mono_samples);
+    }
+#endif
+
+    // Session start/stop and idle pre-roll trimming, at a block boundary so
+    // the raw and processed snapshots begin at the same instant
+    const size_t raw_frame_bytes = sizeof(int16_t) * dec->channels;
+    capture_sync(rate * raw_frame_bytes, raw_frame_bytes);
+
+    // ========================================
+    // 2. Store raw audio data (high quality)
+    // ========================================
+    // Whole blocks only, so a reader never sees a torn frame
+    if (capture_write(&s_audio.raw_ring, &s_audio.raw_floor, data, len) == 0) {
+        s_audio.raw_overruns++;
+    }
+
+    // ========================================
+    // 3. Store 16kHz mono
+    // ========================================
+    if (mono_bytes > 0 &&
+        capture_write(&s_audio.processed_ring, &s_audio.processed_floor, rx_buf_mono, mono_bytes) == 0) {
+        s_audio.overruns++;
+    }
+
+    // Update VAD with mono data
+    if (mono_samples > 0) {
+        update_vad(rx_buf_mono, mono_samples);
+#ifdef CONFIG_AUDIO_ANALYZER
+        audio_analyzer_process(&s_audio.analyzer[AUDIO_TAP_MIC], rx_buf_mono, mono_samples);
+#endif
+    }
+}
+
+// ============================================================================
+// Recording Session / Pre-roll (producer side)
+// ============================================================================
+
+/**
+ * @brief Where writes may wrap to: the published floor, or the consumer's
+ *        tail once it has moved past it
+ *
+ * Outside a session no consumer reads (capture_sync() waits for
+ * capture_readers to drain before moving a floor), so the tail is ignored.
+ */
+static uint32_t capture_floor(const audio_ring_t *ring, _Atomic uint32_t *floor)
+{
+    uint32_t mark = atomic_load_explicit(floor, memory_order_relaxed);
+    if (!atomic_load_explicit(&s_audio.capture_active, memory_order_relaxed)) return mark;
+
+    uint32_t head = audio_ring_head(ring);
+    uint32_t tail = atomic_load_explicit(&((audio_ring_t *)ring)->tail, memory_order_acquire);
+    if ((head - tail) <= ring->size && (int32_t)(tail - mark) > 0) {
+        // Keep the floor within a ring of head as the session runs
+        mark = tail;
+        atomic_store_explicit(floor, mark, memory_order_release);
+    }
+    return mark;
+}
+
+/**
+ * @brief Write a whole block, or nothing
+ * @return Bytes written
+ */
+static size_t capture_write(audio_ring_t *ring, _Atomic uint32_t *floor, const void *data, size_t len)
+{
+    uint32_t mark = capture_floor(ring, floor);
+    if (ring->size - (audio_ring_head(ring) - mark) < len) return 0;
+    return audio_ring_write_floor(ring, data, len, mark);
+}
+
+/**
+ * @brief Bytes between the floor and head
+ */
+static inline uint32_t capture_used(const audio_ring_t *ring, _Atomic uint32_t *floor)
+{
+    return audio_ring_head(ring) - atomic_load_explicit(floor, memory_order_acquire);
+}
+
+/**
+ * @brief Move both floors to the newest @p ms of audio
+ *
+ * Raw and processed keep the same duration, limited by whichever holds
+ * less (counting at most PREROLL_RING_SHARE of each), so both snapshots
+ * start at the same block.
+ *
+ * @return Duration kept (ms)
+ */
+static uint32_t preroll_trim(uint32_t ms, uint32_t raw_bytes_per_sec, size_t raw_frame_bytes)
+{
+    // What each ring holds, up to the share pre-roll may keep
+    uint32_t proc_used = capture_used(&s_audio.processed_ring, &s_audio.processed_floor);
+    uint32_t raw_used = capture_used(&s_audio.raw_ring, &s_audio.raw_floor);
+    if (proc_used > PREROLL_RING_SHARE(PROCESSED_BUFFER_SIZE)) proc_used = PREROLL_RING_SHARE(PROCESSED_BUFFER_SIZE);
+    if (raw_used > PREROLL_RING_SHARE(RAW_BUFFER_SIZE)) raw_used = PREROLL_RING_SHARE(RAW_BUFFER_SIZE);
+
+    uint32_t have = proc_used / PROCESSED_BYTES_PER_MS;
+    uint32_t raw_have = (uint32_t)(((uint64_t)raw_used * 1000) / raw_bytes_per_sec);
+    if (raw_have < have) have = raw_have;
+    if (have < ms) ms = have;
+
+    uint32_t proc_keep = ms * PROCESSED_BYTES_PER_MS;
+    uint32_t raw_keep = (uint32_t)(((uint64_t)ms * raw_bytes_per_sec) / 1000);
+    raw_keep -= raw_keep % raw_frame_bytes;
+
+    atomic_store_explicit(&s_audio.processed_floor, audio_ring_head(&s_audio.processed_ring) - proc_keep,
+                          memory_order_release);
+    atomic_store_explicit(&s_audio.raw_floor, audio_ring_head(&s_audio.raw_ring) - raw_keep,
+                          memory_order_release);
+    return ms;
+}
+
+/**
+ * @brief Apply session requests before writing a block
+ */
+static void capture_sync(uint32_t raw_bytes_per_sec, size_t raw_frame_bytes)
+{
+    bool request = atomic_load_explicit(&s_audio.capture_request, memory_order_acquire);
+
+    if (atomic_load_explicit(&s_audio.capture_active, memory_order_relaxed)) {
+        if (request) return;
+        // Session end. Sequentially consistent with capture_enter(): either
+        // the consumer sees the session closed, or we see it inside
+        atomic_store(&s_audio.capture_active, false);
+    }
+
+    // A consumer still reading from, or holding a span of, the last session
+    if (atomic_load(&s_audio.capture_readers) != 0) return;
+
+    if (request) {
+        // Session start: the consumers' cursors begin N ms back
+        s_audio.capture_preroll_actual_ms = preroll_trim(s_audio.capture_preroll_ms,
+                                                         raw_bytes_per_sec, raw_frame_bytes);
+        atomic_store_explicit(&s_audio.capture_active, true, memory_order_release);
+    } else {
+        // No session: rolling pre-roll window
+        preroll_trim(CONFIG_AUDIO_PREROLL_MS, raw_bytes_per_sec, raw_frame_bytes);
+    }
+}
+
+/**
+ * @brief Empty both capture rings (mic path stopped or restarted)
+ */
+static void capture_reset(void)
+{
+    audio_ring_reset(&s_audio.raw_ring);
+    audio_ring_reset(&s_audio.processed_ring);
+    atomic_store(&s_audio.raw_floor, 0);
+    atomic_store(&s_audio.processed_floor, 0);
+}
+
+// ============================================================================
+// Recording Session (consumer side)
+// ============================================================================
+
+/**
+ * @brief Consumer may read the capture rings
+ */
+static inline bool capture_open(void)
+{
+    return atomic_load_explicit(&s_audio.capture_request, memory_order_relaxed) &&
+           atomic_load_explicit(&s_audio.capture_active, memory_order_acquire);
+}
+
+/**
+ * @brief Enter a consumer call; on success the floors stay put until
+ *        capture_leave() and the ring's tail is at or past its floor
+ */
+static bool capture_enter(audio_ring_t *ring, _Atomic uint32_t *floor)
+{
+    atomic_fetch_add(&s_audio.capture_readers, 1);
+    if (!atomic_load(&s_audio.capture_request) || !atomic_load(&s_audio.capture_active)) {
+        atomic_fetch_sub(&s_audio.capture_readers, 1);
+        return false;
+    }
+    audio_ring_skip_to(ring, atomic_load_explicit(floor, memory_order_acquire));
+    return true;
+}
+
+static inline void capture_leave(void)
+{
+    atomic_fetch_sub(&s_audio.capture_readers, 1);
+}
+
+// ============================================================================
+// DAC Output Engine (I2S0)
+// ============================================================================
+
+/**
+ * @brief I2S0 TX on_sent: one DMA descriptor finished, wake the refill task
+ */
+static IRAM_ATTR bool i2s0_tx_sent_cb(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx)
+{
+    (void)handle;
+    (void)event;
+    (void)user_ctx;
+    BaseType_t high_task_woken = pdFALSE;
+
+    s_audio.tx_sent_time_us = esp_timer_get_time();
+    if (s_audio.output_task_handle) {
+        vTaskNotifyGiveFromISR(s_audio.output_task_handle, &high_task_woken);
+    }
+    return high_task_woken == pdTRUE;
+}
+
+static inline size_t latency_bucket(uint32_t us)
+{
+    if (us < 100) return 0;
+    if (us < 250) return 1;
+    if (us < 500) return 2;
+    if (us < 1000) return 3;
+    if (us < 2500) return 4;
+    return 5;
+}
+
+static inline size_t underrun_bucket(uint32_t descs)
+{
+    if (descs <= 1) return 0;
+    if (descs <= 2) return 1;
+    if (descs <= 4) return 2;
+    if (descs <= 8) return 3;
+    if (descs <= 16) return 4;
+    return 5;
+}
+
+/**
+ * @brief Convert mixed 16-bit PCM to the I2S0 slot format
+ */
+static void convert_to_dac(uint8_t *dst, const int16_t *src, size_t samples)
+{
+#if DAC_BYTES_PER_SAMPLE == 2
+    memcpy(dst, src, samples * sizeof(int16_t));
+#else
+    for (size_t i = 0; i < samples; i++) {
+#if DAC_BYTES_PER_SAMPLE == 4
+        ((int32_t *)dst)[i] = (int32_t)src[i] << 16;
+#else
+        int32_t w = (int32_t)src[i] << 8;
+        dst[i * 3 + 0] = (uint8_t)w;
+        dst[i * 3 + 1] = (uint8_t)(w >> 8);
+        dst[i * 3 + 2] = (uint8_t)(w >> 16);
+#endif
+    }
+#endif
+}
+
+/**
+ * @brief Bytes a stream contributes to the next block (0 = skip it)
+ *
+ * A stream with less than a full block is held for one wake to let its
+ * producer catch up; if still short, the tail is mixed and padded.
+ */
+static size_t stream_take(output_stream_t *st, bool first_in_wake)
+{
+    size_t used = audio_ring_used(&st->ring) & ~(sizeof(int16_t) - 1);
+
+    if (used >= DAC_DESC_SRC_BYTES) {
+        st->partial_wakes = 0;
+        return DAC_DESC_SRC_BYTES;
+    }
+    if (used == 0) {
+        st->partial_wakes = 0;
+        return 0;
+    }
+    if (first_in_wake && ++st->partial_wakes > 1) {
+        st->partial_wakes = 0;
+        return used;
+    }
+    return 0;
+}
+
+#ifdef CONFIG_AUDIO_AEC
+/**
+ * @brief Store the reference for a descriptor about to be queued
+ *
+ * The driver refills the oldest freed DMA slot, so the block goes to the
+ * oldest slot played since the last refill.
+ */
+static void aec_ref_capture(const int16_t *mix)
+{
+    if (s_audio.aec_inflight_free == 0) return;
+
+    uint8_t slot = (s_audio.aec_inflight_head + AUDIO_DMA_DESC_NUM - s_audio.aec_inflight_free)
+                   % AUDIO_DMA_DESC_NUM;
+    audio_decimator_process(&s_audio.aec_ref_decimator, mix, AUDIO_DMA_FRAME_NUM,
+                            s_aec_inflight[slot]);
+    s_audio.aec_inflight_free--;
+}
+
+/**
+ * @brief Publish the reference of @p sent descriptors the DMA just played
+ *
+ * Slots that were not refilled were played as auto_clear silence.
+ */
+static void aec_ref_played(uint32_t sent)
+{
+    static const int16_t silence[AEC_REF_BLOCK];
+
+    for (uint32_t i = 0; i < sent; i++) {
+        // More completions than slots: the extra ones are all silence
+        int16_t *slot = NULL;
+        if (i < AUDIO_DMA_DESC_NUM) {
+            slot = s_aec_inflight[s_audio.aec_inflight_head];
+            s_audio.aec_inflight_head = (s_audio.aec_inflight_head + 1) % AUDIO_DMA_DESC_NUM;
         }
 
-        // ========================================
-        // 2. Convert & store 16kHz mono (ESPHome compatible)
-        // ========================================
-        int16_t rx_buf_mono[frames / DOWNSAMPLE_RATIO + 1];
-        size_t mono_samples;
-
-        if (INPUT_CHANNELS == 2) {
-            // Stereo input: mix to mono + downsample
-            mono_samples = stereo_to_mono_downsample(
-                (const int16_t *)data,
-                rx_buf_mono,
-                frames
-            );
-        } else {
-            // Mono input: just downsample
-            mono_samples = mono_downsample(
-                (const int16_t *)data,
-                rx_buf_mono,
-                frames
-            );
+        // Dropped while nobody consumes (no mic); re-aligned on the next read
+        if (audio_ring_free(&s_audio.aec_ref_ring) >= sizeof(silence)) {
+            audio_ring_write(&s_audio.aec_ref_ring, slot ? slot : silence, sizeof(silence));
         }
-        size_t mono_bytes = mono_samples * sizeof(int16_t);
+        if (slot) {
+            memset(slot, 0, sizeof(silence));   // auto_clear until refilled
+        }
+    }
 
-        size_t proc_space = (s_audio.processed_read_pos - s_audio.processed_write_pos - 1 + PROCESSED_BUFFER_SIZE) % PROCESSED_BUFFER_SIZE;
-        if (mono_bytes <= proc_space) {
-            size_t first_chunk = PROCESSED_BUFFER_SIZE - s_audio.processed_write_pos;
-            if (mono_bytes <= first_chunk) {
-                memcpy(s_audio.input_buffer_processed + s_audio.processed_write_pos, rx_buf_mono, mono_bytes);
-            } else {
-                memcpy(s_audio.input_buffer_processed + s_audio.processed_write_pos, rx_buf_mono, first_chunk);
-                memcpy(s_audio.input_buffer_processed, (uint8_t*)rx_buf_mono + first_chunk, mono_bytes - first_chunk);
+    uint32_t freed = s_audio.aec_inflight_free + sent;
+    s_audio.aec_inflight_free = (freed > AUDIO_DMA_DESC_NUM) ? AUDIO_DMA_DESC_NUM : (uint8_t)freed;
+    s_audio.aec_ref_stamp_us = s_audio.tx_sent_time_us;
+}
+#endif  // CONFIG_AUDIO_AEC
+
+/**
+ * @brief Mix one descriptor from all streams and queue it to I2S0
+ *
+ * @param first_in_wake First block of this on_sent wake (tail hold logic)
+ * @param pending       Output: a stream holds data that was not mixed
+ * @return Number of streams mixed (0 = nothing written)
+ */
+static int mix_one_descriptor(bool first_in_wake, bool *pending)
+{
+    const size_t block_samples = DAC_DESC_SRC_BYTES / sizeof(int16_t);
+    size_t take[AUDIO_STREAM_COUNT];
+    int mixed = 0;
+
+    *pending = false;
+    for (int i = 0; i < AUDIO_STREAM_COUNT; i++) {
+        take[i] = stream_take(&s_audio.streams[i], first_in_wake);
+        if (take[i] == 0 && audio_ring_used(&s_audio.streams[i].ring) > 0) *pending = true;
+    }
+
+    // Auto-duck music while TTS or chime are playing (with hold)
+    output_stream_t *music = &s_audio.streams[AUDIO_STREAM_MUSIC];
+    bool foreground = take[AUDIO_STREAM_TTS] || take[AUDIO_STREAM_CHIME];
+    if (foreground && s_audio.duck_enabled) {
+        s_audio.duck_hold = MIX_DUCK_HOLD_BLOCKS;
+        music->duck.step = audio_gain_ramp_step(MIX_DUCK_ATTACK_MS, AUDIO_DMA_FRAME_NUM, CONFIG_I2S0_SAMPLE_RATE);
+        audio_gain_set_target(&music->duck, audio_gain_from_percent(s_audio.duck_level));
+    } else if (s_audio.duck_hold > 0) {
+        s_audio.duck_hold--;
+    } else {
+        music->duck.step = audio_gain_ramp_step(MIX_DUCK_RELEASE_MS, AUDIO_DMA_FRAME_NUM, CONFIG_I2S0_SAMPLE_RATE);
+        audio_gain_set_target(&music->duck, AUDIO_GAIN_UNITY);
+    }
+
+    // Time advances for every gain, whether or not its stream has data
+    int16_t master = audio_gain_advance(&s_audio.master_gain);
+    memset(s_mix_acc, 0, sizeof(s_mix_acc));
+
+    for (int i = 0; i < AUDIO_STREAM_COUNT; i++) {
+        output_stream_t *st = &s_audio.streams[i];
+        int16_t g_start = st->block_gain;
+        int16_t g_end = audio_gain_mul(audio_gain_mul(audio_gain_advance(&st->gain),
+                                                      audio_gain_advance(&st->duck)), master);
+        st->block_gain = g_end;
+
+        if (take[i] == 0) continue;
+
+        // PSRAM -> internal scratch, then ramped MAC into the accumulator
+        size_t n = audio_ring_read(&st->ring, s_mix_src, take[i]) / sizeof(int16_t);
+        audio_mix_accumulate(s_mix_acc, s_mix_src, n, g_start, g_end);
+        mixed++;
+    }
+
+    if (mixed == 0) return 0;
+
+    bool padded = false;
+    for (int i = 0; i < AUDIO_STREAM_COUNT; i++) {
+        if (take[i] && take[i] < DAC_DESC_SRC_BYTES) padded = true;
+    }
+    if (padded) s_audio.output_stats.descriptors_padded++;
+
+    audio_mix_saturate(s_mix_src, s_mix_acc, block_samples);
+#ifdef CONFIG_AUDIO_AEC
+    aec_ref_capture(s_mix_src);
+#endif
+#ifdef CONFIG_AUDIO_ANALYZER
+    audio_analyzer_process(&s_audio.analyzer[AUDIO_TAP_OUTPUT], s_mix_src, AUDIO_DMA_FRAME_NUM);
+#endif
+    convert_to_dac(s_audio.output_dma_buf, s_mix_src, block_samples);
+
+    size_t bytes_written = 0;
+    i2s_channel_write(s_audio.i2s0_tx_handle, s_audio.output_dma_buf, DAC_DESC_DMA_BYTES,
+                      &bytes_written, pdMS_TO_TICKS(DAC_DESC_PERIOD_MS * 2));
+    s_audio.output_stats.descriptors_written++;
+    return mixed;
+}
+
+/**
+ * @brief Let the output tap fall back over descriptors of auto_clear silence
+ */
+static inline void output_tap_silence(uint32_t descs)
+{
+#ifdef CONFIG_AUDIO_ANALYZER
+    audio_analyzer_silence(&s_audio.analyzer[AUDIO_TAP_OUTPUT], descs * AUDIO_DMA_FRAME_NUM);
+#endif
+}
+
+/**
+ * @brief Record the end of a starvation burst
+ */
+static void end_starvation(void)
+{
+    if (s_audio.output_starved == 0) return;
+
+    s_audio.output_stats.underrun_hist[underrun_bucket(s_audio.output_starved)]++;
+    // Bursts longer than the last bucket boundary are gaps between streams
+    if (s_audio.output_starved <= 16) {
+        s_audio.output_stats.underruns++;
+        s_audio.underruns++;
+    }
+    s_audio.output_starved = 0;
+}
+
+/**
+ * @brief Bytes queued across all output streams
+ */
+static size_t output_used_max(void)
+{
+    size_t max = 0;
+    for (int i = 0; i < AUDIO_STREAM_COUNT; i++) {
+        size_t used = audio_ring_used(&s_audio.streams[i].ring);
+        if (used > max) max = used;
+    }
+    return max;
+}
+
+/**
+ * @brief DAC refill task
+ *
+ * Sleeps until I2S0 reports sent descriptors, then mixes and refills exactly
+ * that many whole descriptors (AUDIO_DMA_FRAME_NUM frames each). On play,
+ * waits for CONFIG_AUDIO_OUTPUT_PRELOAD_DESC descriptors of data and queues
+ * them as one batch so the DMA ring starts full. While starved the driver's
+ * auto_clear plays silence and the task keeps pacing on on_sent.
+ */
+static void dac_output_task(void *arg)
+{
+    (void)arg;
+    ESP_LOGI(TAG, "DAC output task started (%d x %d frames, %d ms/desc, %d streams)",
+             AUDIO_DMA_DESC_NUM, AUDIO_DMA_FRAME_NUM, DAC_DESC_PERIOD_MS, AUDIO_STREAM_COUNT);
+
+    bool priming = false;
+    uint32_t prime_waits = 0;
+
+    while (s_audio.output_running) {
+        uint32_t sent = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(DAC_DESC_PERIOD_MS * 4));
+
+        // Apply pending flushes (consumer side)
+        for (int i = 0; i < AUDIO_STREAM_COUNT; i++) {
+            output_stream_t *st = &s_audio.streams[i];
+            if (atomic_exchange_explicit(&st->flush_pending, false, memory_order_acquire)) {
+                audio_ring_discard_to(&st->ring, st->flush_mark);
+                st->partial_wakes = 0;
             }
-            s_audio.processed_write_pos = (s_audio.processed_write_pos + mono_bytes) % PROCESSED_BUFFER_SIZE;
+        }
 
-            // Legacy alias sync
-            s_audio.input_write_pos = s_audio.processed_write_pos;
-        } else {
-            s_audio.overruns++;
+        if (atomic_exchange_explicit(&s_audio.output_prime_pending, false, memory_order_acquire)) {
+            priming = true;
+            prime_waits = 0;
         }
 
-        xSemaphoreGive(s_audio.mutex);
+        if (sent == 0) continue;
+#ifdef CONFIG_AUDIO_AEC
+        aec_ref_played(sent);
+#endif
+        if (s_audio.state != AUDIO_STATE_PLAYING && s_audio.state != AUDIO_STATE_DUPLEX) {
+            priming = false;
+            end_starvation();
+            output_tap_silence(sent);
+            continue;
+        }
+
+        uint32_t batch = (sent > AUDIO_DMA_DESC_NUM) ? AUDIO_DMA_DESC_NUM : sent;
 
-        // Update VAD with mono data
-        if (mono_samples > 0) {
-            update_vad(rx_buf_mono, mono_samples);
+        if (priming) {
+            const size_t preload_bytes = CONFIG_AUDIO_OUTPUT_PRELOAD_DESC * DAC_DESC_SRC_BYTES;
+            size_t used = output_used_max();
+            if (used < preload_bytes && (used == 0 || ++prime_waits < DAC_PRELOAD_MAX_WAIT)) {
+                continue;
+            }
+            priming = false;
+            batch = CONFIG_AUDIO_OUTPUT_PRELOAD_DESC;
+        }
+
+        for (uint32_t i = 0; i < batch; i++) {
+            bool pending;
+            if (mix_one_descriptor(i == 0, &pending) > 0) {
+                end_starvation();
+            } else {
+                if (!pending) s_audio.output_starved++;
+                output_tap_silence(batch - i);
+                break;
+            }
+        }
+
+        uint32_t latency = (uint32_t)(esp_timer_get_time() - s_audio.tx_sent_time_us);
+        s_audio.output_stats.latency_hist[latency_bucket(latency)]++;
+        if (latency > s_audio.output_stats.latency_max_us) {
+            s_audio.output_stats.latency_max_us = latency;
         }
     }
+
+    s_audio.output_task_handle = NULL;
+    vTaskDelete(NULL);
 }
 
 // ============================================================================
@@ -251,8 +919,9 @@ static void process_mic_data(const uint8_t *data, size_t len)
  */
 static void mic_read_task(void *arg)
 {
+    (void)arg;
     const size_t buf_size = MIC_DMA_FRAME_NUM * INPUT_CHANNELS * sizeof(int16_t);
-    uint8_t *rx_buffer = heap_caps_malloc(buf_size, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+    uint8_t *rx_buffer = mem_arena_acquire(MEM_REGION_DMA, "mic_rx", buf_size);
 
     if (!rx_buffer) {
         ESP_LOGE(TAG, "Failed to allocate mic RX buffer");
@@ -269,7 +938,7 @@ static void mic_read_task(void *arg)
                                           &bytes_read, pdMS_TO_TICKS(100));
 
         if (ret == ESP_OK && bytes_read > 0) {
-            process_mic_data(rx_buffer, bytes_read);
+            process_mic_data(&s_audio.decimator, CONFIG_MIC_SAMPLE_RATE, rx_buffer, bytes_read);
         } else if (ret == ESP_ERR_TIMEOUT) {
             // Timeout is OK, just continue
         } else {
@@ -279,7 +948,7 @@ static void mic_read_task(void *arg)
     }
 
     s_audio.mic_streaming = false;
-    free(rx_buffer);
+    mem_arena_release(rx_buffer);
     ESP_LOGI(TAG, "Microphone task stopped");
     vTaskDelete(NULL);
 }
@@ -291,116 +960,263 @@ static void mic_read_task(void *arg)
 
 #ifdef CONFIG_AUDIO_INPUT_USB
 
-// USB Audio is always 48kHz stereo from ReSpeaker
+// Preferred USB format (ReSpeaker: 48kHz stereo, or every channel it has)
 #define USB_AUDIO_SAMPLE_RATE   48000
 #define USB_AUDIO_CHANNELS      2
-#define USB_DOWNSAMPLE_RATIO    (USB_AUDIO_SAMPLE_RATE / CONFIG_PROCESSED_SAMPLE_RATE)
+#ifdef CONFIG_AUDIO_USB_FULL_LAYOUT
+#define USB_CAPTURE_CHANNELS    0               // Full device layout
+#else
+#define USB_CAPTURE_CHANNELS    USB_AUDIO_CHANNELS
+#endif
 
-// Separate counter for USB audio downsampling
-static uint32_t s_usb_downsample_counter = 0;
+// Device VAD is used while the poller keeps it this recent
+#define USB_BEAM_FRESH_US       (4 * CONFIG_AUDIO_USB_BEAM_POLL_MS * 1000)
+
+// The UAC callback only queues packets; the usb_mic worker drains the
+// queue on the local clock through the drift resampler and runs the
+// shared mic processing (decimation, AEC, VAD) outside the USB stack
+#define USB_RX_RING_SIZE        (64 * 1024)     // ~340ms at 48kHz stereo (power of two)
+#define USB_WORKER_PERIOD_MS    5
+#define USB_WORKER_STACK        4096
+#define USB_WORKER_PRIORITY     5               // Same as the I2S mic task
+#define USB_CHUNK_FRAMES        AUDIO_RESAMPLER_MAX_FRAMES
+#define USB_CHUNK_OUT_FRAMES    (USB_CHUNK_FRAMES + USB_CHUNK_FRAMES / 64 + 2)  // >= resampler max output
+
+// Fill controller: PI on the smoothed fill error (seconds of audio).
+// Transfers arrive in ~21ms bursts, so the fill is averaged over ~0.5s;
+// the loop pulls a fill error back in ~20s and is critically damped
+#define USB_FILL_SMOOTH         0.01            // EMA weight per worker period
+#define USB_CTRL_KP             0.05            // 1/s
+#define USB_CTRL_KI             (USB_CTRL_KP * USB_CTRL_KP / 4)
+#define USB_CTRL_MAX_CORR       1000e-6         // Beyond this it is not drift
+#define USB_RESYNC_FILL         3               // x target: drop back to target
+#define USB_DRIFT_WINDOW_US     (10 * 1000 * 1000)  // Drift from window means
+
+typedef struct {
+    // Queue (UAC callback -> worker)
+    audio_ring_t ring;
+    uint8_t *storage;
+    _Atomic bool format_pending;        // Set on connect, applied by the worker
+    uint32_t pending_rate;
+    uint8_t pending_channels;
+    int8_t pending_select;              // Channel for the processed stream, -1 = mix
+    audio_channel_role_t pending_map[AUDIO_RAW_MAX_CHANNELS];
+
+    // Worker-owned
+    TaskHandle_t task;
+    volatile bool running;
+    audio_decimator_t decimator;
+    audio_resampler_t resampler;
+    uint32_t rate;
+    size_t frame_bytes;
+    audio_channel_role_t channel_map[AUDIO_RAW_MAX_CHANNELS];
+    bool primed;
+    int64_t last_us;
+    double in_carry;                    // Fractional input frames owed
+    double fill_avg;                    // Frames
+    double integral;                    // Integrated correction (tracks drift)
+    double ratio;
+    int64_t window_start_us;
+    double window_fill_sum;             // Σ fill · dt (frame·s)
+    double window_corr_sum;             // Σ correction · dt (s)
+    double prev_fill_mean;              // Previous window, < 0 = none
+
+    audio_usb_stats_t stats;
+} usb_capture_t;
+
+static usb_capture_t s_usb = {0};
+
+static const audio_channel_role_t USB_ROLE_MAP[] = {
+    [USB_AUDIO_CH_UNKNOWN]   = AUDIO_CHANNEL_UNKNOWN,
+    [USB_AUDIO_CH_MIC]       = AUDIO_CHANNEL_MIC,
+    [USB_AUDIO_CH_ASR]       = AUDIO_CHANNEL_ASR,
+    [USB_AUDIO_CH_COMMS]     = AUDIO_CHANNEL_COMMS,
+    [USB_AUDIO_CH_REFERENCE] = AUDIO_CHANNEL_REFERENCE,
+};
+
+// Worker scratch (too large for its stack)
+static int16_t s_usb_in[USB_CHUNK_FRAMES * AUDIO_RESAMPLER_MAX_CHANNELS];
+static int16_t s_usb_out[USB_CHUNK_OUT_FRAMES * AUDIO_RESAMPLER_MAX_CHANNELS];
+// Each resampled chunk is one mic block: one pre-roll / session boundary
+// and no split across the bounded mic scratch
+_Static_assert(USB_CHUNK_OUT_FRAMES <= MIC_BLOCK_MAX_FRAMES, "USB worker chunk must fit one mic block");
 
 /**
- * @brief Convert USB stereo 48kHz to mono 16kHz
- *
- * USB Audio from ReSpeaker is always 48kHz stereo.
- * This function converts it to 16kHz mono for Home Assistant.
+ * @brief USB Audio data callback (UAC driver task): queue whole packets
  */
-static size_t usb_stereo_to_mono_16k(const int16_t *input, int16_t *output, size_t stereo_frames)
+static void usb_audio_data_callback(const uint8_t *data, size_t len, void *user_ctx)
 {
-    size_t out_idx = 0;
+    if (!s_usb.storage) return;
 
-    for (size_t i = 0; i < stereo_frames; i++) {
-        // Each stereo frame: [Left, Right]
-        int16_t left = input[i * 2];
-        int16_t right = input[i * 2 + 1];
+    if (audio_ring_free(&s_usb.ring) >= len) {
+        audio_ring_write(&s_usb.ring, data, len);
+    } else {
+        s_usb.stats.overruns++;
+    }
+}
 
-        // Mix to mono (average both channels)
-        int32_t mono = ((int32_t)left + (int32_t)right) / 2;
+/**
+ * @brief Start over from an empty queue (connect, underrun)
+ */
+static void usb_capture_unprime(void)
+{
+    s_usb.primed = false;
+    s_usb.stats.streaming = false;
+    audio_resampler_reset(&s_usb.resampler);
+}
 
-        // Downsample 48kHz -> 16kHz (take every 3rd sample)
-        s_usb_downsample_counter++;
-        if (s_usb_downsample_counter >= USB_DOWNSAMPLE_RATIO) {
-            s_usb_downsample_counter = 0;
-            output[out_idx++] = (int16_t)mono;
+/**
+ * @brief Update the fill controller after one service period
+ */
+static void usb_capture_window_reset(int64_t now)
+{
+    s_usb.window_start_us = now;
+    s_usb.window_fill_sum = 0;
+    s_usb.window_corr_sum = 0;
+    s_usb.prev_fill_mean = -1;
+}
+
+static void usb_capture_control(size_t fill, double dt, int64_t now)
+{
+    const double target = (double)s_usb.rate * CONFIG_AUDIO_USB_TARGET_FILL_MS / 1000;
+
+    s_usb.fill_avg += USB_FILL_SMOOTH * ((double)fill - s_usb.fill_avg);
+    double err = (s_usb.fill_avg - target) / s_usb.rate;
+
+    // Integral term converges on the drift; the clamp keeps a wrong
+    // nominal rate from winding it up
+    s_usb.integral += USB_CTRL_KI * err * dt;
+    if (s_usb.integral > USB_CTRL_MAX_CORR) s_usb.integral = USB_CTRL_MAX_CORR;
+    if (s_usb.integral < -USB_CTRL_MAX_CORR) s_usb.integral = -USB_CTRL_MAX_CORR;
+
+    double corr = USB_CTRL_KP * err + s_usb.integral;
+    if (corr > USB_CTRL_MAX_CORR) corr = USB_CTRL_MAX_CORR;
+    if (corr < -USB_CTRL_MAX_CORR) corr = -USB_CTRL_MAX_CORR;
+
+    s_usb.ratio = 1.0 + corr;
+    audio_resampler_set_ratio(&s_usb.resampler, s_usb.ratio);
+
+    // Drift = input consumed beyond nominal (mean correction) + what the
+    // queue still gained or lost on top of it (slope of the window-mean
+    // fill, which the transfer bursts do not disturb)
+    s_usb.window_corr_sum += corr * dt;
+    s_usb.window_fill_sum += (double)fill * dt;
+    if (now - s_usb.window_start_us >= USB_DRIFT_WINDOW_US) {
+        double window_s = (now - s_usb.window_start_us) / 1e6;
+        double fill_mean = s_usb.window_fill_sum / window_s;
+
+        if (s_usb.prev_fill_mean >= 0) {
+            double slope = (fill_mean - s_usb.prev_fill_mean) / (s_usb.rate * window_s);
+            float drift_ppm = (float)((s_usb.window_corr_sum / window_s + slope) * 1e6);
+            s_usb.stats.drift_ppm = drift_ppm;
+            usb_audio_input_set_drift_ppm(drift_ppm);
         }
+
+        s_usb.window_start_us = now;
+        s_usb.window_fill_sum = 0;
+        s_usb.window_corr_sum = 0;
+        s_usb.prev_fill_mean = fill_mean;
     }
 
-    return out_idx;
+    s_usb.stats.correction_ppm = (float)(corr * 1e6);
+    s_usb.stats.fill_ms = (uint16_t)(s_usb.fill_avg * 1000 / s_usb.rate);
 }
 
 /**
- * @brief Process USB audio data (always 48kHz stereo)
- *
- * Stores raw stereo data and downsampled 16kHz mono data.
+ * @brief Drain the input owed since the last period through the resampler
  */
-static void process_usb_audio_data(const uint8_t *data, size_t len)
+static void usb_capture_service(void)
 {
-    if (!s_audio.initialized || len == 0) return;
+    const size_t fb = s_usb.frame_bytes;
+    const size_t target = (size_t)s_usb.rate * CONFIG_AUDIO_USB_TARGET_FILL_MS / 1000;
+    size_t fill = audio_ring_used(&s_usb.ring) / fb;
+    int64_t now = esp_timer_get_time();
+
+    if (!s_usb.primed) {
+        if (fill < target) return;
+
+        // Start the local clock at the target fill; the integral (drift)
+        // is kept across re-primes
+        s_usb.primed = true;
+        s_usb.stats.streaming = true;
+        s_usb.last_us = now;
+        s_usb.in_carry = 0;
+        s_usb.fill_avg = (double)fill;
+        usb_capture_window_reset(now);
+        return;
+    }
 
-    // USB audio: 48kHz, 16-bit, stereo
-    size_t stereo_frames = len / (2 * USB_AUDIO_CHANNELS);  // 2 bytes per sample, 2 channels
-
-    if (xSemaphoreTake(s_audio.mutex, pdMS_TO_TICKS(5))) {
-        // ========================================
-        // 1. Store raw 48kHz stereo data
-        // ========================================
-        size_t raw_space = (s_audio.raw_read_pos - s_audio.raw_write_pos - 1 + RAW_BUFFER_SIZE) % RAW_BUFFER_SIZE;
-        if (len <= raw_space) {
-            size_t first_chunk = RAW_BUFFER_SIZE - s_audio.raw_write_pos;
-            if (len <= first_chunk) {
-                memcpy(s_audio.input_buffer_raw + s_audio.raw_write_pos, data, len);
-            } else {
-                memcpy(s_audio.input_buffer_raw + s_audio.raw_write_pos, data, first_chunk);
-                memcpy(s_audio.input_buffer_raw, data + first_chunk, len - first_chunk);
-            }
-            s_audio.raw_write_pos = (s_audio.raw_write_pos + len) % RAW_BUFFER_SIZE;
-        } else {
-            s_audio.raw_overruns++;
-        }
+    if (fill > target * USB_RESYNC_FILL) {
+        // Far beyond what drift explains (stall, wrong nominal rate)
+        audio_ring_discard_to(&s_usb.ring, audio_ring_head(&s_usb.ring) - (uint32_t)(target * fb));
+        s_usb.stats.resyncs++;
+        fill = target;
+        s_usb.fill_avg = (double)fill;
+        usb_capture_window_reset(now);
+    }
 
-        // ========================================
-        // 2. Convert to 16kHz mono for Home Assistant
-        // ========================================
-        int16_t mono_buf[stereo_frames / USB_DOWNSAMPLE_RATIO + 1];
-        size_t mono_samples = usb_stereo_to_mono_16k(
-            (const int16_t *)data,
-            mono_buf,
-            stereo_frames
-        );
-        size_t mono_bytes = mono_samples * sizeof(int16_t);
-
-        size_t proc_space = (s_audio.processed_read_pos - s_audio.processed_write_pos - 1 + PROCESSED_BUFFER_SIZE) % PROCESSED_BUFFER_SIZE;
-        if (mono_bytes <= proc_space) {
-            size_t first_chunk = PROCESSED_BUFFER_SIZE - s_audio.processed_write_pos;
-            if (mono_bytes <= first_chunk) {
-                memcpy(s_audio.input_buffer_processed + s_audio.processed_write_pos, mono_buf, mono_bytes);
-            } else {
-                memcpy(s_audio.input_buffer_processed + s_audio.processed_write_pos, mono_buf, first_chunk);
-                memcpy(s_audio.input_buffer_processed, (uint8_t*)mono_buf + first_chunk, mono_bytes - first_chunk);
-            }
-            s_audio.processed_write_pos = (s_audio.processed_write_pos + mono_bytes) % PROCESSED_BUFFER_SIZE;
+    // Input owed for the local time elapsed, at the current ratio
+    double dt = (now - s_usb.last_us) / 1e6;
+    s_usb.last_us = now;
+    double owed = dt * s_usb.rate * s_usb.ratio + s_usb.in_carry;
+    size_t frames = (size_t)owed;
+    s_usb.in_carry = owed - (double)frames;
 
-            // Legacy alias sync
-            s_audio.input_write_pos = s_audio.processed_write_pos;
-        } else {
-            s_audio.overruns++;
-        }
+    if (frames > fill) {
+        s_usb.stats.underruns++;
+        usb_capture_unprime();
+        return;
+    }
 
-        xSemaphoreGive(s_audio.mutex);
+    for (size_t done = 0; done < frames; ) {
+        size_t n = frames - done;
+        if (n > USB_CHUNK_FRAMES) n = USB_CHUNK_FRAMES;
 
-        // Update VAD with 16kHz mono data
-        if (mono_samples > 0) {
-            update_vad(mono_buf, mono_samples);
-        }
+        audio_ring_read(&s_usb.ring, s_usb_in, n * fb);
+        size_t out = audio_resampler_process(&s_usb.resampler, s_usb_in, n, s_usb_out);
+        process_mic_data(&s_usb.decimator, s_usb.rate, (const uint8_t *)s_usb_out, out * fb);
+        done += n;
     }
+
+    usb_capture_control(fill - frames, dt, now);
 }
 
 /**
- * @brief USB Audio data callback - handles 48kHz stereo from ReSpeaker
+ * @brief USB mic worker: paces the queue on the local clock
  */
-static void usb_audio_data_callback(const uint8_t *data, size_t len, void *user_ctx)
+static void usb_mic_task(void *arg)
 {
-    process_usb_audio_data(data, len);
+    ESP_LOGI(TAG, "USB mic worker started");
+    TickType_t last_wake = xTaskGetTickCount();
+
+    while (s_usb.running) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(USB_WORKER_PERIOD_MS));
+
+        if (atomic_exchange(&s_usb.format_pending, false)) {
+            // New device: empty queue, fresh filter state, ratio back to 1
+            audio_ring_discard_to(&s_usb.ring, audio_ring_head(&s_usb.ring));
+            uint8_t factor = (s_usb.pending_rate == CONFIG_PROCESSED_SAMPLE_RATE) ? 1 : AUDIO_DECIM_FACTOR;
+            audio_decimator_init(&s_usb.decimator, s_usb.pending_channels, factor);
+            audio_decimator_select_channel(&s_usb.decimator, s_usb.pending_select);
+            audio_resampler_init(&s_usb.resampler, s_usb.pending_channels);
+            memcpy(s_usb.channel_map, s_usb.pending_map, sizeof(s_usb.channel_map));
+            s_usb.rate = s_usb.pending_rate;
+            s_usb.frame_bytes = sizeof(int16_t) * s_usb.pending_channels;
+            s_usb.integral = 0;
+            s_usb.ratio = 1.0;
+            usb_capture_unprime();
+        }
+
+        if (!s_audio.mic_ready || s_usb.frame_bytes == 0) {
+            if (s_usb.primed) usb_capture_unprime();
+            continue;
+        }
+        usb_capture_service();
+    }
+
+    ESP_LOGI(TAG, "USB mic worker stopped");
+    s_usb.task = NULL;
+    vTaskDelete(NULL);
 }
 
 /**
@@ -412,11 +1228,52 @@ static void usb_audio_connect_callback(bool connected, const usb_audio_input_inf
         ESP_LOGI(TAG, "USB Audio connected!");
         ESP_LOGI(TAG, "  VID: 0x%04X, PID: 0x%04X", info->vid, info->pid);
         ESP_LOGI(TAG, "  Format: %lu Hz, %d ch, %d-bit",
-                 info->sample_rate, info->channels, info->bit_depth);
+                 (unsigned long)info->sample_rate, info->channels, info->bit_depth);
         if (info->is_respeaker) {
             ESP_LOGI(TAG, "  ReSpeaker USB Mic Array detected - Beamforming enabled!");
         }
 
+        // 48kHz devices are decimated, 16kHz devices only mixed to mono
+        if (info->sample_rate != CONFIG_PROCESSED_SAMPLE_RATE &&
+            info->sample_rate != CONFIG_PROCESSED_SAMPLE_RATE * AUDIO_DECIM_FACTOR) {
+            ESP_LOGW(TAG, "  Unsupported rate %lu Hz for 16kHz output",
+                     (unsigned long)info->sample_rate);
+        }
+        if (info->channels == 0 || info->channels > AUDIO_DECIM_MAX_CHANNELS ||
+            info->channels > AUDIO_RESAMPLER_MAX_CHANNELS) {
+            ESP_LOGE(TAG, "  Unsupported channel count: %d", info->channels);
+            return;
+        }
+
+        // The processed stream takes the device's ASR beam when it has one;
+        // mixing it with the raw mics would undo the beamforming
+        int8_t select = -1;
+#ifdef CONFIG_AUDIO_USB_FULL_LAYOUT
+        select = (CONFIG_AUDIO_USB_ASR_CHANNEL >= 0) ? CONFIG_AUDIO_USB_ASR_CHANNEL : info->asr_channel;
+        if (select >= info->channels) {
+            ESP_LOGW(TAG, "  ASR channel %d not delivered, mixing", select);
+            select = -1;
+        }
+#endif
+        if (select >= 0) {
+            ESP_LOGI(TAG, "  Processed stream: channel %d of %d", select, info->channels);
+        } else {
+            ESP_LOGI(TAG, "  Processed stream: mix of %d channels", info->channels);
+        }
+        if (info->has_beam) {
+            ESP_LOGI(TAG, "  Device DOA/VAD available - energy VAD bypassed while it reports");
+        }
+
+        // Filter state belongs to the worker; it picks the format up
+        s_usb.pending_rate = info->sample_rate;
+        s_usb.pending_channels = info->channels;
+        s_usb.pending_select = select;
+        for (int c = 0; c < AUDIO_RAW_MAX_CHANNELS; c++) {
+            s_usb.pending_map[c] = (c < info->channels) ? USB_ROLE_MAP[info->channel_role[c]]
+                                                        : AUDIO_CHANNEL_UNKNOWN;
+        }
+        atomic_store(&s_usb.format_pending, true);
+
         s_audio.mic_ready = true;
 
         // Auto-start streaming
@@ -426,6 +1283,9 @@ static void usb_audio_connect_callback(bool connected, const usb_audio_input_inf
         ESP_LOGW(TAG, "USB Audio disconnected");
         s_audio.mic_ready = false;
         s_audio.mic_streaming = false;
+#ifdef CONFIG_AUDIO_ANALYZER
+        audio_analyzer_silence(&s_audio.analyzer[AUDIO_TAP_MIC], CONFIG_PROCESSED_SAMPLE_RATE);
+#endif
     }
 }
 
@@ -435,12 +1295,28 @@ static esp_err_t init_usb_audio_input(void)
     ESP_LOGI(TAG, "  Waiting for USB microphone connection...");
     ESP_LOGI(TAG, "  Supported: ReSpeaker USB Mic Array, UAC 1.0 devices");
 
+    s_usb.storage = mem_arena_acquire(MEM_REGION_PSRAM, "usb_rx", USB_RX_RING_SIZE);
+    if (!s_usb.storage) {
+        ESP_LOGE(TAG, "Failed to allocate USB input queue");
+        return ESP_ERR_NO_MEM;
+    }
+    audio_ring_init(&s_usb.ring, s_usb.storage, USB_RX_RING_SIZE);
+    s_usb.stats.target_ms = CONFIG_AUDIO_USB_TARGET_FILL_MS;
+
+    s_usb.running = true;
+    if (xTaskCreatePinnedToCore(usb_mic_task, "usb_mic", USB_WORKER_STACK, NULL,
+                                USB_WORKER_PRIORITY, &s_usb.task, MIC_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create USB mic worker");
+        s_usb.running = false;
+        return ESP_FAIL;
+    }
+
     usb_audio_input_config_t config = {
         .data_cb = usb_audio_data_callback,
         .connect_cb = usb_audio_connect_callback,
         .user_ctx = NULL,
-        .preferred_sample_rate = 48000,
-        .preferred_channels = 2,  // Stereo for ReSpeaker
+        .preferred_sample_rate = USB_AUDIO_SAMPLE_RATE,
+        .preferred_channels = USB_CAPTURE_CHANNELS,
     };
 
     esp_err_t ret = usb_audio_input_init(&config);
@@ -451,77 +1327,20 @@ static esp_err_t init_usb_audio_input(void)
 
     return ESP_OK;
 }
-#endif  // CONFIG_AUDIO_INPUT_USB
-
-// ============================================================================
-// Audio Processing: Stereo to Mono + Downsampling
-// ============================================================================
-
-/**
- * @brief Convert stereo 16-bit samples to mono with downsampling
- *
- * Input:  Stereo 48kHz 16-bit (L, R, L, R, ...)
- * Output: Mono 16kHz 16-bit
- *
- * Process:
- * 1. Mix stereo to mono: (Left + Right) / 2
- * 2. Downsample 48kHz -> 16kHz: take every 3rd sample
- *
- * @param input     Input buffer (stereo 48kHz)
- * @param output    Output buffer (mono 16kHz)
- * @param in_samples Number of stereo sample pairs in input
- * @return Number of mono samples written to output
- */
-static size_t stereo_to_mono_downsample(const int16_t *input, int16_t *output,
-                                         size_t in_samples)
-{
-    size_t out_idx = 0;
-
-    for (size_t i = 0; i < in_samples; i++) {
-        // Each stereo frame: [Left, Right]
-        int16_t left = input[i * 2];
-        int16_t right = input[i * 2 + 1];
-
-        // Mix to mono (average both channels)
-        int32_t mono = ((int32_t)left + (int32_t)right) / 2;
-
-        // Downsampling: only keep every DOWNSAMPLE_RATIO-th sample
-        s_audio.downsample_counter++;
-        if (s_audio.downsample_counter >= DOWNSAMPLE_RATIO) {
-            s_audio.downsample_counter = 0;
-            output[out_idx++] = (int16_t)mono;
-        }
-    }
-
-    return out_idx;
-}
 
 /**
- * @brief Downsample mono input
- *
- * Input:  Mono 48kHz 16-bit
- * Output: Mono 16kHz 16-bit
- *
- * @param input     Input buffer (mono 48kHz)
- * @param output    Output buffer (mono 16kHz)
- * @param in_samples Number of samples in input
- * @return Number of samples written to output
+ * @brief Stop the worker and hand the queue back (after the USB side stopped)
  */
-static size_t mono_downsample(const int16_t *input, int16_t *output, size_t in_samples)
+static void deinit_usb_capture(void)
 {
-    size_t out_idx = 0;
-
-    for (size_t i = 0; i < in_samples; i++) {
-        // Downsampling: only keep every DOWNSAMPLE_RATIO-th sample
-        s_audio.downsample_counter++;
-        if (s_audio.downsample_counter >= DOWNSAMPLE_RATIO) {
-            s_audio.downsample_counter = 0;
-            output[out_idx++] = input[i];
-        }
+    s_usb.running = false;
+    for (int i = 0; i < 20 && s_usb.task; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
     }
-
-    return out_idx;
+    mem_arena_release(s_usb.storage);
+    memset(&s_usb, 0, sizeof(s_usb));
 }
+#endif  // CONFIG_AUDIO_INPUT_USB
 
 // ============================================================================
 // I2S Configuration
@@ -571,6 +1390,15 @@ static esp_err_t init_i2s0_output(void)
         TAG, "Failed to init I2S0 STD mode"
     );
 
+    // Pace the output task from DMA completion
+    i2s_event_callbacks_t cbs = {
+        .on_sent = i2s0_tx_sent_cb,
+    };
+    ESP_RETURN_ON_ERROR(
+        i2s_channel_register_event_callback(s_audio.i2s0_tx_handle, &cbs, NULL),
+        TAG, "Failed to register I2S0 callbacks"
+    );
+
     ESP_LOGI(TAG, "I2S0 initialized: %d Hz, %d-bit, MCLK=GPIO%d, BCK=GPIO%d, WS=GPIO%d, DOUT=GPIO%d",
              CONFIG_I2S0_SAMPLE_RATE, CONFIG_I2S0_BIT_WIDTH,
              CONFIG_I2S0_MCLK_GPIO, CONFIG_I2S0_BCK_GPIO,
@@ -652,50 +1480,216 @@ static esp_err_t init_i2s1_microphone(void)
 }
 
 // ============================================================================
-// Voice Activity Detection
+// Echo Cancellation
 // ============================================================================
 
+#ifdef CONFIG_AUDIO_AEC
+/**
+ * @brief Take the reference samples matching a mic block of @p n samples
+ *
+ * The ring's newest sample is playing "now" (extrapolated from the last
+ * on_sent), and the block's last mic sample arrived now, CONFIG_AUDIO_AEC_
+ * DELAY_MS after it left the speaker. So the ring should hold delay + n
+ * samples; the difference between the DAC and mic clocks is corrected by
+ * dropping or padding reference when it drifts past the tolerance.
+ */
+static void aec_ref_fetch(int16_t *ref, size_t n)
+{
+    audio_ring_t *ring = &s_audio.aec_ref_ring;
+    size_t used = audio_ring_used(ring) / sizeof(int16_t);
+    int64_t age_us = esp_timer_get_time() - s_audio.aec_ref_stamp_us;
+    if (age_us < 0) age_us = 0;
+    if (age_us > DAC_DESC_PERIOD_MS * 1000) age_us = DAC_DESC_PERIOD_MS * 1000;
+
+    int32_t level = (int32_t)used + (int32_t)(age_us * CONFIG_PROCESSED_SAMPLE_RATE / 1000000);
+    int32_t error = level - (int32_t)(AEC_DELAY_SAMPLES + n);
+    size_t pad = 0;
+
+    if (error > AEC_ALIGN_TOLERANCE) {
+        // Reference ahead (mic clock slow, or mic just started)
+        size_t drop = ((size_t)error < used) ? (size_t)error : used;
+        audio_ring_discard_to(ring, audio_ring_head(ring) - (uint32_t)(used - drop) * sizeof(int16_t));
+        s_audio.aec_stats.resyncs++;
+    } else if (error < -AEC_ALIGN_TOLERANCE) {
+        // Reference behind (mic clock fast): repeat silence to catch up
+        pad = ((size_t)-error < n) ? (size_t)-error : n;
+        s_audio.aec_stats.resyncs++;
+    }
+
+    memset(ref, 0, pad * sizeof(int16_t));
+    size_t got = audio_ring_read(ring, ref + pad, (n - pad) * sizeof(int16_t)) / sizeof(int16_t);
+    if (pad + got < n) {
+        memset(ref + pad + got, 0, (n - pad - got) * sizeof(int16_t));
+    }
+}
+
+// Reference matching one mic block (mic producer only; blocks are at most
+// MIC_BLOCK_MAX_FRAMES, so never more 16kHz samples than that)
+static int16_t s_aec_ref[MIC_BLOCK_MAX_FRAMES];
+
 /**
- * @brief Calculate audio energy in dB
+ * @brief Echo-cancel one 16kHz mic block in place
  */
-static float calculate_energy_db(const int16_t *samples, size_t num_samples)
+static void aec_process_block(int16_t *samples, size_t num_samples)
 {
-    if (num_samples == 0) return -96.0f;
+    if (!s_audio.aec) return;
 
-    int64_t sum_squares = 0;
-    for (size_t i = 0; i < num_samples; i++) {
-        int32_t sample = samples[i];
-        sum_squares += sample * sample;
+    // Keep consuming the reference while disabled so alignment holds
+    int16_t *ref = s_aec_ref;
+    aec_ref_fetch(ref, num_samples);
+
+    if (atomic_exchange_explicit(&s_audio.aec_reset_pending, false, memory_order_acquire)) {
+        audio_aec_reset(s_audio.aec);
     }
+    if (!s_audio.aec_enabled) return;
 
-    float rms = sqrtf((float)sum_squares / num_samples);
-    if (rms < 1.0f) rms = 1.0f;
+    int64_t t0 = esp_timer_get_time();
+    audio_aec_process(s_audio.aec, samples, ref, samples, num_samples);
+    uint32_t cost = (uint32_t)(esp_timer_get_time() - t0);
 
-    // Convert to dB (relative to full scale 32767)
-    float db = 20.0f * log10f(rms / 32767.0f);
-    return db;
+    s_audio.aec_cost_us += cost;
+    s_audio.aec_samples += num_samples;
+    if (cost > s_audio.aec_stats.block_cost_max_us) {
+        s_audio.aec_stats.block_cost_max_us = cost;
+    }
 }
+#endif  // CONFIG_AUDIO_AEC
+
+// ============================================================================
+// Voice Activity Detection
+// ============================================================================
 
 /**
- * @brief Update voice activity detection state
+ * @brief Run the detector on one 16kHz block and publish edges
  */
 static void update_vad(const int16_t *samples, size_t num_samples)
 {
-    float energy = calculate_energy_db(samples, num_samples);
-    s_audio.vad.energy_db = energy;
+    audio_vad_t *det = &s_audio.vad_detector;
+    bool device_vad = false, device_voice = false;
+    int16_t doa_deg = -1;
+    uint32_t events;
+
+#ifdef CONFIG_AUDIO_INPUT_USB
+    // A ReSpeaker's own detector replaces the energy VAD while it reports
+    usb_audio_input_beam_t beam;
+    if (usb_audio_input_get_beam(&beam) == ESP_OK &&
+        esp_timer_get_time() - beam.timestamp_us < USB_BEAM_FRESH_US) {
+        device_vad = true;
+        device_voice = beam.voice;
+        doa_deg = (int16_t)beam.doa_deg;
+    }
+#endif
+
+    if (device_vad) {
+        events = audio_vad_process_decision(det, device_voice, num_samples);
+    } else {
+        events = audio_vad_process(det, samples, num_samples);
+        s_audio.vad.energy_db = audio_vad_level_q8(det) / 256.0f;
+        s_audio.vad.noise_floor_db = audio_vad_floor_q8(det) / 256.0f;
+    }
+
+    s_audio.vad.is_active = audio_vad_active(det);
+    s_audio.vad.duration_ms = audio_vad_duration_ms(det);
+    s_audio.vad.device_vad = device_vad;
+    s_audio.vad.doa_deg = doa_deg;
+
+    if (events) {
+        EventBits_t bits = 0;
+        if (events & AUDIO_VAD_EVENT_START) bits |= AUDIO_VAD_START_BIT;
+        if (events & AUDIO_VAD_EVENT_END) bits |= AUDIO_VAD_END_BIT;
+        xEventGroupSetBits(s_audio.event_group, bits);
+    }
+}
+
+#ifdef CONFIG_AUDIO_PIPELINE_BENCHMARK
+// ============================================================================
+// Mic Path Benchmark (on target)
+// ============================================================================
+
+#ifndef CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ
+#define CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ     360
+#endif
+#define MIC_BENCH_ITERATIONS    400     // 2 s of 5ms blocks
+
+static int cmp_cycles(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Time process_mic_data() on synthetic blocks, then restore state
+ *
+ * Runs the whole mic path (decimator, AEC, pre-roll trim, VAD, analyzer)
+ * on a tone burst over LCG noise, as mic_read_task would, and logs cycles
+ * per 5ms block. Nothing is playing yet, so the AEC takes its silent-
+ * reference bypass; tools/host_bench times it with a live reference.
+ */
+static void mic_path_benchmark(uint32_t iterations)
+{
+    static int16_t block[MIC_DMA_FRAME_NUM * INPUT_CHANNELS];
+    uint32_t *cycles = malloc(iterations * sizeof(uint32_t));
+    if (!cycles) return;
+
+    uint32_t seed = 0x1234567u;
+    uint32_t starts = 0;
+    for (uint32_t it = 0; it < iterations; it++) {
+        // Speech-level square wave for the middle half, noise otherwise
+        bool burst = it >= iterations / 4 && it < 3 * iterations / 4;
+        for (size_t i = 0; i < MIC_DMA_FRAME_NUM; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            int16_t x = (int16_t)(seed >> 16) / 512;
+            if (burst) x += ((i / 40) & 1) ? 8000 : -8000;     // 600Hz
+            for (int c = 0; c < INPUT_CHANNELS; c++) block[i * INPUT_CHANNELS + c] = x;
+        }
 
-    bool was_active = s_audio.vad.is_active;
-    s_audio.vad.is_active = (energy > s_audio.energy_threshold);
+        uint32_t start = esp_cpu_get_cycle_count();
+        process_mic_data(&s_audio.decimator, CONFIG_MIC_SAMPLE_RATE,
+                         (const uint8_t *)block, sizeof(block));
+        cycles[it] = esp_cpu_get_cycle_count() - start;
 
-    if (s_audio.vad.is_active && !was_active) {
-        // Voice started
-        s_audio.voice_start_time = xTaskGetTickCount() * portTICK_PERIOD_MS;
-        s_audio.vad.duration_ms = 0;
-    } else if (s_audio.vad.is_active) {
-        // Voice ongoing
-        s_audio.vad.duration_ms = (xTaskGetTickCount() * portTICK_PERIOD_MS) - s_audio.voice_start_time;
+        if (xEventGroupClearBits(s_audio.event_group, AUDIO_VAD_START_BIT) & AUDIO_VAD_START_BIT) {
+            starts++;
+        }
     }
+
+    uint64_t total = 0;
+    for (uint32_t it = 0; it < iterations; it++) total += cycles[it];
+    qsort(cycles, iterations, sizeof(uint32_t), cmp_cycles);
+
+    uint32_t avg = (uint32_t)(total / iterations);
+    uint32_t budget = CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ * 5000;      // 5ms of cycles
+    ESP_LOGI(TAG, "Mic path benchmark: %lu cycles/5ms block avg, p50 %lu, p99 %lu, worst %lu "
+             "(%lu.%02lu%% of a core at %d MHz), %lu VAD start(s), %lu iterations",
+             (unsigned long)avg, (unsigned long)cycles[iterations / 2],
+             (unsigned long)cycles[(iterations * 99) / 100], (unsigned long)cycles[iterations - 1],
+             (unsigned long)((uint64_t)avg * 100 / budget),
+             (unsigned long)(((uint64_t)avg * 10000 / budget) % 100),
+             CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ, (unsigned long)starts, (unsigned long)iterations);
+    free(cycles);
+
+    // Leave the path as audio_pipeline_init() set it up
+    const audio_vad_config_t vad_cfg = s_audio.vad_detector.cfg;
+    audio_vad_init(&s_audio.vad_detector, &vad_cfg);
+    memset(&s_audio.vad, 0, sizeof(s_audio.vad));
+    s_audio.vad.doa_deg = -1;
+    audio_decimator_reset(&s_audio.decimator);
+    capture_reset();
+    s_audio.raw_overruns = 0;
+    s_audio.overruns = 0;
+#ifdef CONFIG_AUDIO_AEC
+    audio_ring_reset(&s_audio.aec_ref_ring);
+    audio_aec_reset(s_audio.aec);
+    memset(&s_audio.aec_stats, 0, sizeof(s_audio.aec_stats));
+    s_audio.aec_cost_us = 0;
+    s_audio.aec_samples = 0;
+#endif
+#ifdef CONFIG_AUDIO_ANALYZER
+    audio_analyzer_init(&s_audio.analyzer[AUDIO_TAP_MIC], CONFIG_PROCESSED_SAMPLE_RATE, 1);
+#endif
+    xEventGroupClearBits(s_audio.event_group, AUDIO_VAD_START_BIT | AUDIO_VAD_END_BIT);
 }
+#endif  // CONFIG_AUDIO_PIPELINE_BENCHMARK
 
 // ============================================================================
 // Public API Implementation
@@ -727,37 +1721,75 @@ esp_err_t audio_pipeline_init(void)
     }
 
     // ========================================
-    // Allocate buffers in PSRAM
+    // Allocate buffers in PSRAM (arena slabs, reused on re-init)
     // ========================================
 
-    // Output buffer (to DAC)
-    s_audio.output_buffer = heap_caps_malloc(AUDIO_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
-    if (!s_audio.output_buffer) {
-        ESP_LOGE(TAG, "Failed to allocate output buffer");
-        return ESP_ERR_NO_MEM;
+    // Output stream rings (to mixer -> DAC)
+    for (int i = 0; i < AUDIO_STREAM_COUNT; i++) {
+        char slab_name[MEM_ARENA_NAME_LEN];
+        snprintf(slab_name, sizeof(slab_name), "out_stream%d", i);
+        s_audio.streams[i].buffer = mem_arena_acquire(MEM_REGION_PSRAM, slab_name, AUDIO_BUFFER_SIZE);
+        if (!s_audio.streams[i].buffer) {
+            ESP_LOGE(TAG, "Failed to allocate output stream %d buffer", i);
+            return ESP_ERR_NO_MEM;
+        }
     }
 
     // Raw input buffer: 48kHz stereo (high quality for local LLM)
-    s_audio.input_buffer_raw = heap_caps_malloc(RAW_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    s_audio.input_buffer_raw = mem_arena_acquire(MEM_REGION_PSRAM, "in_raw", RAW_BUFFER_SIZE);
     if (!s_audio.input_buffer_raw) {
         ESP_LOGE(TAG, "Failed to allocate raw input buffer");
         return ESP_ERR_NO_MEM;
     }
 
     // Processed input buffer: 16kHz mono (ESPHome/Whisper compatible)
-    s_audio.input_buffer_processed = heap_caps_malloc(PROCESSED_BUFFER_SIZE, MALLOC_CAP_SPIRAM);
+    s_audio.input_buffer_processed = mem_arena_acquire(MEM_REGION_PSRAM, "in_processed",
+                                                       PROCESSED_BUFFER_SIZE);
     if (!s_audio.input_buffer_processed) {
         ESP_LOGE(TAG, "Failed to allocate processed input buffer");
         return ESP_ERR_NO_MEM;
     }
 
-    // Legacy alias for backward compatibility
-    s_audio.input_buffer = s_audio.input_buffer_processed;
+    const uint16_t vol_step = audio_gain_ramp_step(MIX_VOLUME_RAMP_MS, AUDIO_DMA_FRAME_NUM,
+                                                   CONFIG_I2S0_SAMPLE_RATE);
+    for (int i = 0; i < AUDIO_STREAM_COUNT; i++) {
+        output_stream_t *st = &s_audio.streams[i];
+        audio_ring_init(&st->ring, st->buffer, AUDIO_BUFFER_SIZE);
+        audio_gain_init(&st->gain, AUDIO_GAIN_UNITY, vol_step);
+        audio_gain_init(&st->duck, AUDIO_GAIN_UNITY, vol_step);
+        st->block_gain = 0;
+    }
+    audio_ring_init(&s_audio.raw_ring, s_audio.input_buffer_raw, RAW_BUFFER_SIZE);
+    audio_ring_init(&s_audio.processed_ring, s_audio.input_buffer_processed, PROCESSED_BUFFER_SIZE);
+#ifndef CONFIG_AUDIO_CAPTURE_SESSIONS
+    // One session for the whole run: the rings are always readable
+    atomic_store(&s_audio.capture_request, true);
+#endif
+
+#ifdef CONFIG_AUDIO_AEC
+    // Echo canceller: filter and reference ring in internal RAM (hot path)
+    s_audio.aec_ref_buffer = mem_arena_acquire(MEM_REGION_DMA, "aec_ref", AEC_REF_BUFFER_SIZE);
+    s_audio.aec = audio_aec_create(AEC_TAPS, AEC_STEP_SIZE);
+    if (!s_audio.aec_ref_buffer || !s_audio.aec) {
+        ESP_LOGE(TAG, "Failed to allocate echo canceller");
+        return ESP_ERR_NO_MEM;
+    }
+    audio_ring_init(&s_audio.aec_ref_ring, s_audio.aec_ref_buffer, AEC_REF_BUFFER_SIZE);
+    audio_decimator_init(&s_audio.aec_ref_decimator, DAC_CHANNELS, AUDIO_DECIM_FACTOR);
+    s_audio.aec_inflight_head = 0;
+    s_audio.aec_inflight_free = AUDIO_DMA_DESC_NUM;
+    s_audio.aec_enabled = true;
+#endif
 
     ESP_LOGI(TAG, "Buffers allocated in PSRAM:");
-    ESP_LOGI(TAG, "  Output (DAC):           %d KB", AUDIO_BUFFER_SIZE / 1024);
+    ESP_LOGI(TAG, "  Output (DAC):           %d x %d KB", AUDIO_STREAM_COUNT, AUDIO_BUFFER_SIZE / 1024);
     ESP_LOGI(TAG, "  Raw (48kHz stereo):     %d KB", RAW_BUFFER_SIZE / 1024);
     ESP_LOGI(TAG, "  Processed (16kHz mono): %d KB", PROCESSED_BUFFER_SIZE / 1024);
+    ESP_LOGI(TAG, "  Pre-roll:               %d ms", CONFIG_AUDIO_PREROLL_MS);
+#ifdef CONFIG_AUDIO_AEC
+    ESP_LOGI(TAG, "  AEC: %d taps (%d ms tail), delay %d ms",
+             AEC_TAPS, CONFIG_AUDIO_AEC_TAIL_MS, CONFIG_AUDIO_AEC_DELAY_MS);
+#endif
 
     // ========================================
     // Initialize I2S0 Output (DAC)
@@ -795,20 +1827,62 @@ esp_err_t audio_pipeline_init(void)
     // Set defaults
     s_audio.volume = 70;
     s_audio.muted = false;
-    s_audio.energy_threshold = -40.0f;  // dB threshold for VAD
+    audio_gain_init(&s_audio.master_gain, audio_gain_from_percent(s_audio.volume),
+                    audio_gain_ramp_step(MIX_VOLUME_RAMP_MS, AUDIO_DMA_FRAME_NUM, CONFIG_I2S0_SAMPLE_RATE));
+    s_audio.duck_level = CONFIG_AUDIO_MIXER_DUCK_LEVEL;
+#ifdef CONFIG_AUDIO_MIXER_AUTO_DUCK
+    s_audio.duck_enabled = true;
+#endif
+    audio_vad_config_t vad_cfg = {
+#ifdef CONFIG_AUDIO_VAD_FIXED
+        .adaptive = false,
+        .threshold_q8 = AUDIO_VAD_DB_Q8(CONFIG_AUDIO_VAD_FIXED_LEVEL_DB),
+#else
+        .adaptive = true,
+        .threshold_q8 = AUDIO_VAD_DB_Q8(CONFIG_AUDIO_VAD_THRESHOLD_DB),
+#endif
+        .attack_frames = CONFIG_AUDIO_VAD_ATTACK_MS / AUDIO_VAD_FRAME_MS,
+        .hangover_frames = CONFIG_AUDIO_VAD_HANGOVER_MS / AUDIO_VAD_FRAME_MS,
+#ifdef CONFIG_AUDIO_VAD_SPECTRAL
+        .spectral = true,
+#endif
+    };
+    audio_vad_init(&s_audio.vad_detector, &vad_cfg);
+    s_audio.vad.doa_deg = -1;
     s_audio.state = AUDIO_STATE_IDLE;
-    s_audio.downsample_counter = 0;
+    audio_decimator_init(&s_audio.decimator, INPUT_CHANNELS, DOWNSAMPLE_RATIO);
+#ifdef CONFIG_AUDIO_ANALYZER
+    audio_analyzer_init(&s_audio.analyzer[AUDIO_TAP_MIC], CONFIG_PROCESSED_SAMPLE_RATE, 1);
+    audio_analyzer_init(&s_audio.analyzer[AUDIO_TAP_OUTPUT], CONFIG_I2S0_SAMPLE_RATE, DAC_CHANNELS);
+#endif
 
-    // Reset buffer positions
-    s_audio.raw_write_pos = 0;
-    s_audio.raw_read_pos = 0;
-    s_audio.processed_write_pos = 0;
-    s_audio.processed_read_pos = 0;
-    s_audio.input_write_pos = 0;
-    s_audio.input_read_pos = 0;
+#ifdef CONFIG_AUDIO_DECIMATOR_BENCHMARK
+    audio_decimator_benchmark(200);
+#endif
 
     s_audio.initialized = true;
 
+#ifdef CONFIG_AUDIO_PIPELINE_BENCHMARK
+    // Before the mic and DAC tasks exist: this is the rings' only producer
+    mic_path_benchmark(MIC_BENCH_ITERATIONS);
+#endif
+
+    // DAC output engine: one descriptor staging buffer in internal RAM
+    s_audio.output_dma_buf = mem_arena_acquire(MEM_REGION_DMA, "dac_staging", DAC_DESC_DMA_BYTES);
+    if (!s_audio.output_dma_buf) {
+        ESP_LOGE(TAG, "Failed to allocate DAC staging buffer");
+        return ESP_ERR_NO_MEM;
+    }
+
+    s_audio.output_running = true;
+    if (xTaskCreatePinnedToCore(dac_output_task, "dac_out", DAC_TASK_STACK, NULL,
+                                DAC_TASK_PRIORITY, &s_audio.output_task_handle,
+                                DAC_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create DAC output task");
+        s_audio.output_running = false;
+        return ESP_FAIL;
+    }
+
     // Enable I2S output channel (DAC)
     i2s_channel_enable(s_audio.i2s0_tx_handle);
 
@@ -824,7 +1898,7 @@ esp_err_t audio_pipeline_init(void)
         NULL,
         5,  // Priority
         &s_audio.mic_task_handle,
-        1   // Core 1
+        MIC_TASK_CORE
     );
 
     if (task_ret != pdPASS) {
@@ -858,8 +1932,9 @@ void audio_pipeline_deinit(void)
     ESP_LOGI(TAG, "Deinitializing audio pipeline...");
 
 #ifdef CONFIG_AUDIO_INPUT_USB
-    // Deinit USB Audio Input
+    // Deinit USB Audio Input, then its worker
     usb_audio_input_deinit();
+    deinit_usb_capture();
 #else
     // Stop I2S microphone task
     s_audio.mic_ready = false;
@@ -877,6 +1952,15 @@ void audio_pipeline_deinit(void)
     }
 #endif
 
+    // Stop DAC output task
+    s_audio.output_running = false;
+    if (s_audio.output_task_handle) {
+        xTaskNotifyGive(s_audio.output_task_handle);
+        for (int i = 0; i < 20 && s_audio.output_task_handle; i++) {
+            vTaskDelay(pdMS_TO_TICKS(10));
+        }
+    }
+
     // Disable and delete I2S output channel (DAC)
     if (s_audio.i2s0_tx_handle) {
         i2s_channel_disable(s_audio.i2s0_tx_handle);
@@ -884,16 +1968,17 @@ void audio_pipeline_deinit(void)
         s_audio.i2s0_tx_handle = NULL;
     }
 
-    // Free buffers
-    if (s_audio.output_buffer) {
-        free(s_audio.output_buffer);
-    }
-    if (s_audio.input_buffer_raw) {
-        free(s_audio.input_buffer_raw);
-    }
-    if (s_audio.input_buffer_processed) {
-        free(s_audio.input_buffer_processed);
+    // Hand buffers back to the arena (kept for the next init)
+    mem_arena_release(s_audio.output_dma_buf);
+    for (int i = 0; i < AUDIO_STREAM_COUNT; i++) {
+        mem_arena_release(s_audio.streams[i].buffer);
     }
+    mem_arena_release(s_audio.input_buffer_raw);
+    mem_arena_release(s_audio.input_buffer_processed);
+#ifdef CONFIG_AUDIO_AEC
+    audio_aec_destroy(s_audio.aec);
+    mem_arena_release(s_audio.aec_ref_buffer);
+#endif
 
     // Delete primitives
     if (s_audio.event_group) {
@@ -927,49 +2012,9 @@ void audio_pipeline_process(void)
     if (!s_audio.initialized) return;
 
     // ========================================
-    // Note: Audio input is handled by USB Audio Host callbacks
-    // (usb_audio_data_callback) - no need to poll here
+    // Audio input is handled by USB Audio Host callbacks / mic task, and
+    // DAC output by the event-paced dac_output_task - nothing to poll here
     // ========================================
-
-    // Write to DAC (I2S0) if playing
-    if (s_audio.state == AUDIO_STATE_PLAYING || s_audio.state == AUDIO_STATE_DUPLEX) {
-        if (xSemaphoreTake(s_audio.mutex, pdMS_TO_TICKS(10))) {
-            size_t available = (s_audio.output_write_pos - s_audio.output_read_pos + AUDIO_BUFFER_SIZE) % AUDIO_BUFFER_SIZE;
-            if (available >= 512) {
-                uint8_t tx_buf[512];
-                size_t to_send = 512;
-
-                // Copy from ring buffer
-                if (s_audio.output_read_pos + to_send <= AUDIO_BUFFER_SIZE) {
-                    memcpy(tx_buf, s_audio.output_buffer + s_audio.output_read_pos, to_send);
-                } else {
-                    size_t first = AUDIO_BUFFER_SIZE - s_audio.output_read_pos;
-                    memcpy(tx_buf, s_audio.output_buffer + s_audio.output_read_pos, first);
-                    memcpy(tx_buf + first, s_audio.output_buffer, to_send - first);
-                }
-                s_audio.output_read_pos = (s_audio.output_read_pos + to_send) % AUDIO_BUFFER_SIZE;
-
-                xSemaphoreGive(s_audio.mutex);
-
-                // Apply volume
-                if (!s_audio.muted) {
-                    int16_t *samples = (int16_t *)tx_buf;
-                    float vol_scale = s_audio.volume / 100.0f;
-                    for (size_t i = 0; i < to_send / 2; i++) {
-                        samples[i] = (int16_t)(samples[i] * vol_scale);
-                    }
-                } else {
-                    memset(tx_buf, 0, to_send);
-                }
-
-                size_t bytes_written;
-                i2s_channel_write(s_audio.i2s0_tx_handle, tx_buf, to_send, &bytes_written, pdMS_TO_TICKS(10));
-            } else {
-                xSemaphoreGive(s_audio.mutex);
-                s_audio.underruns++;
-            }
-        }
-    }
 }
 
 audio_state_t audio_pipeline_get_state(void)
@@ -979,6 +2024,12 @@ audio_state_t audio_pipeline_get_state(void)
 
 esp_err_t audio_pipeline_play(void)
 {
+#ifdef CONFIG_AUDIO_OUTPUT_PRELOAD
+    // Start transmission with a full DMA batch rather than a trickle
+    if (s_audio.state != AUDIO_STATE_PLAYING && s_audio.state != AUDIO_STATE_DUPLEX) {
+        atomic_store_explicit(&s_audio.output_prime_pending, true, memory_order_release);
+    }
+#endif
     s_audio.state = AUDIO_STATE_PLAYING;
     xEventGroupSetBits(s_audio.event_group, AUDIO_PLAYING_BIT);
     return ESP_OK;
@@ -986,16 +2037,24 @@ esp_err_t audio_pipeline_play(void)
 
 esp_err_t audio_pipeline_stop(void)
 {
+    if (!s_audio.initialized) return ESP_ERR_INVALID_STATE;
+
+    if (xSemaphoreTake(s_audio.mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
+
     s_audio.state = AUDIO_STATE_IDLE;
     xEventGroupClearBits(s_audio.event_group, AUDIO_PLAYING_BIT | AUDIO_RECORDING_BIT);
 
-    // Clear buffers
-    if (xSemaphoreTake(s_audio.mutex, pdMS_TO_TICKS(100))) {
-        s_audio.output_write_pos = 0;
-        s_audio.output_read_pos = 0;
-        xSemaphoreGive(s_audio.mutex);
+    // Drop queued output: everything written so far, but nothing written
+    // after this point. The consumer applies it on its next pass.
+    for (int i = 0; i < AUDIO_STREAM_COUNT; i++) {
+        output_stream_t *st = &s_audio.streams[i];
+        st->flush_mark = audio_ring_head(&st->ring);
+        atomic_store_explicit(&st->flush_pending, true, memory_order_release);
     }
 
+    xSemaphoreGive(s_audio.mutex);
     return ESP_OK;
 }
 
@@ -1015,40 +2074,94 @@ esp_err_t audio_pipeline_resume(void)
 
 size_t audio_pipeline_write(const uint8_t *data, size_t len, uint32_t timeout_ms)
 {
-    if (!s_audio.initialized || !data || len == 0) return 0;
+    (void)timeout_ms;
+    return audio_pipeline_write_stream(AUDIO_STREAM_MUSIC, data, len);
+}
 
-    if (xSemaphoreTake(s_audio.mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
-        return 0;
-    }
+size_t audio_pipeline_write_stream(audio_stream_id_t stream, const uint8_t *data, size_t len)
+{
+    if (!s_audio.initialized || !data || len == 0 || stream >= AUDIO_STREAM_COUNT) return 0;
 
-    size_t space = (s_audio.output_read_pos - s_audio.output_write_pos - 1 + AUDIO_BUFFER_SIZE) % AUDIO_BUFFER_SIZE;
-    size_t to_write = (len < space) ? len : space;
+    // Single producer per stream: partial writes when the ring is full
+    return audio_ring_write(&s_audio.streams[stream].ring, data, len);
+}
 
-    if (to_write > 0) {
-        size_t first_chunk = AUDIO_BUFFER_SIZE - s_audio.output_write_pos;
-        if (to_write <= first_chunk) {
-            memcpy(s_audio.output_buffer + s_audio.output_write_pos, data, to_write);
-        } else {
-            memcpy(s_audio.output_buffer + s_audio.output_write_pos, data, first_chunk);
-            memcpy(s_audio.output_buffer, data + first_chunk, to_write - first_chunk);
-        }
-        s_audio.output_write_pos = (s_audio.output_write_pos + to_write) % AUDIO_BUFFER_SIZE;
-    }
+esp_err_t audio_pipeline_flush_stream(audio_stream_id_t stream)
+{
+    if (!s_audio.initialized) return ESP_ERR_INVALID_STATE;
+    if (stream >= AUDIO_STREAM_COUNT) return ESP_ERR_INVALID_ARG;
 
-    xSemaphoreGive(s_audio.mutex);
-    return to_write;
+    output_stream_t *st = &s_audio.streams[stream];
+    st->flush_mark = audio_ring_head(&st->ring);
+    atomic_store_explicit(&st->flush_pending, true, memory_order_release);
+    return ESP_OK;
+}
+
+esp_err_t audio_pipeline_set_stream_gain(audio_stream_id_t stream, uint8_t gain, uint32_t ramp_ms)
+{
+    if (!s_audio.initialized) return ESP_ERR_INVALID_STATE;
+    if (stream >= AUDIO_STREAM_COUNT) return ESP_ERR_INVALID_ARG;
+
+    audio_gain_t *g = &s_audio.streams[stream].gain;
+    g->step = audio_gain_ramp_step(ramp_ms ? ramp_ms : MIX_VOLUME_RAMP_MS,
+                                   AUDIO_DMA_FRAME_NUM, CONFIG_I2S0_SAMPLE_RATE);
+    audio_gain_set_target(g, audio_gain_from_percent(gain));
+    return ESP_OK;
+}
+
+esp_err_t audio_pipeline_set_ducking(bool enable, uint8_t level)
+{
+    if (level > 100) level = 100;
+    s_audio.duck_level = level;
+    s_audio.duck_enabled = enable;
+    ESP_LOGI(TAG, "Ducking: %s (music at %d%% under TTS/chime)", enable ? "ON" : "OFF", level);
+    return ESP_OK;
 }
 
 esp_err_t audio_pipeline_record_start(void)
 {
-    s_audio.state = AUDIO_STATE_RECORDING;
+    return audio_pipeline_record_start_preroll(CONFIG_AUDIO_PREROLL_MS, NULL);
+}
+
+esp_err_t audio_pipeline_record_start_preroll(uint32_t preroll_ms, uint32_t *actual_ms)
+{
+    if (actual_ms) *actual_ms = 0;
+    if (!s_audio.initialized) return ESP_ERR_INVALID_STATE;
+
+#ifdef CONFIG_AUDIO_CAPTURE_SESSIONS
+    if (!atomic_load_explicit(&s_audio.capture_request, memory_order_relaxed)) {
+        if (preroll_ms > CONFIG_AUDIO_PREROLL_MS) preroll_ms = CONFIG_AUDIO_PREROLL_MS;
+        s_audio.capture_preroll_ms = preroll_ms;
+        s_audio.capture_preroll_actual_ms = 0;
+        atomic_store_explicit(&s_audio.capture_request, true, memory_order_release);
+
+        // The producer places the cursor on its next block. Without a
+        // running mic (USB not yet connected) the session opens when it starts.
+        TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(CAPTURE_ACK_TIMEOUT_MS) + 1;
+        while (!capture_open() && (int32_t)(xTaskGetTickCount() - deadline) < 0) {
+            vTaskDelay(1);
+        }
+        if (actual_ms) *actual_ms = s_audio.capture_preroll_actual_ms;
+        ESP_LOGD(TAG, "Recording started with %lu ms pre-roll",
+                 (unsigned long)s_audio.capture_preroll_actual_ms);
+    }
+#endif
+
+    // Recording must not stop playback
+    s_audio.state = (s_audio.state == AUDIO_STATE_PLAYING || s_audio.state == AUDIO_STATE_DUPLEX)
+                        ? AUDIO_STATE_DUPLEX : AUDIO_STATE_RECORDING;
     xEventGroupSetBits(s_audio.event_group, AUDIO_RECORDING_BIT);
     return ESP_OK;
 }
 
 esp_err_t audio_pipeline_record_stop(void)
 {
-    s_audio.state = AUDIO_STATE_IDLE;
+#ifdef CONFIG_AUDIO_CAPTURE_SESSIONS
+    // The producer returns both rings to the rolling pre-roll window
+    atomic_store_explicit(&s_audio.capture_request, false, memory_order_release);
+#endif
+
+    s_audio.state = (s_audio.state == AUDIO_STATE_DUPLEX) ? AUDIO_STATE_PLAYING : AUDIO_STATE_IDLE;
     xEventGroupClearBits(s_audio.event_group, AUDIO_RECORDING_BIT);
     return ESP_OK;
 }
@@ -1061,31 +2174,13 @@ esp_err_t audio_pipeline_record_stop(void)
  */
 size_t audio_pipeline_read(uint8_t *data, size_t len, uint32_t timeout_ms)
 {
+    (void)timeout_ms;
     if (!s_audio.initialized || !data || len == 0) return 0;
+    if (!capture_enter(&s_audio.processed_ring, &s_audio.processed_floor)) return 0;
 
-    if (xSemaphoreTake(s_audio.mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
-        return 0;
-    }
-
-    size_t available = (s_audio.processed_write_pos - s_audio.processed_read_pos + PROCESSED_BUFFER_SIZE) % PROCESSED_BUFFER_SIZE;
-    size_t to_read = (len < available) ? len : available;
-
-    if (to_read > 0) {
-        size_t first_chunk = PROCESSED_BUFFER_SIZE - s_audio.processed_read_pos;
-        if (to_read <= first_chunk) {
-            memcpy(data, s_audio.input_buffer_processed + s_audio.processed_read_pos, to_read);
-        } else {
-            memcpy(data, s_audio.input_buffer_processed + s_audio.processed_read_pos, first_chunk);
-            memcpy(data + first_chunk, s_audio.input_buffer_processed, to_read - first_chunk);
-        }
-        s_audio.processed_read_pos = (s_audio.processed_read_pos + to_read) % PROCESSED_BUFFER_SIZE;
-
-        // Sync legacy alias
-        s_audio.input_read_pos = s_audio.processed_read_pos;
-    }
-
-    xSemaphoreGive(s_audio.mutex);
-    return to_read;
+    size_t n = audio_ring_read(&s_audio.processed_ring, data, len);
+    capture_leave();
+    return n;
 }
 
 /**
@@ -1096,46 +2191,118 @@ size_t audio_pipeline_read(uint8_t *data, size_t len, uint32_t timeout_ms)
  *
  * @param data Output buffer
  * @param len Maximum bytes to read
- * @param timeout_ms Timeout in milliseconds
+ * @param timeout_ms Unused (reads never block)
  * @return Number of bytes actually read
  */
 size_t audio_pipeline_read_raw(uint8_t *data, size_t len, uint32_t timeout_ms)
 {
+    (void)timeout_ms;
     if (!s_audio.initialized || !data || len == 0) return 0;
+    if (!capture_enter(&s_audio.raw_ring, &s_audio.raw_floor)) return 0;
 
-    if (xSemaphoreTake(s_audio.mutex, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) {
-        return 0;
-    }
+    size_t n = audio_ring_read(&s_audio.raw_ring, data, len);
+    capture_leave();
+    return n;
+}
 
-    size_t available = (s_audio.raw_write_pos - s_audio.raw_read_pos + RAW_BUFFER_SIZE) % RAW_BUFFER_SIZE;
-    size_t to_read = (len < available) ? len : available;
+// ============================================================================
+// Zero-copy Capture Access
+// ============================================================================
 
-    if (to_read > 0) {
-        size_t first_chunk = RAW_BUFFER_SIZE - s_audio.raw_read_pos;
-        if (to_read <= first_chunk) {
-            memcpy(data, s_audio.input_buffer_raw + s_audio.raw_read_pos, to_read);
-        } else {
-            memcpy(data, s_audio.input_buffer_raw + s_audio.raw_read_pos, first_chunk);
-            memcpy(data + first_chunk, s_audio.input_buffer_raw, to_read - first_chunk);
-        }
-        s_audio.raw_read_pos = (s_audio.raw_read_pos + to_read) % RAW_BUFFER_SIZE;
+/**
+ * @brief Acquire a span; it stays valid (the session stays entered) until
+ *        the matching release
+ */
+static esp_err_t capture_acquire(audio_ring_t *ring, _Atomic uint32_t *floor, _Atomic bool *held,
+                                 const uint8_t **data, size_t *len)
+{
+    if (!data || !len) return ESP_ERR_INVALID_ARG;
+    *data = NULL;
+    *len = 0;
+    if (!s_audio.initialized) return ESP_ERR_INVALID_STATE;
+
+    if (!atomic_load_explicit(held, memory_order_relaxed)) {
+        if (!capture_enter(ring, floor)) return ESP_OK;
+        atomic_store_explicit(held, true, memory_order_relaxed);
     }
+    *len = audio_ring_read_acquire(ring, data);
+    if (*len == 0) {
+        atomic_store_explicit(held, false, memory_order_relaxed);
+        capture_leave();
+    }
+    return ESP_OK;
+}
 
-    xSemaphoreGive(s_audio.mutex);
-    return to_read;
+static void capture_release(audio_ring_t *ring, _Atomic bool *held, size_t len)
+{
+    if (!atomic_load_explicit(held, memory_order_relaxed)) return;
+    if (len > 0) audio_ring_read_release(ring, len);
+    atomic_store_explicit(held, false, memory_order_relaxed);
+    capture_leave();
+}
+
+esp_err_t audio_pipeline_acquire_processed(const uint8_t **data, size_t *len)
+{
+    return capture_acquire(&s_audio.processed_ring, &s_audio.processed_floor,
+                           &s_audio.processed_span_held, data, len);
+}
+
+void audio_pipeline_release_processed(size_t len)
+{
+    capture_release(&s_audio.processed_ring, &s_audio.processed_span_held, len);
+}
+
+esp_err_t audio_pipeline_acquire_raw(const uint8_t **data, size_t *len)
+{
+    return capture_acquire(&s_audio.raw_ring, &s_audio.raw_floor, &s_audio.raw_span_held, data, len);
+}
+
+void audio_pipeline_release_raw(size_t len)
+{
+    capture_release(&s_audio.raw_ring, &s_audio.raw_span_held, len);
+}
+
+void audio_pipeline_discard_processed(size_t keep_bytes)
+{
+    if (!s_audio.initialized) return;
+    bool held = atomic_load_explicit(&s_audio.processed_span_held, memory_order_relaxed);
+    if (!held && !capture_enter(&s_audio.processed_ring, &s_audio.processed_floor)) return;
+
+    uint32_t head = audio_ring_head(&s_audio.processed_ring);
+    keep_bytes &= ~(sizeof(int16_t) - 1);
+    audio_ring_discard_to(&s_audio.processed_ring, head - (uint32_t)keep_bytes);
+    if (held) {
+        // The span is gone with the discarded data
+        atomic_store_explicit(&s_audio.processed_span_held, false, memory_order_relaxed);
+    }
+    capture_leave();
 }
 
 /**
  * @brief Get raw audio buffer info
  *
  * @param sample_rate Output: sample rate in Hz (48000)
- * @param channels Output: number of channels (1=mono or 2=stereo)
+ * @param channels Output: number of channels (1=mono or 2=stereo, up to 8 over USB)
  * @param bit_depth Output: bits per sample (16)
+ * @param channel_map Output (optional): role of each channel
  */
-void audio_pipeline_get_raw_format(uint32_t *sample_rate, uint8_t *channels, uint8_t *bit_depth)
+void audio_pipeline_get_raw_format(uint32_t *sample_rate, uint8_t *channels, uint8_t *bit_depth,
+                                   audio_channel_role_t *channel_map)
 {
+#ifdef CONFIG_AUDIO_INPUT_USB
+    // Raw buffer holds the device's channels at its nominal rate, on the local clock
+    if (sample_rate) *sample_rate = s_usb.rate ? s_usb.rate : USB_AUDIO_SAMPLE_RATE;
+    if (channels) *channels = s_usb.decimator.channels ? s_usb.decimator.channels : USB_AUDIO_CHANNELS;
+    if (channel_map) memcpy(channel_map, s_usb.channel_map, sizeof(s_usb.channel_map));
+#else
     if (sample_rate) *sample_rate = CONFIG_MIC_SAMPLE_RATE;
     if (channels) *channels = INPUT_CHANNELS;
+    if (channel_map) {
+        for (int c = 0; c < AUDIO_RAW_MAX_CHANNELS; c++) {
+            channel_map[c] = (c < INPUT_CHANNELS) ? AUDIO_CHANNEL_MIC : AUDIO_CHANNEL_UNKNOWN;
+        }
+    }
+#endif
     if (bit_depth) *bit_depth = 16;
 }
 
@@ -1165,10 +2332,31 @@ void audio_pipeline_get_voice_activity(voice_activity_t *activity)
     }
 }
 
+uint32_t audio_pipeline_wait_vad_event(uint32_t timeout_ms)
+{
+    if (!s_audio.event_group) return AUDIO_VAD_EVENT_NONE;
+
+    EventBits_t bits = xEventGroupWaitBits(
+        s_audio.event_group,
+        AUDIO_VAD_START_BIT | AUDIO_VAD_END_BIT,
+        pdTRUE,     // Consume
+        pdFALSE,    // Either edge
+        pdMS_TO_TICKS(timeout_ms)
+    );
+
+    uint32_t events = AUDIO_VAD_EVENT_NONE;
+    if (bits & AUDIO_VAD_START_BIT) events |= AUDIO_VAD_EVENT_START;
+    if (bits & AUDIO_VAD_END_BIT) events |= AUDIO_VAD_EVENT_END;
+    return events;
+}
+
 esp_err_t audio_pipeline_set_volume(uint8_t volume)
 {
     if (volume > 100) volume = 100;
     s_audio.volume = volume;
+    if (!s_audio.muted) {
+        audio_gain_set_target(&s_audio.master_gain, audio_gain_from_percent(volume));
+    }
     ESP_LOGI(TAG, "Volume set to %d%%", volume);
     return ESP_OK;
 }
@@ -1181,20 +2369,26 @@ uint8_t audio_pipeline_get_volume(void)
 esp_err_t audio_pipeline_set_mute(bool mute)
 {
     s_audio.muted = mute;
+    // Ramped, so muting never clicks
+    audio_gain_set_target(&s_audio.master_gain, mute ? 0 : audio_gain_from_percent(s_audio.volume));
     ESP_LOGI(TAG, "Mute: %s", mute ? "ON" : "OFF");
     return ESP_OK;
 }
 
 void audio_pipeline_get_buffer_levels(uint8_t *output_level, uint8_t *input_level)
 {
+    if (!s_audio.initialized) {
+        if (output_level) *output_level = 0;
+        if (input_level) *input_level = 0;
+        return;
+    }
     if (output_level) {
-        size_t used = (s_audio.output_write_pos - s_audio.output_read_pos + AUDIO_BUFFER_SIZE) % AUDIO_BUFFER_SIZE;
-        *output_level = (used * 100) / AUDIO_BUFFER_SIZE;
+        *output_level = (output_used_max() * 100) / AUDIO_BUFFER_SIZE;
     }
     if (input_level) {
-        // Use processed buffer size (16kHz mono) for input level
-        size_t used = (s_audio.processed_write_pos - s_audio.processed_read_pos + PROCESSED_BUFFER_SIZE) % PROCESSED_BUFFER_SIZE;
-        *input_level = (used * 100) / PROCESSED_BUFFER_SIZE;
+        // Use processed buffer (16kHz mono) for input level
+        *input_level = (uint8_t)((capture_used(&s_audio.processed_ring, &s_audio.processed_floor) * 100) /
+                                 PROCESSED_BUFFER_SIZE);
     }
 }
 
@@ -1203,3 +2397,79 @@ void audio_pipeline_get_stats(uint32_t *underruns, uint32_t *overruns)
     if (underruns) *underruns = s_audio.underruns;
     if (overruns) *overruns = s_audio.overruns;
 }
+
+void audio_pipeline_get_output_stats(audio_output_stats_t *stats)
+{
+    if (stats) {
+        memcpy(stats, &s_audio.output_stats, sizeof(audio_output_stats_t));
+    }
+}
+
+void audio_pipeline_reset_output_stats(void)
+{
+    memset(&s_audio.output_stats, 0, sizeof(audio_output_stats_t));
+}
+
+esp_err_t audio_pipeline_set_aec_enabled(bool enable)
+{
+#ifdef CONFIG_AUDIO_AEC
+    if (!s_audio.initialized) return ESP_ERR_INVALID_STATE;
+
+    // Applied by the mic path (the canceller's only user)
+    if (enable && !s_audio.aec_enabled) {
+        atomic_store_explicit(&s_audio.aec_reset_pending, true, memory_order_release);
+    }
+    s_audio.aec_enabled = enable;
+    ESP_LOGI(TAG, "Echo cancellation: %s", enable ? "ON" : "OFF");
+    return ESP_OK;
+#else
+    (void)enable;
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t audio_pipeline_get_analysis(audio_tap_t tap, audio_analysis_t *analysis)
+{
+    if (!analysis || tap >= AUDIO_TAP_COUNT) return ESP_ERR_INVALID_ARG;
+#ifdef CONFIG_AUDIO_ANALYZER
+    if (!s_audio.initialized) return ESP_ERR_INVALID_STATE;
+
+    audio_analyzer_read(&s_audio.analyzer[tap], analysis);
+    return ESP_OK;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void audio_pipeline_get_usb_stats(audio_usb_stats_t *stats)
+{
+    if (!stats) return;
+    memset(stats, 0, sizeof(audio_usb_stats_t));
+
+#ifdef CONFIG_AUDIO_INPUT_USB
+    memcpy(stats, &s_usb.stats, sizeof(audio_usb_stats_t));
+#endif
+}
+
+void audio_pipeline_get_aec_stats(audio_aec_stats_t *stats)
+{
+    if (!stats) return;
+    memset(stats, 0, sizeof(audio_aec_stats_t));
+
+#ifdef CONFIG_AUDIO_AEC
+    if (!s_audio.aec) return;
+
+    audio_aec_metrics_t m;
+    audio_aec_get_metrics(s_audio.aec, &m);
+
+    memcpy(stats, &s_audio.aec_stats, sizeof(audio_aec_stats_t));
+    stats->enabled = s_audio.aec_enabled;
+    stats->ref_active = m.ref_active;
+    stats->double_talk = m.double_talk;
+    stats->erle_db = m.erle_db;
+    stats->frames = s_audio.aec_samples / AEC_FRAME_SAMPLES;
+    if (s_audio.aec_samples > 0) {
+        stats->frame_cost_us = (uint32_t)((s_audio.aec_cost_us * AEC_FRAME_SAMPLES) / s_audio.aec_samples);
+    }
+#endif
+}
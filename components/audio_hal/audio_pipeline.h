@@ -30,6 +30,8 @@
 #include <stdbool.h>
 #include "esp_err.h"
 #include "freertos/FreeRTOS.h"
+#include "audio_vad.h"
+#include "audio_analyzer.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,9 +41,14 @@ extern "C" {
 // Constants
 // ============================================================================
 
-#define AUDIO_BUFFER_SIZE       4096
+#define AUDIO_BUFFER_SIZE       (16 * 1024)     // Per output stream, ~85ms at 48kHz stereo 16-bit
 #define AUDIO_DMA_DESC_NUM      6
-#define AUDIO_DMA_FRAME_NUM     240
+#define AUDIO_DMA_FRAME_NUM     240             // Frames per DMA descriptor (5ms at 48kHz)
+#define AUDIO_RAW_MAX_CHANNELS  8               // Raw stream channel map entries
+
+// Output engine histogram sizes (see audio_output_stats_t)
+#define AUDIO_OUTPUT_LATENCY_BUCKETS    6
+#define AUDIO_OUTPUT_UNDERRUN_BUCKETS   6
 
 // LED notification bits (for voice activity)
 #define LED_NOTIFY_VOICE_ACTIVE     BIT0
@@ -94,15 +101,115 @@ typedef enum {
     AUDIO_STATE_ERROR
 } audio_state_t;
 
+/**
+ * @brief Output mixer streams
+ *
+ * All streams are 16-bit stereo PCM at CONFIG_I2S0_SAMPLE_RATE. Each has its
+ * own ring (one producer task per stream) and ramped Q15 gain. Music is
+ * ducked automatically while TTS or chime audio is playing.
+ */
+typedef enum {
+    AUDIO_STREAM_MUSIC = 0,     // Media playback (audio_pipeline_write)
+    AUDIO_STREAM_TTS,           // Voice assistant announcements (audio_player)
+    AUDIO_STREAM_CHIME,         // Notification/wake sounds
+    AUDIO_STREAM_COUNT
+} audio_stream_id_t;
+
+/**
+ * @brief What a raw-stream channel carries
+ */
+typedef enum {
+    AUDIO_CHANNEL_UNKNOWN = 0,  // Layout not identified
+    AUDIO_CHANNEL_MIC,          // Unprocessed microphone
+    AUDIO_CHANNEL_ASR,          // Device-processed, tuned for speech recognition
+    AUDIO_CHANNEL_COMMS,        // Device-processed, tuned for calls
+    AUDIO_CHANNEL_REFERENCE,    // Playback loopback (echo reference)
+} audio_channel_role_t;
+
 /**
  * @brief Voice activity detection result
+ *
+ * With a ReSpeaker that reports its own voice activity, the segment
+ * follows the device decision (same attack / hangover) and the energy
+ * detector does not run; energy_db / noise_floor_db then hold their last
+ * values.
  */
 typedef struct {
-    bool is_active;
-    float energy_db;
-    uint32_t duration_ms;
+    bool is_active;             // Inside a speech segment (with hangover)
+    float energy_db;            // Last 10ms frame level (dBFS)
+    float noise_floor_db;       // Tracked noise floor (dBFS)
+    uint32_t duration_ms;       // Length of the current segment
+    bool device_vad;            // Decided by the mic array DSP
+    int16_t doa_deg;            // Direction of arrival (0-359), -1 = unknown
 } voice_activity_t;
 
+/**
+ * @brief Level / spectrum analysis taps (see audio_analyzer.h)
+ */
+typedef enum {
+    AUDIO_TAP_MIC = 0,          // 16kHz mic after echo cancellation
+    AUDIO_TAP_OUTPUT,           // DAC mix after volume (what the speaker plays)
+    AUDIO_TAP_COUNT
+} audio_tap_t;
+
+/**
+ * @brief DAC output engine statistics
+ *
+ * Refill latency is measured from the I2S0 on_sent interrupt to the end of
+ * the refill batch. Buckets (us): <100, <250, <500, <1000, <2500, >=2500.
+ * A refill slower than one descriptor period (5ms) risks an audible gap.
+ *
+ * Underrun bursts count consecutive starved descriptors while playing,
+ * recorded when data resumes. Buckets (descriptors): 1, 2, 3-4, 5-8, 9-16,
+ * >16. Only bursts up to 16 descriptors (80ms) count as underruns; longer
+ * ones are gaps between streams.
+ */
+typedef struct {
+    uint32_t descriptors_written;       // Descriptors queued to I2S0
+    uint32_t descriptors_padded;        // Stream tails padded with silence
+    uint32_t underruns;                 // Glitch-length starvation bursts
+    uint32_t latency_max_us;            // Worst on_sent -> refill latency
+    uint32_t latency_hist[AUDIO_OUTPUT_LATENCY_BUCKETS];
+    uint32_t underrun_hist[AUDIO_OUTPUT_UNDERRUN_BUCKETS];
+} audio_output_stats_t;
+
+/**
+ * @brief Echo canceller statistics
+ *
+ * ERLE (echo return loss enhancement) is the mic-to-residual power ratio
+ * over single-talk blocks with the speaker active; 20-30 dB is a well
+ * converged filter. Cost is wall time spent in the canceller per 10ms of
+ * 16kHz audio, so 1000 us per frame is 10% of one core.
+ */
+typedef struct {
+    bool enabled;                       // Canceller running on the mic path
+    bool ref_active;                    // Speaker reference present
+    bool double_talk;                   // Adaptation frozen (near-end speech)
+    float erle_db;                      // Smoothed ERLE
+    uint32_t frames;                    // 10ms frames processed
+    uint32_t frame_cost_us;             // Average cost per 10ms frame
+    uint32_t block_cost_max_us;         // Worst single mic block
+    uint32_t resyncs;                   // Reference realignments (clock drift)
+} audio_aec_stats_t;
+
+/**
+ * @brief USB input drift compensation statistics
+ *
+ * The USB input queue is drained on the local clock; its fill slope plus
+ * the resampler correction is the device clock offset. A locked loop
+ * holds the smoothed fill within a few ms of the target.
+ */
+typedef struct {
+    bool streaming;                     // Device connected and primed
+    float drift_ppm;                    // Device clock vs local (+ = fast)
+    float correction_ppm;               // Current resampler ratio - 1
+    uint16_t fill_ms;                   // Smoothed queue fill
+    uint16_t target_ms;                 // CONFIG_AUDIO_USB_TARGET_FILL_MS
+    uint32_t underruns;                 // Queue ran dry (re-primed)
+    uint32_t overruns;                  // Packets dropped on a full queue
+    uint32_t resyncs;                   // Fill forced back to target
+} audio_usb_stats_t;
+
 // ============================================================================
 // Public API
 // ============================================================================
@@ -135,8 +242,9 @@ esp_err_t audio_pipeline_wait_ready(uint32_t timeout_ms);
 /**
  * @brief Process audio data (called from audio task)
  *
- * This function should be called periodically from the audio task.
- * It handles buffer management, voice detection, and data routing.
+ * Kept for API compatibility. Mic input is callback/task driven and DAC
+ * output is refilled by an internal task paced by I2S0 DMA completion, so
+ * this no longer moves audio.
  */
 void audio_pipeline_process(void);
 
@@ -149,6 +257,11 @@ audio_state_t audio_pipeline_get_state(void);
 
 /**
  * @brief Start audio playback
+ *
+ * With CONFIG_AUDIO_OUTPUT_PRELOAD, transmission starts once the output
+ * ring holds CONFIG_AUDIO_OUTPUT_PRELOAD_DESC descriptors (or after ~100ms),
+ * which are then queued to the DMA ring as one batch.
+ *
  * @return ESP_OK on success
  */
 esp_err_t audio_pipeline_play(void);
@@ -170,23 +283,92 @@ esp_err_t audio_pipeline_resume(void);
 
 /**
  * @brief Write audio data to output buffer
+ *
+ * The output ring is single-producer: call from one task only.
+ * Never blocks; writes as much as fits.
+ *
  * @param data Audio data (PCM)
  * @param len Data length in bytes
- * @param timeout_ms Write timeout
+ * @param timeout_ms Unused (kept for API compatibility)
  * @return Number of bytes written
  */
 size_t audio_pipeline_write(const uint8_t *data, size_t len, uint32_t timeout_ms);
 
+// --- Output Mixer ---
+
+/**
+ * @brief Write audio data to a mixer stream
+ *
+ * Single producer per stream. Never blocks; writes as much as fits.
+ * audio_pipeline_write() is equivalent to AUDIO_STREAM_MUSIC.
+ *
+ * @param stream Target stream
+ * @param data Audio data (16-bit stereo PCM)
+ * @param len Data length in bytes
+ * @return Number of bytes written
+ */
+size_t audio_pipeline_write_stream(audio_stream_id_t stream, const uint8_t *data, size_t len);
+
+/**
+ * @brief Drop audio queued on one stream (e.g. cancel an announcement)
+ *
+ * Data written after this call is kept. Other streams keep playing.
+ */
+esp_err_t audio_pipeline_flush_stream(audio_stream_id_t stream);
+
+/**
+ * @brief Set a stream's gain
+ * @param stream Target stream
+ * @param gain Gain (0-100)
+ * @param ramp_ms Full-scale ramp time (0 = default 20ms)
+ * @return ESP_OK on success
+ */
+esp_err_t audio_pipeline_set_stream_gain(audio_stream_id_t stream, uint8_t gain, uint32_t ramp_ms);
+
+/**
+ * @brief Configure automatic music ducking under TTS/chime
+ * @param enable Enable ducking
+ * @param level Music level while ducked (0-100)
+ */
+esp_err_t audio_pipeline_set_ducking(bool enable, uint8_t level);
+
 // --- Recording Control ---
 
 /**
- * @brief Start audio recording
+ * @brief Start audio recording with the default pre-roll
+ *
+ * Same as audio_pipeline_record_start_preroll(CONFIG_AUDIO_PREROLL_MS, NULL).
+ *
  * @return ESP_OK on success
  */
 esp_err_t audio_pipeline_record_start(void);
 
+/**
+ * @brief Start a recording session that begins @p preroll_ms in the past
+ *
+ * With CONFIG_AUDIO_CAPTURE_SESSIONS (default), mic audio is readable only
+ * inside a session. Outside one the raw and processed rings hold a rolling
+ * window of the most recent audio and audio_pipeline_read(),
+ * audio_pipeline_read_raw() and the acquire calls return nothing, unlike
+ * before sessions existed. Without it the rings are always readable and
+ * this call applies no pre-roll. Starting a session
+ * moves both read cursors to @p preroll_ms before now, at the same
+ * instant, so the first syllables before a wake word / VAD trigger are
+ * kept. Waits up to one mic block for the capture path to place the
+ * cursor; if no mic is streaming yet, the session opens when it starts.
+ * Playback continues (state becomes DUPLEX while playing).
+ *
+ * @param preroll_ms Audio before the call to include (capped at
+ *                   CONFIG_AUDIO_PREROLL_MS)
+ * @param actual_ms  Optional output: pre-roll actually available
+ * @return ESP_OK, or ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t audio_pipeline_record_start_preroll(uint32_t preroll_ms, uint32_t *actual_ms);
+
 /**
  * @brief Stop audio recording
+ *
+ * Unread audio stays in the rings as pre-roll for the next session.
  */
 esp_err_t audio_pipeline_record_stop(void);
 
@@ -194,10 +376,14 @@ esp_err_t audio_pipeline_record_stop(void);
  * @brief Read audio data from input buffer (processed: 16kHz mono)
  *
  * Returns downsampled and mono-mixed audio suitable for ESPHome/Home Assistant.
+ * The processed ring is single-consumer: call from one task only.
+ * Never blocks; returns what is available. Returns 0 outside a recording
+ * session when CONFIG_AUDIO_CAPTURE_SESSIONS is set (the default, see
+ * audio_pipeline_record_start_preroll()).
  *
  * @param data Buffer to store audio data
  * @param len Maximum bytes to read
- * @param timeout_ms Read timeout
+ * @param timeout_ms Unused (kept for API compatibility)
  * @return Number of bytes read
  */
 size_t audio_pipeline_read(uint8_t *data, size_t len, uint32_t timeout_ms);
@@ -207,22 +393,86 @@ size_t audio_pipeline_read(uint8_t *data, size_t len, uint32_t timeout_ms);
  *
  * Returns high-quality raw audio for local LLM processing or high-fidelity
  * applications. No downsampling or channel mixing applied.
+ * The raw ring is single-consumer: call from one task only.
+ * Never blocks; returns what is available. Gated on recording sessions
+ * like audio_pipeline_read().
  *
  * @param data Buffer to store audio data
  * @param len Maximum bytes to read
- * @param timeout_ms Read timeout
+ * @param timeout_ms Unused (kept for API compatibility)
  * @return Number of bytes read
  */
 size_t audio_pipeline_read_raw(uint8_t *data, size_t len, uint32_t timeout_ms);
 
+// --- Zero-copy Capture Access ---
+
+/**
+ * @brief Acquire a contiguous span of processed audio (16kHz mono)
+ *
+ * Returns a pointer straight into the processed ring, with no copy. The
+ * span stays valid until audio_pipeline_release_processed() is called. It
+ * may be shorter than the total available data when the ring wraps:
+ * release it, then acquire again for the remainder. Same single-consumer
+ * rule as audio_pipeline_read(); do not mix the two from different tasks.
+ * The span is empty outside a recording session. While a span is held
+ * the capture path keeps the session's data in place, so release it
+ * (even with 0) before acquiring in a later session.
+ *
+ * @param data Output: start of readable span
+ * @param len Output: span length in bytes (0 if no data)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t audio_pipeline_acquire_processed(const uint8_t **data, size_t *len);
+
+/**
+ * @brief Release bytes consumed from the acquired processed span
+ * @param len Bytes consumed (<= acquired length, whole samples)
+ */
+void audio_pipeline_release_processed(size_t len);
+
+/**
+ * @brief Acquire a contiguous span of raw audio (native rate/channels)
+ *
+ * Zero-copy equivalent of audio_pipeline_read_raw(). See
+ * audio_pipeline_acquire_processed() for the span rules. Use
+ * audio_pipeline_get_raw_format() for the frame layout.
+ *
+ * @param data Output: start of readable span
+ * @param len Output: span length in bytes (0 if no data)
+ * @return ESP_OK on success, ESP_ERR_INVALID_STATE if not initialized
+ */
+esp_err_t audio_pipeline_acquire_raw(const uint8_t **data, size_t *len);
+
+/**
+ * @brief Release bytes consumed from the acquired raw span
+ * @param len Bytes consumed (<= acquired length)
+ */
+void audio_pipeline_release_raw(size_t len);
+
+/**
+ * @brief Drop queued processed audio, keeping only the newest bytes
+ *
+ * Consumer side (same task as acquire/release). Used to skip silence
+ * while still holding the onset that led up to a VAD start.
+ *
+ * @param keep_bytes Newest bytes to keep
+ */
+void audio_pipeline_discard_processed(size_t keep_bytes);
+
 /**
  * @brief Get raw audio format information
  *
+ * The raw stream keeps every captured channel; the channel map says what
+ * each carries (e.g. ReSpeaker v2.0: ASR beam, four raw mics, playback).
+ *
  * @param sample_rate Pointer to store sample rate (48000 Hz typical)
  * @param channels Pointer to store channel count (2 for stereo)
  * @param bit_depth Pointer to store bit depth (16)
+ * @param channel_map Optional (NULL): AUDIO_RAW_MAX_CHANNELS entries, the
+ *                    first @p channels are filled in
  */
-void audio_pipeline_get_raw_format(uint32_t *sample_rate, uint8_t *channels, uint8_t *bit_depth);
+void audio_pipeline_get_raw_format(uint32_t *sample_rate, uint8_t *channels, uint8_t *bit_depth,
+                                   audio_channel_role_t *channel_map);
 
 /**
  * @brief Get processed audio format information
@@ -247,10 +497,40 @@ bool audio_pipeline_voice_detected(void);
  */
 void audio_pipeline_get_voice_activity(voice_activity_t *activity);
 
+/**
+ * @brief Wait for a speech segment edge
+ *
+ * Edges are latched, so none are lost between calls; intended for a
+ * single consumer (each call consumes the events it returns).
+ *
+ * @param timeout_ms Maximum wait
+ * @return AUDIO_VAD_EVENT_START / AUDIO_VAD_EVENT_END bitmask, 0 on timeout
+ */
+uint32_t audio_pipeline_wait_vad_event(uint32_t timeout_ms);
+
+// --- Visualizer Taps ---
+
+/**
+ * @brief Get the newest level / spectrum of a tap
+ *
+ * Lock-free and cheap enough to call every animation frame from an LED
+ * or UI task. Levels follow each block; bands update every 20ms and fall
+ * back to zero while the tap is silent (output idle, USB mic unplugged).
+ *
+ * @param tap      Tap to read
+ * @param analysis Output
+ * @return ESP_OK, ESP_ERR_INVALID_STATE before init, or
+ *         ESP_ERR_NOT_SUPPORTED without CONFIG_AUDIO_ANALYZER
+ */
+esp_err_t audio_pipeline_get_analysis(audio_tap_t tap, audio_analysis_t *analysis);
+
 // --- Volume Control ---
 
 /**
  * @brief Set master volume
+ *
+ * Master gain of the output mixer; applied with a short ramp.
+ *
  * @param volume Volume level (0-100)
  * @return ESP_OK on success
  */
@@ -263,7 +543,7 @@ esp_err_t audio_pipeline_set_volume(uint8_t volume);
 uint8_t audio_pipeline_get_volume(void);
 
 /**
- * @brief Mute/unmute audio output
+ * @brief Mute/unmute audio output (ramped, click-free)
  * @param mute true to mute
  */
 esp_err_t audio_pipeline_set_mute(bool mute);
@@ -284,6 +564,46 @@ void audio_pipeline_get_buffer_levels(uint8_t *output_level, uint8_t *input_leve
  */
 void audio_pipeline_get_stats(uint32_t *underruns, uint32_t *overruns);
 
+/**
+ * @brief Get DAC output engine statistics (latency/underrun histograms)
+ * @param stats Pointer to statistics structure
+ */
+void audio_pipeline_get_output_stats(audio_output_stats_t *stats);
+
+/**
+ * @brief Reset DAC output engine statistics
+ */
+void audio_pipeline_reset_output_stats(void);
+
+// --- Echo Cancellation ---
+
+/**
+ * @brief Enable/disable acoustic echo cancellation on the processed stream
+ *
+ * The canceller uses the post-volume DAC mix as its reference and runs on
+ * the 16kHz stream before it reaches the processed ring (and VAD). The raw
+ * stream is never processed. Re-enabling restarts adaptation.
+ *
+ * @param enable true to cancel echo
+ * @return ESP_OK, or ESP_ERR_NOT_SUPPORTED without CONFIG_AUDIO_AEC
+ */
+esp_err_t audio_pipeline_set_aec_enabled(bool enable);
+
+/**
+ * @brief Get echo canceller statistics
+ * @param stats Pointer to statistics structure
+ */
+void audio_pipeline_get_aec_stats(audio_aec_stats_t *stats);
+
+// --- USB Input ---
+
+/**
+ * @brief Get USB input drift compensation statistics
+ * @param stats Pointer to statistics structure (zeroed without
+ *              CONFIG_AUDIO_INPUT_USB)
+ */
+void audio_pipeline_get_usb_stats(audio_usb_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,90 @@
+/**
+ * @file audio_resampler.c
+ * @brief Fractional adaptive resampler implementation
+ *
+ * Each input block is appended behind the three carried frames:
+ *
+ *   buf:  [h0 h1 h2 | x0 x1 ... xN-1]
+ *
+ * An output at position p (frame i = ⌊p⌋, t = p - i) interpolates
+ * buf[i-1..i+2] with a Catmull-Rom (cubic Hermite) spline. Outputs are
+ * produced while buf[i+2] exists; the position then moves back by N so
+ * the last three frames become the next block's history.
+ */
+
+#include "audio_resampler.h"
+#include <string.h>
+
+#define Q32_ONE     (1ULL << 32)
+
+// ============================================================================
+// Kernel
+// ============================================================================
+
+static inline int16_t hermite(float xm1, float x0, float x1, float x2, float t)
+{
+    float c1 = 0.5f * (x1 - xm1);
+    float c2 = xm1 - 2.5f * x0 + 2.0f * x1 - 0.5f * x2;
+    float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+    float y = ((c3 * t + c2) * t + c1) * t + x0;
+
+    // Spline overshoot near full scale
+    if (y >= 32767.0f) return INT16_MAX;
+    if (y <= -32768.0f) return INT16_MIN;
+    return (int16_t)(y + (y >= 0 ? 0.5f : -0.5f));
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool audio_resampler_init(audio_resampler_t *rs, uint8_t channels)
+{
+    if (!rs || channels == 0 || channels > AUDIO_RESAMPLER_MAX_CHANNELS) return false;
+
+    rs->channels = channels;
+    rs->step = Q32_ONE;
+    audio_resampler_reset(rs);
+    return true;
+}
+
+void audio_resampler_reset(audio_resampler_t *rs)
+{
+    memset(rs->buf, 0, sizeof(int16_t) * AUDIO_RESAMPLER_HISTORY * rs->channels);
+    rs->pos = Q32_ONE;          // First output needs buf[0] as x[-1]
+}
+
+void audio_resampler_set_ratio(audio_resampler_t *rs, double ratio)
+{
+    if (ratio > 1.0 + AUDIO_RESAMPLER_MAX_DEVIATION) ratio = 1.0 + AUDIO_RESAMPLER_MAX_DEVIATION;
+    if (ratio < 1.0 - AUDIO_RESAMPLER_MAX_DEVIATION) ratio = 1.0 - AUDIO_RESAMPLER_MAX_DEVIATION;
+    rs->step = (uint64_t)(ratio * (double)Q32_ONE + 0.5);
+}
+
+size_t audio_resampler_process(audio_resampler_t *rs, const int16_t *input,
+                               size_t frames, int16_t *output)
+{
+    if (frames == 0) return 0;
+    if (frames > AUDIO_RESAMPLER_MAX_FRAMES) frames = AUDIO_RESAMPLER_MAX_FRAMES;
+
+    const int ch = rs->channels;
+    memcpy(&rs->buf[AUDIO_RESAMPLER_HISTORY * ch], input, sizeof(int16_t) * frames * ch);
+
+    size_t out = 0;
+    uint64_t pos = rs->pos;
+    while ((pos >> 32) <= frames) {
+        const int16_t *x = &rs->buf[((pos >> 32) - 1) * ch];
+        const float t = (float)(uint32_t)pos * (1.0f / 4294967296.0f);
+
+        for (int c = 0; c < ch; c++) {
+            output[out * ch + c] = hermite(x[c], x[ch + c], x[2 * ch + c], x[3 * ch + c], t);
+        }
+        out++;
+        pos += rs->step;
+    }
+
+    // Last three frames become the history of the next block
+    memmove(rs->buf, &rs->buf[frames * ch], sizeof(int16_t) * AUDIO_RESAMPLER_HISTORY * ch);
+    rs->pos = pos - ((uint64_t)frames << 32);
+    return out;
+}
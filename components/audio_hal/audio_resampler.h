@@ -0,0 +1,106 @@
+/**
+ * @file audio_resampler.h
+ * @brief Fractional adaptive resampler (clock-drift compensation)
+ *
+ * Converts a stream clocked by a foreign device (USB microphone) onto the
+ * local clock. The ratio stays within a fraction of a percent of 1 and is
+ * retuned between blocks by the caller's fill controller:
+ *
+ *   in (device clock) ──► 4-point cubic Hermite ──► out (local clock)
+ *                           ▲ pos += ratio per output frame
+ *
+ *   - Ratio is input frames per output frame, Q32 fixed point
+ *   - Any block length; the last three input frames are carried over
+ *   - At ratio ~1 the fractional delay barely moves, so the response
+ *     is that of a fixed fractional-delay filter: < 0.3 dB droop at 8kHz
+ *     for 48kHz input
+ *
+ * The core has no ESP-IDF dependencies so it can be built on the host.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define AUDIO_RESAMPLER_MAX_CHANNELS    8
+#define AUDIO_RESAMPLER_MAX_FRAMES      240     // Input frames per call (5ms at 48kHz)
+#define AUDIO_RESAMPLER_HISTORY         3       // Carried input frames
+#define AUDIO_RESAMPLER_MAX_DEVIATION   0.01    // Accepted |ratio - 1|
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Resampler state (one instance per input stream)
+ */
+typedef struct {
+    int16_t buf[(AUDIO_RESAMPLER_HISTORY + AUDIO_RESAMPLER_MAX_FRAMES) * AUDIO_RESAMPLER_MAX_CHANNELS];
+    uint64_t pos;               // Q32 position of the next output in buf (frames)
+    uint64_t step;              // Q32 input frames per output frame
+    uint8_t channels;
+} audio_resampler_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initialize resampler state (ratio 1)
+ *
+ * @param rs       Resampler instance
+ * @param channels Interleaved channels
+ * @return true on success, false on invalid arguments
+ */
+bool audio_resampler_init(audio_resampler_t *rs, uint8_t channels);
+
+/**
+ * @brief Clear history (e.g. on stream restart); keeps the ratio
+ */
+void audio_resampler_reset(audio_resampler_t *rs);
+
+/**
+ * @brief Set the conversion ratio (input frames per output frame)
+ *
+ * Clamped to 1 ± AUDIO_RESAMPLER_MAX_DEVIATION. Takes effect with the
+ * next output frame; the phase is continuous.
+ */
+void audio_resampler_set_ratio(audio_resampler_t *rs, double ratio);
+
+/**
+ * @brief Resample a block of frames
+ *
+ * All input is consumed; the number of outputs follows from the ratio
+ * and the carried phase.
+ *
+ * @param rs     Resampler instance
+ * @param input  Interleaved 16-bit PCM (rs->channels per frame)
+ * @param frames Input frames (<= AUDIO_RESAMPLER_MAX_FRAMES)
+ * @param output Interleaved output, at least
+ *               audio_resampler_max_output(frames) frames
+ * @return Output frames written
+ */
+size_t audio_resampler_process(audio_resampler_t *rs, const int16_t *input,
+                               size_t frames, int16_t *output);
+
+/**
+ * @brief Upper bound of output frames for a given input block
+ */
+static inline size_t audio_resampler_max_output(size_t frames)
+{
+    return (size_t)(frames / (1.0 - AUDIO_RESAMPLER_MAX_DEVIATION)) + 2;
+}
+
+#ifdef __cplusplus
+}
+#endif
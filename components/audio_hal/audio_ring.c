@@ -0,0 +1,152 @@
+/**
+ * @file audio_ring.c
+ * @brief Lock-free SPSC byte ring implementation
+ */
+
+#include "audio_ring.h"
+#include <string.h>
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+esp_err_t audio_ring_init(audio_ring_t *ring, uint8_t *storage, size_t size)
+{
+    if (!ring || !storage || size == 0 || (size & (size - 1)) != 0 || size > UINT32_MAX / 2) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    ring->buf = storage;
+    ring->size = (uint32_t)size;
+    ring->mask = (uint32_t)size - 1;
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    return ESP_OK;
+}
+
+void audio_ring_reset(audio_ring_t *ring)
+{
+    atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, 0, memory_order_release);
+}
+
+// ============================================================================
+// Producer Side
+// ============================================================================
+
+size_t audio_ring_write_acquire(audio_ring_t *ring, uint8_t **ptr)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t free_bytes = ring->size - (head - tail);
+    uint32_t offset = head & ring->mask;
+    uint32_t to_end = ring->size - offset;
+
+    *ptr = ring->buf + offset;
+    return (free_bytes < to_end) ? free_bytes : to_end;
+}
+
+void audio_ring_write_commit(audio_ring_t *ring, size_t len)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + (uint32_t)len, memory_order_release);
+}
+
+size_t audio_ring_write(audio_ring_t *ring, const void *data, size_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    size_t written = 0;
+
+    // At most two passes (before and after the wrap point)
+    while (written < len) {
+        uint8_t *dst;
+        size_t span = audio_ring_write_acquire(ring, &dst);
+        if (span == 0) break;
+        if (span > len - written) span = len - written;
+        memcpy(dst, src + written, span);
+        audio_ring_write_commit(ring, span);
+        written += span;
+    }
+
+    return written;
+}
+
+size_t audio_ring_write_floor(audio_ring_t *ring, const void *data, size_t len, uint32_t floor)
+{
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t used = head - floor;
+    if (used >= ring->size) return 0;
+
+    size_t free_bytes = ring->size - used;
+    if (len > free_bytes) len = free_bytes;
+
+    // Two copies at most (before and after the wrap point)
+    const uint8_t *src = (const uint8_t *)data;
+    uint32_t offset = head & ring->mask;
+    size_t first = ring->size - offset;
+    if (first > len) first = len;
+    memcpy(ring->buf + offset, src, first);
+    memcpy(ring->buf, src + first, len - first);
+    audio_ring_write_commit(ring, len);
+    return len;
+}
+
+// ============================================================================
+// Consumer Side
+// ============================================================================
+
+size_t audio_ring_read_acquire(audio_ring_t *ring, const uint8_t **ptr)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    uint32_t used = head - tail;
+    uint32_t offset = tail & ring->mask;
+    uint32_t to_end = ring->size - offset;
+
+    *ptr = ring->buf + offset;
+    return (used < to_end) ? used : to_end;
+}
+
+void audio_ring_read_release(audio_ring_t *ring, size_t len)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + (uint32_t)len, memory_order_release);
+}
+
+size_t audio_ring_read(audio_ring_t *ring, void *data, size_t len)
+{
+    uint8_t *dst = (uint8_t *)data;
+    size_t read = 0;
+
+    while (read < len) {
+        const uint8_t *src;
+        size_t span = audio_ring_read_acquire(ring, &src);
+        if (span == 0) break;
+        if (span > len - read) span = len - read;
+        memcpy(dst + read, src, span);
+        audio_ring_read_release(ring, span);
+        read += span;
+    }
+
+    return read;
+}
+
+void audio_ring_discard_to(audio_ring_t *ring, uint32_t mark)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+    // Only move forward (mark may already have been consumed)
+    if ((int32_t)(mark - tail) > 0) {
+        atomic_store_explicit(&ring->tail, mark, memory_order_release);
+    }
+}
+
+void audio_ring_skip_to(audio_ring_t *ring, uint32_t mark)
+{
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+    if ((head - tail) > ring->size || (int32_t)(mark - tail) > 0) {
+        atomic_store_explicit(&ring->tail, mark, memory_order_release);
+    }
+}
@@ -0,0 +1,194 @@
+/**
+ * @file audio_ring.h
+ * @brief Lock-free single-producer/single-consumer byte ring
+ *
+ * Used for every audio stream in the pipeline (DAC output, raw mic,
+ * processed mic). Exactly one task/callback may write and exactly one may
+ * read; no lock is taken on either side.
+ *
+ *   head (producer-owned)            tail (consumer-owned)
+ *     │                                │
+ *     ▼                                ▼
+ *   ┌──────────────────────────────────────────────────┐
+ *   │ free │ ████ used ████████████████ │    free      │
+ *   └──────────────────────────────────────────────────┘
+ *
+ *   - head/tail are free-running 32-bit counters; size is a power of two,
+ *     so used = head - tail and the offset is (index & mask)
+ *   - Producer publishes data with a release store of head, consumer
+ *     frees space with a release store of tail
+ *   - Contiguous-region accessors (acquire/commit) let DMA, DSP or the
+ *     caller work directly on the storage without an intermediate copy
+ *
+ * Storage is supplied by the caller (typically PSRAM).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief SPSC ring state
+ */
+typedef struct {
+    uint8_t *buf;               // Caller-owned storage
+    uint32_t size;              // Capacity in bytes (power of two)
+    uint32_t mask;              // size - 1
+    _Atomic uint32_t head;      // Total bytes written (producer)
+    _Atomic uint32_t tail;      // Total bytes consumed (consumer)
+} audio_ring_t;
+
+// ============================================================================
+// Setup
+// ============================================================================
+
+/**
+ * @brief Initialize a ring over caller-provided storage
+ *
+ * @param ring    Ring instance
+ * @param storage Backing buffer
+ * @param size    Buffer size in bytes (must be a power of two)
+ * @return ESP_OK, or ESP_ERR_INVALID_ARG
+ */
+esp_err_t audio_ring_init(audio_ring_t *ring, uint8_t *storage, size_t size);
+
+/**
+ * @brief Empty the ring (only while neither side is active)
+ */
+void audio_ring_reset(audio_ring_t *ring);
+
+// ============================================================================
+// Status (callable from either side)
+// ============================================================================
+
+/**
+ * @brief Bytes available to the consumer
+ */
+static inline size_t audio_ring_used(const audio_ring_t *ring)
+{
+    uint32_t head = atomic_load_explicit(&((audio_ring_t *)ring)->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&((audio_ring_t *)ring)->tail, memory_order_acquire);
+    return head - tail;
+}
+
+/**
+ * @brief Bytes available to the producer
+ */
+static inline size_t audio_ring_free(const audio_ring_t *ring)
+{
+    return ring->size - audio_ring_used(ring);
+}
+
+/**
+ * @brief Fill level in percent
+ */
+static inline uint8_t audio_ring_level(const audio_ring_t *ring)
+{
+    return ring->size ? (uint8_t)((audio_ring_used(ring) * 100) / ring->size) : 0;
+}
+
+// ============================================================================
+// Producer Side
+// ============================================================================
+
+/**
+ * @brief Get the contiguous writable region at head
+ *
+ * The region may be shorter than audio_ring_free() when free space wraps;
+ * commit and call again for the remainder.
+ *
+ * @param ring Ring instance
+ * @param ptr  Output: start of writable region
+ * @return Writable bytes at *ptr
+ */
+size_t audio_ring_write_acquire(audio_ring_t *ring, uint8_t **ptr);
+
+/**
+ * @brief Publish bytes written into the acquired region
+ */
+void audio_ring_write_commit(audio_ring_t *ring, size_t len);
+
+/**
+ * @brief Copy data in (partial writes allowed)
+ * @return Bytes written
+ */
+size_t audio_ring_write(audio_ring_t *ring, const void *data, size_t len);
+
+/**
+ * @brief Copy data in against a producer-published floor
+ *
+ * For a producer that has told its consumer to skip everything before
+ * @p floor (the consumer applies it with audio_ring_skip_to() before its
+ * next read): free space is measured from @p floor instead of the tail,
+ * and the tail is not touched. Only valid while the consumer holds no
+ * span below @p floor.
+ *
+ * @return Bytes written (partial writes allowed)
+ */
+size_t audio_ring_write_floor(audio_ring_t *ring, const void *data, size_t len, uint32_t floor);
+
+// ============================================================================
+// Consumer Side
+// ============================================================================
+
+/**
+ * @brief Get the contiguous readable region at tail
+ *
+ * @param ring Ring instance
+ * @param ptr  Output: start of readable region
+ * @return Readable bytes at *ptr (may be less than audio_ring_used())
+ */
+size_t audio_ring_read_acquire(audio_ring_t *ring, const uint8_t **ptr);
+
+/**
+ * @brief Release bytes consumed from the acquired region
+ */
+void audio_ring_read_release(audio_ring_t *ring, size_t len);
+
+/**
+ * @brief Copy data out (partial reads allowed)
+ * @return Bytes read
+ */
+size_t audio_ring_read(audio_ring_t *ring, void *data, size_t len);
+
+/**
+ * @brief Discard everything the producer had written up to @p mark
+ *
+ * Consumer side. Used to apply a flush requested by another task: the
+ * requester snapshots audio_ring_head() and the consumer drops data up to
+ * that point, leaving anything written afterwards intact.
+ */
+void audio_ring_discard_to(audio_ring_t *ring, uint32_t mark);
+
+/**
+ * @brief Move the tail to a producer-published floor
+ *
+ * Consumer side. Like audio_ring_discard_to(), and also when the tail is
+ * more than a ring behind head, i.e. was left behind while the producer
+ * wrote with audio_ring_write_floor().
+ */
+void audio_ring_skip_to(audio_ring_t *ring, uint32_t mark);
+
+/**
+ * @brief Current producer position (for audio_ring_discard_to)
+ */
+static inline uint32_t audio_ring_head(const audio_ring_t *ring)
+{
+    return atomic_load_explicit(&((audio_ring_t *)ring)->head, memory_order_acquire);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file audio_vad.c
+ * @brief Integer energy VAD implementation
+ */
+
+#include "audio_vad.h"
+#include <string.h>
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define VAD_DB_PER_LOG2_Q8      771         // 10·log10(2) = 3.0103 dB (Q8)
+#define VAD_FULL_SCALE_LOG2     30          // log2(32767²)
+#define VAD_FLOOR_MIN_Q8        AUDIO_VAD_DB_Q8(-90)
+#define VAD_FLOOR_MAX_Q8        AUDIO_VAD_DB_Q8(-10)
+#define VAD_FLOOR_FALL_SHIFT    3           // Follow quieter frames in ~80ms
+#define VAD_FLOOR_RISE_Q12      123         // 3 dB/s while idle (0.03 dB/frame)
+#define VAD_FLOOR_RISE_ACTIVE_Q12   20      // 0.5 dB/s in a segment, so a noise
+                                            // step cannot hold it open forever
+#define VAD_TILT_MAX_Q8         410         // Δ-energy/energy < 1.6 (white = 2.0)
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+int32_t audio_vad_energy_to_db_q8(uint32_t mean_sq)
+{
+    if (mean_sq == 0) return AUDIO_VAD_DB_Q8(AUDIO_VAD_MIN_DB);
+
+    // log2 in Q8: integer part from the leading one, fraction from the
+    // next 8 bits (linear interpolation, < 0.3 dB error)
+    int32_t msb = 31 - __builtin_clz(mean_sq);
+    uint32_t frac = (msb >= 8) ? (mean_sq >> (msb - 8)) : (mean_sq << (8 - msb));
+    int32_t log2_q8 = msb * 256 + (int32_t)(frac & 0xFF);
+
+    int32_t db_q8 = ((log2_q8 - (VAD_FULL_SCALE_LOG2 << 8)) * VAD_DB_PER_LOG2_Q8) / 256;
+    if (db_q8 < AUDIO_VAD_DB_Q8(AUDIO_VAD_MIN_DB)) db_q8 = AUDIO_VAD_DB_Q8(AUDIO_VAD_MIN_DB);
+    return db_q8;
+}
+
+static void update_floor(audio_vad_t *vad)
+{
+    int32_t level_q12 = vad->level_q8 * 16;
+
+    if (!vad->floor_valid) {
+        vad->floor_q12 = level_q12;
+        vad->floor_valid = true;
+    } else if (level_q12 < vad->floor_q12) {
+        vad->floor_q12 += (level_q12 - vad->floor_q12) >> VAD_FLOOR_FALL_SHIFT;
+    } else {
+        // Frames that did not open a segment (noise steps, hiss) rise too
+        int32_t rise = vad->active ? VAD_FLOOR_RISE_ACTIVE_Q12 : VAD_FLOOR_RISE_Q12;
+        vad->floor_q12 += rise;
+        if (vad->floor_q12 > level_q12) vad->floor_q12 = level_q12;
+    }
+
+    if (vad->floor_q12 < (VAD_FLOOR_MIN_Q8 * 16)) vad->floor_q12 = VAD_FLOOR_MIN_Q8 * 16;
+    if (vad->floor_q12 > (VAD_FLOOR_MAX_Q8 * 16)) vad->floor_q12 = VAD_FLOOR_MAX_Q8 * 16;
+}
+
+/**
+ * @brief Attack / hangover on one frame's speech decision
+ * @return Edge event for this frame
+ */
+static uint32_t decide_frame(audio_vad_t *vad, bool speech, bool tonal)
+{
+    uint32_t event = AUDIO_VAD_EVENT_NONE;
+    if (!vad->active) {
+        vad->run = (speech && tonal) ? vad->run + 1 : 0;
+        if (vad->run >= vad->cfg.attack_frames) {
+            vad->active = true;
+            vad->active_frames = vad->run;
+            vad->run = 0;
+            event = AUDIO_VAD_EVENT_START;
+        }
+    } else {
+        vad->active_frames++;
+        vad->run = speech ? 0 : vad->run + 1;
+        if (vad->run >= vad->cfg.hangover_frames) {
+            vad->active = false;
+            vad->active_frames = 0;
+            vad->run = 0;
+            event = AUDIO_VAD_EVENT_END;
+        }
+    }
+
+    return event;
+}
+
+/**
+ * @brief Measure and decide one completed frame
+ * @return Edge event for this frame
+ */
+static uint32_t process_frame(audio_vad_t *vad)
+{
+    uint32_t mean_sq = (uint32_t)(vad->sum_sq / AUDIO_VAD_FRAME_SAMPLES);
+    vad->level_q8 = audio_vad_energy_to_db_q8(mean_sq);
+
+    int32_t ref_q8 = vad->cfg.adaptive ? audio_vad_floor_q8(vad) + vad->cfg.threshold_q8
+                                       : vad->cfg.threshold_q8;
+    bool speech = vad->level_q8 > ref_q8;
+
+    // Hiss-like frames may not open a segment
+    bool tonal = true;
+    if (vad->cfg.spectral && !vad->active && vad->sum_sq > 0) {
+        tonal = ((vad->sum_diff_sq << 8) / vad->sum_sq) < VAD_TILT_MAX_Q8;
+    }
+
+    update_floor(vad);
+
+    return decide_frame(vad, speech, tonal);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void audio_vad_init(audio_vad_t *vad, const audio_vad_config_t *cfg)
+{
+    memset(vad, 0, sizeof(audio_vad_t));
+    vad->cfg = *cfg;
+    if (vad->cfg.attack_frames == 0) vad->cfg.attack_frames = 1;
+    if (vad->cfg.hangover_frames == 0) vad->cfg.hangover_frames = 1;
+    vad->level_q8 = AUDIO_VAD_DB_Q8(AUDIO_VAD_MIN_DB);
+}
+
+uint32_t audio_vad_process(audio_vad_t *vad, const int16_t *samples, size_t n)
+{
+    uint32_t events = AUDIO_VAD_EVENT_NONE;
+    int32_t prev = vad->prev_sample;
+
+    for (size_t i = 0; i < n; i++) {
+        int32_t s = samples[i];
+        int32_t d = s - prev;
+        vad->sum_sq += (uint32_t)(s * s);
+        vad->sum_diff_sq += (uint64_t)((int64_t)d * d);
+        prev = s;
+
+        if (++vad->fill == AUDIO_VAD_FRAME_SAMPLES) {
+            events |= process_frame(vad);
+            vad->sum_sq = 0;
+            vad->sum_diff_sq = 0;
+            vad->fill = 0;
+        }
+    }
+
+    vad->prev_sample = (int16_t)prev;
+    return events;
+}
+
+uint32_t audio_vad_process_decision(audio_vad_t *vad, bool speech, size_t n)
+{
+    uint32_t events = AUDIO_VAD_EVENT_NONE;
+
+    // Same 10ms framing as audio_vad_process(); levels are not measured
+    size_t fill = vad->fill + n;
+    while (fill >= AUDIO_VAD_FRAME_SAMPLES) {
+        events |= decide_frame(vad, speech, true);
+        fill -= AUDIO_VAD_FRAME_SAMPLES;
+    }
+    vad->fill = (uint16_t)fill;
+    vad->sum_sq = 0;
+    vad->sum_diff_sq = 0;
+
+    return events;
+}
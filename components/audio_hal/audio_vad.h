@@ -0,0 +1,166 @@
+/**
+ * @file audio_vad.h
+ * @brief Integer energy VAD with noise-floor tracking and hangover
+ *
+ * Replaces the per-block float RMS / log10 threshold, which flapped on
+ * every block near the threshold:
+ *
+ *   x[n] ──► 10ms frames ──► Σx² ──► log2 (clz) ──► dBFS (Q8)
+ *                                                     │
+ *                        noise floor ◄── fast down / slow up (non-speech)
+ *                                                     │
+ *            speech = level > floor + threshold  [+ spectral tilt check]
+ *                                                     │
+ *            attack (N speech frames) / hangover (M silent frames)
+ *                                                     │
+ *                                          START / END edge events
+ *
+ *   - No floating point in the per-sample or per-frame path
+ *   - Adaptive mode compares against the tracked floor; fixed mode
+ *     against an absolute level (legacy -40 dBFS behaviour, plus hangover)
+ *   - Optional spectral tilt (first-difference / signal energy) keeps
+ *     hiss-like noise (white ≈ 2.0, voiced speech < 1.0) from starting a
+ *     segment; continuing frames are not checked, so fricatives survive
+ *
+ * No ESP-IDF dependencies (host buildable).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define AUDIO_VAD_FRAME_SAMPLES     160         // 10ms at 16kHz
+#define AUDIO_VAD_FRAME_MS          10
+#define AUDIO_VAD_DB_Q8(db)         ((int32_t)((db) * 256))
+#define AUDIO_VAD_MIN_DB            (-96)       // Digital silence
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Edge events returned by audio_vad_process()
+ */
+typedef enum {
+    AUDIO_VAD_EVENT_NONE = 0,
+    AUDIO_VAD_EVENT_START = (1 << 0),   // Speech segment began
+    AUDIO_VAD_EVENT_END = (1 << 1),     // Speech segment ended (after hangover)
+} audio_vad_event_t;
+
+/**
+ * @brief VAD configuration
+ */
+typedef struct {
+    bool adaptive;              // Track the noise floor (else fixed level)
+    int32_t threshold_q8;       // Adaptive: dB above floor / fixed: dBFS (Q8)
+    uint16_t attack_frames;     // Speech frames needed to start
+    uint16_t hangover_frames;   // Silent frames needed to end
+    bool spectral;              // Spectral tilt check on attack frames
+} audio_vad_config_t;
+
+/**
+ * @brief VAD state
+ */
+typedef struct {
+    audio_vad_config_t cfg;
+
+    // Frame accumulator
+    uint64_t sum_sq;
+    uint64_t sum_diff_sq;
+    int16_t prev_sample;
+    uint16_t fill;
+
+    // Tracking (dB in Q8; floor in Q12 for slow-rise resolution)
+    int32_t level_q8;           // Last frame level
+    int32_t floor_q12;
+    bool floor_valid;
+
+    // Decision
+    bool active;
+    uint16_t run;               // Consecutive speech (idle) / silent (active) frames
+    uint32_t active_frames;     // Frames in the current segment
+} audio_vad_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initialize a VAD
+ */
+void audio_vad_init(audio_vad_t *vad, const audio_vad_config_t *cfg);
+
+/**
+ * @brief Feed samples (any block length; decisions are per 10ms frame)
+ *
+ * @param vad     Instance
+ * @param samples 16kHz mono PCM
+ * @param n       Sample count
+ * @return Edge events that occurred in this block (bitmask)
+ */
+uint32_t audio_vad_process(audio_vad_t *vad, const int16_t *samples, size_t n);
+
+/**
+ * @brief Advance by @p n samples on an external speech decision
+ *
+ * For a front end that runs its own detector (e.g. a mic array DSP):
+ * each 10ms frame completed in the span is decided by @p speech through
+ * the same attack / hangover logic. Level and floor are not updated.
+ *
+ * @param vad    Instance
+ * @param speech External decision for the span
+ * @param n      Sample count (16kHz)
+ * @return Edge events that occurred in this span (bitmask)
+ */
+uint32_t audio_vad_process_decision(audio_vad_t *vad, bool speech, size_t n);
+
+/**
+ * @brief Speech segment currently open
+ */
+static inline bool audio_vad_active(const audio_vad_t *vad)
+{
+    return vad->active;
+}
+
+/**
+ * @brief Level of the last frame in dBFS (Q8)
+ */
+static inline int32_t audio_vad_level_q8(const audio_vad_t *vad)
+{
+    return vad->level_q8;
+}
+
+/**
+ * @brief Tracked noise floor in dBFS (Q8)
+ */
+static inline int32_t audio_vad_floor_q8(const audio_vad_t *vad)
+{
+    return vad->floor_q12 >> 4;
+}
+
+/**
+ * @brief Duration of the current speech segment in ms
+ */
+static inline uint32_t audio_vad_duration_ms(const audio_vad_t *vad)
+{
+    return vad->active ? vad->active_frames * AUDIO_VAD_FRAME_MS : 0;
+}
+
+/**
+ * @brief Mean-square energy to dBFS (Q8), integer only
+ */
+int32_t audio_vad_energy_to_db_q8(uint32_t mean_sq);
+
+#ifdef __cplusplus
+}
+#endif
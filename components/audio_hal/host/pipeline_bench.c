@@ -0,0 +1,358 @@
+/**
+ * @file pipeline_bench.c
+ * @brief Host benchmark and replay for the microphone processing path
+ *
+ * Builds audio_pipeline.c against the IDF shims in tools/host_bench and
+ * feeds recordings through process_mic_data() in the 5ms blocks that
+ * mic_read_task delivers, so the decimator, AEC, pre-roll trimming, VAD
+ * and analyzer run exactly as on the device:
+ *
+ *   WAV / synthetic ──► 240-frame blocks ──► process_mic_data()
+ *                                              │ per-block latency
+ *                                              └► VAD edges (segments)
+ *
+ * Reports throughput (× realtime), per-block latency percentiles against
+ * the 5ms budget and the speech segments the VAD opened. A stage table
+ * then times the decimator, drift resampler (USB path), AEC and VAD on
+ * their own.
+ *
+ * Recordings must be 16-bit PCM at CONFIG_MIC_SAMPLE_RATE or 16kHz
+ * (held ×3 to 48kHz). Channels are mapped onto CONFIG_MIC_CHANNELS by
+ * index; a mono file is duplicated.
+ *
+ * Usage (see tools/host_bench/CMakeLists.txt):
+ *   ./pipeline_bench [-v] [-r rounds] [capture.wav ...]
+ */
+
+// The mic path is file-static; compile the pipeline into this unit
+#include "../audio_pipeline.c"
+
+#include "bench_stats.h"
+#include "wav_reader.h"
+#include <math.h>
+#include <stdlib.h>
+
+#define BENCH_BLOCK_FRAMES      MIC_DMA_FRAME_NUM
+#define BENCH_BLOCK_US          (BENCH_BLOCK_FRAMES * 1000000ull / CONFIG_MIC_SAMPLE_RATE)
+#define BENCH_SYNTH_SECONDS     10
+#define BENCH_MAX_SEGMENTS      64
+
+typedef struct {
+    uint32_t start_ms;
+    uint32_t end_ms;
+} bench_segment_t;
+
+// ============================================================================
+// Input
+// ============================================================================
+
+/**
+ * @brief Speech-like test signal: harmonic bursts over a -60 dBFS floor
+ *
+ * Bursts at 1.0-2.5 s, 4.0-6.0 s and 7.5-8.0 s; a 150Hz voiced source
+ * with a falling spectrum, amplitude-modulated at 4Hz like syllables.
+ */
+static int16_t *synth_speech(size_t *frames_out)
+{
+    static const float BURSTS[][2] = { {1.0f, 2.5f}, {4.0f, 6.0f}, {7.5f, 8.0f} };
+    const size_t frames = (size_t)BENCH_SYNTH_SECONDS * CONFIG_MIC_SAMPLE_RATE;
+    int16_t *pcm = malloc(frames * INPUT_CHANNELS * sizeof(int16_t));
+    if (!pcm) return NULL;
+
+    uint32_t seed = 0x1234567u;
+    for (size_t i = 0; i < frames; i++) {
+        float t = (float)i / CONFIG_MIC_SAMPLE_RATE;
+        seed = seed * 1664525u + 1013904223u;
+        float x = (float)(int16_t)(seed >> 16) * 0.001f;   // ≈ -60 dBFS
+
+        for (size_t b = 0; b < sizeof(BURSTS) / sizeof(BURSTS[0]); b++) {
+            if (t < BURSTS[b][0] || t >= BURSTS[b][1]) continue;
+            float env = 0.6f + 0.4f * sinf(2.0f * (float)M_PI * 4.0f * t);
+            for (int h = 1; h <= 20; h++) {
+                x += env * (6000.0f / h) * sinf(2.0f * (float)M_PI * 150.0f * h * t);
+            }
+        }
+
+        if (x > 32767.0f) x = 32767.0f;
+        if (x < -32768.0f) x = -32768.0f;
+        for (int c = 0; c < INPUT_CHANNELS; c++) pcm[i * INPUT_CHANNELS + c] = (int16_t)x;
+    }
+
+    *frames_out = frames;
+    return pcm;
+}
+
+/**
+ * @brief Convert a recording to the mic format (rate and channel count)
+ */
+static int16_t *wav_to_mic(const char *path, const wav_file_t *wav, size_t *frames_out)
+{
+    size_t hold;
+    if (wav->rate == CONFIG_MIC_SAMPLE_RATE) {
+        hold = 1;
+    } else if (wav->rate * DOWNSAMPLE_RATIO == CONFIG_MIC_SAMPLE_RATE) {
+        hold = DOWNSAMPLE_RATIO;
+    } else {
+        fprintf(stderr, "%s: unsupported rate %lu Hz (need %d or %d)\n", path, (unsigned long)wav->rate,
+                CONFIG_MIC_SAMPLE_RATE, CONFIG_PROCESSED_SAMPLE_RATE);
+        return NULL;
+    }
+
+    const size_t frames = wav->frames * hold;
+    int16_t *pcm = malloc(frames * INPUT_CHANNELS * sizeof(int16_t) + 1);
+    if (!pcm) return NULL;
+
+    for (size_t i = 0; i < frames; i++) {
+        const int16_t *src = &wav->samples[(i / hold) * wav->channels];
+        for (int c = 0; c < INPUT_CHANNELS; c++) {
+            pcm[i * INPUT_CHANNELS + c] = src[c < wav->channels ? c : 0];
+        }
+    }
+
+    *frames_out = frames;
+    return pcm;
+}
+
+// ============================================================================
+// Replay
+// ============================================================================
+
+/**
+ * @brief Back to the state audio_pipeline_init() leaves, between inputs
+ */
+static void reset_mic_path(void)
+{
+    capture_reset();
+    audio_decimator_reset(&s_audio.decimator);
+    const audio_vad_config_t vad_cfg = s_audio.vad_detector.cfg;   // init clears the instance
+    audio_vad_init(&s_audio.vad_detector, &vad_cfg);
+    s_audio.vad.is_active = false;
+#ifdef CONFIG_AUDIO_AEC
+    audio_ring_reset(&s_audio.aec_ref_ring);
+    audio_aec_reset(s_audio.aec);
+#endif
+    xEventGroupClearBits(s_audio.event_group, AUDIO_VAD_START_BIT | AUDIO_VAD_END_BIT);
+}
+
+static void replay(const char *name, const int16_t *pcm, size_t frames, int rounds)
+{
+    const size_t block_bytes = BENCH_BLOCK_FRAMES * INPUT_CHANNELS * sizeof(int16_t);
+    const size_t blocks = frames / BENCH_BLOCK_FRAMES;
+    bench_segment_t segments[BENCH_MAX_SEGMENTS];
+    size_t segment_count = 0;
+    uint32_t starts = 0, ends = 0, over_budget = 0;
+
+    bench_stats_t lat;
+    bench_stats_init(&lat);
+
+    printf("\n%s: %.2f s, %zu blocks of %d frames\n", name,
+           (double)frames / CONFIG_MIC_SAMPLE_RATE, blocks, BENCH_BLOCK_FRAMES);
+
+    uint64_t wall = 0;
+    for (int r = 0; r < rounds; r++) {
+        reset_mic_path();
+        bool active = false;
+
+        for (size_t b = 0; b < blocks; b++) {
+            const uint8_t *block = (const uint8_t *)&pcm[b * BENCH_BLOCK_FRAMES * INPUT_CHANNELS];
+
+            uint64_t t0 = bench_now_ns();
+            process_mic_data(&s_audio.decimator, CONFIG_MIC_SAMPLE_RATE, block, block_bytes);
+            uint64_t ns = bench_now_ns() - t0;
+
+            wall += ns;
+            bench_stats_add(&lat, ns);
+            if (ns > BENCH_BLOCK_US * 1000) over_budget++;
+
+            // Edges are decided inside the block; report at its end
+            if (r > 0) continue;
+            EventBits_t bits = xEventGroupClearBits(s_audio.event_group,
+                                                    AUDIO_VAD_START_BIT | AUDIO_VAD_END_BIT);
+            if (bits & AUDIO_VAD_START_BIT) starts++;
+            if (bits & AUDIO_VAD_END_BIT) ends++;
+
+            uint32_t now_ms = (uint32_t)(((b + 1) * BENCH_BLOCK_US) / 1000);
+            if (s_audio.vad.is_active && !active && segment_count < BENCH_MAX_SEGMENTS) {
+                segments[segment_count].start_ms = now_ms - s_audio.vad.duration_ms;
+                segments[segment_count].end_ms = 0;
+                segment_count++;
+            } else if (!s_audio.vad.is_active && active && segment_count > 0) {
+                segments[segment_count - 1].end_ms = now_ms;
+            }
+            active = s_audio.vad.is_active;
+        }
+    }
+
+    double audio_s = (double)blocks * rounds * BENCH_BLOCK_US / 1e6;
+    printf("  throughput             %.0fx realtime, %.2f%% of one core (%d round%s)\n",
+           audio_s / (wall / 1e9), 100.0 * (wall / 1e9) / audio_s, rounds, rounds == 1 ? "" : "s");
+    bench_stats_print(&lat, "process_mic_data");
+    printf("  over %llu us budget      %lu block(s)\n",
+           (unsigned long long)BENCH_BLOCK_US, (unsigned long)over_budget);
+
+    printf("  VAD: %lu start / %lu end edge(s), noise floor %.1f dBFS\n",
+           (unsigned long)starts, (unsigned long)ends, s_audio.vad.noise_floor_db);
+    for (size_t i = 0; i < segment_count; i++) {
+        if (segments[i].end_ms) {
+            printf("    speech %7.2f s - %7.2f s\n", segments[i].start_ms / 1000.0,
+                   segments[i].end_ms / 1000.0);
+        } else {
+            printf("    speech %7.2f s - (open)\n", segments[i].start_ms / 1000.0);
+        }
+    }
+#ifdef CONFIG_AUDIO_AEC
+    // Nothing plays on the host, so the canceller takes its silent-reference
+    // bypass here; the stage table below times it with a live reference
+    printf("  AEC: reference silent (no playback), filter bypassed\n");
+#endif
+
+    bench_stats_free(&lat);
+}
+
+// ============================================================================
+// Stage Timing
+// ============================================================================
+
+typedef void (*stage_fn_t)(size_t block);
+
+static const int16_t *s_stage_pcm;      // Mic format
+static int16_t s_stage_mono[BENCH_BLOCK_FRAMES];
+static audio_decimator_t s_stage_dec;
+static audio_resampler_t s_stage_rs;
+static audio_vad_t s_stage_vad;
+
+static void stage_decimator(size_t b)
+{
+    audio_decimator_process(&s_stage_dec, &s_stage_pcm[b * BENCH_BLOCK_FRAMES * INPUT_CHANNELS],
+                            BENCH_BLOCK_FRAMES, s_stage_mono);
+}
+
+static void stage_resampler(size_t b)
+{
+    static int16_t out[(BENCH_BLOCK_FRAMES + 8) * INPUT_CHANNELS];
+    audio_resampler_process(&s_stage_rs, &s_stage_pcm[b * BENCH_BLOCK_FRAMES * INPUT_CHANNELS],
+                            BENCH_BLOCK_FRAMES, out);
+}
+
+static void stage_vad(size_t b)
+{
+    (void)b;
+    audio_vad_process(&s_stage_vad, s_stage_mono, BENCH_BLOCK_FRAMES / DOWNSAMPLE_RATIO);
+}
+
+#ifdef CONFIG_AUDIO_AEC
+static void stage_aec(size_t b)
+{
+    static int16_t ref[BENCH_BLOCK_FRAMES / AUDIO_DECIM_FACTOR];
+    static int16_t out[BENCH_BLOCK_FRAMES / AUDIO_DECIM_FACTOR];
+    // Reference = the decimated input one block late, so the filter adapts
+    audio_aec_process(s_audio.aec, s_stage_mono, ref, out, BENCH_BLOCK_FRAMES / AUDIO_DECIM_FACTOR);
+    memcpy(ref, s_stage_mono, sizeof(ref));
+    (void)b;
+}
+#endif
+
+static void time_stage(const char *label, stage_fn_t fn, size_t blocks, int rounds)
+{
+    bench_stats_t st;
+    bench_stats_init(&st);
+    for (int r = 0; r < rounds; r++) {
+        for (size_t b = 0; b < blocks; b++) {
+            uint64_t t0 = bench_now_ns();
+            fn(b);
+            bench_stats_add(&st, bench_now_ns() - t0);
+        }
+    }
+    bench_stats_print(&st, label);
+    bench_stats_free(&st);
+}
+
+static void stage_table(const int16_t *pcm, size_t frames, int rounds)
+{
+    const size_t blocks = frames / BENCH_BLOCK_FRAMES;
+    s_stage_pcm = pcm;
+
+    printf("\nStages (per %llu us block, synthetic input):\n", (unsigned long long)BENCH_BLOCK_US);
+    audio_decimator_init(&s_stage_dec, INPUT_CHANNELS, DOWNSAMPLE_RATIO);
+    time_stage("decimator", stage_decimator, blocks, rounds);
+
+    audio_resampler_init(&s_stage_rs, INPUT_CHANNELS);
+    audio_resampler_set_ratio(&s_stage_rs, 1.0005);
+    time_stage("drift resampler (USB)", stage_resampler, blocks, rounds);
+
+    // VAD and AEC see the decimated block the decimator stage left
+    audio_vad_init(&s_stage_vad, &s_audio.vad_detector.cfg);   // Distinct instance
+    time_stage("vad", stage_vad, blocks, rounds);
+#ifdef CONFIG_AUDIO_AEC
+    audio_aec_reset(s_audio.aec);
+    time_stage("aec (far end active)", stage_aec, blocks, rounds);
+#endif
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char **argv)
+{
+    int rounds = 5;
+    int first_file = 1;
+    for (; first_file < argc && argv[first_file][0] == '-'; first_file++) {
+        if (strcmp(argv[first_file], "-v") == 0) {
+            idf_shim_log_level = ESP_LOG_INFO;
+        } else if (strcmp(argv[first_file], "-r") == 0 && first_file + 1 < argc) {
+            rounds = atoi(argv[++first_file]);
+            if (rounds < 1) rounds = 1;
+        } else {
+            fprintf(stderr, "usage: %s [-v] [-r rounds] [capture.wav ...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    // Boot order: regions first, then the pipeline's slabs
+    mem_arena_init();
+    if (audio_pipeline_init() != ESP_OK) {
+        fprintf(stderr, "audio_pipeline_init failed\n");
+        return 1;
+    }
+    printf("Mic path: %d Hz x %d ch -> %d Hz, VAD %s%s, AEC %s\n",
+           CONFIG_MIC_SAMPLE_RATE, INPUT_CHANNELS, CONFIG_PROCESSED_SAMPLE_RATE,
+           s_audio.vad_detector.cfg.adaptive ? "adaptive" : "fixed",
+           s_audio.vad_detector.cfg.spectral ? "+spectral" : "",
+#ifdef CONFIG_AUDIO_AEC
+           "on"
+#else
+           "off"
+#endif
+    );
+
+    size_t frames;
+    int16_t *synth = synth_speech(&frames);
+    if (!synth) return 1;
+
+    int failed = 0;
+    if (first_file == argc) {
+        replay("synthetic (speech at 1.0-2.5, 4.0-6.0, 7.5-8.0 s)", synth, frames, rounds);
+    }
+    for (int i = first_file; i < argc; i++) {
+        wav_file_t wav;
+        size_t mic_frames;
+        int16_t *pcm = NULL;
+        if (wav_load(argv[i], &wav)) {
+            pcm = wav_to_mic(argv[i], &wav, &mic_frames);
+            wav_free(&wav);
+        }
+        if (!pcm) {
+            failed++;
+            continue;
+        }
+        replay(argv[i], pcm, mic_frames, rounds);
+        free(pcm);
+    }
+
+    stage_table(synth, frames, rounds);
+    free(synth);
+
+    audio_pipeline_deinit();
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,1061 @@
+/**
+ * @file audio_player.c
+ * @brief Playback queue implementation
+ *
+ * Clip slots form a FIFO indexed by free-running counters:
+ *
+ *   q_play ≤ q_decode ≤ q_head
+ *     │         │         └─ next enqueue
+ *     │         └─ next clip for player_dec
+ *     └─ clip player_out is playing (retired once its audio is handed on)
+ *
+ * player_dec writes each clip's audio into the pool and records where it
+ * starts and ends (pool byte positions). player_out follows the pool tail
+ * across those marks to report STARTED / FINISHED, which is what lets it
+ * stream through clip boundaries without stopping.
+ *
+ * Cancellation bumps a generation counter: player_dec abandons a stale
+ * clip between chunks, player_out flushes the TTS stream and discards the
+ * stale clips' pooled audio up to their end marks.
+ */
+
+#include "audio_player.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdatomic.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "freertos/stream_buffer.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_http_client.h"
+#include "sdkconfig.h"
+#include "audio_pipeline.h"
+#include "audio_ring.h"
+#include "mem_arena.h"
+
+static const char *TAG = "audio_player";
+
+// ============================================================================
+// Configuration
+// ============================================================================
+
+#ifndef CONFIG_AUDIO_PLAYER_QUEUE_DEPTH
+#define CONFIG_AUDIO_PLAYER_QUEUE_DEPTH     8
+#endif
+#ifndef CONFIG_AUDIO_PLAYER_POOL_KB
+#define CONFIG_AUDIO_PLAYER_POOL_KB         128
+#endif
+#ifndef CONFIG_AUDIO_PLAYER_PREFETCH_MS
+#define CONFIG_AUDIO_PLAYER_PREFETCH_MS     120
+#endif
+#ifndef CONFIG_AUDIO_PLAYER_PIPE_KB
+#define CONFIG_AUDIO_PLAYER_PIPE_KB         16
+#endif
+#ifndef CONFIG_AUDIO_PLAYER_HTTP_TIMEOUT_MS
+#define CONFIG_AUDIO_PLAYER_HTTP_TIMEOUT_MS 5000
+#endif
+
+#define OUT_RATE                CONFIG_I2S0_SAMPLE_RATE
+#define OUT_FRAME_BYTES         (2 * sizeof(int16_t))           // Stereo, as every mixer stream
+#define OUT_BYTES_PER_MS        (OUT_RATE * OUT_FRAME_BYTES / 1000)
+#define PLAYER_STREAM           AUDIO_STREAM_TTS
+
+#define FEED_PERIOD_MS          10      // TTS stream ring holds ~85ms
+#define POOL_WAIT_MS            20      // Decoder re-check while the pool is full
+#define PIPE_WAIT_MS            20      // PUSH source poll (cancel latency)
+
+#define IN_BUF_SIZE             4096    // Encoded bytes buffered for the decoder
+#define DEC_PCM_SAMPLES         2048
+#define CONV_OUT_FRAMES         1024
+
+#define DEC_TASK_STACK          6144    // Plug-in decoders run here
+#define DEC_TASK_PRIORITY       4
+#define DEC_TASK_CORE           ((CONFIG_TASK_CORE_HELPER < 0) ? tskNO_AFFINITY : CONFIG_TASK_CORE_HELPER)
+#define OUT_TASK_STACK          3072
+#define OUT_TASK_PRIORITY       5       // With the mic task, below the DAC task
+#define OUT_TASK_CORE           CONFIG_TASK_CORE_AUDIO
+
+#define TTFA_EWMA_SHIFT         3       // avg += (sample - avg) / 8
+#define Q16_ONE                 (1u << 16)
+
+// Largest power of two within the configured pool (audio_ring requirement)
+#define POOL_SIZE_FOR(kb)       ((kb) >= 512 ? 512 * 1024 : (kb) >= 256 ? 256 * 1024 : \
+                                 (kb) >= 128 ? 128 * 1024 : (kb) >= 64 ? 64 * 1024 : 32 * 1024)
+#define POOL_SIZE               POOL_SIZE_FOR(CONFIG_AUDIO_PLAYER_POOL_KB)
+#define PIPE_SIZE               (CONFIG_AUDIO_PLAYER_PIPE_KB * 1024)
+
+// Prefetch never needs more than half the pool
+#define PREFETCH_BYTES          ((CONFIG_AUDIO_PLAYER_PREFETCH_MS * OUT_BYTES_PER_MS < POOL_SIZE / 2) ? \
+                                 CONFIG_AUDIO_PLAYER_PREFETCH_MS * OUT_BYTES_PER_MS : POOL_SIZE / 2)
+
+// ============================================================================
+// State
+// ============================================================================
+
+typedef enum {
+    CLIP_FREE = 0,
+    CLIP_QUEUED,
+    CLIP_DECODING,
+    CLIP_DONE,                          // All of its audio is pooled (end_pos valid)
+} clip_state_t;
+
+typedef struct {
+    clip_state_t state;
+    audio_player_clip_t id;
+    audio_player_source_t src;          // src.uri points at uri[]
+    char uri[AUDIO_PLAYER_URI_LEN];
+    uint32_t gen;                       // Stale when != s_player.gen
+    esp_err_t err;
+    uint32_t start_pos;                 // Pool positions (valid from DECODING / DONE)
+    uint32_t end_pos;
+    bool started;
+    int64_t enqueued_us;
+} clip_t;
+
+typedef struct {
+    bool initialized;
+    _Atomic bool running;
+    _Atomic uint32_t gen;
+
+    clip_t clips[CONFIG_AUDIO_PLAYER_QUEUE_DEPTH];
+    uint32_t q_head;
+    uint32_t q_decode;
+    uint32_t q_play;
+    audio_player_clip_t next_id;
+
+    audio_ring_t pool;                  // player_dec → player_out
+    uint8_t *pool_buf;
+
+    // PUSH source
+    StreamBufferHandle_t pipe;
+    StaticStreamBuffer_t pipe_struct;
+    uint8_t *pipe_buf;
+    audio_player_clip_t push_clip;      // Open PUSH clip (0 = none)
+    audio_player_clip_t push_draining;  // Stopped PUSH clip player_dec may still read for
+    _Atomic bool push_ended;
+
+    const audio_player_decoder_t *decoders[AUDIO_PLAYER_FORMAT_COUNT];
+
+    TaskHandle_t dec_task;
+    TaskHandle_t out_task;
+    SemaphoreHandle_t tasks_done;
+
+    audio_player_stats_t stats;
+} audio_player_state_t;
+
+static audio_player_state_t s_player = {0};
+static portMUX_TYPE s_player_lock = portMUX_INITIALIZER_UNLOCKED;  // clips[], q_*, push_*, decoders[], stats
+
+// Decoder scratch (player_dec only)
+static uint8_t s_in_buf[IN_BUF_SIZE];
+static int16_t s_dec_pcm[DEC_PCM_SAMPLES];
+static int16_t s_conv_out[CONV_OUT_FRAMES * 2];
+
+static inline clip_t *slot(uint32_t index)
+{
+    return &s_player.clips[index % CONFIG_AUDIO_PLAYER_QUEUE_DEPTH];
+}
+
+static inline bool pos_reached(uint32_t pos, uint32_t mark)
+{
+    return (int32_t)(pos - mark) >= 0;
+}
+
+static inline bool clip_stale(const clip_t *clip)
+{
+    return clip->gen != atomic_load_explicit(&s_player.gen, memory_order_acquire);
+}
+
+static inline uint32_t pool_tail(void)
+{
+    return atomic_load_explicit(&s_player.pool.tail, memory_order_relaxed);
+}
+
+// ============================================================================
+// Built-in Decoders
+// ============================================================================
+
+static uint16_t le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Copy whole 16-bit frames (shared by WAV data and raw PCM)
+ */
+static size_t copy_frames(const audio_player_pcm_format_t *fmt, const uint8_t *in, size_t in_len,
+                          int16_t *pcm, size_t max_samples, size_t *frames)
+{
+    size_t frame_bytes = sizeof(int16_t) * fmt->channels;
+    size_t n = in_len / frame_bytes;
+    if (n > max_samples / fmt->channels) n = max_samples / fmt->channels;
+    memcpy(pcm, in, n * frame_bytes);
+    *frames = n;
+    return n * frame_bytes;
+}
+
+typedef struct {
+    audio_player_pcm_format_t fmt;
+    bool riff;
+    bool have_fmt;
+    bool in_data;
+    uint32_t skip;                      // Rest of an ignored chunk
+    uint32_t data_left;                 // UINT32_MAX: until the end of the stream
+} wav_dec_t;
+
+static void *wav_open(const audio_player_pcm_format_t *hint)
+{
+    (void)hint;
+    return calloc(1, sizeof(wav_dec_t));
+}
+
+/**
+ * @brief Streaming RIFF parser: chunks may arrive split across reads
+ *
+ * Streaming TTS servers write a data size of 0 or 0xFFFFFFFF when the
+ * length is not known up front; both mean "until the end of the stream".
+ */
+static esp_err_t wav_decode(void *ctx, const uint8_t *in, size_t in_len, size_t *consumed,
+                            int16_t *pcm, size_t max_samples, size_t *frames,
+                            audio_player_pcm_format_t *fmt)
+{
+    wav_dec_t *w = ctx;
+    size_t pos = 0;
+    *frames = 0;
+
+    while (!w->in_data) {
+        if (w->skip) {
+            size_t n = (in_len - pos < w->skip) ? in_len - pos : w->skip;
+            pos += n;
+            w->skip -= n;
+            if (w->skip) goto out;
+            continue;
+        }
+        if (!w->riff) {
+            if (in_len - pos < 12) goto out;
+            if (memcmp(in + pos, "RIFF", 4) || memcmp(in + pos + 8, "WAVE", 4)) {
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            w->riff = true;
+            pos += 12;
+            continue;
+        }
+        if (in_len - pos < 8) goto out;
+
+        const uint8_t *chunk = in + pos;
+        uint32_t size = le32(chunk + 4);
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            if (size < 16 || size > 64) return ESP_ERR_INVALID_RESPONSE;
+            if (in_len - pos < 8 + size) goto out;      // Parse it whole
+
+            uint16_t tag = le16(chunk + 8);
+            if (tag == 0xFFFE && size >= 40) tag = le16(chunk + 32);   // Extensible: subformat
+            uint16_t channels = le16(chunk + 10);
+            uint16_t bits = le16(chunk + 22);
+            if (tag != 1 || bits != 16 || channels == 0 || channels > AUDIO_PLAYER_MAX_CHANNELS) {
+                ESP_LOGE(TAG, "WAV: need 16-bit PCM (format %u, %u bits, %u ch)", tag, bits, channels);
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            w->fmt.channels = (uint8_t)channels;
+            w->fmt.sample_rate = le32(chunk + 12);
+            w->have_fmt = w->fmt.sample_rate > 0;
+            pos += 8;
+            w->skip = size + (size & 1);
+        } else if (memcmp(chunk, "data", 4) == 0) {
+            if (!w->have_fmt) return ESP_ERR_INVALID_RESPONSE;
+            w->in_data = true;
+            w->data_left = (size == 0 || size == UINT32_MAX) ? UINT32_MAX : size;
+            pos += 8;
+        } else {
+            pos += 8;
+            w->skip = size + (size & 1);
+        }
+    }
+
+    if (w->data_left == 0) {
+        pos = in_len;                   // Trailing chunks (LIST, id3) are ignored
+        goto out;
+    }
+
+    size_t avail = in_len - pos;
+    if (avail > w->data_left) avail = w->data_left;
+    size_t used = copy_frames(&w->fmt, in + pos, avail, pcm, max_samples, frames);
+    pos += used;
+    if (w->data_left != UINT32_MAX) w->data_left -= used;
+    *fmt = w->fmt;
+
+out:
+    *consumed = pos;
+    return ESP_OK;
+}
+
+static void *pcm_open(const audio_player_pcm_format_t *hint)
+{
+    if (!hint || hint->sample_rate == 0 || hint->channels == 0 ||
+        hint->channels > AUDIO_PLAYER_MAX_CHANNELS) {
+        ESP_LOGE(TAG, "PCM source needs sample_rate and channels");
+        return NULL;
+    }
+    audio_player_pcm_format_t *fmt = malloc(sizeof(*fmt));
+    if (fmt) *fmt = *hint;
+    return fmt;
+}
+
+static esp_err_t pcm_decode(void *ctx, const uint8_t *in, size_t in_len, size_t *consumed,
+                            int16_t *pcm, size_t max_samples, size_t *frames,
+                            audio_player_pcm_format_t *fmt)
+{
+    *fmt = *(const audio_player_pcm_format_t *)ctx;
+    *consumed = copy_frames(fmt, in, in_len, pcm, max_samples, frames);
+    return ESP_OK;
+}
+
+static void builtin_close(void *ctx)
+{
+    free(ctx);
+}
+
+static const audio_player_decoder_t WAV_DECODER = { wav_open, wav_decode, builtin_close };
+static const audio_player_decoder_t PCM_DECODER = { pcm_open, pcm_decode, builtin_close };
+
+/**
+ * @brief Format from the first bytes of a clip
+ */
+static audio_player_format_t sniff_format(const uint8_t *p, size_t len)
+{
+    if (len >= 4 && memcmp(p, "RIFF", 4) == 0) return AUDIO_PLAYER_FORMAT_WAV;
+    if (len >= 4 && memcmp(p, "OggS", 4) == 0) return AUDIO_PLAYER_FORMAT_OPUS;
+    if (len >= 3 && memcmp(p, "ID3", 3) == 0) return AUDIO_PLAYER_FORMAT_MP3;
+    if (len >= 2 && p[0] == 0xFF && (p[1] & 0xE0) == 0xE0) return AUDIO_PLAYER_FORMAT_MP3;
+    return AUDIO_PLAYER_FORMAT_AUTO;
+}
+
+// ============================================================================
+// Rate / Channel Conversion
+// ============================================================================
+
+/**
+ * @brief Linear interpolation onto OUT_RATE stereo
+ *
+ * TTS voices are 16-24kHz, where interpolation images sit above most of
+ * the speech band; sources above OUT_RATE are not low-passed.
+ */
+typedef struct {
+    uint32_t rate;
+    uint32_t step_q16;                  // Input frames per output frame
+    uint32_t phase_q16;                 // Position between last and the next input
+    int16_t last[2];
+} converter_t;
+
+static void converter_reset(converter_t *cv, uint32_t rate)
+{
+    memset(cv, 0, sizeof(*cv));
+    cv->rate = rate;
+    cv->step_q16 = (uint32_t)(((uint64_t)rate << 16) / OUT_RATE);
+    if (cv->step_q16 == 0) cv->step_q16 = 1;
+}
+
+/**
+ * @return Output frames (stereo) written to @p out
+ */
+static size_t converter_run(converter_t *cv, const int16_t *in, size_t frames, uint8_t channels,
+                            int16_t *out, size_t out_cap)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < frames; i++) {
+        int16_t l = in[i * channels];
+        int16_t r = (channels > 1) ? in[i * channels + 1] : l;
+
+        while (cv->phase_q16 < Q16_ONE && n < out_cap) {
+            int32_t f = (int32_t)(cv->phase_q16 >> 1);     // Q15 keeps Δ·f in 32 bits
+            out[n * 2] = (int16_t)(cv->last[0] + (((l - cv->last[0]) * f) >> 15));
+            out[n * 2 + 1] = (int16_t)(cv->last[1] + (((r - cv->last[1]) * f) >> 15));
+            n++;
+            cv->phase_q16 += cv->step_q16;
+        }
+        cv->phase_q16 -= Q16_ONE;
+        cv->last[0] = l;
+        cv->last[1] = r;
+    }
+    return n;
+}
+
+// ============================================================================
+// Sources
+// ============================================================================
+
+#define SOURCE_AGAIN    (-2)
+
+typedef struct {
+    audio_player_source_type_t type;
+    esp_http_client_handle_t http;
+    FILE *file;
+    const uint8_t *mem;
+    size_t mem_len;
+    size_t mem_pos;
+} source_reader_t;
+
+static esp_err_t source_open(source_reader_t *rd, const clip_t *clip)
+{
+    memset(rd, 0, sizeof(*rd));
+    rd->type = clip->src.type;
+
+    switch (rd->type) {
+        case AUDIO_PLAYER_SOURCE_URL: {
+            esp_http_client_config_t config = {
+                .url = clip->uri,
+                .method = HTTP_METHOD_GET,
+                .timeout_ms = CONFIG_AUDIO_PLAYER_HTTP_TIMEOUT_MS,
+            };
+            rd->http = esp_http_client_init(&config);
+            if (!rd->http) return ESP_ERR_NO_MEM;
+
+            esp_err_t ret = esp_http_client_open(rd->http, 0);
+            if (ret != ESP_OK) return ret;
+            int64_t length = esp_http_client_fetch_headers(rd->http);
+            int status = esp_http_client_get_status_code(rd->http);
+            if (status != 200) {
+                ESP_LOGE(TAG, "GET %s: HTTP %d", clip->uri, status);
+                return ESP_ERR_INVALID_RESPONSE;
+            }
+            ESP_LOGD(TAG, "GET %s: %s", clip->uri, length > 0 ? "sized" : "chunked");
+            return ESP_OK;
+        }
+        case AUDIO_PLAYER_SOURCE_FILE:
+            rd->file = fopen(clip->uri, "rb");
+            if (!rd->file) {
+                ESP_LOGE(TAG, "Cannot open %s", clip->uri);
+                return ESP_ERR_NOT_FOUND;
+            }
+            return ESP_OK;
+        case AUDIO_PLAYER_SOURCE_MEMORY:
+            rd->mem = clip->src.data;
+            rd->mem_len = clip->src.len;
+            return ESP_OK;
+        case AUDIO_PLAYER_SOURCE_PUSH:
+            return ESP_OK;
+    }
+    return ESP_ERR_INVALID_ARG;
+}
+
+/**
+ * @return Bytes read, 0 at the end, SOURCE_AGAIN (nothing yet) or -1 on error
+ */
+static int source_read(source_reader_t *rd, uint8_t *buf, size_t len)
+{
+    switch (rd->type) {
+        case AUDIO_PLAYER_SOURCE_URL:
+            return esp_http_client_read(rd->http, (char *)buf, (int)len);
+        case AUDIO_PLAYER_SOURCE_FILE: {
+            size_t n = fread(buf, 1, len, rd->file);
+            return (n == 0 && ferror(rd->file)) ? -1 : (int)n;
+        }
+        case AUDIO_PLAYER_SOURCE_MEMORY: {
+            size_t n = rd->mem_len - rd->mem_pos;
+            if (n > len) n = len;
+            memcpy(buf, rd->mem + rd->mem_pos, n);
+            rd->mem_pos += n;
+            return (int)n;
+        }
+        case AUDIO_PLAYER_SOURCE_PUSH: {
+            // Check the end flag first so bytes pushed before push_end are not lost
+            bool ended = atomic_load_explicit(&s_player.push_ended, memory_order_acquire);
+            size_t n = xStreamBufferReceive(s_player.pipe, buf, len, pdMS_TO_TICKS(PIPE_WAIT_MS));
+            if (n > 0) return (int)n;
+            return ended ? 0 : SOURCE_AGAIN;
+        }
+    }
+    return -1;
+}
+
+static void source_close(source_reader_t *rd)
+{
+    if (rd->http) {
+        esp_http_client_close(rd->http);
+        esp_http_client_cleanup(rd->http);
+    }
+    if (rd->file) fclose(rd->file);
+    memset(rd, 0, sizeof(*rd));
+}
+
+// ============================================================================
+// Decode Worker (player_dec)
+// ============================================================================
+
+/**
+ * @brief Write to the pool, waiting for player_out to make room
+ * @return false if the clip went stale while waiting
+ */
+static bool pool_write(const clip_t *clip, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        size_t n = audio_ring_write(&s_player.pool, data, len);
+        data += n;
+        len -= n;
+        if (n > 0) xTaskNotifyGive(s_player.out_task);
+        if (len == 0) break;
+
+        if (clip_stale(clip) || !atomic_load(&s_player.running)) return false;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(POOL_WAIT_MS));
+    }
+    return true;
+}
+
+static esp_err_t decode_clip(clip_t *clip)
+{
+    source_reader_t rd;
+    esp_err_t ret = source_open(&rd, clip);
+    if (ret != ESP_OK) {
+        source_close(&rd);
+        return ret;
+    }
+
+    audio_player_format_t format = clip->src.format;
+    const audio_player_decoder_t *dec = NULL;
+    void *ctx = NULL;
+    converter_t cv = {0};
+    size_t in_len = 0;
+    bool eof = false;
+
+    while (!clip_stale(clip) && atomic_load(&s_player.running)) {
+        if (!eof && in_len < IN_BUF_SIZE) {
+            int n = source_read(&rd, s_in_buf + in_len, IN_BUF_SIZE - in_len);
+            if (n > 0) {
+                in_len += n;
+            } else if (n == 0) {
+                eof = true;
+            } else if (n != SOURCE_AGAIN) {
+                ret = ESP_FAIL;
+                break;
+            }
+        }
+        if (in_len == 0) {
+            if (eof) break;
+            continue;
+        }
+
+        if (!dec) {
+            if (format == AUDIO_PLAYER_FORMAT_AUTO) {
+                if (in_len < 4 && !eof) continue;
+                format = sniff_format(s_in_buf, in_len);
+            }
+            portENTER_CRITICAL(&s_player_lock);
+            dec = (format == AUDIO_PLAYER_FORMAT_AUTO) ? NULL : s_player.decoders[format];
+            portEXIT_CRITICAL(&s_player_lock);
+            if (!dec) {
+                ESP_LOGE(TAG, "Clip %lu: no decoder for format %d",
+                         (unsigned long)clip->id, (int)format);
+                ret = ESP_ERR_NOT_SUPPORTED;
+                break;
+            }
+            audio_player_pcm_format_t hint = {clip->src.sample_rate, clip->src.channels};
+            ctx = dec->open(&hint);
+            if (!ctx) {
+                ret = ESP_ERR_NO_MEM;
+                break;
+            }
+        }
+
+        size_t consumed = 0, frames = 0;
+        audio_player_pcm_format_t fmt = {0};
+        ret = dec->decode(ctx, s_in_buf, in_len, &consumed, s_dec_pcm, DEC_PCM_SAMPLES, &frames, &fmt);
+        if (ret != ESP_OK) break;
+        if (consumed > in_len) consumed = in_len;
+        if (consumed > 0) {
+            memmove(s_in_buf, s_in_buf + consumed, in_len - consumed);
+            in_len -= consumed;
+        }
+
+        if (frames > 0 && fmt.sample_rate > 0 && fmt.channels > 0) {
+            if (fmt.sample_rate != cv.rate) converter_reset(&cv, fmt.sample_rate);
+
+            // Slices small enough that the converted output fits
+            size_t slice = (size_t)(((uint64_t)CONV_OUT_FRAMES - 2) * fmt.sample_rate / OUT_RATE);
+            if (slice == 0) slice = 1;
+            for (size_t off = 0; off < frames; off += slice) {
+                size_t n = (frames - off < slice) ? frames - off : slice;
+                size_t out = converter_run(&cv, &s_dec_pcm[off * fmt.channels], n, fmt.channels,
+                                           s_conv_out, CONV_OUT_FRAMES);
+                if (!pool_write(clip, (const uint8_t *)s_conv_out, out * OUT_FRAME_BYTES)) break;
+            }
+        } else if (consumed == 0) {
+            // Decoder wants more input than is left
+            if (eof) break;
+            if (in_len == IN_BUF_SIZE) {
+                ESP_LOGE(TAG, "Clip %lu: decoder stalled", (unsigned long)clip->id);
+                ret = ESP_ERR_INVALID_RESPONSE;
+                break;
+            }
+        }
+    }
+
+    if (ctx) dec->close(ctx);
+    source_close(&rd);
+    return ret;
+}
+
+/**
+ * @brief Take the next queued clip (DECODING), or NULL
+ */
+static clip_t *next_clip(void)
+{
+    clip_t *clip = NULL;
+    portENTER_CRITICAL(&s_player_lock);
+    if (s_player.q_decode != s_player.q_head) {
+        clip = slot(s_player.q_decode++);
+        clip->start_pos = audio_ring_head(&s_player.pool);
+        clip->state = CLIP_DECODING;
+    }
+    portEXIT_CRITICAL(&s_player_lock);
+    return clip;
+}
+
+static void player_dec_task(void *arg)
+{
+    while (atomic_load(&s_player.running)) {
+        clip_t *clip = next_clip();
+        if (!clip) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        esp_err_t err = clip_stale(clip) ? ESP_OK : decode_clip(clip);
+        if (err != ESP_OK && !clip_stale(clip)) {
+            ESP_LOGW(TAG, "Clip %lu failed: %s", (unsigned long)clip->id, esp_err_to_name(err));
+        }
+
+        bool reset_pipe = false;
+        portENTER_CRITICAL(&s_player_lock);
+        if (clip->src.type == AUDIO_PLAYER_SOURCE_PUSH) {
+            if (s_player.push_clip == clip->id) s_player.push_clip = 0;
+            reset_pipe = (s_player.push_clip == 0);     // No newer PUSH clip writing yet
+        }
+        clip->err = err;
+        clip->end_pos = audio_ring_head(&s_player.pool);
+        clip->state = CLIP_DONE;
+        portEXIT_CRITICAL(&s_player_lock);
+
+        if (reset_pipe) {
+            // Bytes a cancelled or failed PUSH clip left behind
+            xStreamBufferReset(s_player.pipe);
+        }
+        if (clip->src.type == AUDIO_PLAYER_SOURCE_PUSH) {
+            // Only now can a new PUSH clip open: this one no longer reads the pipe
+            portENTER_CRITICAL(&s_player_lock);
+            if (s_player.push_draining == clip->id) s_player.push_draining = 0;
+            portEXIT_CRITICAL(&s_player_lock);
+        }
+        xTaskNotifyGive(s_player.out_task);
+    }
+
+    xSemaphoreGive(s_player.tasks_done);
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Output Worker (player_out)
+// ============================================================================
+
+typedef struct {
+    uint32_t gen;
+    bool buffering;                     // Waiting for the prefetch threshold
+    bool idle;                          // Nothing played since the last clip ended
+    bool gap;                           // Ran dry before the next clip started (underrun)
+} out_state_t;
+
+static void record_ttfa(uint32_t ms)
+{
+    audio_player_stats_t *st = &s_player.stats;
+    bool first = st->ttfa_max_ms == 0 && st->ttfa_last_ms == 0;
+    st->ttfa_last_ms = ms;
+    if (first) {
+        st->ttfa_avg_ms = ms;
+    } else {
+        int32_t delta = (int32_t)ms - (int32_t)st->ttfa_avg_ms;
+        st->ttfa_avg_ms += delta / (1 << TTFA_EWMA_SHIFT);
+    }
+    if (ms > st->ttfa_max_ms) st->ttfa_max_ms = ms;
+}
+
+/**
+ * @brief Report clip starts / ends the pool tail has passed
+ */
+static void retire_clips(out_state_t *out)
+{
+    for (;;) {
+        audio_player_event_t event;
+        bool fire = false;
+        clip_t done;
+
+        portENTER_CRITICAL(&s_player_lock);
+        if (s_player.q_play == s_player.q_decode) {
+            portEXIT_CRITICAL(&s_player_lock);
+            return;
+        }
+        clip_t *clip = slot(s_player.q_play);
+        uint32_t tail = pool_tail();
+        bool stale = clip->gen != out->gen;
+
+        if (stale) {
+            // Its pooled audio is dropped; the end is known once the decoder lets go
+            if (clip->state != CLIP_DONE) {
+                portEXIT_CRITICAL(&s_player_lock);
+                audio_ring_discard_to(&s_player.pool, audio_ring_head(&s_player.pool));
+                return;
+            }
+            if (!pos_reached(tail, clip->end_pos)) {
+                portEXIT_CRITICAL(&s_player_lock);
+                audio_ring_discard_to(&s_player.pool, clip->end_pos);
+                continue;
+            }
+            event = AUDIO_PLAYER_EVENT_CANCELLED;
+            s_player.stats.clips_cancelled++;
+            fire = true;
+        } else {
+            if (!clip->started && tail != clip->start_pos && pos_reached(tail, clip->start_pos) &&
+                (clip->state != CLIP_DONE || !pos_reached(clip->start_pos, clip->end_pos))) {
+                clip->started = true;
+                if (out->idle) {
+                    record_ttfa((uint32_t)((esp_timer_get_time() - clip->enqueued_us) / 1000));
+                } else if (!out->gap) {
+                    s_player.stats.gapless++;
+                }
+                out->idle = false;
+                out->gap = false;
+                done = *clip;
+                portEXIT_CRITICAL(&s_player_lock);
+                if (done.src.cb) done.src.cb(done.id, AUDIO_PLAYER_EVENT_STARTED, ESP_OK, done.src.user_ctx);
+                continue;
+            }
+            if (clip->state != CLIP_DONE || !pos_reached(tail, clip->end_pos)) {
+                portEXIT_CRITICAL(&s_player_lock);
+                return;
+            }
+            event = (clip->err == ESP_OK) ? AUDIO_PLAYER_EVENT_FINISHED : AUDIO_PLAYER_EVENT_FAILED;
+            if (clip->err == ESP_OK) s_player.stats.clips_finished++;
+            else s_player.stats.clips_failed++;
+            fire = true;
+        }
+
+        done = *clip;
+        clip->state = CLIP_FREE;
+        s_player.q_play++;
+        portEXIT_CRITICAL(&s_player_lock);
+
+        if (fire && done.src.cb) {
+            done.src.cb(done.id, event, event == AUDIO_PLAYER_EVENT_FAILED ? done.err : ESP_OK,
+                        done.src.user_ctx);
+        }
+    }
+}
+
+/**
+ * @brief Whether the clip at q_play has all of its audio pooled
+ */
+static bool current_clip_complete(void)
+{
+    portENTER_CRITICAL(&s_player_lock);
+    bool complete = s_player.q_play != s_player.q_decode &&
+                    slot(s_player.q_play)->state == CLIP_DONE;
+    portEXIT_CRITICAL(&s_player_lock);
+    return complete;
+}
+
+/**
+ * @brief Whether queued audio is still to come
+ * @param next Out: it belongs to a clip that has not started yet
+ */
+static bool audio_pending(bool *next)
+{
+    portENTER_CRITICAL(&s_player_lock);
+    uint32_t queued = s_player.q_head - s_player.q_play;
+    const clip_t *clip = slot(s_player.q_play);
+    bool pending = queued > 1 || (queued == 1 && clip->state != CLIP_DONE);
+    *next = queued > 0 && (clip->state == CLIP_DONE || !clip->started);
+    portEXIT_CRITICAL(&s_player_lock);
+    return pending;
+}
+
+static bool clips_pending(void)
+{
+    portENTER_CRITICAL(&s_player_lock);
+    bool pending = s_player.q_play != s_player.q_head;
+    portEXIT_CRITICAL(&s_player_lock);
+    return pending;
+}
+
+/**
+ * @brief Top up the TTS stream from the pool
+ */
+static void feed(out_state_t *out)
+{
+    size_t used = audio_ring_used(&s_player.pool);
+
+    if (out->buffering) {
+        if (used < PREFETCH_BYTES && !current_clip_complete()) return;
+        out->buffering = false;
+    }
+
+    if (used == 0) {
+        // Dry with audio still to come is an underrun (before the next clip: a
+        // gapless miss, neither gapless nor TTFA); only a quiet queue is idle
+        bool next = false;
+        if (audio_pending(&next)) {
+            if (!out->idle) {
+                portENTER_CRITICAL(&s_player_lock);
+                s_player.stats.underruns++;
+                portEXIT_CRITICAL(&s_player_lock);
+                if (next) out->gap = true;
+            }
+        } else {
+            out->idle = true;
+        }
+        out->buffering = true;
+        return;
+    }
+
+    // Whole frames only; the stream ring never holds a torn frame
+    for (int pass = 0; pass < 2; pass++) {
+        const uint8_t *ptr;
+        size_t len = audio_ring_read_acquire(&s_player.pool, &ptr) & ~(OUT_FRAME_BYTES - 1);
+        if (len == 0) break;
+        size_t written = audio_pipeline_write_stream(PLAYER_STREAM, ptr, len);
+        audio_ring_read_release(&s_player.pool, written);
+        if (written < len) break;
+    }
+    xTaskNotifyGive(s_player.dec_task);
+}
+
+static void player_out_task(void *arg)
+{
+    out_state_t out = {
+        .gen = atomic_load(&s_player.gen),
+        .buffering = true,
+        .idle = true,
+    };
+
+    while (atomic_load(&s_player.running)) {
+        uint32_t gen = atomic_load_explicit(&s_player.gen, memory_order_acquire);
+        if (gen != out.gen) {
+            // audio_player_stop(): silence now, then drop stale pooled audio
+            out.gen = gen;
+            audio_pipeline_flush_stream(PLAYER_STREAM);
+            out.buffering = true;
+            out.idle = true;
+            out.gap = false;
+        }
+
+        retire_clips(&out);
+        feed(&out);
+        retire_clips(&out);
+
+        portENTER_CRITICAL(&s_player_lock);
+        s_player.stats.playing = !out.buffering;
+        portEXIT_CRITICAL(&s_player_lock);
+
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(FEED_PERIOD_MS));
+    }
+
+    xSemaphoreGive(s_player.tasks_done);
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t audio_player_init(void)
+{
+    if (s_player.initialized) return ESP_OK;
+
+    s_player.pool_buf = mem_arena_acquire(MEM_REGION_PSRAM, "player_pool", POOL_SIZE);
+    s_player.pipe_buf = mem_arena_acquire(MEM_REGION_PSRAM, "player_pipe", PIPE_SIZE + 1);
+    s_player.tasks_done = xSemaphoreCreateCounting(2, 0);
+    if (!s_player.pool_buf || !s_player.pipe_buf || !s_player.tasks_done) {
+        ESP_LOGE(TAG, "Failed to allocate player buffers");
+        audio_player_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+    audio_ring_init(&s_player.pool, s_player.pool_buf, POOL_SIZE);
+    s_player.pipe = xStreamBufferCreateStatic(PIPE_SIZE, 1, s_player.pipe_buf, &s_player.pipe_struct);
+
+    s_player.decoders[AUDIO_PLAYER_FORMAT_WAV] = &WAV_DECODER;
+    s_player.decoders[AUDIO_PLAYER_FORMAT_PCM] = &PCM_DECODER;
+    s_player.next_id = 1;
+    atomic_store(&s_player.running, true);
+
+    if (xTaskCreatePinnedToCore(player_out_task, "player_out", OUT_TASK_STACK, NULL,
+                                OUT_TASK_PRIORITY, &s_player.out_task, OUT_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create output task");
+        atomic_store(&s_player.running, false);
+        audio_player_deinit();
+        return ESP_FAIL;
+    }
+    if (xTaskCreatePinnedToCore(player_dec_task, "player_dec", DEC_TASK_STACK, NULL,
+                                DEC_TASK_PRIORITY, &s_player.dec_task, DEC_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create decode task");
+        s_player.initialized = true;
+        audio_player_deinit();
+        return ESP_FAIL;
+    }
+
+    s_player.initialized = true;
+    ESP_LOGI(TAG, "Player ready: %u KB pool (%u ms), prefetch %u ms, %d clips",
+             (unsigned)(POOL_SIZE / 1024), (unsigned)(POOL_SIZE / OUT_BYTES_PER_MS),
+             (unsigned)(PREFETCH_BYTES / OUT_BYTES_PER_MS), CONFIG_AUDIO_PLAYER_QUEUE_DEPTH);
+    return ESP_OK;
+}
+
+void audio_player_deinit(void)
+{
+    if (s_player.initialized) {
+        audio_player_stop();
+
+        int tasks = (s_player.out_task ? 1 : 0) + (s_player.dec_task ? 1 : 0);
+        atomic_store(&s_player.running, false);
+        if (s_player.out_task) xTaskNotifyGive(s_player.out_task);
+        if (s_player.dec_task) xTaskNotifyGive(s_player.dec_task);
+        for (int i = 0; i < tasks; i++) {
+            xSemaphoreTake(s_player.tasks_done, portMAX_DELAY);
+        }
+        audio_pipeline_flush_stream(PLAYER_STREAM);
+    }
+
+    if (s_player.pipe) vStreamBufferDelete(s_player.pipe);
+    if (s_player.tasks_done) vSemaphoreDelete(s_player.tasks_done);
+    mem_arena_release(s_player.pool_buf);
+    mem_arena_release(s_player.pipe_buf);
+    memset(&s_player, 0, sizeof(s_player));
+}
+
+esp_err_t audio_player_enqueue(const audio_player_source_t *src, audio_player_clip_t *clip_out)
+{
+    if (!s_player.initialized) return ESP_ERR_INVALID_STATE;
+    if (!src || src->format >= AUDIO_PLAYER_FORMAT_COUNT) return ESP_ERR_INVALID_ARG;
+    if ((src->type == AUDIO_PLAYER_SOURCE_URL || src->type == AUDIO_PLAYER_SOURCE_FILE) &&
+        (!src->uri || strlen(src->uri) >= AUDIO_PLAYER_URI_LEN)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (src->type == AUDIO_PLAYER_SOURCE_MEMORY && (!src->data || src->len == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (src->type > AUDIO_PLAYER_SOURCE_PUSH) return ESP_ERR_INVALID_ARG;
+
+    esp_err_t ret = ESP_OK;
+    audio_player_clip_t id = 0;
+
+    portENTER_CRITICAL(&s_player_lock);
+    if (s_player.q_head - s_player.q_play >= CONFIG_AUDIO_PLAYER_QUEUE_DEPTH) {
+        ret = ESP_ERR_NO_MEM;
+    } else if (src->type == AUDIO_PLAYER_SOURCE_PUSH && (s_player.push_clip || s_player.push_draining)) {
+        ret = ESP_ERR_INVALID_STATE;
+    } else {
+        clip_t *clip = slot(s_player.q_head);
+        memset(clip, 0, sizeof(*clip));
+        clip->src = *src;
+        if (src->uri) {
+            strncpy(clip->uri, src->uri, AUDIO_PLAYER_URI_LEN - 1);
+        }
+        clip->src.uri = clip->uri;
+        id = s_player.next_id++;
+        if (s_player.next_id == 0) s_player.next_id = 1;
+        clip->id = id;
+        clip->gen = atomic_load(&s_player.gen);
+        clip->enqueued_us = esp_timer_get_time();
+        clip->state = CLIP_QUEUED;
+        if (src->type == AUDIO_PLAYER_SOURCE_PUSH) {
+            s_player.push_clip = id;
+            atomic_store(&s_player.push_ended, false);
+        }
+        s_player.q_head++;
+    }
+    portEXIT_CRITICAL(&s_player_lock);
+
+    if (ret != ESP_OK) return ret;
+    if (clip_out) *clip_out = id;
+    xTaskNotifyGive(s_player.dec_task);
+    return ESP_OK;
+}
+
+size_t audio_player_push(const void *data, size_t len, uint32_t timeout_ms)
+{
+    if (!s_player.initialized || !data || len == 0) return 0;
+
+    portENTER_CRITICAL(&s_player_lock);
+    bool open = s_player.push_clip != 0;
+    portEXIT_CRITICAL(&s_player_lock);
+    if (!open || atomic_load(&s_player.push_ended)) return 0;
+
+    return xStreamBufferSend(s_player.pipe, data, len, pdMS_TO_TICKS(timeout_ms));
+}
+
+esp_err_t audio_player_push_end(void)
+{
+    if (!s_player.initialized) return ESP_ERR_INVALID_STATE;
+
+    portENTER_CRITICAL(&s_player_lock);
+    bool open = s_player.push_clip != 0;
+    portEXIT_CRITICAL(&s_player_lock);
+    if (!open) return ESP_ERR_INVALID_STATE;
+
+    atomic_store_explicit(&s_player.push_ended, true, memory_order_release);
+    return ESP_OK;
+}
+
+esp_err_t audio_player_stop(void)
+{
+    if (!s_player.initialized) return ESP_ERR_INVALID_STATE;
+
+    // Everything enqueued so far becomes stale; both workers notice
+    portENTER_CRITICAL(&s_player_lock);
+    atomic_fetch_add_explicit(&s_player.gen, 1, memory_order_release);
+    if (s_player.push_clip) s_player.push_draining = s_player.push_clip;
+    s_player.push_clip = 0;
+    portEXIT_CRITICAL(&s_player_lock);
+    atomic_store(&s_player.push_ended, true);
+
+    if (s_player.out_task) xTaskNotifyGive(s_player.out_task);
+    if (s_player.dec_task) xTaskNotifyGive(s_player.dec_task);
+    return ESP_OK;
+}
+
+esp_err_t audio_player_register_decoder(audio_player_format_t format,
+                                        const audio_player_decoder_t *decoder)
+{
+    if (format == AUDIO_PLAYER_FORMAT_AUTO || format >= AUDIO_PLAYER_FORMAT_COUNT) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (decoder && (!decoder->open || !decoder->decode || !decoder->close)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Before init too: init only fills the built-in entries
+    portENTER_CRITICAL(&s_player_lock);
+    s_player.decoders[format] = decoder;
+    portEXIT_CRITICAL(&s_player_lock);
+    return ESP_OK;
+}
+
+bool audio_player_is_busy(void)
+{
+    return s_player.initialized && clips_pending();
+}
+
+void audio_player_get_stats(audio_player_stats_t *stats)
+{
+    if (!stats) return;
+
+    portENTER_CRITICAL(&s_player_lock);
+    *stats = s_player.stats;
+    stats->queued = (uint8_t)(s_player.q_head - s_player.q_play);
+    portEXIT_CRITICAL(&s_player_lock);
+    stats->pool_ms = s_player.initialized ?
+                     (uint16_t)(audio_ring_used(&s_player.pool) / OUT_BYTES_PER_MS) : 0;
+}
@@ -0,0 +1,248 @@
+/**
+ * @file audio_player.h
+ * @brief Playback queue for spoken replies (streaming TTS, cached clips)
+ *
+ * Clips are enqueued from any task and played back-to-back on
+ * AUDIO_STREAM_TTS:
+ *
+ *   enqueue(src) ──► clip FIFO ──► player_dec task
+ *                                    read chunk (HTTP / file / memory / push)
+ *                                    decode (WAV, PCM, registered MP3/Opus)
+ *                                    → stereo, → CONFIG_I2S0_SAMPLE_RATE
+ *                                        │
+ *                                        ▼
+ *                                  PCM pool (PSRAM ring)
+ *                                        │  prefetch gate
+ *                                        ▼
+ *                                  player_out task ──► audio_pipeline_write_stream(TTS)
+ *
+ *   - A clip starts once CONFIG_AUDIO_PLAYER_PREFETCH_MS of decoded audio
+ *     is pooled, or as soon as all of it is (short clips)
+ *   - The next clip is decoded while the current one plays and follows it
+ *     without a gap or a new prefetch
+ *   - A pool that runs dry mid-clip (slow server) re-arms the prefetch
+ *     gate instead of stuttering block by block
+ *   - Chunked HTTP responses are decoded as they arrive: time to first
+ *     audio is one prefetch, not the whole reply
+ *
+ * WAV (16-bit PCM) and raw PCM are decoded built in; MP3 and Opus play
+ * once a decoder is registered with audio_player_register_decoder().
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define AUDIO_PLAYER_URI_LEN        160     // URL / path, including terminator
+#define AUDIO_PLAYER_MAX_CHANNELS   8       // Decoded channels accepted (first two played)
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Clip handle (0 = none)
+ */
+typedef uint32_t audio_player_clip_t;
+
+/**
+ * @brief Where a clip's bytes come from
+ */
+typedef enum {
+    AUDIO_PLAYER_SOURCE_URL = 0,    // HTTP(S) GET, plain or chunked
+    AUDIO_PLAYER_SOURCE_FILE,       // VFS path (e.g. cached replies on /spiffs)
+    AUDIO_PLAYER_SOURCE_MEMORY,     // Caller buffer, valid until the clip ends
+    AUDIO_PLAYER_SOURCE_PUSH,       // Fed with audio_player_push()
+} audio_player_source_type_t;
+
+/**
+ * @brief Encoded format of a clip
+ */
+typedef enum {
+    AUDIO_PLAYER_FORMAT_AUTO = 0,   // From the first bytes (RIFF, ID3 / MPEG sync, OggS)
+    AUDIO_PLAYER_FORMAT_WAV,
+    AUDIO_PLAYER_FORMAT_PCM,        // Raw 16-bit LE, rate / channels from the source
+    AUDIO_PLAYER_FORMAT_MP3,
+    AUDIO_PLAYER_FORMAT_OPUS,       // Ogg Opus
+    AUDIO_PLAYER_FORMAT_COUNT
+} audio_player_format_t;
+
+/**
+ * @brief Clip progress reported to the source callback
+ */
+typedef enum {
+    AUDIO_PLAYER_EVENT_STARTED = 0, // First sample handed to the mixer
+    AUDIO_PLAYER_EVENT_FINISHED,    // Last sample handed to the mixer
+    AUDIO_PLAYER_EVENT_FAILED,      // Source or decode error (what decoded was played)
+    AUDIO_PLAYER_EVENT_CANCELLED,   // audio_player_stop()
+} audio_player_event_t;
+
+/**
+ * @brief Clip callback (player_out task context; keep it short)
+ *
+ * Every clip ends with exactly one FINISHED, FAILED or CANCELLED.
+ */
+typedef void (*audio_player_cb_t)(audio_player_clip_t clip, audio_player_event_t event,
+                                  esp_err_t err, void *user_ctx);
+
+/**
+ * @brief Clip description for audio_player_enqueue()
+ */
+typedef struct {
+    audio_player_source_type_t type;
+    const char *uri;                // URL or file path (copied)
+    const uint8_t *data;            // MEMORY source
+    size_t len;
+    audio_player_format_t format;
+    uint32_t sample_rate;           // PCM format only
+    uint8_t channels;               // PCM format only
+    audio_player_cb_t cb;           // Optional
+    void *user_ctx;
+} audio_player_source_t;
+
+/**
+ * @brief Decoded PCM layout
+ */
+typedef struct {
+    uint32_t sample_rate;
+    uint8_t channels;
+} audio_player_pcm_format_t;
+
+/**
+ * @brief Decoder plug-in (one instance per clip, player_dec task)
+ *
+ * decode() is called with everything buffered so far. It reports the
+ * input bytes it used (0 = needs more input) and the interleaved 16-bit
+ * frames it produced; unused input is passed again with more appended.
+ */
+typedef struct {
+    /**
+     * @param hint Rate / channels the source declared (0 if unknown)
+     * @return Decoder state, NULL on failure
+     */
+    void *(*open)(const audio_player_pcm_format_t *hint);
+
+    /**
+     * @param ctx         State from open()
+     * @param in          Buffered input
+     * @param in_len      Bytes in @p in
+     * @param consumed    Out: input bytes used
+     * @param pcm         Out: interleaved samples
+     * @param max_samples Capacity of @p pcm in samples
+     * @param frames      Out: frames written
+     * @param fmt         Out: layout of the frames written
+     * @return ESP_OK, or an error that fails the clip
+     */
+    esp_err_t (*decode)(void *ctx, const uint8_t *in, size_t in_len, size_t *consumed,
+                        int16_t *pcm, size_t max_samples, size_t *frames,
+                        audio_player_pcm_format_t *fmt);
+
+    void (*close)(void *ctx);
+} audio_player_decoder_t;
+
+/**
+ * @brief Player statistics
+ *
+ * Time to first audio is measured from enqueue to the clip's first sample
+ * reaching the TTS stream (it plays one DAC descriptor later), for clips
+ * that start from silence; clips chained onto a playing one count as
+ * gapless instead, or as an underrun when the pool ran dry between them.
+ */
+typedef struct {
+    bool playing;                       // Pooled audio is being fed
+    uint8_t queued;                     // Clips not yet finished
+    uint16_t pool_ms;                   // Decoded audio waiting in the pool
+    uint32_t clips_finished;
+    uint32_t clips_failed;
+    uint32_t clips_cancelled;
+    uint32_t gapless;                   // Clips chained without a gap
+    uint32_t underruns;                 // Pool ran dry with audio queued (prefetch re-armed)
+    uint32_t ttfa_last_ms;
+    uint32_t ttfa_avg_ms;               // EWMA
+    uint32_t ttfa_max_ms;
+} audio_player_stats_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Allocate the pool and start the decode / output tasks
+ *
+ * Call after audio_pipeline_init().
+ */
+esp_err_t audio_player_init(void);
+
+/**
+ * @brief Cancel all clips and stop the tasks
+ */
+void audio_player_deinit(void);
+
+/**
+ * @brief Queue a clip behind the ones already queued
+ *
+ * @param src  Clip description (copied; MEMORY data is not)
+ * @param clip Out: handle passed to the callback (optional)
+ * @return ESP_OK, ESP_ERR_NO_MEM when CONFIG_AUDIO_PLAYER_QUEUE_DEPTH clips
+ *         are pending, ESP_ERR_INVALID_STATE for a second PUSH clip while
+ *         one is still open or a stopped one is still reading the pipe
+ *         (briefly after audio_player_stop(); retry)
+ */
+esp_err_t audio_player_enqueue(const audio_player_source_t *src, audio_player_clip_t *clip);
+
+/**
+ * @brief Feed bytes to the open PUSH clip
+ *
+ * Buffered up to CONFIG_AUDIO_PLAYER_PIPE_KB, also while earlier clips
+ * are still playing.
+ *
+ * @param data       Encoded bytes
+ * @param len        Byte count
+ * @param timeout_ms Wait for pipe space
+ * @return Bytes accepted (0 without an open PUSH clip)
+ */
+size_t audio_player_push(const void *data, size_t len, uint32_t timeout_ms);
+
+/**
+ * @brief End the open PUSH clip (it finishes once the pipe drains)
+ */
+esp_err_t audio_player_push_end(void);
+
+/**
+ * @brief Cancel the playing and all queued clips
+ *
+ * Output stops at once: the TTS stream is flushed and pooled audio
+ * dropped; an HTTP read in progress ends within its timeout.
+ */
+esp_err_t audio_player_stop(void);
+
+/**
+ * @brief Install a decoder for a format (replaces the built-in one)
+ */
+esp_err_t audio_player_register_decoder(audio_player_format_t format,
+                                        const audio_player_decoder_t *decoder);
+
+/**
+ * @brief Clips queued or playing
+ */
+bool audio_player_is_busy(void);
+
+/**
+ * @brief Get player statistics
+ */
+void audio_player_get_stats(audio_player_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
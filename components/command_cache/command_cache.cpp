@@ -21,17 +21,28 @@ static const char* TAG = "cmd_cache";
 #define LOG_I(fmt, ...) printf("[INFO] " fmt "\n", ##__VA_ARGS__)
 #define LOG_W(fmt, ...) printf("[WARN] " fmt "\n", ##__VA_ARGS__)
 #define LOG_E(fmt, ...) printf("[ERROR] " fmt "\n", ##__VA_ARGS__)
+#ifdef CMD_CACHE_HOST_DEBUG
 #define LOG_D(fmt, ...) printf("[DEBUG] " fmt "\n", ##__VA_ARGS__)
+#else
+#define LOG_D(fmt, ...) do { } while (0)
+#endif
 #endif
 
 // Cache storage
 static cmd_cache_entry_t s_cache[CMD_CACHE_MAX_ENTRIES];
 static int s_cache_count = 0;
 static int s_fuzzy_threshold = CMD_FUZZY_THRESHOLD;
-static cmd_cache_stats_t s_stats = {0};
+static cmd_cache_stats_t s_stats = {};
 static cmd_action_callback_t s_callbacks[CMD_ACTION_COUNT] = {NULL};
 static bool s_initialized = false;
 
+// Slot state
+static char s_appliance_names[CMD_APPLIANCE_MAX][CMD_APPLIANCE_NAME_MAX_LEN];
+static uint16_t s_appliance_cps[CMD_APPLIANCE_MAX][CMD_APPLIANCE_NAME_MAX_LEN];
+static uint8_t s_appliance_len[CMD_APPLIANCE_MAX];
+static int s_appliance_count = 0;
+static cmd_slot_values_t s_slots = {};
+
 // ============================================================================
 // Default Japanese Commands
 // ============================================================================
@@ -42,6 +53,7 @@ static const cmd_cache_entry_t DEFAULT_COMMANDS[] = {
     {"照明消して", "電気消して", "はい、照明を消します", CMD_CAT_LIGHTING, CMD_ACTION_LIGHT_OFF, 0, NULL, true},
     {"明るくして", "もっと明るく", "照明を明るくします", CMD_CAT_LIGHTING, CMD_ACTION_LIGHT_BRIGHT, 20, NULL, true},
     {"暗くして", "もっと暗く", "照明を暗くします", CMD_CAT_LIGHTING, CMD_ACTION_LIGHT_DIM, -20, NULL, true},
+    {"明るさを{pct}にして", "明るさ{pct}", "明るさを{pct}%にします", CMD_CAT_LIGHTING, CMD_ACTION_LIGHT_SET, 100, NULL, true},
     {"ライトオン", "ライトつけて", "ライトをつけます", CMD_CAT_LIGHTING, CMD_ACTION_LIGHT_ON, 100, NULL, true},
     {"ライトオフ", "ライト消して", "ライトを消します", CMD_CAT_LIGHTING, CMD_ACTION_LIGHT_OFF, 0, NULL, true},
 
@@ -51,6 +63,7 @@ static const cmd_cache_entry_t DEFAULT_COMMANDS[] = {
     {"暖房つけて", "ヒーターつけて", "暖房を起動します", CMD_CAT_CLIMATE, CMD_ACTION_AC_ON, 22, NULL, true},
     {"温度上げて", "もっと暖かく", "設定温度を上げます", CMD_CAT_CLIMATE, CMD_ACTION_AC_TEMP_UP, 1, NULL, true},
     {"温度下げて", "もっと涼しく", "設定温度を下げます", CMD_CAT_CLIMATE, CMD_ACTION_AC_TEMP_DOWN, -1, NULL, true},
+    {"温度を{num}度にして", "{num}度にして", "設定温度を{num}度にします", CMD_CAT_CLIMATE, CMD_ACTION_AC_SET_TEMP, 26, NULL, true},
 
     // === センサー情報 ===
     {"今何度", "室温教えて", "現在の室温は%d度です", CMD_CAT_SENSOR, CMD_ACTION_REPORT_TEMP, 0, NULL, true},
@@ -66,82 +79,661 @@ static const cmd_cache_entry_t DEFAULT_COMMANDS[] = {
     {"音量上げて", "ボリュームアップ", "音量を上げます", CMD_CAT_MEDIA, CMD_ACTION_VOLUME_UP, 10, NULL, true},
     {"音量下げて", "ボリュームダウン", "音量を下げます", CMD_CAT_MEDIA, CMD_ACTION_VOLUME_DOWN, -10, NULL, true},
     {"ミュート", "消音", "ミュートにします", CMD_CAT_MEDIA, CMD_ACTION_VOLUME_MUTE, 0, NULL, true},
+    {"音量を{num}にして", "音量{num}", "音量を{num}にします", CMD_CAT_MEDIA, CMD_ACTION_VOLUME_SET, 0, NULL, true},
 
     // === タイマー ===
     {"タイマーセット", "タイマー設定", "タイマーを設定しました", CMD_CAT_TIMER, CMD_ACTION_TIMER_SET, 0, NULL, true},
     {"タイマー解除", "タイマーキャンセル", "タイマーを解除しました", CMD_CAT_TIMER, CMD_ACTION_TIMER_CANCEL, 0, NULL, true},
+    {"{dur}のタイマー", "タイマー{dur}", "{dur}のタイマーを設定しました", CMD_CAT_TIMER, CMD_ACTION_TIMER_SET, 0, NULL, true},
 
     // === システム ===
     {"システム状態", "ステータス確認", "システムは正常に動作しています", CMD_CAT_SYSTEM, CMD_ACTION_SYSTEM_STATUS, 0, NULL, true},
     {"おはよう", "おはようございます", "おはようございます。今日も良い一日を", CMD_CAT_SYSTEM, CMD_ACTION_NONE, 0, NULL, true},
     {"おやすみ", "おやすみなさい", "おやすみなさい。照明を消しますか？", CMD_CAT_SYSTEM, CMD_ACTION_NONE, 0, NULL, true},
     {"ありがとう", "サンキュー", "どういたしまして", CMD_CAT_SYSTEM, CMD_ACTION_NONE, 0, NULL, true},
+
+    // === 登録機器 (cmd_cache_set_appliances) ===
+    {"{appliance}つけて", "{appliance}オン", "{appliance}をつけます", CMD_CAT_CUSTOM, CMD_ACTION_APPLIANCE_ON, 0, NULL, true},
+    {"{appliance}消して", "{appliance}オフ", "{appliance}を消します", CMD_CAT_CUSTOM, CMD_ACTION_APPLIANCE_OFF, 0, NULL, true},
 };
 
 #define DEFAULT_COMMANDS_COUNT (sizeof(DEFAULT_COMMANDS) / sizeof(DEFAULT_COMMANDS[0]))
 
 // ============================================================================
-// Fuzzy Matching (Levenshtein Distance based)
+// Text Normalization (UTF-8 → folded code points)
+// ============================================================================
+
+// Half-width katakana U+FF66..U+FF9D → full-width katakana (offset from U+30A0)
+static const uint8_t HALFWIDTH_KANA[] = {
+    0x52, 0x01, 0x03, 0x05, 0x07, 0x09, 0x43, 0x45, 0x47, 0x23,     // ｦｧｨｩｪｫｬｭｮｯ
+    0x5C, 0x02, 0x04, 0x06, 0x08, 0x0A, 0x0B, 0x0D, 0x0F, 0x11,     // ｰｱｲｳｴｵｶｷｸｹ
+    0x13, 0x15, 0x17, 0x19, 0x1B, 0x1D, 0x1F, 0x21, 0x24, 0x26,     // ｺｻｼｽｾｿﾀﾁﾂﾃ
+    0x28, 0x2A, 0x2B, 0x2C, 0x2D, 0x2E, 0x2F, 0x32, 0x35, 0x38,     // ﾄﾅﾆﾇﾈﾉﾊﾋﾌﾍ
+    0x3B, 0x3E, 0x3F, 0x40, 0x41, 0x42, 0x44, 0x46, 0x48, 0x49,     // ﾎﾏﾐﾑﾒﾓﾔﾕﾖﾗ
+    0x4A, 0x4B, 0x4C, 0x4D, 0x4F, 0x53,                             // ﾘﾙﾚﾛﾜﾝ
+};
+
+/**
+ * @brief Decode one UTF-8 sequence (invalid bytes become U+FFFD)
+ */
+static uint32_t utf8_next(const unsigned char** p) {
+    const unsigned char* s = *p;
+    uint32_t cp;
+    int extra;
+
+    if (s[0] < 0x80)      { cp = s[0];        extra = 0; }
+    else if (s[0] < 0xC2) { *p = s + 1;       return 0xFFFD; }
+    else if (s[0] < 0xE0) { cp = s[0] & 0x1F; extra = 1; }
+    else if (s[0] < 0xF0) { cp = s[0] & 0x0F; extra = 2; }
+    else if (s[0] < 0xF5) { cp = s[0] & 0x07; extra = 3; }
+    else                  { *p = s + 1;       return 0xFFFD; }
+
+    for (int i = 1; i <= extra; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *p = s + i;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (s[i] & 0x3F);
+    }
+    *p = s + extra + 1;
+    return cp;
+}
+
+/**
+ * @brief Apply a voiced / semi-voiced sound mark to the previous kana
+ */
+static uint16_t apply_sound_mark(uint16_t prev, bool semi) {
+    bool ha_row = prev >= 0x306F && prev <= 0x307B && ((prev - 0x306F) % 3) == 0;
+
+    if (semi) return ha_row ? prev + 2 : prev;
+    if (prev == 0x3046) return 0x3094;                              // う → ゔ
+    if ((prev >= 0x304B && prev <= 0x3061 && (prev & 1)) ||         // か〜ち
+        prev == 0x3064 || prev == 0x3066 || prev == 0x3068 ||       // つてと
+        ha_row) {
+        return prev + 1;
+    }
+    return prev;
+}
+
+/**
+ * @brief Fold one code point for matching
+ * @return Folded code point, or 0 if it carries no meaning for matching
+ */
+static uint16_t fold_code_point(uint32_t cp) {
+    // Full-width ASCII → ASCII
+    if (cp >= 0xFF01 && cp <= 0xFF5E) cp -= 0xFEE0;
+
+    // Half-width katakana → full-width katakana
+    if (cp >= 0xFF66 && cp <= 0xFF9D) cp = 0x30A0 + HALFWIDTH_KANA[cp - 0xFF66];
+
+    // Katakana → hiragana (ー is kept)
+    if (cp >= 0x30A1 && cp <= 0x30F6) cp -= 0x60;
+
+    if (cp < 0x80) {
+        if (cp >= 'A' && cp <= 'Z') return (uint16_t)(cp - 'A' + 'a');
+        return (isalnum((int)cp) || cp == '%') ? (uint16_t)cp : 0;
+    }
+
+    // Private use area is reserved for slot markers
+    if (cp >= 0xE000 && cp <= 0xF8FF) return 0;
+
+    // Spaces and punctuation: 　、。〃〈〉《》「」『』【】〜・ and half-width ｡｢｣､･
+    if ((cp >= 0x3000 && cp <= 0x3003) || (cp >= 0x3008 && cp <= 0x3011) ||
+        cp == 0x301C || cp == 0x30FB || (cp >= 0xFF61 && cp <= 0xFF65)) {
+        return 0;
+    }
+
+    return (cp > 0xFFFF) ? 0xFFFD : (uint16_t)cp;
+}
+
+// Slot placeholders ("{num}" ...) and their marker code points (U+E000 + type)
+static const char* const SLOT_NAMES[CMD_SLOT_COUNT] = {"num", "pct", "dur", "appliance"};
+#define CMD_SLOT_MARKER(type)       ((uint16_t)(0xE000 + (type)))
+#define CMD_SLOT_IS_MARKER(cp)      ((cp) >= 0xE000 && (cp) < 0xE000 + CMD_SLOT_COUNT)
+
+/**
+ * @brief Parse a "{name}" placeholder at p
+ * @return Byte length of the placeholder, or 0 if there is none
+ */
+static size_t parse_placeholder(const char* p, cmd_slot_type_t* type) {
+    for (int t = 0; t < CMD_SLOT_COUNT; t++) {
+        size_t n = strlen(SLOT_NAMES[t]);
+        if (p[0] == '{' && strncmp(p + 1, SLOT_NAMES[t], n) == 0 && p[n + 1] == '}') {
+            *type = (cmd_slot_type_t)t;
+            return n + 2;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Normalize UTF-8 text into folded code points
+ *
+ * Katakana, half-width katakana and hiragana compare equal, full-width
+ * ASCII folds to lower-case ASCII, and spaces / punctuation are dropped,
+ * so "ライトオン", "らいとおん" and "ﾗｲﾄｵﾝ！" normalize identically.
+ *
+ * @param slot_mask If non-NULL, placeholders become slot markers and
+ *                  their types are OR'd into *slot_mask (patterns only)
+ * @return Number of code points written (truncated at max_len)
+ */
+static int normalize_text(const char* text, uint16_t* out, int max_len, uint8_t* slot_mask) {
+    const unsigned char* p = (const unsigned char*)text;
+    int len = 0;
+
+    while (*p && len < max_len) {
+        cmd_slot_type_t type;
+        size_t placeholder = slot_mask ? parse_placeholder((const char*)p, &type) : 0;
+        if (placeholder) {
+            out[len++] = CMD_SLOT_MARKER(type);
+            *slot_mask |= (uint8_t)(1 << type);
+            p += placeholder;
+            continue;
+        }
+
+        uint32_t cp = utf8_next(&p);
+
+        // Voiced sound marks: half-width ﾞﾟ, combining, and spacing forms
+        if (cp == 0xFF9E || cp == 0xFF9F || (cp >= 0x3099 && cp <= 0x309C)) {
+            bool semi = (cp == 0xFF9F || cp == 0x309A || cp == 0x309C);
+            if (len > 0) out[len - 1] = apply_sound_mark(out[len - 1], semi);
+            continue;
+        }
+
+        uint16_t folded = fold_code_point(cp);
+        if (folded) out[len++] = folded;
+    }
+
+    return len;
+}
+
+// ============================================================================
+// Slot Tokenizer
 // ============================================================================
 
+static int kanji_digit(uint16_t c) {
+    switch (c) {
+    case 0x3007: case 0x96F6: return 0;     // 〇 零
+    case 0x4E00: return 1;                  // 一
+    case 0x4E8C: return 2;                  // 二
+    case 0x4E09: return 3;                  // 三
+    case 0x56DB: return 4;                  // 四
+    case 0x4E94: return 5;                  // 五
+    case 0x516D: return 6;                  // 六
+    case 0x4E03: return 7;                  // 七
+    case 0x516B: return 8;                  // 八
+    case 0x4E5D: return 9;                  // 九
+    default: return -1;
+    }
+}
+
+static int kanji_unit(uint16_t c) {
+    switch (c) {
+    case 0x5341: return 10;                 // 十
+    case 0x767E: return 100;                // 百
+    case 0x5343: return 1000;               // 千
+    case 0x4E07: return 10000;              // 万
+    default: return 0;
+    }
+}
+
+#define CMD_NUMBER_MAX  999999999           // Longer numerals saturate here
+
+static inline int cap_number(int64_t v) {
+    return v < CMD_NUMBER_MAX ? (int)v : CMD_NUMBER_MAX;
+}
+
+/**
+ * @brief Parse an ASCII or kanji numeral at q[pos]
+ *
+ * Handles "25", "二十五", "百二十", "三万" and digit-by-digit "二五".
+ * Values saturate at CMD_NUMBER_MAX.
+ *
+ * @return End position (pos if there is no numeral)
+ */
+static int parse_number(const uint16_t* q, int len, int pos, int* value) {
+    int i = pos;
+
+    if (q[i] >= '0' && q[i] <= '9') {
+        int v = 0;
+        while (i < len && q[i] >= '0' && q[i] <= '9') {
+            if (v < 100000000) v = v * 10 + (q[i] - '0');
+            i++;
+        }
+        *value = v;
+        return i;
+    }
+
+    int total = 0, section = 0, digit = -1;
+    while (i < len) {
+        int d = kanji_digit(q[i]);
+        int unit = kanji_unit(q[i]);
+        if (d >= 0) {
+            if (digit < 0) {
+                digit = d;
+            } else if (digit < 100000000) {
+                digit = digit * 10 + d;
+            }
+        } else if (unit == 10000) {
+            total = cap_number(total + ((int64_t)section + (digit > 0 ? digit : 0)) * unit);
+            if (total == 0) total = unit;
+            section = 0;
+            digit = -1;
+        } else if (unit) {
+            section = cap_number(section + (int64_t)(digit > 0 ? digit : 1) * unit);
+            digit = -1;
+        } else {
+            break;
+        }
+        i++;
+    }
+    if (i == pos) return pos;
+
+    *value = cap_number((int64_t)total + section + (digit > 0 ? digit : 0));
+    return i;
+}
+
+static bool match_cps(const uint16_t* q, int len, int pos, const uint16_t* word, int n) {
+    return pos + n <= len && memcmp(&q[pos], word, n * sizeof(uint16_t)) == 0;
+}
+
+/**
+ * @brief Parse one or more duration units after a numeral ("1時間30分")
+ *
+ * Seconds saturate at CMD_NUMBER_MAX.
+ *
+ * @return End position (pos if the numeral has no duration unit)
+ */
+static int parse_duration(const uint16_t* q, int len, int pos, int value, int* seconds) {
+    static const uint16_t HOUR[] = {0x6642, 0x9593};    // 時間
+    int total = 0;
+    int i = pos;
+
+    while (true) {
+        int unit = 0, n = 0;
+        if (match_cps(q, len, i, HOUR, 2)) { unit = 3600; n = 2; }
+        else if (i < len && q[i] == 0x5206) { unit = 60; n = 1; }     // 分
+        else if (i < len && q[i] == 0x79D2) { unit = 1; n = 1; }      // 秒
+        if (!unit) break;
+
+        total = cap_number(total + (int64_t)value * unit);
+        i += n;
+        if (unit > 1 && i < len && q[i] == 0x534A) {                 // 半
+            total = cap_number((int64_t)total + unit / 2);
+            i++;
+        }
+
+        // Continue with the next "<numeral><unit>" group, if any
+        int next_value = 0;
+        int next = (i < len) ? parse_number(q, len, i, &next_value) : i;
+        if (next == i) break;
+        int save = i;
+        i = next;
+        value = next_value;
+        if (!(match_cps(q, len, i, HOUR, 2) || (i < len && (q[i] == 0x5206 || q[i] == 0x79D2)))) {
+            i = save;
+            break;
+        }
+    }
+
+    if (i == pos) return pos;
+    *seconds = total;
+    return i;
+}
+
+/**
+ * @brief Parse a percent suffix ("%", "パーセント", "割")
+ * @return End position (pos if there is none)
+ */
+static int parse_percent(const uint16_t* q, int len, int pos, int value, int* percent) {
+    static const uint16_t PERCENT_WORD[] = {0x3071, 0x30FC, 0x305B, 0x3093, 0x3068};   // ぱーせんと
+
+    if (pos < len && q[pos] == '%') { *percent = value; return pos + 1; }
+    if (match_cps(q, len, pos, PERCENT_WORD, 5)) { *percent = value; return pos + 5; }
+    if (pos < len && q[pos] == 0x5272) { *percent = cap_number((int64_t)value * 10); return pos + 1; }   // 割
+    return pos;
+}
+
+static void fill_slot(cmd_slot_values_t* slots, cmd_slot_type_t type, int value) {
+    if (!(slots->filled & (1 << type))) {
+        slots->filled |= (uint8_t)(1 << type);
+        slots->value[type] = value;
+    }
+}
+
 /**
- * @brief Calculate Levenshtein distance between two UTF-8 strings
+ * @brief Replace slot values in a normalized input with slot markers
+ *
+ * The first value of each type is kept in slots. Appliance names are
+ * matched longest-first before numerals, so names containing digits work.
+ *
+ * @return Length of the tokenized input written to out
  */
-static int levenshtein_distance(const char* s1, const char* s2) {
-    int len1 = strlen(s1);
-    int len2 = strlen(s2);
-
-    // Simple implementation for short strings
-    if (len1 == 0) return len2;
-    if (len2 == 0) return len1;
-
-    // Use stack allocation for small strings
-    int matrix[64][64];
-    if (len1 > 63 || len2 > 63) {
-        // Fall back to simple comparison for long strings
-        return (strcmp(s1, s2) == 0) ? 0 : (len1 + len2) / 2;
-    }
-
-    for (int i = 0; i <= len1; i++) matrix[i][0] = i;
-    for (int j = 0; j <= len2; j++) matrix[0][j] = j;
-
-    for (int i = 1; i <= len1; i++) {
-        for (int j = 1; j <= len2; j++) {
-            int cost = (s1[i-1] == s2[j-1]) ? 0 : 1;
-            int del = matrix[i-1][j] + 1;
-            int ins = matrix[i][j-1] + 1;
-            int sub = matrix[i-1][j-1] + cost;
-
-            matrix[i][j] = del;
-            if (ins < matrix[i][j]) matrix[i][j] = ins;
-            if (sub < matrix[i][j]) matrix[i][j] = sub;
+static int tokenize_slots(const uint16_t* q, int len, uint16_t* out, cmd_slot_values_t* slots) {
+    int n = 0;
+    int i = 0;
+
+    while (i < len) {
+        // Appliance name
+        int best = -1, best_len = 0;
+        for (int a = 0; a < s_appliance_count; a++) {
+            int alen = s_appliance_len[a];
+            if (alen > best_len && match_cps(q, len, i, s_appliance_cps[a], alen)) {
+                best = a;
+                best_len = alen;
+            }
         }
+        if (best >= 0) {
+            if (!(slots->filled & (1 << CMD_SLOT_APPLIANCE))) {
+                snprintf(slots->appliance, sizeof(slots->appliance), "%s", s_appliance_names[best]);
+            }
+            fill_slot(slots, CMD_SLOT_APPLIANCE, best);
+            out[n++] = CMD_SLOT_MARKER(CMD_SLOT_APPLIANCE);
+            i += best_len;
+            continue;
+        }
+
+        // Numeral, typed by its suffix
+        int value = 0;
+        int end = parse_number(q, len, i, &value);
+        if (end > i) {
+            int typed = 0;
+            int next;
+            if ((next = parse_duration(q, len, end, value, &typed)) > end) {
+                fill_slot(slots, CMD_SLOT_DURATION, typed);
+                out[n++] = CMD_SLOT_MARKER(CMD_SLOT_DURATION);
+            } else if ((next = parse_percent(q, len, end, value, &typed)) > end) {
+                fill_slot(slots, CMD_SLOT_PERCENT, typed);
+                out[n++] = CMD_SLOT_MARKER(CMD_SLOT_PERCENT);
+            } else {
+                fill_slot(slots, CMD_SLOT_NUMBER, value);
+                out[n++] = CMD_SLOT_MARKER(CMD_SLOT_NUMBER);
+            }
+            i = next;
+            continue;
+        }
+
+        out[n++] = q[i++];
     }
 
-    return matrix[len1][len2];
+    return n;
+}
+
+// ============================================================================
+// Pattern Index (padded bigram inverted lists)
+// ============================================================================
+//
+// Each pattern (id = entry * 2 + alt) is stored normalized in a shared
+// code point pool and posted under the hash of every bigram of "^pattern$".
+// A query only scores the entries that share at least one bigram with it:
+//
+//   - Containment (scores 95 / 90) always shares the inner bigrams when
+//     both sides have 2+ code points; 1-code-point patterns are kept on a
+//     separate short list and 1-code-point inputs fall back to a full scan
+//   - Edit distance: every edit destroys at most two of the L+1 padded
+//     bigrams, so a pattern within distance k shares at least L+1-2k of
+//     them (q-gram lemma). Posting hits give an upper bound on the shared
+//     count, so patterns below the bound for the threshold's k are skipped
+//   - No shared bigram at all means d ≥ (L+1)/2, i.e. a score ≤ 50, so
+//     thresholds at or below CMD_INDEX_EXACT_THRESHOLD fall back to a
+//     full scan
+//
+// Hash collisions only add candidates. The index is appended to by
+// cmd_cache_add() and rebuilt by cmd_cache_remove().
+
+#define CMD_INDEX_BUCKETS           1024
+#define CMD_INDEX_BUCKET_SHIFT      22              // 32 - log2(buckets)
+#define CMD_INDEX_POOL_CP           (CMD_CACHE_MAX_ENTRIES * 2 * CMD_INDEX_AVG_PATTERN_CP)
+#define CMD_INDEX_POSTINGS          (CMD_INDEX_POOL_CP + CMD_CACHE_MAX_ENTRIES * 2)
+#define CMD_INDEX_EXACT_THRESHOLD   50
+#define CMD_INDEX_NONE              0xFFFF
+#define CMD_INPUT_MAX_CP            128
+#define CMD_BOUNDARY                0               // Padding code point (never produced by folding)
+
+typedef struct {
+    uint16_t offset;                            // Into s_norm_pool
+    uint8_t len;                                // Code points (0 = not matchable)
+    uint8_t slot_mask;                          // Placeholder types (1 << cmd_slot_type_t)
+} cmd_norm_ref_t;
+
+static uint16_t s_norm_pool[CMD_INDEX_POOL_CP];
+static uint16_t s_norm_used = 0;
+static cmd_norm_ref_t s_norm[CMD_CACHE_MAX_ENTRIES * 2];
+
+static uint16_t s_bucket_head[CMD_INDEX_BUCKETS];
+static uint16_t s_post_id[CMD_INDEX_POSTINGS];
+static uint16_t s_post_next[CMD_INDEX_POSTINGS];
+static uint16_t s_post_used = 0;
+
+static uint16_t s_short_ids[CMD_CACHE_MAX_ENTRIES * 2];
+static int s_short_count = 0;
+
+// Per-query candidate collection (epoch-stamped to avoid clearing)
+static uint16_t s_pattern_epoch[CMD_CACHE_MAX_ENTRIES * 2];
+static uint8_t s_pattern_hits[CMD_CACHE_MAX_ENTRIES * 2];
+static uint16_t s_touched[CMD_CACHE_MAX_ENTRIES * 2];
+static uint16_t s_entry_epoch[CMD_CACHE_MAX_ENTRIES];
+static uint16_t s_epoch = 0;
+static uint16_t s_candidates[CMD_CACHE_MAX_ENTRIES];
+
+static inline uint32_t bigram_bucket(uint16_t a, uint16_t b) {
+    uint32_t key = ((uint32_t)a << 16) | b;
+    return (key * 2654435761u) >> CMD_INDEX_BUCKET_SHIFT;
+}
+
+static void index_clear(void) {
+    memset(s_bucket_head, 0xFF, sizeof(s_bucket_head));
+    memset(s_norm, 0, sizeof(s_norm));
+    s_norm_used = 0;
+    s_post_used = 0;
+    s_short_count = 0;
 }
 
 /**
- * @brief Calculate similarity score (0-100)
+ * @brief Normalize and post one pattern
+ * @return false if the index pools are exhausted
  */
-static int calculate_similarity(const char* input, const char* pattern) {
-    if (!input || !pattern) return 0;
+static bool index_add_pattern(uint16_t id, const char* pattern) {
+    uint16_t cps[CMD_PATTERN_MAX_LEN];
+    uint8_t slot_mask = 0;
+    int len = normalize_text(pattern, cps, CMD_PATTERN_MAX_LEN, &slot_mask);
+
+    s_norm[id].len = 0;
+    s_norm[id].slot_mask = slot_mask;
+    if (len == 0) return true;      // Empty patterns never match
+
+    if (s_norm_used + len > CMD_INDEX_POOL_CP || s_post_used + len + 1 > CMD_INDEX_POSTINGS) {
+        return false;
+    }
+
+    s_norm[id].offset = s_norm_used;
+    s_norm[id].len = (uint8_t)len;
+    memcpy(&s_norm_pool[s_norm_used], cps, len * sizeof(uint16_t));
+    s_norm_used += len;
+
+    if (len == 1) {
+        s_short_ids[s_short_count++] = id;
+    }
+
+    uint16_t prev = CMD_BOUNDARY;
+    for (int i = 0; i <= len; i++) {
+        uint16_t cur = (i < len) ? cps[i] : CMD_BOUNDARY;
+        uint32_t bucket = bigram_bucket(prev, cur);
+        s_post_id[s_post_used] = id;
+        s_post_next[s_post_used] = s_bucket_head[bucket];
+        s_bucket_head[bucket] = s_post_used++;
+        prev = cur;
+    }
+
+    return true;
+}
+
+static bool index_add_entry(int index) {
+    return index_add_pattern((uint16_t)(index * 2), s_cache[index].pattern) &&
+           index_add_pattern((uint16_t)(index * 2 + 1), s_cache[index].pattern_alt);
+}
+
+static void index_rebuild(void) {
+    index_clear();
+    for (int i = 0; i < s_cache_count; i++) {
+        if (!index_add_entry(i)) {
+            LOG_E("Index pool exhausted at entry %d", i);
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Largest edit distance that still scores at least threshold
+ *
+ * 100 - d*100/L >= T  <=>  d <= ((101 - T)*L - 1) / 100
+ */
+static inline int max_distance(int max_len, int threshold) {
+    int max_dist = ((101 - threshold) * max_len - 1) / 100;
+    return (max_dist < 0) ? 0 : max_dist;
+}
+
+/**
+ * @brief Whether a pattern with `hits` shared-bigram hits can still score
+ */
+static bool pattern_may_match(int lq, int lp, int hits, int threshold) {
+    if (lp == 1) return true;
+
+    // Containment needs every inner bigram of the shorter side
+    int contain_need = ((lq < lp) ? lq : lp) - 1;
+    if (hits >= contain_need) return true;
+
+    int max_len = (lq > lp) ? lq : lp;
+    return hits >= max_len + 1 - 2 * max_distance(max_len, threshold);
+}
+
+static inline void add_candidate(int entry, int* count) {
+    if (s_entry_epoch[entry] != s_epoch) {
+        s_entry_epoch[entry] = s_epoch;
+        s_candidates[(*count)++] = (uint16_t)entry;
+    }
+}
+
+/**
+ * @brief Collect entries whose patterns pass the shared-bigram filter
+ * @return Candidate count (entries in s_candidates)
+ */
+static int collect_candidates(const uint16_t* q, int lq, int threshold) {
+    if (++s_epoch == 0) {
+        memset(s_pattern_epoch, 0, sizeof(s_pattern_epoch));
+        memset(s_entry_epoch, 0, sizeof(s_entry_epoch));
+        s_epoch = 1;
+    }
+
+    // Count posting hits per pattern
+    int touched = 0;
+    uint16_t prev = CMD_BOUNDARY;
+    for (int i = 0; i <= lq; i++) {
+        uint16_t cur = (i < lq) ? q[i] : CMD_BOUNDARY;
+        for (uint16_t p = s_bucket_head[bigram_bucket(prev, cur)]; p != CMD_INDEX_NONE; p = s_post_next[p]) {
+            uint16_t id = s_post_id[p];
+            if (s_pattern_epoch[id] != s_epoch) {
+                s_pattern_epoch[id] = s_epoch;
+                s_pattern_hits[id] = 0;
+                s_touched[touched++] = id;
+            }
+            if (s_pattern_hits[id] < UINT8_MAX) s_pattern_hits[id]++;
+        }
+        prev = cur;
+    }
+
+    int count = 0;
+    for (int i = 0; i < touched; i++) {
+        uint16_t id = s_touched[i];
+        if (pattern_may_match(lq, s_norm[id].len, s_pattern_hits[id], threshold)) {
+            add_candidate(id >> 1, &count);
+        }
+    }
+
+    for (int i = 0; i < s_short_count; i++) {
+        add_candidate(s_short_ids[i] >> 1, &count);
+    }
+
+    return count;
+}
+
+// ============================================================================
+// Fuzzy Matching (banded Levenshtein over code points)
+// ============================================================================
+
+static bool contains_cp(const uint16_t* hay, int lh, const uint16_t* needle, int ln) {
+    for (int i = 0; i + ln <= lh; i++) {
+        if (memcmp(&hay[i], needle, ln * sizeof(uint16_t)) == 0) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Levenshtein distance limited to max_dist (two rows, diagonal band)
+ * @return Distance, or max_dist + 1 if it exceeds max_dist
+ */
+static int banded_distance(const uint16_t* a, int la, const uint16_t* b, int lb, int max_dist) {
+    const int inf = max_dist + 1;
+    if (la - lb > max_dist || lb - la > max_dist) return inf;
+
+    int rows[2][CMD_PATTERN_MAX_LEN + 1];
+    int* prev = rows[0];
+    int* cur = rows[1];
+
+    for (int j = 0; j <= lb; j++) prev[j] = (j <= max_dist) ? j : inf;
+
+    for (int i = 1; i <= la; i++) {
+        int lo = (i - max_dist > 1) ? i - max_dist : 1;
+        int hi = (i + max_dist < lb) ? i + max_dist : lb;
+
+        cur[lo - 1] = (lo == 1 && i <= max_dist) ? i : inf;
+        int row_min = cur[lo - 1];
+
+        for (int j = lo; j <= hi; j++) {
+            int v = prev[j - 1] + (a[i - 1] != b[j - 1]);
+            if (prev[j] + 1 < v) v = prev[j] + 1;
+            if (cur[j - 1] + 1 < v) v = cur[j - 1] + 1;
+            if (v > inf) v = inf;
+            cur[j] = v;
+            if (v < row_min) row_min = v;
+        }
+        if (hi < lb) cur[hi + 1] = inf;     // Next row reads one past the band
+
+        if (row_min > max_dist) return inf;
+
+        int* tmp = prev;
+        prev = cur;
+        cur = tmp;
+    }
+
+    return prev[lb];
+}
+
+/**
+ * @brief Calculate similarity score (0-100) against one indexed pattern
+ *
+ * Scores below the threshold are reported as 0 (the band stops early).
+ */
+static int calculate_similarity(const uint16_t* q, int lq, uint16_t id, int threshold) {
+    const int lp = s_norm[id].len;
+    if (lp == 0) return 0;
+    const uint16_t* p = &s_norm_pool[s_norm[id].offset];
 
     // Check for exact match first
-    if (strcmp(input, pattern) == 0) return 100;
+    if (lq == lp && memcmp(q, p, lq * sizeof(uint16_t)) == 0) return 100;
 
     // Check if input contains pattern
-    if (strstr(input, pattern) != NULL) return 95;
+    if (contains_cp(q, lq, p, lp)) return 95;
 
     // Check if pattern contains input
-    if (strstr(pattern, input) != NULL) return 90;
+    if (contains_cp(p, lp, q, lq)) return 90;
 
-    // Calculate Levenshtein-based similarity
-    int distance = levenshtein_distance(input, pattern);
-    int max_len = strlen(input);
-    if ((int)strlen(pattern) > max_len) max_len = strlen(pattern);
+    // Edit distance bounded by what the threshold still accepts
+    int max_len = (lq > lp) ? lq : lp;
+    int max_dist = max_distance(max_len, threshold);
 
-    if (max_len == 0) return 0;
+    int distance = banded_distance(q, lq, p, lp, max_dist);
+    if (distance > max_dist) return 0;
 
     int similarity = 100 - (distance * 100 / max_len);
     if (similarity < 0) similarity = 0;
@@ -150,13 +742,116 @@ static int calculate_similarity(const char* input, const char* pattern) {
 }
 
 /**
- * @brief Check if input matches pattern with fuzzy matching
+ * @brief Whether a pattern takes part in a matching pass
+ *
+ * Plain patterns match the plain input (filled = -1); slot patterns match
+ * the tokenized input, and only if every slot they use was filled.
+ */
+static inline bool pattern_in_pass(uint16_t id, int filled) {
+    uint8_t mask = s_norm[id].slot_mask;
+    if (filled < 0) return mask == 0;
+    return mask != 0 && (mask & ~filled) == 0;
+}
+
+/**
+ * @brief Check if input matches entry (best of pattern / pattern_alt)
+ * @param pattern_id Output: id of the better-scoring pattern
+ */
+static int match_pattern(const uint16_t* q, int lq, int index, int threshold, int filled,
+                         uint16_t* pattern_id) {
+    uint16_t id1 = (uint16_t)(index * 2);
+    uint16_t id2 = (uint16_t)(index * 2 + 1);
+    int score1 = pattern_in_pass(id1, filled) ? calculate_similarity(q, lq, id1, threshold) : 0;
+    int score2 = pattern_in_pass(id2, filled) ? calculate_similarity(q, lq, id2, threshold) : 0;
+
+    *pattern_id = (score2 > score1) ? id2 : id1;
+    return (score1 >= score2) ? score1 : score2;
+}
+
+/**
+ * @brief Score the candidates of one query form
  */
-static int match_pattern(const char* input, const cmd_cache_entry_t* entry) {
-    int score1 = calculate_similarity(input, entry->pattern);
-    int score2 = calculate_similarity(input, entry->pattern_alt);
+static void find_best_match(const uint16_t* q, int lq, int threshold, int filled,
+                            int* best_score, int* best_index, uint16_t* best_pattern) {
+    *best_score = 0;
+    *best_index = -1;
+    if (lq == 0) return;
+
+    // Low thresholds and 1-code-point inputs can match without a shared bigram
+    bool full_scan = (lq < 2 || threshold <= CMD_INDEX_EXACT_THRESHOLD);
+    int count = full_scan ? s_cache_count : collect_candidates(q, lq, threshold);
+
+    // Find best matching command (ties go to the lower index, as in a linear scan)
+    for (int c = 0; c < count; c++) {
+        int i = full_scan ? c : s_candidates[c];
+        if (!s_cache[i].enabled) continue;
 
-    return (score1 > score2) ? score1 : score2;
+        s_stats.candidates_scored++;
+        uint16_t id;
+        int score = match_pattern(q, lq, i, threshold, filled, &id);
+        if (score > *best_score || (score == *best_score && score > 0 && i < *best_index)) {
+            *best_score = score;
+            *best_index = i;
+            *best_pattern = id;
+        }
+    }
+}
+
+/**
+ * @brief Action parameter for a slot pattern: first numeric slot, else appliance
+ */
+static int slot_param(uint8_t mask, const cmd_slot_values_t* slots, int fallback) {
+    for (int t = 0; t < CMD_SLOT_COUNT; t++) {
+        if (mask & (1 << t)) return slots->value[t];
+    }
+    return fallback;
+}
+
+// ============================================================================
+// Response Rendering
+// ============================================================================
+
+static size_t append_duration(char* out, size_t len, int seconds) {
+    int h = seconds / 3600;
+    int m = (seconds % 3600) / 60;
+    int sec = seconds % 60;
+    int n = 0;
+
+    if (h) n += snprintf(out + n, len - n, "%d時間", h);
+    if (m && n < (int)len) n += snprintf(out + n, len - n, "%d分", m);
+    if ((sec || (!h && !m)) && n < (int)len) n += snprintf(out + n, len - n, "%d秒", sec);
+    return (n < (int)len) ? n : len - 1;
+}
+
+/**
+ * @brief Copy a response template, expanding slot placeholders
+ *
+ * {num} / {pct} expand to param, {dur} to a 時間/分/秒 string and
+ * {appliance} to the appliance name of the current input.
+ */
+static void render_response(const char* tmpl, int param, char* out, size_t len) {
+    size_t n = 0;
+
+    while (*tmpl && n + 1 < len) {
+        cmd_slot_type_t type;
+        size_t placeholder = parse_placeholder(tmpl, &type);
+        if (!placeholder) {
+            out[n++] = *tmpl++;
+            continue;
+        }
+
+        if (type == CMD_SLOT_DURATION) {
+            n += append_duration(out + n, len - n, param);
+        } else {
+            int w = (type == CMD_SLOT_APPLIANCE)
+                ? snprintf(out + n, len - n, "%s", s_slots.appliance)
+                : snprintf(out + n, len - n, "%d", param);
+            n = (n + w < len) ? n + w : len - 1;
+        }
+        tmpl += placeholder;
+    }
+
+    out[n] = '\0';
 }
 
 // ============================================================================
@@ -173,10 +868,12 @@ bool cmd_cache_init(void) {
     memset(&s_stats, 0, sizeof(s_stats));
     memset(s_callbacks, 0, sizeof(s_callbacks));
     s_cache_count = 0;
+    index_clear();
 
     // Load default commands
     for (size_t i = 0; i < DEFAULT_COMMANDS_COUNT && s_cache_count < CMD_CACHE_MAX_ENTRIES; i++) {
         memcpy(&s_cache[s_cache_count], &DEFAULT_COMMANDS[i], sizeof(cmd_cache_entry_t));
+        if (!index_add_entry(s_cache_count)) break;
         s_cache_count++;
     }
 
@@ -191,6 +888,7 @@ void cmd_cache_deinit(void) {
 
     memset(s_cache, 0, sizeof(s_cache));
     s_cache_count = 0;
+    index_clear();
     s_initialized = false;
 
     LOG_I("Command cache deinitialized");
@@ -204,39 +902,67 @@ bool cmd_cache_process(const char* input, cmd_match_result_t* result) {
     memset(result, 0, sizeof(cmd_match_result_t));
     s_stats.total_queries++;
 
-    int best_score = 0;
-    int best_index = -1;
-
-    // Find best matching command
-    for (int i = 0; i < s_cache_count; i++) {
-        if (!s_cache[i].enabled) continue;
-
-        int score = match_pattern(input, &s_cache[i]);
+    uint16_t query[CMD_INPUT_MAX_CP];
+    int query_len = normalize_text(input, query, CMD_INPUT_MAX_CP, NULL);
+    const int threshold = s_fuzzy_threshold;
+
+    // Plain patterns against the input as spoken
+    int best_score, best_index;
+    uint16_t best_pattern = 0;
+    find_best_match(query, query_len, threshold, -1, &best_score, &best_index, &best_pattern);
+
+    // Slot patterns against the input with numerals / appliances tokenized;
+    // ties keep the plain match ("一時停止" is not "{num}時停止"). A bare
+    // value ("十分") would be contained in every pattern using its slot,
+    // so at least two literal code points must remain.
+    memset(&s_slots, 0, sizeof(s_slots));
+    uint16_t slotted[CMD_INPUT_MAX_CP];
+    int slotted_len = tokenize_slots(query, query_len, slotted, &s_slots);
+    int literal = 0;
+    for (int i = 0; i < slotted_len; i++) {
+        if (!CMD_SLOT_IS_MARKER(slotted[i])) literal++;
+    }
+    if (s_slots.filled && literal >= 2) {
+        int score, index;
+        uint16_t pattern = 0;
+        find_best_match(slotted, slotted_len, threshold, s_slots.filled, &score, &index, &pattern);
         if (score > best_score) {
             best_score = score;
-            best_index = i;
+            best_index = index;
+            best_pattern = pattern;
         }
     }
+    result->slots = s_slots;
 
     // Check if best match meets threshold
-    if (best_score >= s_fuzzy_threshold && best_index >= 0) {
+    if (best_score >= threshold && best_index >= 0) {
+        uint8_t used = s_norm[best_pattern].slot_mask;
+        int param = slot_param(used, &s_slots, s_cache[best_index].default_param);
+
         result->matched = true;
         result->entry_index = best_index;
         result->match_score = best_score;
+        result->extracted_param = param;
 
         // Execute action and generate response
-        cmd_cache_execute(best_index, s_cache[best_index].default_param,
-                         result->response, sizeof(result->response));
+        cmd_cache_execute(best_index, param, result->response, sizeof(result->response));
 
         s_stats.cache_hits++;
         s_stats.category_hits[s_cache[best_index].category]++;
+        for (int t = 0; t < CMD_SLOT_COUNT; t++) {
+            if (used & (1 << t)) s_stats.slot_hits[t]++;
+        }
 
-        LOG_D("Cache hit: '%s' -> '%s' (score: %d)",
-              input, s_cache[best_index].pattern, best_score);
+        LOG_D("Cache hit: '%s' -> '%s' (score: %d, param: %d)",
+              input, s_cache[best_index].pattern, best_score, param);
 
         return true;
     }
 
+    for (int t = 0; t < CMD_SLOT_COUNT; t++) {
+        if (s_slots.filled & (1 << t)) s_stats.slot_misses[t]++;
+    }
+
     // No match - will need LLM fallback
     s_stats.cache_misses++;
     LOG_D("Cache miss: '%s' (best score: %d)", input, best_score);
@@ -268,8 +994,8 @@ bool cmd_cache_execute(int entry_index, int param, char* response, size_t respon
         return success;
     }
 
-    // Default: copy response template
-    snprintf(response, response_len, "%s", entry->response);
+    // Default: response template with slot placeholders expanded
+    render_response(entry->response, param, response, response_len);
     s_stats.action_successes++;
 
     return true;
@@ -282,9 +1008,14 @@ int cmd_cache_add(const cmd_cache_entry_t* entry) {
 
     memcpy(&s_cache[s_cache_count], entry, sizeof(cmd_cache_entry_t));
     int index = s_cache_count;
+    if (!index_add_entry(index)) {
+        LOG_W("Index pool full, cannot add '%s'", entry->pattern);
+        index_rebuild();
+        return -1;
+    }
     s_cache_count++;
 
-    LOG_I("Added command: '%s' at index %d", entry->pattern, index);
+    LOG_D("Added command: '%s' at index %d", entry->pattern, index);
     return index;
 }
 
@@ -298,6 +1029,7 @@ bool cmd_cache_remove(int index) {
         memcpy(&s_cache[i], &s_cache[i + 1], sizeof(cmd_cache_entry_t));
     }
     s_cache_count--;
+    index_rebuild();
 
     LOG_I("Removed command at index %d", index);
     return true;
@@ -333,6 +1065,29 @@ void cmd_cache_set_threshold(int threshold) {
     }
 }
 
+void cmd_cache_set_appliances(const char* const* names, int count) {
+    s_appliance_count = 0;
+    for (int i = 0; names && i < count && s_appliance_count < CMD_APPLIANCE_MAX; i++) {
+        if (!names[i]) continue;
+
+        int a = s_appliance_count;
+        int len = normalize_text(names[i], s_appliance_cps[a], CMD_APPLIANCE_NAME_MAX_LEN, NULL);
+        if (len == 0) continue;
+
+        snprintf(s_appliance_names[a], sizeof(s_appliance_names[a]), "%s", names[i]);
+        s_appliance_len[a] = (uint8_t)len;
+        s_appliance_count++;
+    }
+
+    LOG_I("Registered %d appliance names for slots", s_appliance_count);
+}
+
+void cmd_cache_get_slots(cmd_slot_values_t* slots) {
+    if (slots) {
+        memcpy(slots, &s_slots, sizeof(cmd_slot_values_t));
+    }
+}
+
 int cmd_cache_get_count(void) {
     return s_cache_count;
 }
@@ -341,9 +1096,12 @@ void cmd_cache_dump(void) {
     LOG_I("=== Command Cache Dump ===");
     LOG_I("Total entries: %d", s_cache_count);
     LOG_I("Fuzzy threshold: %d", s_fuzzy_threshold);
+    LOG_I("Index: %u/%u code points, %u/%u postings",
+          (unsigned)s_norm_used, (unsigned)CMD_INDEX_POOL_CP,
+          (unsigned)s_post_used, (unsigned)CMD_INDEX_POSTINGS);
 
     for (int i = 0; i < s_cache_count; i++) {
-        LOG_I("[%d] %s: '%s' -> '%s' (cat:%d, act:%d, %s)",
+        LOG_D("[%d] %s: '%s' -> '%s' (cat:%d, act:%d, %s)",
               i,
               s_cache[i].enabled ? "ON " : "OFF",
               s_cache[i].pattern,
@@ -358,6 +1116,16 @@ void cmd_cache_dump(void) {
           (unsigned long)s_stats.total_queries,
           (unsigned long)s_stats.cache_hits,
           (unsigned long)s_stats.cache_misses);
+    LOG_I("Candidates scored: %lu (%.1f per query)",
+          (unsigned long)s_stats.candidates_scored,
+          (s_stats.total_queries > 0)
+              ? (float)s_stats.candidates_scored / s_stats.total_queries
+              : 0.0f);
+    for (int t = 0; t < CMD_SLOT_COUNT; t++) {
+        LOG_I("Slot {%s}: %lu hits, %lu misses", SLOT_NAMES[t],
+              (unsigned long)s_stats.slot_hits[t],
+              (unsigned long)s_stats.slot_misses[t]);
+    }
 
     float hit_rate = (s_stats.total_queries > 0)
         ? (float)s_stats.cache_hits * 100.0f / s_stats.total_queries
@@ -10,6 +10,26 @@
  *   User Input → Pattern Match → [Hit] → Execute + Respond (local)
  *                              → [Miss] → Forward to LLM
  *
+ * Matching:
+ *   - Patterns and input are normalized to code points (katakana /
+ *     half-width kana → hiragana, full-width ASCII → lower-case ASCII,
+ *     spaces and punctuation dropped)
+ *   - A padded bigram index built by cmd_cache_init() / cmd_cache_add()
+ *     picks candidate entries; only those are scored
+ *   - Scoring: exact / containment, else a banded two-row edit distance
+ *     over code points, limited by the fuzzy threshold
+ *
+ * Slots:
+ *   Patterns may contain typed placeholders, e.g. "温度を{num}度にして":
+ *     {num}        整数       「25」「２５」「二十五」
+ *     {pct}        パーセント 「30%」「三十パーセント」「3割」
+ *     {dur}        秒数       「5分」「1時間半」「90秒」
+ *     {appliance}  機器名     cmd_cache_set_appliances() で登録した名前
+ *   The input is tokenized into slot values; slot patterns are matched
+ *   against the tokenized input, all other patterns against the plain
+ *   input, so words like "一時停止" still match literally. Responses may
+ *   use the same placeholders.
+ *
  * @author Omni-P4 Project
  * @date 2024
  */
@@ -20,6 +40,10 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#ifdef ESP_PLATFORM
+#include "sdkconfig.h"
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -36,8 +60,33 @@ extern "C" {
 
 /**
  * @brief Maximum number of cached commands
+ *
+ * The entry table and the bigram index are static .bss sized by this
+ * (about 470 bytes per entry); CONFIG_CMD_CACHE_MAX_ENTRIES overrides it.
  */
+#ifdef CONFIG_CMD_CACHE_MAX_ENTRIES
+#define CMD_CACHE_MAX_ENTRIES   CONFIG_CMD_CACHE_MAX_ENTRIES
+#else
 #define CMD_CACHE_MAX_ENTRIES   64
+#endif
+
+/**
+ * @brief Average normalized code points per pattern reserved in the index
+ *
+ * The index pool holds CMD_CACHE_MAX_ENTRIES * 2 * this many code points;
+ * cmd_cache_add() fails once it is full.
+ */
+#define CMD_INDEX_AVG_PATTERN_CP    12
+
+/**
+ * @brief Maximum number of appliance names for {appliance} slots
+ */
+#define CMD_APPLIANCE_MAX           16
+
+/**
+ * @brief Maximum length of an appliance name
+ */
+#define CMD_APPLIANCE_NAME_MAX_LEN  32
 
 /**
  * @brief Fuzzy match threshold (0-100, higher = stricter)
@@ -58,6 +107,17 @@ typedef enum {
     CMD_CAT_COUNT
 } cmd_category_t;
 
+/**
+ * @brief Slot type (placeholder in a pattern)
+ */
+typedef enum {
+    CMD_SLOT_NUMBER = 0,     // {num}: 整数
+    CMD_SLOT_PERCENT,        // {pct}: パーセント
+    CMD_SLOT_DURATION,       // {dur}: 秒数
+    CMD_SLOT_APPLIANCE,      // {appliance}: 機器インデックス
+    CMD_SLOT_COUNT
+} cmd_slot_type_t;
+
 /**
  * @brief Action type for command execution
  */
@@ -86,11 +146,21 @@ typedef enum {
     CMD_ACTION_TIMER_CANCEL,
     CMD_ACTION_SYSTEM_STATUS,
     CMD_ACTION_CUSTOM,
+    // Slot actions; appended so the values above stay stable
+    CMD_ACTION_LIGHT_SET,
+    CMD_ACTION_AC_SET_TEMP,
+    CMD_ACTION_VOLUME_SET,
+    CMD_ACTION_APPLIANCE_ON,
+    CMD_ACTION_APPLIANCE_OFF,
     CMD_ACTION_COUNT
 } cmd_action_t;
 
 /**
  * @brief Command callback function type
+ *
+ * For slot patterns, param is the first filled numeric slot (number,
+ * percent, seconds) or the appliance index; see cmd_cache_get_slots().
+ *
  * @param param Optional parameter (e.g., brightness level, temperature)
  * @param response Buffer to write dynamic response
  * @param response_len Maximum response buffer length
@@ -112,6 +182,15 @@ typedef struct {
     bool enabled;                                // 有効/無効フラグ
 } cmd_cache_entry_t;
 
+/**
+ * @brief Slot values extracted from one input
+ */
+typedef struct {
+    uint8_t filled;                             // 抽出済みスロット (1 << cmd_slot_type_t)
+    int value[CMD_SLOT_COUNT];                  // 数値 / % / 秒 / 機器インデックス
+    char appliance[CMD_APPLIANCE_NAME_MAX_LEN]; // 機器名 (CMD_SLOT_APPLIANCE)
+} cmd_slot_values_t;
+
 /**
  * @brief Command match result
  */
@@ -119,7 +198,8 @@ typedef struct {
     bool matched;                               // パターンマッチ成功
     int entry_index;                            // マッチしたエントリのインデックス
     int match_score;                            // マッチスコア (0-100)
-    int extracted_param;                        // 抽出されたパラメータ
+    int extracted_param;                        // 抽出されたパラメータ (スロット or default_param)
+    cmd_slot_values_t slots;                    // 入力から抽出したスロット値
     char response[CMD_RESPONSE_MAX_LEN];        // 生成された応答文
 } cmd_match_result_t;
 
@@ -133,6 +213,9 @@ typedef struct {
     uint32_t action_successes;                  // アクション成功数
     uint32_t action_failures;                   // アクション失敗数
     uint32_t category_hits[CMD_CAT_COUNT];      // カテゴリ別ヒット数
+    uint32_t candidates_scored;                 // インデックスで絞り込んだ候補のスコア計算数
+    uint32_t slot_hits[CMD_SLOT_COUNT];         // スロット付きパターンでのヒット数
+    uint32_t slot_misses[CMD_SLOT_COUNT];       // スロット値を含むがミスした入力数
 } cmd_cache_stats_t;
 
 /**
@@ -209,6 +292,27 @@ void cmd_cache_register_callback(cmd_action_t action, cmd_action_callback_t call
  */
 void cmd_cache_set_threshold(int threshold);
 
+/**
+ * @brief Set the appliance names recognized by {appliance} slots
+ *
+ * Typically fed from remo_client_get_appliances(). Names are copied and
+ * matched normalized (case, width and kana folded); the slot value is the
+ * index into this list. Call it from the same task that queries the cache.
+ *
+ * @param names Appliance names
+ * @param count Number of names (truncated at CMD_APPLIANCE_MAX)
+ */
+void cmd_cache_set_appliances(const char* const* names, int count);
+
+/**
+ * @brief Get slot values of the most recent cmd_cache_process() input
+ *
+ * Valid inside action callbacks, which run before the result is returned.
+ *
+ * @param slots Pointer to slot structure
+ */
+void cmd_cache_get_slots(cmd_slot_values_t* slots);
+
 /**
  * @brief Get number of cached commands
  * @return Number of entries
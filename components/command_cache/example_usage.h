@@ -119,6 +119,19 @@ static void setup_command_cache(void) {
     };
     cmd_cache_add(&custom);
 
+    // Optional: Slot pattern (param = extracted value, e.g. "寝室は18度で" → 18)
+    cmd_cache_entry_t bedroom_ac = {
+        .pattern = "寝室は{num}度で",
+        .pattern_alt = "寝室のエアコンを{num}度に",
+        .response = "寝室のエアコンを{num}度に設定します",
+        .category = CMD_CAT_CLIMATE,
+        .action = CMD_ACTION_AC_SET_TEMP,
+        .default_param = 26,
+        .callback = NULL,
+        .enabled = true
+    };
+    cmd_cache_add(&bedroom_ac);
+
     printf("Command cache setup complete. %d commands registered.\n",
            cmd_cache_get_count());
 }
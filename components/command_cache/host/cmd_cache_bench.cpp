@@ -0,0 +1,284 @@
+/**
+ * @file cmd_cache_bench.cpp
+ * @brief Host benchmark for cmd_cache_process() with a few hundred entries
+ *
+ * Fills the cache with generated room × device commands on top of the
+ * defaults, then replays exact, kana/width-variant, filler, typo and
+ * out-of-domain queries, or the utterances of one or more corpus files.
+ * Reports per-query latency percentiles, hit rate and candidates scored
+ * by the index, next to the previous byte-wise linear Levenshtein scan.
+ *
+ * Corpus format (UTF-8 TSV, '#' comments; expectation optional):
+ *   電気つけて<TAB>hit
+ *   明日の天気は<TAB>miss
+ *
+ * Build with tools/host_bench (CMake), then:
+ *   ./cmd_cache_bench [-v] [-r rounds] [utterances.tsv ...]
+ *
+ * -v shows the cache's INFO log (init, dump); by default only warnings.
+ */
+
+#include "command_cache.h"
+#include "bench_stats.h"
+#include "esp_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+static const char* ROOMS[] = {
+    "リビング", "寝室", "キッチン", "書斎", "子供部屋", "玄関",
+    "浴室", "廊下", "和室", "洗面所", "ガレージ",
+};
+
+static const char* DEVICES[] = {
+    "照明", "エアコン", "テレビ", "扇風機", "加湿器",
+    "カーテン", "換気扇", "スピーカー", "ヒーター", "空気清浄機",
+};
+
+static const char* OUT_OF_DOMAIN[] = {
+    "明日の天気はどうですか", "今日のニュースを教えて", "近くのラーメン屋",
+    "英語で猫は何と言う", "ジャンケンしよう", "面白い話をして",
+    "東京の人口は", "明日の予定は何", "宿題手伝って", "三たす五は",
+};
+
+static std::string room_device(size_t r, size_t d, const char* action) {
+    return std::string(ROOMS[r]) + "の" + DEVICES[d] + action;
+}
+
+// ============================================================================
+// Previous matcher (byte-wise strstr + 64x64 Levenshtein per pattern)
+// ============================================================================
+
+static int legacy_levenshtein(const char* s1, const char* s2) {
+    int len1 = strlen(s1);
+    int len2 = strlen(s2);
+    if (len1 == 0) return len2;
+    if (len2 == 0) return len1;
+
+    int matrix[64][64];
+    if (len1 > 63 || len2 > 63) {
+        return (strcmp(s1, s2) == 0) ? 0 : (len1 + len2) / 2;
+    }
+    for (int i = 0; i <= len1; i++) matrix[i][0] = i;
+    for (int j = 0; j <= len2; j++) matrix[0][j] = j;
+    for (int i = 1; i <= len1; i++) {
+        for (int j = 1; j <= len2; j++) {
+            int cost = (s1[i-1] == s2[j-1]) ? 0 : 1;
+            int v = matrix[i-1][j] + 1;
+            if (matrix[i][j-1] + 1 < v) v = matrix[i][j-1] + 1;
+            if (matrix[i-1][j-1] + cost < v) v = matrix[i-1][j-1] + cost;
+            matrix[i][j] = v;
+        }
+    }
+    return matrix[len1][len2];
+}
+
+static int legacy_similarity(const char* input, const char* pattern) {
+    if (strcmp(input, pattern) == 0) return 100;
+    if (strstr(input, pattern) != NULL) return 95;
+    if (strstr(pattern, input) != NULL) return 90;
+    int max_len = strlen(input);
+    if ((int)strlen(pattern) > max_len) max_len = strlen(pattern);
+    if (max_len == 0) return 0;
+    int similarity = 100 - (legacy_levenshtein(input, pattern) * 100 / max_len);
+    return similarity < 0 ? 0 : similarity;
+}
+
+static bool legacy_process(const std::vector<cmd_cache_entry_t>& entries, const char* input) {
+    int best = 0;
+    for (const cmd_cache_entry_t& e : entries) {
+        int s1 = legacy_similarity(input, e.pattern);
+        int s2 = legacy_similarity(input, e.pattern_alt);
+        int s = (s1 > s2) ? s1 : s2;
+        if (s > best) best = s;
+    }
+    return best >= CMD_FUZZY_THRESHOLD;
+}
+
+// ============================================================================
+// Benchmark
+// ============================================================================
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+static double elapsed_us(bench_clock_t::time_point start, size_t ops) {
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(bench_clock_t::now() - start).count();
+    return (double)ns / 1000.0 / (double)ops;
+}
+
+static std::vector<cmd_cache_entry_t> generate_entries(void) {
+    std::vector<cmd_cache_entry_t> entries;
+
+    // "<部屋>の<機器>つけて" / "<部屋><機器>オン" (and off)
+    for (size_t r = 0; r < sizeof(ROOMS) / sizeof(ROOMS[0]); r++) {
+        for (size_t d = 0; d < sizeof(DEVICES) / sizeof(DEVICES[0]); d++) {
+            for (int on = 1; on >= 0; on--) {
+                cmd_cache_entry_t e = {};
+                snprintf(e.pattern, sizeof(e.pattern), "%s", room_device(r, d, on ? "つけて" : "消して").c_str());
+                snprintf(e.pattern_alt, sizeof(e.pattern_alt), "%s%s%s", ROOMS[r], DEVICES[d], on ? "オン" : "オフ");
+                snprintf(e.response, sizeof(e.response), "%sの%sを%sます", ROOMS[r], DEVICES[d], on ? "つけ" : "消し");
+                e.category = CMD_CAT_CUSTOM;
+                e.action = CMD_ACTION_CUSTOM;
+                e.enabled = true;
+                entries.push_back(e);
+            }
+        }
+    }
+    return entries;
+}
+
+// ============================================================================
+// Query Corpus
+// ============================================================================
+
+enum expect_t { EXPECT_ANY, EXPECT_HIT, EXPECT_MISS };
+
+struct query_t {
+    std::string text;
+    expect_t expect;
+};
+
+static void generated_queries(std::vector<query_t>& queries) {
+    for (size_t r = 0; r < sizeof(ROOMS) / sizeof(ROOMS[0]); r += 2) {
+        for (size_t d = 0; d < sizeof(DEVICES) / sizeof(DEVICES[0]); d += 3) {
+            queries.push_back({room_device(r, d, "つけて"), EXPECT_HIT});                    // exact
+            queries.push_back({"ねえ、" + room_device(r, d, "消して") + "！", EXPECT_HIT});   // filler + punctuation
+            queries.push_back({room_device(r, d, "付けて"), EXPECT_HIT});                    // one-kanji typo
+        }
+    }
+    const char* variants[] = {
+        "ﾗｲﾄｵﾝ", "らいとおふ", "エアコン　つけて", "ＣＯ２は", "おやすみ",
+        "音量あげて", "タイマーセットして", "ミュートにして",
+    };
+    for (const char* v : variants) queries.push_back({v, EXPECT_HIT});
+    for (const char* q : OUT_OF_DOMAIN) queries.push_back({q, EXPECT_MISS});
+}
+
+static bool load_corpus(const char* path, std::vector<query_t>& queries) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    char line[512];
+    size_t before = queries.size();
+    while (fgets(line, sizeof(line), f)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '\0' || line[0] == '#') continue;
+
+        expect_t expect = EXPECT_ANY;
+        char* tab = strchr(line, '\t');
+        if (tab) {
+            *tab = '\0';
+            if (strcmp(tab + 1, "hit") == 0) expect = EXPECT_HIT;
+            else if (strcmp(tab + 1, "miss") == 0) expect = EXPECT_MISS;
+        }
+        if (line[0]) queries.push_back({line, expect});
+    }
+    fclose(f);
+
+    printf("Corpus %s: %zu utterances\n", path, queries.size() - before);
+    return true;
+}
+
+// ============================================================================
+// Main
+// ============================================================================
+
+int main(int argc, char** argv) {
+    int rounds = 200;
+    int first_file = 1;
+    for (; first_file < argc && argv[first_file][0] == '-'; first_file++) {
+        if (strcmp(argv[first_file], "-v") == 0) {
+            idf_shim_log_level = ESP_LOG_INFO;
+        } else if (strcmp(argv[first_file], "-r") == 0 && first_file + 1 < argc) {
+            rounds = atoi(argv[++first_file]);
+            if (rounds < 1) rounds = 1;
+        } else {
+            fprintf(stderr, "usage: %s [-v] [-r rounds] [utterances.tsv ...]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    cmd_cache_init();
+    int defaults = cmd_cache_get_count();
+
+    std::vector<cmd_cache_entry_t> generated = generate_entries();
+    std::vector<cmd_cache_entry_t> added;
+    for (const cmd_cache_entry_t& e : generated) {
+        if (cmd_cache_add(&e) < 0) break;
+        added.push_back(e);
+    }
+
+    int total = cmd_cache_get_count();
+    printf("\nEntries: %d (%d default + %d generated)\n", total, defaults, total - defaults);
+
+    std::vector<query_t> queries;
+    if (first_file == argc) {
+        generated_queries(queries);
+    }
+    for (int i = first_file; i < argc; i++) {
+        if (!load_corpus(argv[i], queries)) return 1;
+    }
+    if (queries.empty()) {
+        fprintf(stderr, "No queries\n");
+        return 1;
+    }
+
+    // Outcome against the expectations
+    int labelled = 0, correct = 0;
+    cmd_match_result_t result;
+    for (const query_t& q : queries) {
+        bool hit = cmd_cache_process(q.text.c_str(), &result);
+        if (q.expect == EXPECT_ANY) continue;
+        labelled++;
+        if (hit == (q.expect == EXPECT_HIT)) {
+            correct++;
+        } else {
+            printf("  unexpected %s: '%s'\n", hit ? "hit" : "miss", q.text.c_str());
+        }
+    }
+    printf("Queries: %zu, expected outcome: %d/%d labelled\n", queries.size(), correct, labelled);
+
+    // Timing
+    const int legacy_rounds = rounds / 10 ? rounds / 10 : 1;
+    cmd_cache_reset_stats();
+
+    bench_stats_t lat;
+    bench_stats_init(&lat);
+    for (int r = 0; r < rounds; r++) {
+        for (const query_t& q : queries) {
+            uint64_t t0 = bench_now_ns();
+            cmd_cache_process(q.text.c_str(), &result);
+            bench_stats_add(&lat, bench_now_ns() - t0);
+        }
+    }
+    double indexed_us = (double)lat.total / 1000.0 / (double)lat.count;
+
+    cmd_cache_stats_t stats;
+    cmd_cache_get_stats(&stats);
+
+    int legacy_hits = 0;
+    auto start = bench_clock_t::now();
+    for (int r = 0; r < legacy_rounds; r++) {
+        for (const query_t& q : queries) legacy_hits += legacy_process(added, q.text.c_str());
+    }
+    double legacy_us = elapsed_us(start, (size_t)legacy_rounds * queries.size());
+
+    printf("Indexed: %.1f candidates scored/query, hit rate %.1f%%\n",
+           (double)stats.candidates_scored / stats.total_queries,
+           100.0 * stats.cache_hits / stats.total_queries);
+    bench_stats_print(&lat, "cmd_cache_process");
+    printf("Previous scan (generated entries only): %.2f us/query, hit rate %.1f%%\n",
+           legacy_us, 100.0 * legacy_hits / (legacy_rounds * queries.size()));
+    printf("Speedup: %.1fx\n", legacy_us / indexed_us);
+    bench_stats_free(&lat);
+
+    cmd_cache_dump();
+    cmd_cache_deinit();
+    return 0;
+}
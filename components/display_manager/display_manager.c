@@ -10,14 +10,20 @@
 #include "freertos/task.h"
 #include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_check.h"
+#include "esp_attr.h"
 #include "esp_lcd_panel_ops.h"
+#include "esp_lcd_panel_io.h"
 #include "esp_lcd_mipi_dsi.h"
 #include "esp_ldo_regulator.h"
 #include "driver/gpio.h"
+#include "driver/ppa.h"
 #include "driver/ledc.h"
 #include "lvgl.h"
 #include "sdkconfig.h"
 #include "ui/ui_app.h"
+#include "ui_bus.h"
+#include "mem_arena.h"
 
 static const char *TAG = "display_mgr";
 
@@ -26,20 +32,68 @@ static const char *TAG = "display_mgr";
 // ============================================================================
 
 #define LVGL_TICK_PERIOD_MS     2
-#define LVGL_BUFFER_LINES       50
+#define LVGL_FLUSH_TIMEOUT_MS   100     // Several frames; only a stalled DMA hits it
+
+// Physical panel (the UI size DISPLAY_WIDTH x DISPLAY_HEIGHT may be rotated)
+#define PANEL_H_RES             CONFIG_DISPLAY_H_RES
+#define PANEL_V_RES             CONFIG_DISPLAY_V_RES
+#define PANEL_BPP               2       // RGB565
+
+#if CONFIG_DISPLAY_RENDER_DIRECT
+#define PANEL_NUM_FBS           2
+#else
+#define PANEL_NUM_FBS           1
+#define LVGL_BUFFER_LINES       CONFIG_DISPLAY_BUFFER_LINES
+#if CONFIG_DISPLAY_ROTATION % 90 != 0
+#error "CONFIG_DISPLAY_ROTATION must be 0, 90, 180 or 270"
+#endif
+#endif
+
+// Pixel clock for CONFIG_DISPLAY_REFRESH_HZ over the whole timing frame
+#define PANEL_H_TOTAL           (PANEL_H_RES + CONFIG_DISPLAY_HSYNC_PULSE + \
+                                 CONFIG_DISPLAY_HSYNC_BACK_PORCH + CONFIG_DISPLAY_HSYNC_FRONT_PORCH)
+#define PANEL_V_TOTAL           (PANEL_V_RES + CONFIG_DISPLAY_VSYNC_PULSE + \
+                                 CONFIG_DISPLAY_VSYNC_BACK_PORCH + CONFIG_DISPLAY_VSYNC_FRONT_PORCH)
+#define UI_SPECTRUM_BANDS       16
+#define UI_WAVEFORM_POINTS      128     // Chart points per waveform update
+
+#define PANEL_DPI_CLOCK_MHZ     ((PANEL_H_TOTAL * PANEL_V_TOTAL * CONFIG_DISPLAY_REFRESH_HZ + 999999) / 1000000)
 
 // ============================================================================
 // Internal State
 // ============================================================================
 
+// UI bus values (plain data, converted on the producer side)
+typedef struct {
+    uint8_t count;
+    uint8_t value[UI_SPECTRUM_BANDS];   // Bar value 5-100
+} ui_spectrum_t;
+
+typedef struct {
+    uint16_t count;
+    int16_t samples[UI_WAVEFORM_POINTS];
+} ui_waveform_t;
+
 typedef struct {
     // Display handles
     esp_lcd_panel_handle_t panel;
+    esp_lcd_panel_io_handle_t dbi_io;   // DCS commands
     esp_lcd_dsi_bus_handle_t dsi_bus;
+    esp_ldo_channel_handle_t phy_ldo;
+    void *fbs[PANEL_NUM_FBS];           // DPI frame buffers (PSRAM, driver-owned)
+#if CONFIG_DISPLAY_RENDER_PARTIAL && CONFIG_DISPLAY_ROTATION != 0
+    ppa_client_handle_t ppa_srm;        // Rotating blit into the frame buffer
+#endif
 
     // LVGL
     lv_display_t *display;
     SemaphoreHandle_t lvgl_mutex;
+    SemaphoreHandle_t flush_done;       // Given by the DMA-done / vsync ISR
+#if CONFIG_DISPLAY_RENDER_DIRECT
+    volatile bool swap_pending;         // Waiting for the vsync after a swap
+    int dirty_y1, dirty_y2;             // Lines drawn this refresh
+    int prev_y1, prev_y2;               // ... and last refresh (LVGL syncs them)
+#endif
 
     // Screens
     lv_obj_t *screens[SCREEN_COUNT];
@@ -73,6 +127,15 @@ typedef struct {
     lv_obj_t *notification_popup;
     lv_timer_t *notification_timer;
 
+    // Newest reading, for legacy screens built after it arrived
+    sensor_data_t last_sensors;
+    bool have_sensors;
+
+    // UI bus: producers post, display_manager_timer_handler() applies
+    ui_bus_slot_t bus_sensors;
+    ui_bus_slot_t bus_spectrum;
+    ui_bus_slot_t bus_waveform;
+
     // State
     uint8_t brightness;
     bool power_on;
@@ -82,6 +145,10 @@ typedef struct {
 
 static display_state_t s_disp = {0};
 
+static sensor_data_t s_bus_sensors[3];
+static ui_spectrum_t s_bus_spectrum[3];
+static ui_waveform_t s_bus_waveform[3];
+
 // ============================================================================
 // LVGL Tick Timer Callback
 // ============================================================================
@@ -92,23 +159,150 @@ static void lvgl_tick_cb(void *arg)
 }
 
 // ============================================================================
-// LVGL Flush Callback
+// LVGL Flush (completed asynchronously from the DMA/vsync ISR)
 // ============================================================================
+//
+// Direct:  LVGL draws into the back frame buffer; the last area of a refresh
+//          makes it the scan-out buffer (no copy), and the next end-of-frame
+//          interrupt, when the DMA has picked it up, releases the old one.
+// Partial: each strip is copied into the frame buffer by DMA2D (or rotated
+//          by the PPA) while LVGL renders the next strip into the other
+//          buffer; the copy-done interrupt releases the strip.
+//
+// LVGL blocks in lvgl_flush_wait_cb() instead of spinning on the flag.
+
+static IRAM_ATTR bool flush_done_from_isr(void)
+{
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(s_disp.flush_done, &woken);
+    return woken == pdTRUE;
+}
+
+#if CONFIG_DISPLAY_RENDER_DIRECT
+static IRAM_ATTR bool on_refresh_done(esp_lcd_panel_handle_t panel,
+                                      esp_lcd_dpi_panel_event_data_t *edata, void *user_ctx)
+{
+    if (!s_disp.swap_pending) return false;
+    s_disp.swap_pending = false;
+    return flush_done_from_isr();
+}
+#else
+static IRAM_ATTR bool on_color_trans_done(esp_lcd_panel_handle_t panel,
+                                          esp_lcd_dpi_panel_event_data_t *edata, void *user_ctx)
+{
+    return flush_done_from_isr();
+}
+
+#if CONFIG_DISPLAY_ROTATION != 0
+static IRAM_ATTR bool on_ppa_done(ppa_client_handle_t client, ppa_event_data_t *event, void *user_ctx)
+{
+    return flush_done_from_isr();
+}
+
+/**
+ * @brief Rotate one strip into the frame buffer (non-blocking)
+ */
+static esp_err_t rotate_strip(const lv_area_t *area, const uint8_t *px_map)
+{
+    int w = lv_area_get_width(area);
+    int h = lv_area_get_height(area);
+    int x, y;
+
+    // Top-left of the strip on the panel, clockwise rotation
+#if CONFIG_DISPLAY_ROTATION == 90
+    x = PANEL_H_RES - 1 - area->y2;
+    y = area->x1;
+    const ppa_srm_rotation_angle_t angle = PPA_SRM_ROTATION_ANGLE_270;  // PPA turns counter-clockwise
+#elif CONFIG_DISPLAY_ROTATION == 180
+    x = PANEL_H_RES - 1 - area->x2;
+    y = PANEL_V_RES - 1 - area->y2;
+    const ppa_srm_rotation_angle_t angle = PPA_SRM_ROTATION_ANGLE_180;
+#else
+    x = area->y1;
+    y = PANEL_V_RES - 1 - area->x2;
+    const ppa_srm_rotation_angle_t angle = PPA_SRM_ROTATION_ANGLE_90;
+#endif
+
+    ppa_srm_oper_config_t srm = {
+        .in = {
+            .buffer = px_map,
+            .pic_w = w,
+            .pic_h = h,
+            .block_w = w,
+            .block_h = h,
+            .srm_cm = PPA_SRM_COLOR_MODE_RGB565,
+        },
+        .out = {
+            .buffer = s_disp.fbs[0],
+            .buffer_size = PANEL_H_RES * PANEL_V_RES * PANEL_BPP,
+            .pic_w = PANEL_H_RES,
+            .pic_h = PANEL_V_RES,
+            .block_offset_x = x,
+            .block_offset_y = y,
+            .srm_cm = PPA_SRM_COLOR_MODE_RGB565,
+        },
+        .rotation_angle = angle,
+        .scale_x = 1.0f,
+        .scale_y = 1.0f,
+        .mode = PPA_TRANS_MODE_NON_BLOCKING,
+    };
+    return ppa_do_scale_rotate_mirror(s_disp.ppa_srm, &srm);
+}
+#endif
+#endif
 
 static void lvgl_flush_cb(lv_display_t *disp, const lv_area_t *area, uint8_t *px_map)
 {
-    esp_lcd_panel_handle_t panel = lv_display_get_user_data(disp);
+    esp_err_t ret;
 
-    int x_start = area->x1;
-    int y_start = area->y1;
-    int x_end = area->x2 + 1;
-    int y_end = area->y2 + 1;
+#if CONFIG_DISPLAY_RENDER_DIRECT
+    if (area->y1 < s_disp.dirty_y1) s_disp.dirty_y1 = area->y1;
+    if (area->y2 + 1 > s_disp.dirty_y2) s_disp.dirty_y2 = area->y2 + 1;
 
-    esp_lcd_panel_draw_bitmap(panel, x_start, y_start, x_end, y_end, px_map);
+    // px_map is the whole back buffer, complete only after the last area
+    if (!lv_display_flush_is_last(disp)) {
+        lv_display_flush_ready(disp);
+        return;
+    }
 
+    // Write back the lines drawn now and those LVGL copied over from the
+    // previous frame, then swap (the driver only switches buffers)
+    int y1 = (s_disp.prev_y1 < s_disp.dirty_y1) ? s_disp.prev_y1 : s_disp.dirty_y1;
+    int y2 = (s_disp.prev_y2 > s_disp.dirty_y2) ? s_disp.prev_y2 : s_disp.dirty_y2;
+    s_disp.prev_y1 = s_disp.dirty_y1;
+    s_disp.prev_y2 = s_disp.dirty_y2;
+    s_disp.dirty_y1 = PANEL_V_RES;
+    s_disp.dirty_y2 = 0;
+
+    ret = esp_lcd_panel_draw_bitmap(s_disp.panel, 0, y1, PANEL_H_RES, y2, px_map);
+    if (ret == ESP_OK) {
+        // Armed after the switch: an end-of-frame in between only costs a frame
+        s_disp.swap_pending = true;
+        return;
+    }
+#elif CONFIG_DISPLAY_ROTATION != 0
+    ret = rotate_strip(area, px_map);
+    if (ret == ESP_OK) return;
+#else
+    ret = esp_lcd_panel_draw_bitmap(s_disp.panel, area->x1, area->y1,
+                                    area->x2 + 1, area->y2 + 1, px_map);
+    if (ret == ESP_OK) return;
+#endif
+
+    ESP_LOGW(TAG, "Flush failed: %s", esp_err_to_name(ret));
     lv_display_flush_ready(disp);
 }
 
+static void lvgl_flush_wait_cb(lv_display_t *disp)
+{
+    if (xSemaphoreTake(s_disp.flush_done, pdMS_TO_TICKS(LVGL_FLUSH_TIMEOUT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "Flush completion timed out");
+#if CONFIG_DISPLAY_RENDER_DIRECT
+        s_disp.swap_pending = false;
+#endif
+    }
+}
+
 // ============================================================================
 // UI Creation
 // ============================================================================
@@ -309,6 +503,30 @@ static void create_notification_popup(void)
     lv_obj_add_flag(s_disp.notification_popup, LV_OBJ_FLAG_HIDDEN);
 }
 
+static void apply_sensors(const sensor_data_t *data);
+
+/**
+ * @brief Build a legacy screen on first use (LVGL lock held)
+ *
+ * The TileView UI is what boots; these screens cost nothing until
+ * something switches to or updates them.
+ */
+static bool ensure_screen(screen_type_t screen)
+{
+    if (s_disp.screens[screen]) return true;
+
+    switch (screen) {
+    case SCREEN_HOME:    create_home_screen();   break;
+    case SCREEN_SENSORS: create_sensor_screen(); break;
+    case SCREEN_MUSIC:   create_music_screen();  break;
+    default:             return false;
+    }
+
+    // Start from the newest reading, not placeholders
+    if (s_disp.have_sensors) apply_sensors(&s_disp.last_sensors);
+    return true;
+}
+
 // ============================================================================
 // Backlight Control
 // ============================================================================
@@ -342,6 +560,233 @@ static void init_backlight(void)
 #endif
 }
 
+// ============================================================================
+// MIPI-DSI Panel
+// ============================================================================
+
+/**
+ * @brief Bring up the DSI bus and the DPI panel with its frame buffers
+ *
+ * Sends only the standard DCS sleep-out / display-on; panels that need a
+ * vendor register sequence get it here, after the DBI IO is created.
+ */
+static esp_err_t init_dsi_panel(void)
+{
+    esp_err_t ret;
+
+#if CONFIG_DISPLAY_DSI_PHY_LDO_CHAN >= 0
+    esp_ldo_channel_config_t ldo_cfg = {
+        .chan_id = CONFIG_DISPLAY_DSI_PHY_LDO_CHAN,
+        .voltage_mv = CONFIG_DISPLAY_DSI_PHY_LDO_MV,
+    };
+    ESP_RETURN_ON_ERROR(esp_ldo_acquire_channel(&ldo_cfg, &s_disp.phy_ldo), TAG, "DSI PHY LDO");
+#endif
+
+    esp_lcd_dsi_bus_config_t bus_cfg = {
+        .bus_id = 0,
+        .num_data_lanes = CONFIG_DISPLAY_DSI_LANES,
+        .phy_clk_src = MIPI_DSI_PHY_CLK_SRC_DEFAULT,
+        .lane_bit_rate_mbps = CONFIG_DISPLAY_DSI_LANE_MBPS,
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_new_dsi_bus(&bus_cfg, &s_disp.dsi_bus), TAG, "DSI bus");
+
+    esp_lcd_dbi_io_config_t dbi_cfg = {
+        .virtual_channel = 0,
+        .lcd_cmd_bits = 8,
+        .lcd_param_bits = 8,
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_io_dbi(s_disp.dsi_bus, &dbi_cfg, &s_disp.dbi_io), TAG, "DBI IO");
+
+    // Standard DCS wake-up (exit sleep needs 120ms before display on)
+    ret = esp_lcd_panel_io_tx_param(s_disp.dbi_io, 0x11, NULL, 0);
+    vTaskDelay(pdMS_TO_TICKS(120));
+    if (ret == ESP_OK) ret = esp_lcd_panel_io_tx_param(s_disp.dbi_io, 0x29, NULL, 0);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "DCS wake-up failed (%s), panel may need a vendor init", esp_err_to_name(ret));
+    }
+
+    esp_lcd_dpi_panel_config_t dpi_cfg = {
+        .virtual_channel = 0,
+        .dpi_clk_src = MIPI_DSI_DPI_CLK_SRC_DEFAULT,
+        .dpi_clock_freq_mhz = PANEL_DPI_CLOCK_MHZ,
+        .pixel_format = LCD_COLOR_PIXEL_FORMAT_RGB565,
+        .num_fbs = PANEL_NUM_FBS,
+        .video_timing = {
+            .h_size = PANEL_H_RES,
+            .v_size = PANEL_V_RES,
+            .hsync_pulse_width = CONFIG_DISPLAY_HSYNC_PULSE,
+            .hsync_back_porch = CONFIG_DISPLAY_HSYNC_BACK_PORCH,
+            .hsync_front_porch = CONFIG_DISPLAY_HSYNC_FRONT_PORCH,
+            .vsync_pulse_width = CONFIG_DISPLAY_VSYNC_PULSE,
+            .vsync_back_porch = CONFIG_DISPLAY_VSYNC_BACK_PORCH,
+            .vsync_front_porch = CONFIG_DISPLAY_VSYNC_FRONT_PORCH,
+        },
+        .flags.use_dma2d = true,        // Partial-mode strip copies
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_new_panel_dpi(s_disp.dsi_bus, &dpi_cfg, &s_disp.panel), TAG, "DPI panel");
+
+    esp_lcd_dpi_panel_event_callbacks_t cbs = {
+#if CONFIG_DISPLAY_RENDER_DIRECT
+        .on_refresh_done = on_refresh_done,
+#else
+        .on_color_trans_done = on_color_trans_done,
+#endif
+    };
+    ESP_RETURN_ON_ERROR(esp_lcd_dpi_panel_register_event_callbacks(s_disp.panel, &cbs, NULL),
+                        TAG, "DPI callbacks");
+
+    ESP_RETURN_ON_ERROR(esp_lcd_panel_init(s_disp.panel), TAG, "DPI init");
+
+#if PANEL_NUM_FBS == 2
+    ret = esp_lcd_dpi_panel_get_frame_buffer(s_disp.panel, 2, &s_disp.fbs[0], &s_disp.fbs[1]);
+#else
+    ret = esp_lcd_dpi_panel_get_frame_buffer(s_disp.panel, 1, &s_disp.fbs[0]);
+#endif
+    ESP_RETURN_ON_ERROR(ret, TAG, "Frame buffers");
+
+#if CONFIG_DISPLAY_RENDER_PARTIAL && CONFIG_DISPLAY_ROTATION != 0
+    ppa_client_config_t ppa_cfg = {
+        .oper_type = PPA_OPERATION_SRM,
+        .max_pending_trans_num = 1,     // LVGL has one strip in flight
+    };
+    ESP_RETURN_ON_ERROR(ppa_register_client(&ppa_cfg, &s_disp.ppa_srm), TAG, "PPA client");
+    ppa_event_callbacks_t ppa_cbs = {
+        .on_trans_done = on_ppa_done,
+    };
+    ESP_RETURN_ON_ERROR(ppa_client_register_event_callbacks(s_disp.ppa_srm, &ppa_cbs), TAG, "PPA callbacks");
+#endif
+
+    ESP_LOGI(TAG, "DSI panel %dx%d @ %d MHz, %d lane(s) x %d Mbps, %d frame buffer(s)",
+             PANEL_H_RES, PANEL_V_RES, PANEL_DPI_CLOCK_MHZ, CONFIG_DISPLAY_DSI_LANES,
+             CONFIG_DISPLAY_DSI_LANE_MBPS, PANEL_NUM_FBS);
+    return ESP_OK;
+}
+
+static void deinit_dsi_panel(void)
+{
+#if CONFIG_DISPLAY_RENDER_PARTIAL && CONFIG_DISPLAY_ROTATION != 0
+    if (s_disp.ppa_srm) ppa_unregister_client(s_disp.ppa_srm);
+    s_disp.ppa_srm = NULL;
+#endif
+    if (s_disp.panel) esp_lcd_panel_del(s_disp.panel);
+    if (s_disp.dbi_io) esp_lcd_panel_io_del(s_disp.dbi_io);
+    if (s_disp.dsi_bus) esp_lcd_del_dsi_bus(s_disp.dsi_bus);
+    if (s_disp.phy_ldo) esp_ldo_release_channel(s_disp.phy_ldo);
+
+    s_disp.panel = NULL;
+    s_disp.dbi_io = NULL;
+    s_disp.dsi_bus = NULL;
+    s_disp.phy_ldo = NULL;
+}
+
+// ============================================================================
+// UI Update Bus (display task side)
+// ============================================================================
+
+/**
+ * @brief Set a label only if its text changes (set_text always invalidates)
+ */
+static void set_label_text(lv_obj_t *label, const char *text)
+{
+    if (strcmp(lv_label_get_text(label), text) != 0) {
+        lv_label_set_text(label, text);
+    }
+}
+
+static void apply_sensors(const sensor_data_t *data)
+{
+    char buf[32];
+
+    // Update home screen
+    if (s_disp.screens[SCREEN_HOME] && data->sht40_valid) {
+        snprintf(buf, sizeof(buf), "%.1f°C", data->temperature);
+        set_label_text(s_disp.lbl_temp, buf);
+        snprintf(buf, sizeof(buf), "%.0f%%", data->humidity);
+        set_label_text(s_disp.lbl_humidity, buf);
+    }
+
+    // Update sensor screen (built lazily)
+    if (!s_disp.screens[SCREEN_SENSORS]) return;
+
+    if (data->sht40_valid) {
+        snprintf(buf, sizeof(buf), "%.1f°C", data->temperature);
+        set_label_text(s_disp.lbl_sensor_temp, buf);
+        snprintf(buf, sizeof(buf), "%.1f%%", data->humidity);
+        set_label_text(s_disp.lbl_sensor_hum, buf);
+    }
+
+    if (data->scd41_valid) {
+        snprintf(buf, sizeof(buf), "%d ppm", data->co2);
+        set_label_text(s_disp.lbl_sensor_co2, buf);
+
+        // Color based on CO2 level
+        lv_color_t color;
+        if (data->co2 < 800) {
+            color = lv_color_hex(0x2ecc71);  // Green
+        } else if (data->co2 < 1000) {
+            color = lv_color_hex(0xf1c40f);  // Yellow
+        } else if (data->co2 < 1500) {
+            color = lv_color_hex(0xe67e22);  // Orange
+        } else {
+            color = lv_color_hex(0xe74c3c);  // Red
+        }
+        if (!lv_color_eq(lv_obj_get_style_text_color(s_disp.lbl_sensor_co2, 0), color)) {
+            lv_obj_set_style_text_color(s_disp.lbl_sensor_co2, color, 0);
+        }
+    }
+
+    if (data->ens160_valid) {
+        snprintf(buf, sizeof(buf), "%d ppb", data->tvoc);
+        set_label_text(s_disp.lbl_sensor_tvoc, buf);
+        set_label_text(s_disp.lbl_sensor_aqi, sensor_hub_aqi_description(data->aqi));
+    }
+
+    if (data->bmp388_valid) {
+        snprintf(buf, sizeof(buf), "%.1f hPa", data->pressure);
+        set_label_text(s_disp.lbl_sensor_pressure, buf);
+    }
+
+    if (data->bh1750_valid) {
+        snprintf(buf, sizeof(buf), "%.0f lux", data->lux);
+        set_label_text(s_disp.lbl_sensor_lux, buf);
+    }
+}
+
+static void apply_spectrum(const ui_spectrum_t *spectrum)
+{
+    if (!s_disp.screens[SCREEN_MUSIC]) return;
+
+    // No animation: values arrive every frame and are already smoothed
+    for (int i = 0; i < spectrum->count; i++) {
+        if (lv_bar_get_value(s_disp.spectrum_bars[i]) != spectrum->value[i]) {
+            lv_bar_set_value(s_disp.spectrum_bars[i], spectrum->value[i], LV_ANIM_OFF);
+        }
+    }
+}
+
+/**
+ * @brief Apply the newest value of every slot that changed since last frame
+ */
+static void apply_pending_updates(void)
+{
+    const sensor_data_t *sensors = ui_bus_slot_take(&s_disp.bus_sensors);
+    if (sensors) {
+        s_disp.last_sensors = *sensors;
+        s_disp.have_sensors = true;
+        apply_sensors(sensors);
+        if (sensors->sht40_valid) {
+            ui_app_update_sensors(sensors->temperature, sensors->humidity,
+                                  sensors->co2, sensors->pressure);
+        }
+    }
+
+    const ui_spectrum_t *spectrum = ui_bus_slot_take(&s_disp.bus_spectrum);
+    if (spectrum) apply_spectrum(spectrum);
+
+    const ui_waveform_t *waveform = ui_bus_slot_take(&s_disp.bus_waveform);
+    if (waveform) ui_app_update_waveform(waveform->samples, waveform->count);
+}
+
 // ============================================================================
 // Public API Implementation
 // ============================================================================
@@ -357,10 +802,21 @@ esp_err_t display_manager_init(void)
 
     // Create LVGL mutex
     s_disp.lvgl_mutex = xSemaphoreCreateRecursiveMutex();
-    if (!s_disp.lvgl_mutex) {
+    s_disp.flush_done = xSemaphoreCreateBinary();
+    if (!s_disp.lvgl_mutex || !s_disp.flush_done) {
         return ESP_ERR_NO_MEM;
     }
 
+    ui_bus_slot_init(&s_disp.bus_sensors, s_bus_sensors, sizeof(s_bus_sensors[0]));
+    ui_bus_slot_init(&s_disp.bus_spectrum, s_bus_spectrum, sizeof(s_bus_spectrum[0]));
+    ui_bus_slot_init(&s_disp.bus_waveform, s_bus_waveform, sizeof(s_bus_waveform[0]));
+
+    esp_err_t ret = init_dsi_panel();
+    if (ret != ESP_OK) {
+        deinit_dsi_panel();
+        return ret;
+    }
+
     // Initialize LVGL
     lv_init();
 
@@ -371,10 +827,17 @@ esp_err_t display_manager_init(void)
         return ESP_FAIL;
     }
 
-    // Allocate draw buffers in PSRAM
-    size_t buf_size = DISPLAY_WIDTH * LVGL_BUFFER_LINES * sizeof(lv_color_t);
-    void *buf1 = heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM);
-    void *buf2 = heap_caps_malloc(buf_size, MALLOC_CAP_SPIRAM);
+#if CONFIG_DISPLAY_RENDER_DIRECT
+    // LVGL renders into the DPI frame buffers themselves
+    lv_display_set_buffers(s_disp.display, s_disp.fbs[0], s_disp.fbs[1],
+                           PANEL_H_RES * PANEL_V_RES * PANEL_BPP, LV_DISPLAY_RENDER_MODE_DIRECT);
+    s_disp.dirty_y1 = s_disp.prev_y1 = PANEL_V_RES;
+    s_disp.dirty_y2 = s_disp.prev_y2 = 0;
+#else
+    // Strip buffers in PSRAM, cache-line aligned for DMA2D / PPA
+    size_t buf_size = DISPLAY_WIDTH * LVGL_BUFFER_LINES * PANEL_BPP;  // RGB565, not sizeof(lv_color_t)
+    void *buf1 = mem_arena_acquire(MEM_REGION_PSRAM_ALIGNED, "lvgl_buf0", buf_size);
+    void *buf2 = mem_arena_acquire(MEM_REGION_PSRAM_ALIGNED, "lvgl_buf1", buf_size);
 
     if (!buf1 || !buf2) {
         ESP_LOGE(TAG, "Failed to allocate LVGL buffers");
@@ -382,14 +845,9 @@ esp_err_t display_manager_init(void)
     }
 
     lv_display_set_buffers(s_disp.display, buf1, buf2, buf_size, LV_DISPLAY_RENDER_MODE_PARTIAL);
+#endif
     lv_display_set_flush_cb(s_disp.display, lvgl_flush_cb);
-
-    // TODO: Initialize MIPI-DSI panel
-    // This is board-specific and requires ESP-BSP or custom driver
-    // For now, we'll use a placeholder
-
-    // Set user data for flush callback
-    // lv_display_set_user_data(s_disp.display, s_disp.panel);
+    lv_display_set_flush_wait_cb(s_disp.display, lvgl_flush_wait_cb);
 
     // Initialize tick timer
     const esp_timer_create_args_t timer_args = {
@@ -403,17 +861,8 @@ esp_err_t display_manager_init(void)
     // Initialize backlight
     init_backlight();
 
-    // Create UI screens (legacy)
-    create_home_screen();
-    create_sensor_screen();
-    create_music_screen();
-    create_notification_popup();
-
-    // Initialize advanced UI (TileView + Glass Cockpit)
-    ui_app_init();
-    ESP_LOGI(TAG, "Advanced UI initialized");
-
-    // Set initial screen (advanced UI takes over)
+    // Legacy screens and the notification popup are built on first use;
+    // the advanced UI comes from display_manager_start_ui()
     s_disp.current_screen = SCREEN_HOME;
 
     s_disp.brightness = 80;
@@ -424,15 +873,31 @@ esp_err_t display_manager_init(void)
     return ESP_OK;
 }
 
+esp_err_t display_manager_start_ui(void)
+{
+    if (!s_disp.initialized) return ESP_ERR_INVALID_STATE;
+
+    if (!display_manager_lock(-1)) return ESP_ERR_TIMEOUT;
+    int ret = ui_app_init();
+    display_manager_unlock();
+
+    if (ret != 0) return ESP_FAIL;
+    ESP_LOGI(TAG, "Advanced UI initialized");
+    return ESP_OK;
+}
+
 void display_manager_deinit(void)
 {
     if (!s_disp.initialized) return;
 
-    // TODO: Cleanup MIPI-DSI panel
+    deinit_dsi_panel();
 
     if (s_disp.lvgl_mutex) {
         vSemaphoreDelete(s_disp.lvgl_mutex);
     }
+    if (s_disp.flush_done) {
+        vSemaphoreDelete(s_disp.flush_done);
+    }
 
     memset(&s_disp, 0, sizeof(s_disp));
 }
@@ -454,16 +919,19 @@ void display_manager_unlock(void)
 
 uint32_t display_manager_timer_handler(void)
 {
+    apply_pending_updates();
     return lv_timer_handler();
 }
 
 void display_manager_set_screen(screen_type_t screen)
 {
-    if (screen >= SCREEN_COUNT || !s_disp.screens[screen]) return;
+    if (screen >= SCREEN_COUNT || !s_disp.initialized) return;
 
     if (display_manager_lock(100)) {
-        s_disp.current_screen = screen;
-        lv_screen_load_anim(s_disp.screens[screen], LV_SCR_LOAD_ANIM_FADE_IN, 300, 0, false);
+        if (ensure_screen(screen)) {
+            s_disp.current_screen = screen;
+            lv_screen_load_anim(s_disp.screens[screen], LV_SCR_LOAD_ANIM_FADE_IN, 300, 0, false);
+        }
         display_manager_unlock();
     }
 }
@@ -476,62 +944,7 @@ screen_type_t display_manager_get_screen(void)
 void display_manager_update_sensors(const sensor_data_t *data)
 {
     if (!data || !s_disp.initialized) return;
-
-    if (display_manager_lock(50)) {
-        char buf[32];
-
-        // Update home screen
-        if (data->sht40_valid) {
-            snprintf(buf, sizeof(buf), "%.1f°C", data->temperature);
-            lv_label_set_text(s_disp.lbl_temp, buf);
-            snprintf(buf, sizeof(buf), "%.0f%%", data->humidity);
-            lv_label_set_text(s_disp.lbl_humidity, buf);
-        }
-
-        // Update sensor screen
-        if (data->sht40_valid) {
-            snprintf(buf, sizeof(buf), "%.1f°C", data->temperature);
-            lv_label_set_text(s_disp.lbl_sensor_temp, buf);
-            snprintf(buf, sizeof(buf), "%.1f%%", data->humidity);
-            lv_label_set_text(s_disp.lbl_sensor_hum, buf);
-        }
-
-        if (data->scd41_valid) {
-            snprintf(buf, sizeof(buf), "%d ppm", data->co2);
-            lv_label_set_text(s_disp.lbl_sensor_co2, buf);
-
-            // Color based on CO2 level
-            lv_color_t color;
-            if (data->co2 < 800) {
-                color = lv_color_hex(0x2ecc71);  // Green
-            } else if (data->co2 < 1000) {
-                color = lv_color_hex(0xf1c40f);  // Yellow
-            } else if (data->co2 < 1500) {
-                color = lv_color_hex(0xe67e22);  // Orange
-            } else {
-                color = lv_color_hex(0xe74c3c);  // Red
-            }
-            lv_obj_set_style_text_color(s_disp.lbl_sensor_co2, color, 0);
-        }
-
-        if (data->ens160_valid) {
-            snprintf(buf, sizeof(buf), "%d ppb", data->tvoc);
-            lv_label_set_text(s_disp.lbl_sensor_tvoc, buf);
-            lv_label_set_text(s_disp.lbl_sensor_aqi, sensor_hub_aqi_description(data->aqi));
-        }
-
-        if (data->bmp388_valid) {
-            snprintf(buf, sizeof(buf), "%.1f hPa", data->pressure);
-            lv_label_set_text(s_disp.lbl_sensor_pressure, buf);
-        }
-
-        if (data->bh1750_valid) {
-            snprintf(buf, sizeof(buf), "%.0f lux", data->lux);
-            lv_label_set_text(s_disp.lbl_sensor_lux, buf);
-        }
-
-        display_manager_unlock();
-    }
+    ui_bus_slot_post(&s_disp.bus_sensors, data, sizeof(*data));
 }
 
 void display_manager_update_time(int hour, int minute)
@@ -539,9 +952,12 @@ void display_manager_update_time(int hour, int minute)
     if (!s_disp.initialized) return;
 
     if (display_manager_lock(50)) {
-        char buf[16];
-        snprintf(buf, sizeof(buf), "%02d:%02d", hour, minute);
-        lv_label_set_text(s_disp.lbl_time, buf);
+        // Not built yet: it gets the time once something shows it
+        if (s_disp.screens[SCREEN_HOME]) {
+            char buf[16];
+            snprintf(buf, sizeof(buf), "%02d:%02d", hour, minute);
+            lv_label_set_text(s_disp.lbl_time, buf);
+        }
         display_manager_unlock();
     }
 }
@@ -552,6 +968,7 @@ void display_manager_update_music(const char *title, const char *artist,
     if (!s_disp.initialized) return;
 
     if (display_manager_lock(50)) {
+        ensure_screen(SCREEN_MUSIC);
         if (title) {
             lv_label_set_text(s_disp.lbl_track_title, title);
         }
@@ -567,23 +984,39 @@ void display_manager_update_spectrum(const float *spectrum, int num_bands)
 {
     if (!s_disp.initialized || !spectrum) return;
 
-    if (display_manager_lock(20)) {
-        for (int i = 0; i < 16 && i < num_bands; i++) {
-            int value = (int)(spectrum[i] * 100);
-            if (value > 100) value = 100;
-            if (value < 5) value = 5;
-            lv_bar_set_value(s_disp.spectrum_bars[i], value, LV_ANIM_ON);
-        }
-        display_manager_unlock();
+    ui_spectrum_t *out = ui_bus_slot_back(&s_disp.bus_spectrum);
+    out->count = (num_bands < UI_SPECTRUM_BANDS) ? num_bands : UI_SPECTRUM_BANDS;
+    for (int i = 0; i < out->count; i++) {
+        int value = (int)(spectrum[i] * 100);
+        if (value > 100) value = 100;
+        if (value < 5) value = 5;
+        out->value[i] = value;
     }
+    ui_bus_slot_publish(&s_disp.bus_spectrum);
+}
+
+void display_manager_update_waveform(const int16_t *samples, int count)
+{
+    if (!s_disp.initialized || !samples || count <= 0) return;
+
+    // Downsample to the chart width here, not in the display task
+    ui_waveform_t *out = ui_bus_slot_back(&s_disp.bus_waveform);
+    int step = count / UI_WAVEFORM_POINTS;
+    if (step < 1) step = 1;
+    out->count = 0;
+    for (int i = 0; i < count && out->count < UI_WAVEFORM_POINTS; i += step) {
+        out->samples[out->count++] = samples[i];
+    }
+    ui_bus_slot_publish(&s_disp.bus_waveform);
 }
 
 void display_manager_show_notification(const char *title, const char *message,
                                         uint32_t duration_ms)
 {
-    if (!s_disp.initialized || !s_disp.notification_popup) return;
+    if (!s_disp.initialized) return;
 
     if (display_manager_lock(100)) {
+        if (!s_disp.notification_popup) create_notification_popup();
         // TODO: Update notification content and animate in
         lv_obj_clear_flag(s_disp.notification_popup, LV_OBJ_FLAG_HIDDEN);
         display_manager_unlock();
@@ -3,6 +3,12 @@
  * @brief Display Manager for Omni-P4 (MIPI-DSI + LVGL)
  *
  * Manages the 7-inch MIPI-DSI LCD with LVGL v9.x
+ *
+ * LVGL renders directly into the two DPI frame buffers, swapped on vsync
+ * (CONFIG_DISPLAY_RENDER_DIRECT), or into strip buffers that DMA2D / the
+ * PPA copy into the frame buffer (CONFIG_DISPLAY_RENDER_PARTIAL). Either
+ * way flushes complete from the DMA interrupt, not by polling.
+ *
  * Features:
  * - Home Assistant dashboard view
  * - Sensor data visualization
@@ -15,6 +21,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "sdkconfig.h"
 #include "sensor_hub.h"
 
 #ifdef __cplusplus
@@ -25,8 +32,14 @@ extern "C" {
 // Display Configuration
 // ============================================================================
 
+// UI size; 90/270 degree rotation (partial render mode) swaps the panel axes
+#if CONFIG_DISPLAY_ROTATION == 90 || CONFIG_DISPLAY_ROTATION == 270
+#define DISPLAY_WIDTH   CONFIG_DISPLAY_V_RES
+#define DISPLAY_HEIGHT  CONFIG_DISPLAY_H_RES
+#else
 #define DISPLAY_WIDTH   CONFIG_DISPLAY_H_RES
 #define DISPLAY_HEIGHT  CONFIG_DISPLAY_V_RES
+#endif
 
 // ============================================================================
 // Screen/View Types
@@ -49,12 +62,21 @@ typedef enum {
 /**
  * @brief Initialize display manager
  *
- * Initializes MIPI-DSI, LVGL, and creates UI screens.
+ * Initializes MIPI-DSI and LVGL. Legacy screens are built on first use.
  *
  * @return ESP_OK on success
  */
 esp_err_t display_manager_init(void);
 
+/**
+ * @brief Build the advanced UI (TileView + Glass Cockpit)
+ *
+ * Separate boot stage after display_manager_init(); takes the LVGL lock.
+ *
+ * @return ESP_OK on success
+ */
+esp_err_t display_manager_start_ui(void);
+
 /**
  * @brief Deinitialize display manager
  */
@@ -73,9 +95,9 @@ bool display_manager_lock(int timeout_ms);
 void display_manager_unlock(void);
 
 /**
- * @brief Call LVGL timer handler
+ * @brief Apply pending UI bus updates, then call LVGL timer handler
  *
- * Should be called from display task.
+ * Should be called from display task with the LVGL lock held.
  *
  * @return Suggested delay until next call (in ms)
  */
@@ -95,6 +117,12 @@ screen_type_t display_manager_get_screen(void);
 
 /**
  * @brief Update sensor data display
+ *
+ * Posts to the UI bus and returns: never blocks and never touches LVGL,
+ * so it may be called from any task (one producer per value kind). The
+ * display task applies the newest value on its next frame, skipping
+ * widgets whose text did not change.
+ *
  * @param data Sensor data structure
  */
 void display_manager_update_sensors(const sensor_data_t *data);
@@ -117,12 +145,19 @@ void display_manager_update_music(const char *title, const char *artist,
                                    float progress, bool is_playing);
 
 /**
- * @brief Update audio spectrum for visualizer
+ * @brief Update audio spectrum for visualizer (UI bus, non-blocking)
  * @param spectrum Array of spectrum values (0.0-1.0)
  * @param num_bands Number of frequency bands
  */
 void display_manager_update_spectrum(const float *spectrum, int num_bands);
 
+/**
+ * @brief Update the cockpit waveform chart (UI bus, non-blocking)
+ * @param samples Audio samples (downsampled to the chart width)
+ * @param count Number of samples
+ */
+void display_manager_update_waveform(const int16_t *samples, int count);
+
 /**
  * @brief Show notification toast
  * @param title Notification title
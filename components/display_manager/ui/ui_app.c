@@ -8,8 +8,10 @@
 #include "ui_app.h"
 #include <string.h>
 #include <stdio.h>
+#include "sdkconfig.h"
 #include "esp_log.h"
 #include "remo_client.h"
+#include "display_manager.h"
 
 static const char *TAG = "ui_app";
 
@@ -27,6 +29,20 @@ static const char *TAG = "ui_app";
 #define COLOR_TEXT_DIM      lv_color_hex(0x88aa88)
 #define COLOR_GRID          lv_color_hex(0x224422)
 
+// ============================================================================
+// Rendering
+// ============================================================================
+
+#define UI_WAVE_POINTS          128     // Chart columns (one sweep)
+#define UI_WAVE_COLUMNS         16      // New columns per waveform update
+#define UI_DEFERRED_BUILD_MS    100     // Off-screen tiles, after the first frame
+
+#ifdef CONFIG_DISPLAY_STANDBY_REFR_MS
+#define UI_STANDBY_REFR_MS      CONFIG_DISPLAY_STANDBY_REFR_MS
+#else
+#define UI_STANDBY_REFR_MS      250
+#endif
+
 // ============================================================================
 // UI State
 // ============================================================================
@@ -35,6 +51,8 @@ typedef struct {
     // Main containers
     lv_obj_t *tileview;
     lv_obj_t *tiles[UI_TILE_COUNT];
+    bool tile_built[UI_TILE_COUNT];
+    lv_timer_t *deferred_build;
 
     // Standby overlay
     lv_obj_t *standby_layer;
@@ -58,15 +76,107 @@ typedef struct {
     lv_obj_t *tab_climate;
     lv_obj_t *tab_media;
 
+    // Widget cache: what LVGL currently shows (-1 = nothing yet), and the
+    // newest values held back while the cockpit is off screen
+    struct {
+        int temp_bar;
+        int co2;
+        int clock;              // Seconds since midnight
+        int clock_small;        // Minutes since midnight
+    } shown;
+    struct {
+        bool sensors;
+        float temp;
+        float humidity;
+        int co2;
+        float pressure;
+        bool time;
+        int hour, minute;
+    } pending;
+
     bool initialized;
 } ui_app_state_t;
 
 static ui_app_state_t s_ui = {0};
 
+static void apply_sensors(float temp, float humidity, int co2, float pressure);
+static void apply_time_small(int hour, int minute);
+static void build_all_tiles(void);
+
+// ============================================================================
+// Widget Cache
+// ============================================================================
+
+/**
+ * @brief Whether cockpit widgets are on screen
+ *
+ * Off-screen tiles and anything under the standby overlay are not worth
+ * invalidating; their values are parked in s_ui.pending instead.
+ */
+static bool cockpit_visible(void)
+{
+    return !s_ui.standby_active &&
+           lv_tileview_get_tile_active(s_ui.tileview) == s_ui.tiles[UI_TILE_HOME];
+}
+
+/**
+ * @brief Set label text only when it differs from what is shown
+ */
+static void set_label_text(lv_obj_t *label, const char *text)
+{
+    if (strcmp(lv_label_get_text(label), text) != 0) {
+        lv_label_set_text(label, text);
+    }
+}
+
+/**
+ * @brief Render values parked while the cockpit was hidden
+ */
+static void apply_pending(void)
+{
+    if (!cockpit_visible()) return;
+
+    if (s_ui.pending.sensors) {
+        s_ui.pending.sensors = false;
+        apply_sensors(s_ui.pending.temp, s_ui.pending.humidity,
+                      s_ui.pending.co2, s_ui.pending.pressure);
+    }
+    if (s_ui.pending.time) {
+        s_ui.pending.time = false;
+        apply_time_small(s_ui.pending.hour, s_ui.pending.minute);
+    }
+}
+
+static void reset_widget_cache(void)
+{
+    s_ui.shown.temp_bar = -1;
+    s_ui.shown.co2 = -1;
+    s_ui.shown.clock = -1;
+    s_ui.shown.clock_small = -1;
+    memset(&s_ui.pending, 0, sizeof(s_ui.pending));
+}
+
 // ============================================================================
 // Event Handlers
 // ============================================================================
 
+static void tile_changed_cb(lv_event_t *e)
+{
+    apply_pending();
+}
+
+static void tile_scroll_begin_cb(lv_event_t *e)
+{
+    // A swipe is about to reveal a neighbour: it has to exist by now
+    build_all_tiles();
+}
+
+static void deferred_build_cb(lv_timer_t *timer)
+{
+    s_ui.deferred_build = NULL;     // One-shot: LVGL deletes it
+    build_all_tiles();
+}
+
 static void standby_swipe_cb(lv_event_t *e)
 {
     lv_dir_t dir = lv_indev_get_gesture_dir(lv_indev_active());
@@ -76,6 +186,24 @@ static void standby_swipe_cb(lv_event_t *e)
     }
 }
 
+/**
+ * @brief Remo worker completion: color the button by the outcome
+ */
+static void remo_done_cb(const remo_send_result_t *result, void *user_ctx)
+{
+    lv_obj_t *btn = (lv_obj_t *)user_ctx;
+
+    ESP_LOGD(TAG, "Remo: %s in %lu ms (queue %lu, connect %lu, response %lu)",
+             esp_err_to_name(result->result), (unsigned long)result->total_ms,
+             (unsigned long)result->queue_ms, (unsigned long)result->connect_ms,
+             (unsigned long)result->response_ms);
+
+    if (!display_manager_lock(100)) return;
+    // Green on success, red on failure (reset after delay would need timer)
+    lv_obj_set_style_bg_color(btn, (result->result == ESP_OK) ? COLOR_ACCENT : COLOR_DANGER, 0);
+    display_manager_unlock();
+}
+
 static void remo_btn_cb(lv_event_t *e)
 {
     const char *app_name = (const char *)lv_event_get_user_data(e);
@@ -87,13 +215,9 @@ static void remo_btn_cb(lv_event_t *e)
 
     ESP_LOGI(TAG, "Remo: %s -> %s", app_name, signal);
 
-    // Send command via remo_client
-    esp_err_t ret = remo_client_send_quick(app_name, signal);
-    if (ret == ESP_OK) {
-        // Flash button green briefly
-        lv_obj_set_style_bg_color(btn, COLOR_ACCENT, 0);
-        // Reset after delay (would need timer)
-    } else {
+    // Queue only: the HTTP request runs on the Remo worker, not the UI task
+    esp_err_t ret = remo_client_send_quick_async(app_name, signal, remo_done_cb, btn);
+    if (ret != ESP_OK) {
         // Flash button red
         lv_obj_set_style_bg_color(btn, COLOR_DANGER, 0);
     }
@@ -179,18 +303,21 @@ static void create_glass_cockpit(lv_obj_t *parent)
     lv_obj_set_size(s_ui.chart_waveform, 330, 150);
     lv_obj_align(s_ui.chart_waveform, LV_ALIGN_BOTTOM_MID, 0, -5);
     lv_chart_set_type(s_ui.chart_waveform, LV_CHART_TYPE_LINE);
-    lv_chart_set_point_count(s_ui.chart_waveform, 128);
+    lv_chart_set_point_count(s_ui.chart_waveform, UI_WAVE_POINTS);
     lv_chart_set_range(s_ui.chart_waveform, LV_CHART_AXIS_PRIMARY_Y, -100, 100);
     lv_obj_set_style_bg_color(s_ui.chart_waveform, COLOR_BG_DARK, 0);
     lv_obj_set_style_line_color(s_ui.chart_waveform, COLOR_GRID, LV_PART_MAIN);
     lv_chart_set_div_line_count(s_ui.chart_waveform, 5, 8);
 
+    // Circular: each new point overwrites one column and invalidates only
+    // that column, like a sweeping oscilloscope trace (shift mode would
+    // scroll and redraw the whole chart on every point)
+    lv_chart_set_update_mode(s_ui.chart_waveform, LV_CHART_UPDATE_MODE_CIRCULAR);
+
     s_ui.wave_series = lv_chart_add_series(s_ui.chart_waveform, COLOR_ACCENT,
                                             LV_CHART_AXIS_PRIMARY_Y);
     // Initialize with flat line
-    for (int i = 0; i < 128; i++) {
-        lv_chart_set_next_value(s_ui.chart_waveform, s_ui.wave_series, 0);
-    }
+    lv_chart_set_all_value(s_ui.chart_waveform, s_ui.wave_series, 0);
 
     // =============================================
     // Center Panel: CO2 Meter (Analog Gauge)
@@ -396,6 +523,30 @@ static void create_extra_tile(lv_obj_t *parent)
     lv_obj_align(hint, LV_ALIGN_BOTTOM_MID, 0, -50);
 }
 
+// ============================================================================
+// Lazy Tile Construction
+// ============================================================================
+
+static void build_tile(ui_tile_t tile)
+{
+    if (s_ui.tile_built[tile]) return;
+
+    switch (tile) {
+    case UI_TILE_CONTROL: create_control_center(s_ui.tiles[tile]); break;
+    case UI_TILE_HOME:    create_glass_cockpit(s_ui.tiles[tile]);  break;
+    case UI_TILE_EXTRA:   create_extra_tile(s_ui.tiles[tile]);     break;
+    default:              return;
+    }
+    s_ui.tile_built[tile] = true;
+}
+
+static void build_all_tiles(void)
+{
+    for (int i = 0; i < UI_TILE_COUNT; i++) {
+        build_tile((ui_tile_t)i);
+    }
+}
+
 // ============================================================================
 // Public API Implementation
 // ============================================================================
@@ -419,19 +570,28 @@ int ui_app_init(void)
     s_ui.tiles[UI_TILE_HOME] = lv_tileview_add_tile(s_ui.tileview, 1, 0, LV_DIR_LEFT | LV_DIR_RIGHT);
     s_ui.tiles[UI_TILE_EXTRA] = lv_tileview_add_tile(s_ui.tileview, 2, 0, LV_DIR_LEFT);
 
-    // Create content for each tile
-    create_control_center(s_ui.tiles[UI_TILE_CONTROL]);
-    create_glass_cockpit(s_ui.tiles[UI_TILE_HOME]);
-    create_extra_tile(s_ui.tiles[UI_TILE_EXTRA]);
+    // Only the Home tile is on screen at boot; the others are built once
+    // the first frame is out, or as soon as a swipe starts
+    build_tile(UI_TILE_HOME);
+    s_ui.deferred_build = lv_timer_create(deferred_build_cb, UI_DEFERRED_BUILD_MS, NULL);
+    if (s_ui.deferred_build) {
+        lv_timer_set_repeat_count(s_ui.deferred_build, 1);
+    } else {
+        build_all_tiles();
+    }
 
     // Set initial view to Home (center)
     lv_obj_set_tile(s_ui.tileview, s_ui.tiles[UI_TILE_HOME], LV_ANIM_OFF);
+    lv_obj_add_event_cb(s_ui.tileview, tile_changed_cb, LV_EVENT_VALUE_CHANGED, NULL);
+    lv_obj_add_event_cb(s_ui.tileview, tile_scroll_begin_cb, LV_EVENT_SCROLL_BEGIN, NULL);
 
     // Create standby overlay
     create_standby_overlay();
 
+    reset_widget_cache();
+
     s_ui.initialized = true;
-    ESP_LOGI(TAG, "Advanced UI initialized (3-tile TileView + Glass Cockpit)");
+    ESP_LOGI(TAG, "Advanced UI initialized (3-tile TileView + Glass Cockpit, side tiles deferred)");
 
     return 0;
 }
@@ -439,6 +599,7 @@ int ui_app_init(void)
 void ui_app_deinit(void)
 {
     if (!s_ui.initialized) return;
+    if (s_ui.deferred_build) lv_timer_delete(s_ui.deferred_build);
     // LVGL handles object cleanup automatically
     memset(&s_ui, 0, sizeof(s_ui));
 }
@@ -446,19 +607,30 @@ void ui_app_deinit(void)
 void ui_app_goto_tile(ui_tile_t tile)
 {
     if (!s_ui.initialized || tile >= UI_TILE_COUNT) return;
+    build_tile(tile);
     lv_obj_set_tile(s_ui.tileview, s_ui.tiles[tile], LV_ANIM_ON);
 }
 
 void ui_app_set_standby(bool show)
 {
     if (!s_ui.initialized || !s_ui.standby_layer) return;
+    if (show == s_ui.standby_active) return;
 
+    // While standby shows, the tiles are taken out of rendering altogether
+    // and the display only refreshes often enough for the clock and swipes
+    lv_timer_t *refr = lv_display_get_refr_timer(lv_display_get_default());
     if (show) {
+        lv_obj_add_flag(s_ui.tileview, LV_OBJ_FLAG_HIDDEN);
         lv_obj_clear_flag(s_ui.standby_layer, LV_OBJ_FLAG_HIDDEN);
+        if (refr) lv_timer_set_period(refr, UI_STANDBY_REFR_MS);
     } else {
+        lv_obj_clear_flag(s_ui.tileview, LV_OBJ_FLAG_HIDDEN);
         lv_obj_add_flag(s_ui.standby_layer, LV_OBJ_FLAG_HIDDEN);
+        if (refr) lv_timer_set_period(refr, LV_DEF_REFR_PERIOD);
     }
     s_ui.standby_active = show;
+
+    if (!show) apply_pending();
 }
 
 bool ui_app_is_standby(void)
@@ -466,77 +638,115 @@ bool ui_app_is_standby(void)
     return s_ui.standby_active;
 }
 
-void ui_app_update_time(int hour, int minute, int second)
+static void apply_time_small(int hour, int minute)
 {
-    if (!s_ui.initialized) return;
+    int minutes = hour * 60 + minute;
+    if (minutes == s_ui.shown.clock_small) return;
 
     char buf[16];
+    snprintf(buf, sizeof(buf), "%02d:%02d", hour, minute);
+    lv_label_set_text(s_ui.lbl_time_small, buf);
+    s_ui.shown.clock_small = minutes;
+}
 
-    // Update standby clock
-    if (s_ui.standby_clock) {
+void ui_app_update_time(int hour, int minute, int second)
+{
+    if (!s_ui.initialized) return;
+
+    // Update standby clock (only visible while standby is active)
+    int seconds = (hour * 60 + minute) * 60 + second;
+    if (s_ui.standby_clock && s_ui.standby_active && seconds != s_ui.shown.clock) {
+        char buf[16];
         snprintf(buf, sizeof(buf), "%02d:%02d:%02d", hour, minute, second);
         lv_label_set_text(s_ui.standby_clock, buf);
+        s_ui.shown.clock = seconds;
     }
 
     // Update small time on cockpit
     if (s_ui.lbl_time_small) {
-        snprintf(buf, sizeof(buf), "%02d:%02d", hour, minute);
-        lv_label_set_text(s_ui.lbl_time_small, buf);
+        if (cockpit_visible()) {
+            apply_time_small(hour, minute);
+        } else {
+            s_ui.pending.time = true;
+            s_ui.pending.hour = hour;
+            s_ui.pending.minute = minute;
+        }
     }
 }
 
-void ui_app_update_sensors(float temp, float humidity, int co2, float pressure)
+static void apply_sensors(float temp, float humidity, int co2, float pressure)
 {
-    if (!s_ui.initialized) return;
-
     char buf[32];
 
     // Temperature bar and label
-    if (s_ui.bar_temp) {
-        lv_bar_set_value(s_ui.bar_temp, (int)temp, LV_ANIM_ON);
+    int temp_bar = (int)temp;
+    if (s_ui.bar_temp && temp_bar != s_ui.shown.temp_bar) {
+        lv_bar_set_value(s_ui.bar_temp, temp_bar, LV_ANIM_ON);
+        s_ui.shown.temp_bar = temp_bar;
     }
     if (s_ui.lbl_temp_value) {
         snprintf(buf, sizeof(buf), "%.1fC", temp);
-        lv_label_set_text(s_ui.lbl_temp_value, buf);
+        set_label_text(s_ui.lbl_temp_value, buf);
     }
 
     // Humidity
     if (s_ui.lbl_humidity) {
         snprintf(buf, sizeof(buf), "%.0f%%RH", humidity);
-        lv_label_set_text(s_ui.lbl_humidity, buf);
+        set_label_text(s_ui.lbl_humidity, buf);
     }
 
     // Pressure
     if (s_ui.lbl_pressure) {
         snprintf(buf, sizeof(buf), "%.0fhPa", pressure);
-        lv_label_set_text(s_ui.lbl_pressure, buf);
+        set_label_text(s_ui.lbl_pressure, buf);
     }
 
-    // CO2 meter needle
+    // CO2 meter needle (a set redraws the whole gauge, even for the same value)
     if (s_ui.meter_co2 && s_ui.co2_needle) {
         int display_co2 = co2;
         if (display_co2 < 400) display_co2 = 400;
         if (display_co2 > 2000) display_co2 = 2000;
-        lv_meter_set_indicator_value(s_ui.meter_co2, s_ui.co2_needle, display_co2);
+        if (display_co2 != s_ui.shown.co2) {
+            lv_meter_set_indicator_value(s_ui.meter_co2, s_ui.co2_needle, display_co2);
+            s_ui.shown.co2 = display_co2;
+        }
+    }
+}
+
+void ui_app_update_sensors(float temp, float humidity, int co2, float pressure)
+{
+    if (!s_ui.initialized) return;
+
+    if (!cockpit_visible()) {
+        s_ui.pending.sensors = true;
+        s_ui.pending.temp = temp;
+        s_ui.pending.humidity = humidity;
+        s_ui.pending.co2 = co2;
+        s_ui.pending.pressure = pressure;
+        return;
     }
+    s_ui.pending.sensors = false;
+    apply_sensors(temp, humidity, co2, pressure);
 }
 
 void ui_app_update_waveform(const int16_t *samples, int count)
 {
     if (!s_ui.initialized || !s_ui.chart_waveform || !samples) return;
 
-    // Downsample to 128 points for display
-    int step = count / 128;
+    // A scope trace has no useful backlog: drop blocks nobody can see
+    if (!cockpit_visible()) return;
+
+    // Downsample the block to a few new columns; in circular mode each
+    // set_next_value() invalidates just the column it writes
+    int step = count / UI_WAVE_COLUMNS;
     if (step < 1) step = 1;
 
-    for (int i = 0; i < 128 && i * step < count; i++) {
+    for (int i = 0; i < UI_WAVE_COLUMNS && i * step < count; i++) {
         int16_t sample = samples[i * step];
         // Scale to -100..100 range
         int scaled = (sample * 100) / 32767;
         lv_chart_set_next_value(s_ui.chart_waveform, s_ui.wave_series, scaled);
     }
-
-    lv_chart_refresh(s_ui.chart_waveform);
 }
 
 void ui_app_refresh_controls(void)
@@ -82,6 +82,9 @@ void ui_app_update_time(int hour, int minute, int second);
 /**
  * @brief Update glass cockpit sensor data
  *
+ * LVGL context (display lock held); producer tasks use
+ * display_manager_update_sensors().
+ *
  * @param temp Temperature in Celsius
  * @param humidity Humidity in %
  * @param co2 CO2 in ppm
@@ -92,6 +95,9 @@ void ui_app_update_sensors(float temp, float humidity, int co2, float pressure);
 /**
  * @brief Update audio waveform display
  *
+ * LVGL context (display lock held); producer tasks use
+ * display_manager_update_waveform().
+ *
  * @param samples Audio sample data
  * @param count Number of samples
  */
@@ -0,0 +1,47 @@
+/**
+ * @file ui_bus.c
+ * @brief Triple-buffered latest-value slots
+ */
+
+#include "ui_bus.h"
+#include <string.h>
+
+#define UI_BUS_FRESH        0x80
+#define UI_BUS_INDEX_MASK   0x03
+
+void ui_bus_slot_init(ui_bus_slot_t *slot, void *storage, size_t size)
+{
+    memset(storage, 0, 3 * size);
+    slot->buf = (uint8_t *)storage;
+    slot->size = size;
+    slot->back = 0;
+    slot->front = 2;
+    atomic_store_explicit(&slot->middle, 1, memory_order_release);
+}
+
+void ui_bus_slot_publish(ui_bus_slot_t *slot)
+{
+    // Release: the value is visible before the index; acquire: the buffer
+    // handed back is no longer being read
+    uint8_t prev = atomic_exchange_explicit(&slot->middle, slot->back | UI_BUS_FRESH,
+                                            memory_order_acq_rel);
+    slot->back = prev & UI_BUS_INDEX_MASK;
+}
+
+void ui_bus_slot_post(ui_bus_slot_t *slot, const void *value, size_t len)
+{
+    if (len > slot->size) len = slot->size;
+    memcpy(ui_bus_slot_back(slot), value, len);
+    ui_bus_slot_publish(slot);
+}
+
+const void *ui_bus_slot_take(ui_bus_slot_t *slot)
+{
+    if (!(atomic_load_explicit(&slot->middle, memory_order_relaxed) & UI_BUS_FRESH)) {
+        return NULL;
+    }
+
+    uint8_t prev = atomic_exchange_explicit(&slot->middle, slot->front, memory_order_acq_rel);
+    slot->front = prev & UI_BUS_INDEX_MASK;
+    return slot->buf + slot->front * slot->size;
+}
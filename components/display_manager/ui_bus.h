@@ -0,0 +1,70 @@
+/**
+ * @file ui_bus.h
+ * @brief Latest-value slots between producer tasks and the display task
+ *
+ * Each slot is a lock-free triple buffer: the producer fills its back
+ * buffer and swaps it into the middle, the display task swaps the middle
+ * out once per frame. Neither side ever waits, intermediate values are
+ * simply overwritten, and the consumer always sees a whole value.
+ *
+ *   producer:  write back ──► publish (back ⇄ middle, mark fresh)
+ *   display:   take (front ⇄ middle if fresh) ──► apply to LVGL
+ *
+ * One producer and one consumer per slot. No LVGL or FreeRTOS
+ * dependencies.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Triple-buffered slot
+ */
+typedef struct {
+    uint8_t *buf;               // 3 × size, caller-owned
+    size_t size;
+    uint8_t back;               // Producer-owned buffer index
+    uint8_t front;              // Consumer-owned buffer index
+    _Atomic uint8_t middle;     // Handed-over index | UI_BUS_FRESH
+} ui_bus_slot_t;
+
+/**
+ * @brief Initialize a slot over 3 × size bytes of storage
+ */
+void ui_bus_slot_init(ui_bus_slot_t *slot, void *storage, size_t size);
+
+/**
+ * @brief Producer: buffer to fill before ui_bus_slot_publish()
+ */
+static inline void *ui_bus_slot_back(ui_bus_slot_t *slot)
+{
+    return slot->buf + slot->back * slot->size;
+}
+
+/**
+ * @brief Producer: hand the back buffer to the consumer
+ */
+void ui_bus_slot_publish(ui_bus_slot_t *slot);
+
+/**
+ * @brief Producer: copy a value in and publish it
+ */
+void ui_bus_slot_post(ui_bus_slot_t *slot, const void *value, size_t len);
+
+/**
+ * @brief Consumer: newest value if one was published since the last take
+ * @return Value (valid until the next take), or NULL
+ */
+const void *ui_bus_slot_take(ui_bus_slot_t *slot);
+
+#ifdef __cplusplus
+}
+#endif
@@ -49,12 +49,26 @@ void ESP32P4AudioComponent::setup() {
 void ESP32P4AudioComponent::loop() {
   // Audio processing is handled by I2S interrupts
   // This loop is for monitoring and diagnostics
+  if (echo_cancel_pending_) {
+    init_echo_cancellation_();
+  }
+
+  if (echo_cancel_enabled_ && !echo_cancel_pending_) {
+    uint32_t now = millis();
+    if (now - last_aec_log_ms_ >= 10000) {
+      last_aec_log_ms_ = now;
+      log_echo_cancellation_stats_();
+    }
+  }
 }
 
 void ESP32P4AudioComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "ESP32-P4 Audio Component:");
   ESP_LOGCONFIG(TAG, "  ES8311 Codec: %s", es8311_enabled_ ? "enabled" : "disabled");
   ESP_LOGCONFIG(TAG, "  Echo Cancellation: %s", echo_cancel_enabled_ ? "enabled" : "disabled");
+  if (echo_cancel_enabled_) {
+    log_echo_cancellation_stats_();
+  }
   ESP_LOGCONFIG(TAG, "  Buffer Size: %u bytes", buffer_size_);
   ESP_LOGCONFIG(TAG, "  Sample Rate: %u Hz", sample_rate_);
   ESP_LOGCONFIG(TAG, "  Free PSRAM: %u bytes", (uint32_t)get_free_psram());
@@ -117,16 +131,36 @@ bool ESP32P4AudioComponent::init_es8311_() {
 bool ESP32P4AudioComponent::init_echo_cancellation_() {
   ESP_LOGI(TAG, "Initializing echo cancellation");
 
-  // Echo cancellation uses the ESP-ADF AEC (Acoustic Echo Cancellation)
-  // This requires dual microphones for proper operation
-
-  // Note: Full AEC implementation requires ESP-ADF library
-  // This is a placeholder for the basic structure
+  // Echo cancellation runs inside audio_pipeline: an NLMS filter on the
+  // 16kHz mic stream, with the post-volume DAC mix as far-end reference.
+  // The pipeline may be started by another component after this one.
+#ifdef USE_ESP_IDF
+  esp_err_t err = audio_pipeline_set_aec_enabled(true);
+  if (err == ESP_ERR_INVALID_STATE) {
+    echo_cancel_pending_ = true;
+    return true;
+  }
+  echo_cancel_pending_ = false;
+  if (err != ESP_OK) {
+    ESP_LOGW(TAG, "Echo cancellation unavailable: %s", esp_err_to_name(err));
+    return false;
+  }
+#endif
 
   ESP_LOGI(TAG, "Echo cancellation initialized");
   return true;
 }
 
+void ESP32P4AudioComponent::log_echo_cancellation_stats_() {
+#ifdef USE_ESP_IDF
+  audio_aec_stats_t stats;
+  audio_pipeline_get_aec_stats(&stats);
+  ESP_LOGD(TAG, "AEC: %s, ERLE %.1f dB%s, %u us/10ms frame (max %u us/block), %u resyncs",
+           stats.ref_active ? "active" : "idle", stats.erle_db, stats.double_talk ? " (double-talk)" : "",
+           (unsigned) stats.frame_cost_us, (unsigned) stats.block_cost_max_us, (unsigned) stats.resyncs);
+#endif
+}
+
 void ESP32P4AudioComponent::configure_audio_clocks_() {
   ESP_LOGI(TAG, "Configuring audio clocks for sample rate %u Hz", sample_rate_);
 
@@ -3,7 +3,7 @@
  *
  * Provides optimized audio handling for ESP32-P4 with:
  * - ES8311 audio codec support
- * - Dual microphone echo cancellation
+ * - Echo cancellation (audio_pipeline NLMS, DAC mix as reference)
  * - PSRAM buffer management
  * - Low-latency audio streaming
  */
@@ -20,6 +20,12 @@
 #include <freertos/task.h>
 #endif
 
+#ifdef USE_ESP_IDF
+extern "C" {
+#include "audio_pipeline.h"
+}
+#endif
+
 namespace esphome {
 namespace esp32_p4_audio {
 
@@ -51,10 +57,13 @@ class ESP32P4AudioComponent : public Component {
  protected:
   bool init_es8311_();
   bool init_echo_cancellation_();
+  void log_echo_cancellation_stats_();
   void configure_audio_clocks_();
 
   bool es8311_enabled_{true};
   bool echo_cancel_enabled_{false};
+  bool echo_cancel_pending_{false};  // Pipeline not up yet, retry from loop()
+  uint32_t last_aec_log_ms_{0};
   uint32_t buffer_size_{4096};
   uint32_t sample_rate_{16000};
   bool initialized_{false};
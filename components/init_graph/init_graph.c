@@ -0,0 +1,194 @@
+/**
+ * @file init_graph.c
+ * @brief Dependency-ordered concurrent bring-up implementation
+ */
+
+#include "init_graph.h"
+#include <string.h>
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "init_graph";
+
+// ============================================================================
+// State
+// ============================================================================
+
+typedef struct {
+    const init_stage_t *stages;
+    int count;
+    EventGroupHandle_t events;      // Done bit per stage (failures included)
+    uint32_t failed;                // INIT_STAGE_BIT() of failed / skipped stages
+    init_stage_record_t records[INIT_GRAPH_MAX_STAGES];
+} init_graph_state_t;
+
+static init_graph_state_t s_graph = {0};
+static portMUX_TYPE s_graph_lock = portMUX_INITIALIZER_UNLOCKED;   // records[], failed
+
+static const char *const STATE_NAMES[] = {
+    [INIT_STAGE_PENDING] = "pending",
+    [INIT_STAGE_RUNNING] = "running",
+    [INIT_STAGE_OK]      = "ok",
+    [INIT_STAGE_FAILED]  = "FAILED",
+    [INIT_STAGE_SKIPPED] = "skipped",
+};
+
+// ============================================================================
+// Worker
+// ============================================================================
+
+static void set_record(int id, init_stage_state_t state, esp_err_t result,
+                       int64_t start_us, int64_t end_us)
+{
+    portENTER_CRITICAL(&s_graph_lock);
+    init_stage_record_t *rec = &s_graph.records[id];
+    rec->state = state;
+    rec->result = result;
+    if (start_us) rec->start_us = start_us;
+    if (end_us) rec->end_us = end_us;
+    if (state == INIT_STAGE_FAILED || state == INIT_STAGE_SKIPPED) {
+        s_graph.failed |= INIT_STAGE_BIT(id);
+    }
+    portEXIT_CRITICAL(&s_graph_lock);
+}
+
+static uint32_t failed_of(uint32_t stages)
+{
+    portENTER_CRITICAL(&s_graph_lock);
+    uint32_t failed = s_graph.failed & stages;
+    portEXIT_CRITICAL(&s_graph_lock);
+    return failed;
+}
+
+static void stage_worker(void *arg)
+{
+    int id = (int)(intptr_t)arg;
+    const init_stage_t *stage = &s_graph.stages[id];
+
+    // Done bits are set for failures too, so a dependency that failed
+    // ends the wait instead of blocking it forever. The failed mask is
+    // updated before the done bit, so it is current once the wait returns.
+    if (stage->deps) {
+        xEventGroupWaitBits(s_graph.events, stage->deps, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+
+    int64_t start = esp_timer_get_time();
+    if (failed_of(stage->deps)) {
+        ESP_LOGW(TAG, "%s: skipped (dependency failed)", stage->name);
+        set_record(id, INIT_STAGE_SKIPPED, ESP_ERR_INVALID_STATE, start, start);
+        xEventGroupSetBits(s_graph.events, INIT_STAGE_BIT(id));
+        vTaskDelete(NULL);
+        return;
+    }
+
+    set_record(id, INIT_STAGE_RUNNING, ESP_OK, start, 0);
+    esp_err_t ret = stage->fn();
+    int64_t end = esp_timer_get_time();
+
+    if (ret == ESP_OK) {
+        set_record(id, INIT_STAGE_OK, ret, 0, end);
+        ESP_LOGD(TAG, "%s: ok in %lld ms", stage->name, (end - start) / 1000);
+    } else {
+        set_record(id, INIT_STAGE_FAILED, ret, 0, end);
+        ESP_LOGE(TAG, "%s: %s", stage->name, esp_err_to_name(ret));
+    }
+    xEventGroupSetBits(s_graph.events, INIT_STAGE_BIT(id));
+    vTaskDelete(NULL);
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t init_graph_start(const init_stage_t *stages, int count)
+{
+    if (!stages || count <= 0 || count > INIT_GRAPH_MAX_STAGES || s_graph.events) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (int i = 0; i < count; i++) {
+        // Only earlier stages: keeps the graph acyclic
+        if (!stages[i].fn || (stages[i].deps & ~(INIT_STAGE_BIT(i) - 1))) {
+            ESP_LOGE(TAG, "Stage %d (%s): bad function or forward dependency",
+                     i, stages[i].name ? stages[i].name : "?");
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+
+    s_graph.events = xEventGroupCreate();
+    if (!s_graph.events) return ESP_ERR_NO_MEM;
+    s_graph.stages = stages;
+    s_graph.count = count;
+    s_graph.failed = 0;
+    memset(s_graph.records, 0, sizeof(s_graph.records));
+
+    for (int i = 0; i < count; i++) {
+        if (xTaskCreate(stage_worker, stages[i].name, stages[i].stack, (void *)(intptr_t)i,
+                        stages[i].priority, NULL) != pdPASS) {
+            // Dependents see it as failed and skip
+            ESP_LOGE(TAG, "%s: no memory for worker", stages[i].name);
+            int64_t now = esp_timer_get_time();
+            set_record(i, INIT_STAGE_FAILED, ESP_ERR_NO_MEM, now, now);
+            xEventGroupSetBits(s_graph.events, INIT_STAGE_BIT(i));
+        }
+    }
+
+    return ESP_OK;
+}
+
+bool init_graph_wait(uint32_t stages, TickType_t timeout)
+{
+    if (!s_graph.events) return false;
+
+    EventBits_t bits = xEventGroupWaitBits(s_graph.events, stages, pdFALSE, pdTRUE, timeout);
+    return (bits & stages) == stages && !failed_of(stages);
+}
+
+void init_graph_get_record(int id, init_stage_record_t *out)
+{
+    if (!out) return;
+    if (id < 0 || id >= s_graph.count) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    portENTER_CRITICAL(&s_graph_lock);
+    *out = s_graph.records[id];
+    portEXIT_CRITICAL(&s_graph_lock);
+}
+
+int64_t init_graph_done_us(uint32_t stages)
+{
+    int64_t last = 0;
+    for (int i = 0; i < s_graph.count; i++) {
+        if (!(stages & INIT_STAGE_BIT(i))) continue;
+
+        init_stage_record_t rec;
+        init_graph_get_record(i, &rec);
+        if (rec.state < INIT_STAGE_OK) return 0;
+        if (rec.end_us > last) last = rec.end_us;
+    }
+    return last;
+}
+
+void init_graph_log_timeline(void)
+{
+    ESP_LOGI(TAG, "Boot timeline (ms since boot):");
+    ESP_LOGI(TAG, "  %-10s %8s %8s %8s  %s", "stage", "start", "end", "took", "result");
+
+    for (int i = 0; i < s_graph.count; i++) {
+        init_stage_record_t rec;
+        init_graph_get_record(i, &rec);
+
+        int64_t start = rec.start_us / 100, end = rec.end_us / 100;   // 0.1 ms
+        int64_t took = (rec.state >= INIT_STAGE_OK) ? end - start : 0;
+        if (rec.state < INIT_STAGE_OK) end = 0;
+
+        ESP_LOGI(TAG, "  %-10s %6lld.%lld %6lld.%lld %6lld.%lld  %s%s%s",
+                 s_graph.stages[i].name,
+                 start / 10, start % 10, end / 10, end % 10, took / 10, took % 10,
+                 STATE_NAMES[rec.state],
+                 (rec.state == INIT_STAGE_FAILED) ? " " : "",
+                 (rec.state == INIT_STAGE_FAILED) ? esp_err_to_name(rec.result) : "");
+    }
+}
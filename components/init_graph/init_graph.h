@@ -0,0 +1,123 @@
+/**
+ * @file init_graph.h
+ * @brief Boot-time subsystem bring-up with declared dependencies
+ *
+ * Each stage names the stages it needs; stages whose prerequisites are
+ * done run concurrently, each in its own short-lived worker task:
+ *
+ *   nvs ──► wifi ──► remo          memory ──► audio, led
+ *        └─────────┘               memory ──► display ──► ui
+ *                                  sensors (independent)
+ *
+ *   - A stage starts as soon as all of its dependencies succeeded
+ *   - A failed stage skips everything that depends on it
+ *   - Start / end of every stage is recorded for the boot timeline
+ *
+ * Stages are listed in dependency order (a stage may only depend on
+ * stages before it), which rules out cycles.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define INIT_GRAPH_MAX_STAGES       24      // One event group bit each
+
+_Static_assert(INIT_GRAPH_MAX_STAGES <= 24, "event groups carry 24 usable bits");
+
+#define INIT_STAGE_BIT(id)          (1u << (id))
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Stage body (runs in the stage's worker task)
+ */
+typedef esp_err_t (*init_stage_fn_t)(void);
+
+/**
+ * @brief Stage descriptor (the table must outlive the boot)
+ */
+typedef struct {
+    const char *name;
+    init_stage_fn_t fn;
+    uint32_t deps;              // INIT_STAGE_BIT() of earlier stages
+    uint32_t stack;             // Worker stack (bytes)
+    uint8_t priority;           // Worker priority
+} init_stage_t;
+
+/**
+ * @brief Stage outcome
+ */
+typedef enum {
+    INIT_STAGE_PENDING = 0,
+    INIT_STAGE_RUNNING,
+    INIT_STAGE_OK,
+    INIT_STAGE_FAILED,
+    INIT_STAGE_SKIPPED,         // A dependency failed
+} init_stage_state_t;
+
+/**
+ * @brief Stage timeline entry (times since boot)
+ */
+typedef struct {
+    init_stage_state_t state;
+    esp_err_t result;
+    int64_t start_us;
+    int64_t end_us;
+} init_stage_record_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Start bringing up all stages (returns immediately)
+ *
+ * @param stages Stage table, in dependency order
+ * @param count  Number of stages (<= INIT_GRAPH_MAX_STAGES)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG for a bad table, ESP_ERR_NO_MEM
+ */
+esp_err_t init_graph_start(const init_stage_t *stages, int count);
+
+/**
+ * @brief Wait until the given stages have finished
+ *
+ * @param stages  INIT_STAGE_BIT() mask
+ * @param timeout Ticks to wait
+ * @return true if all of them succeeded; false if one failed, was
+ *         skipped, or the wait timed out
+ */
+bool init_graph_wait(uint32_t stages, TickType_t timeout);
+
+/**
+ * @brief Timeline entry of one stage
+ */
+void init_graph_get_record(int id, init_stage_record_t *out);
+
+/**
+ * @brief When the last of the given stages finished (us since boot, 0 if
+ *        one has not finished yet)
+ */
+int64_t init_graph_done_us(uint32_t stages);
+
+/**
+ * @brief Log the per-stage boot timeline
+ */
+void init_graph_log_timeline(void);
+
+#ifdef __cplusplus
+}
+#endif
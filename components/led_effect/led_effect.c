@@ -8,7 +8,10 @@
 #include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "driver/rmt_tx.h"
+#include "mem_arena.h"
+#include "esp_attr.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "sdkconfig.h"
@@ -27,6 +30,10 @@ static const char *TAG = "led_effect";
 
 #define RMT_LED_STRIP_RESOLUTION_HZ 10000000  // 10MHz
 
+#define LED_FRAME_MS            20          // Animations: 50 Hz
+#define LED_IDLE_FRAME_MS       250         // Static frame: only look for changes
+#define LED_TX_TIMEOUT_MS       100         // Frame is ~1 ms on the wire
+
 // ============================================================================
 // Internal State
 // ============================================================================
@@ -38,6 +45,14 @@ typedef struct {
     led_color_t *pixels;
     int led_count;
     uint8_t brightness;
+    uint8_t lut[256];           // Gamma + brightness, per channel value
+
+    // GRB frames: one on the wire (or last sent), one being encoded
+    uint8_t *grb[2];
+    int back;                   // Index encoded into next
+    bool has_sent;              // grb[back ^ 1] is what the strip shows
+    volatile bool tx_busy;
+    SemaphoreHandle_t tx_done;  // Given by the RMT done callback
 
     led_mode_t mode;
     led_mode_t prev_mode;
@@ -48,12 +63,15 @@ typedef struct {
     uint32_t frame_count;
     float phase;
     float audio_level;
+    uint8_t audio_bands[LED_AUDIO_MAX_BANDS];  // Low band first, 0-255
+    int audio_band_count;
 
     // Flash state
     bool flash_active;
     led_color_t flash_color;
     int flash_count;
 
+    bool enabled;               // RMT channel enabled
     bool initialized;
 } led_state_t;
 
@@ -138,15 +156,15 @@ static esp_err_t rmt_new_led_strip_encoder(rmt_encoder_handle_t *ret_encoder)
     rmt_bytes_encoder_config_t bytes_config = {
         .bit0 = {
             .level0 = 1,
-            .duration0 = WS2812_T0H_NS * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000,
+            .duration0 = WS2812_T0H_NS * (RMT_LED_STRIP_RESOLUTION_HZ / 1000000) / 1000,
             .level1 = 0,
-            .duration1 = WS2812_T0L_NS * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000,
+            .duration1 = WS2812_T0L_NS * (RMT_LED_STRIP_RESOLUTION_HZ / 1000000) / 1000,
         },
         .bit1 = {
             .level0 = 1,
-            .duration0 = WS2812_T1H_NS * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000,
+            .duration0 = WS2812_T1H_NS * (RMT_LED_STRIP_RESOLUTION_HZ / 1000000) / 1000,
             .level1 = 0,
-            .duration1 = WS2812_T1L_NS * RMT_LED_STRIP_RESOLUTION_HZ / 1000000000,
+            .duration1 = WS2812_T1L_NS * (RMT_LED_STRIP_RESOLUTION_HZ / 1000000) / 1000,
         },
         .flags.msb_first = 1,
     };
@@ -169,9 +187,9 @@ static esp_err_t rmt_new_led_strip_encoder(rmt_encoder_handle_t *ret_encoder)
     // Reset code
     led_encoder->reset_code = (rmt_symbol_word_t){
         .level0 = 0,
-        .duration0 = WS2812_RESET_US * RMT_LED_STRIP_RESOLUTION_HZ / 1000000,
+        .duration0 = WS2812_RESET_US * (RMT_LED_STRIP_RESOLUTION_HZ / 1000000),
         .level1 = 0,
-        .duration1 = WS2812_RESET_US * RMT_LED_STRIP_RESOLUTION_HZ / 1000000,
+        .duration1 = WS2812_RESET_US * (RMT_LED_STRIP_RESOLUTION_HZ / 1000000),
     };
 
     *ret_encoder = &led_encoder->base;
@@ -202,28 +220,73 @@ static led_color_t blend_colors(led_color_t c1, led_color_t c2, float t)
     };
 }
 
-static void write_pixels_to_strip(void)
+/**
+ * @brief Rebuild the gamma + brightness table (no per-pixel divides)
+ */
+static void build_lut(uint8_t brightness)
+{
+    const float gamma = CONFIG_LED_STRIP_GAMMA_X10 / 10.0f;
+    for (int i = 0; i < 256; i++) {
+        s_led.lut[i] = (uint8_t)(powf(i / 255.0f, gamma) * brightness + 0.5f);
+    }
+}
+
+static bool IRAM_ATTR on_tx_done(rmt_channel_handle_t channel, const rmt_tx_done_event_data_t *edata,
+                                 void *user_ctx)
+{
+    BaseType_t woken = pdFALSE;
+    s_led.tx_busy = false;
+    xSemaphoreGiveFromISR(s_led.tx_done, &woken);
+    return woken == pdTRUE;
+}
+
+static bool wait_tx_idle(uint32_t timeout_ms)
+{
+    // tx_done may hold a give from an earlier frame; tx_busy is the truth
+    while (s_led.tx_busy) {
+        if (xSemaphoreTake(s_led.tx_done, pdMS_TO_TICKS(timeout_ms)) != pdTRUE) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Encode the frame and start transmitting it (non-blocking)
+ *
+ * At most one frame is in flight, so the back buffer is never the one
+ * the RMT is reading. An unchanged frame is not sent unless forced; a
+ * frame that finds the previous one still on the wire is dropped and
+ * re-rendered on the next update.
+ */
+static void write_pixels_to_strip(bool force)
 {
     if (!s_led.initialized || !s_led.rmt_channel) return;
+    if (s_led.tx_busy) return;
 
     // Convert to GRB format for WS2812B
-    uint8_t *grb_data = malloc(s_led.led_count * 3);
-    if (!grb_data) return;
-
+    size_t len = s_led.led_count * 3;
+    uint8_t *grb_data = s_led.grb[s_led.back];
     for (int i = 0; i < s_led.led_count; i++) {
-        led_color_t c = scale_brightness(s_led.pixels[i], s_led.brightness);
-        grb_data[i * 3 + 0] = c.g;
-        grb_data[i * 3 + 1] = c.r;
-        grb_data[i * 3 + 2] = c.b;
+        led_color_t c = s_led.pixels[i];
+        grb_data[i * 3 + 0] = s_led.lut[c.g];
+        grb_data[i * 3 + 1] = s_led.lut[c.r];
+        grb_data[i * 3 + 2] = s_led.lut[c.b];
+    }
+
+    if (!force && s_led.has_sent && memcmp(grb_data, s_led.grb[s_led.back ^ 1], len) == 0) {
+        return;
     }
 
     rmt_transmit_config_t tx_config = {
         .loop_count = 0,
     };
-    rmt_transmit(s_led.rmt_channel, s_led.encoder, grb_data, s_led.led_count * 3, &tx_config);
-    rmt_tx_wait_all_done(s_led.rmt_channel, portMAX_DELAY);
+    s_led.tx_busy = true;
+    if (rmt_transmit(s_led.rmt_channel, s_led.encoder, grb_data, len, &tx_config) != ESP_OK) {
+        s_led.tx_busy = false;
+        return;
+    }
 
-    free(grb_data);
+    s_led.back ^= 1;
+    s_led.has_sent = true;
 }
 
 // ============================================================================
@@ -248,13 +311,14 @@ static void effect_breathing(void)
 
 static void effect_listening(void)
 {
-    // Wave effect spreading from center
+    // Wave effect spreading from center, swelling with the voice
     int center = s_led.led_count / 2;
+    float swell = 0.35f + 0.65f * s_led.audio_level;
 
     for (int i = 0; i < s_led.led_count; i++) {
         float dist = fabsf((float)(i - center)) / center;
         float wave = sinf(s_led.phase - dist * M_PI);
-        wave = (wave + 1.0f) / 2.0f;
+        wave = (wave + 1.0f) / 2.0f * swell;
 
         s_led.pixels[i] = blend_colors(LED_COLOR_OFF, s_led.secondary_color, wave);
     }
@@ -294,7 +358,14 @@ static void effect_speaking(void)
 
         if (lit) {
             float t = (float)dist_from_center / (s_led.led_count / 2);
-            s_led.pixels[i] = blend_colors(s_led.primary_color, s_led.secondary_color, t);
+            led_color_t c = blend_colors(s_led.primary_color, s_led.secondary_color, t);
+
+            // Bass at the center, treble at the edges
+            if (s_led.audio_band_count > 0) {
+                int band = (int)(t * (s_led.audio_band_count - 1) + 0.5f);
+                c = scale_brightness(c, 64 + (s_led.audio_bands[band] * 191) / 255);
+            }
+            s_led.pixels[i] = c;
         } else {
             s_led.pixels[i] = LED_COLOR_OFF;
         }
@@ -364,6 +435,18 @@ esp_err_t led_effect_init_config(const led_effect_config_t *config)
     s_led.brightness = config->brightness;
     s_led.primary_color = config->primary_color;
     s_led.secondary_color = config->secondary_color;
+    build_lut(s_led.brightness);
+
+    // Frame buffers: internal DMA arena slabs, reused on re-init
+    s_led.tx_done = xSemaphoreCreateBinary();
+    for (int i = 0; i < 2; i++) {
+        s_led.grb[i] = mem_arena_acquire(MEM_REGION_DMA, i ? "led_grb1" : "led_grb0",
+                                         (size_t)config->led_count * 3);
+    }
+    if (!s_led.tx_done || !s_led.grb[0] || !s_led.grb[1]) {
+        led_effect_deinit();
+        return ESP_ERR_NO_MEM;
+    }
 
     // Configure RMT TX channel
     rmt_tx_channel_config_t tx_config = {
@@ -376,24 +459,27 @@ esp_err_t led_effect_init_config(const led_effect_config_t *config)
 
     esp_err_t ret = rmt_new_tx_channel(&tx_config, &s_led.rmt_channel);
     if (ret != ESP_OK) {
-        free(s_led.pixels);
+        s_led.rmt_channel = NULL;
+        led_effect_deinit();
         return ret;
     }
 
-    // Create encoder
-    ret = rmt_new_led_strip_encoder(&s_led.encoder);
-    if (ret != ESP_OK) {
-        rmt_del_channel(s_led.rmt_channel);
-        free(s_led.pixels);
-        return ret;
+    rmt_tx_event_callbacks_t cbs = {
+        .on_trans_done = on_tx_done,
+    };
+    ret = rmt_tx_register_event_callbacks(s_led.rmt_channel, &cbs, NULL);
+    if (ret == ESP_OK) {
+        // Create encoder
+        ret = rmt_new_led_strip_encoder(&s_led.encoder);
+        if (ret != ESP_OK) s_led.encoder = NULL;
+    }
+    if (ret == ESP_OK) {
+        // Enable channel
+        ret = rmt_enable(s_led.rmt_channel);
+        if (ret == ESP_OK) s_led.enabled = true;
     }
-
-    // Enable channel
-    ret = rmt_enable(s_led.rmt_channel);
     if (ret != ESP_OK) {
-        rmt_del_encoder(s_led.encoder);
-        rmt_del_channel(s_led.rmt_channel);
-        free(s_led.pixels);
+        led_effect_deinit();
         return ret;
     }
 
@@ -410,13 +496,15 @@ esp_err_t led_effect_init_config(const led_effect_config_t *config)
 
 void led_effect_deinit(void)
 {
-    if (!s_led.initialized) return;
-
-    led_effect_clear();
-    led_effect_refresh();
+    // Also unwinds a partially failed init
+    if (s_led.initialized) {
+        led_effect_clear();
+        led_effect_refresh();
+        wait_tx_idle(LED_TX_TIMEOUT_MS);
+    }
 
     if (s_led.rmt_channel) {
-        rmt_disable(s_led.rmt_channel);
+        if (s_led.enabled) rmt_disable(s_led.rmt_channel);
         rmt_del_channel(s_led.rmt_channel);
     }
 
@@ -424,6 +512,13 @@ void led_effect_deinit(void)
         rmt_del_encoder(s_led.encoder);
     }
 
+    for (int i = 0; i < 2; i++) {
+        mem_arena_release(s_led.grb[i]);
+    }
+    if (s_led.tx_done) {
+        vSemaphoreDelete(s_led.tx_done);
+    }
+
     if (s_led.pixels) {
         free(s_led.pixels);
     }
@@ -448,7 +543,7 @@ void led_effect_update(void)
         } else {
             s_led.flash_active = false;
         }
-        write_pixels_to_strip();
+        write_pixels_to_strip(false);
         s_led.frame_count++;
         return;
     }
@@ -490,7 +585,7 @@ void led_effect_update(void)
         break;
     }
 
-    write_pixels_to_strip();
+    write_pixels_to_strip(false);
     s_led.frame_count++;
 }
 
@@ -511,7 +606,9 @@ led_mode_t led_effect_get_mode(void)
 
 void led_effect_set_brightness(uint8_t brightness)
 {
+    if (brightness == s_led.brightness) return;
     s_led.brightness = brightness;
+    build_lut(brightness);
 }
 
 void led_effect_set_primary_color(led_color_t color)
@@ -559,7 +656,11 @@ void led_effect_clear(void)
 
 void led_effect_refresh(void)
 {
-    write_pixels_to_strip();
+    if (!s_led.initialized) return;
+
+    // Let the frame on the wire finish (~1 ms) rather than drop this one
+    wait_tx_idle(LED_TX_TIMEOUT_MS);
+    write_pixels_to_strip(true);
 }
 
 void led_effect_set_audio_level(float level)
@@ -568,3 +669,29 @@ void led_effect_set_audio_level(float level)
     if (level > 1) level = 1;
     s_led.audio_level = level;
 }
+
+void led_effect_set_audio_bands(const uint8_t *bands, int count)
+{
+    if (!bands || count <= 0) {
+        s_led.audio_band_count = 0;
+        return;
+    }
+    if (count > LED_AUDIO_MAX_BANDS) count = LED_AUDIO_MAX_BANDS;
+    memcpy(s_led.audio_bands, bands, count);
+    s_led.audio_band_count = count;
+}
+
+uint32_t led_effect_frame_interval_ms(void)
+{
+    if (s_led.flash_active) return LED_FRAME_MS;
+
+    switch (s_led.mode) {
+    case LED_MODE_OFF:
+    case LED_MODE_SUCCESS:
+    case LED_MODE_ERROR:
+    case LED_MODE_CUSTOM:
+        return LED_IDLE_FRAME_MS;
+    default:
+        return LED_FRAME_MS;
+    }
+}
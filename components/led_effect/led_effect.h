@@ -8,6 +8,10 @@
  * - Thinking: Rotating animation during processing
  * - Speaking: Visualization during TTS output
  * - Error: Flash red on errors
+ *
+ * Frames go through a gamma + brightness table into two preallocated GRB
+ * buffers and are transmitted without waiting; a frame identical to the
+ * one on the strip is not sent at all.
  */
 
 #pragma once
@@ -20,6 +24,8 @@
 extern "C" {
 #endif
 
+#define LED_AUDIO_MAX_BANDS     16          // led_effect_set_audio_bands()
+
 // ============================================================================
 // LED Effect Modes
 // ============================================================================
@@ -106,10 +112,20 @@ void led_effect_deinit(void);
 /**
  * @brief Update LED animation (call from LED task)
  *
- * This should be called at ~50Hz for smooth animations.
+ * Call every led_effect_frame_interval_ms(): ~50Hz while animating.
  */
 void led_effect_update(void);
 
+/**
+ * @brief Update period the current mode needs
+ *
+ * Static modes (off, success, error, custom) return a long interval so
+ * the LED task sleeps instead of re-rendering an unchanged frame.
+ *
+ * @return Milliseconds until the next led_effect_update()
+ */
+uint32_t led_effect_frame_interval_ms(void);
+
 /**
  * @brief Set LED effect mode
  * @param mode Effect mode
@@ -179,6 +195,13 @@ void led_effect_refresh(void);
  */
 void led_effect_set_audio_level(float level);
 
+/**
+ * @brief Set spectrum bands for the visualizer effect
+ * @param bands Band levels (0-255), low band first
+ * @param count Number of bands (up to LED_AUDIO_MAX_BANDS, 0 = level only)
+ */
+void led_effect_set_audio_bands(const uint8_t *bands, int count);
+
 #ifdef __cplusplus
 }
 #endif
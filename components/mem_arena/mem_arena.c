@@ -0,0 +1,284 @@
+/**
+ * @file mem_arena.c
+ * @brief Boot-sized regions and named slab table implementation
+ */
+
+#include "mem_arena.h"
+#include <string.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+
+static const char *TAG = "mem_arena";
+
+#ifndef CONFIG_MEM_ARENA_DMA_KB
+#define CONFIG_MEM_ARENA_DMA_KB             16
+#endif
+#ifndef CONFIG_MEM_ARENA_PSRAM_KB
+#define CONFIG_MEM_ARENA_PSRAM_KB           384
+#endif
+#ifndef CONFIG_MEM_ARENA_PSRAM_ALIGNED_KB
+#define CONFIG_MEM_ARENA_PSRAM_ALIGNED_KB   0
+#endif
+
+// ============================================================================
+// Region Table
+// ============================================================================
+
+typedef struct {
+    const char *name;
+    uint32_t caps;
+    size_t align;
+    size_t budget;
+} region_cfg_t;
+
+static const region_cfg_t REGION_CFG[MEM_REGION_COUNT] = {
+    [MEM_REGION_DMA] = {
+        "dma", MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT, 16,
+        CONFIG_MEM_ARENA_DMA_KB * 1024,
+    },
+    [MEM_REGION_PSRAM] = {
+        "psram", MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, 16,
+        CONFIG_MEM_ARENA_PSRAM_KB * 1024,
+    },
+    [MEM_REGION_PSRAM_ALIGNED] = {
+        "psram_aligned", MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT, 64,
+        CONFIG_MEM_ARENA_PSRAM_ALIGNED_KB * 1024,
+    },
+};
+
+// ============================================================================
+// State
+// ============================================================================
+
+typedef struct {
+    char name[MEM_ARENA_NAME_LEN];
+    uint8_t *ptr;
+    size_t size;
+    mem_region_t region;
+    bool in_use;
+    bool overflow;              // Heap fallback
+} slab_t;
+
+typedef struct {
+    uint8_t *base;
+    size_t budget;
+    size_t carved;
+    size_t in_use;
+    size_t high_water;
+    size_t overflow;
+    uint8_t slabs;
+} region_t;
+
+typedef struct {
+    bool initialized;
+    region_t regions[MEM_REGION_COUNT];
+    slab_t slabs[MEM_ARENA_MAX_SLABS];
+    int slab_count;
+} mem_arena_state_t;
+
+static mem_arena_state_t s_arena = {0};
+static portMUX_TYPE s_arena_lock = portMUX_INITIALIZER_UNLOCKED;   // regions[], slabs[]
+
+static size_t align_up(size_t v, size_t align)
+{
+    return (v + align - 1) & ~(align - 1);
+}
+
+static slab_t *find_slab(const char *name)
+{
+    for (int i = 0; i < s_arena.slab_count; i++) {
+        slab_t *slab = &s_arena.slabs[i];
+        if (slab->name[0] && strncmp(slab->name, name, MEM_ARENA_NAME_LEN - 1) == 0) {
+            return slab;
+        }
+    }
+    return NULL;
+}
+
+static void mark_acquired(slab_t *slab)
+{
+    region_t *r = &s_arena.regions[slab->region];
+    slab->in_use = true;
+    r->in_use += slab->size;
+    if (r->in_use > r->high_water) r->high_water = r->in_use;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t mem_arena_init(void)
+{
+    if (s_arena.initialized) return ESP_OK;
+
+    esp_err_t result = ESP_OK;
+    for (int i = 0; i < MEM_REGION_COUNT; i++) {
+        const region_cfg_t *cfg = &REGION_CFG[i];
+        region_t *r = &s_arena.regions[i];
+        if (cfg->budget == 0) continue;
+
+        r->base = heap_caps_aligned_alloc(cfg->align, cfg->budget, cfg->caps);
+        if (!r->base) {
+            ESP_LOGW(TAG, "Could not reserve %s region (%u KB), using heap",
+                     cfg->name, (unsigned)(cfg->budget / 1024));
+            result = ESP_ERR_NO_MEM;
+            continue;
+        }
+        r->budget = cfg->budget;
+    }
+
+    s_arena.initialized = true;
+    ESP_LOGI(TAG, "Reserved dma %u KB, psram %u KB, psram_aligned %u KB",
+             (unsigned)(s_arena.regions[MEM_REGION_DMA].budget / 1024),
+             (unsigned)(s_arena.regions[MEM_REGION_PSRAM].budget / 1024),
+             (unsigned)(s_arena.regions[MEM_REGION_PSRAM_ALIGNED].budget / 1024));
+    return result;
+}
+
+void *mem_arena_acquire(mem_region_t region, const char *name, size_t size)
+{
+    if (region >= MEM_REGION_COUNT || !name || !name[0] || size == 0) return NULL;
+
+    const region_cfg_t *cfg = &REGION_CFG[region];
+    size = align_up(size, cfg->align);
+
+    // Reuse or carve under the lock; heap fallback happens outside it
+    portENTER_CRITICAL(&s_arena_lock);
+    slab_t *slab = find_slab(name);
+    if (slab) {
+        bool busy = slab->in_use;
+        bool fits = slab->region == region && size <= slab->size;
+        if (!busy && fits) mark_acquired(slab);
+        portEXIT_CRITICAL(&s_arena_lock);
+
+        if (busy) {
+            ESP_LOGE(TAG, "Slab '%s' already acquired", name);
+            return NULL;
+        }
+        if (!fits) {
+            ESP_LOGE(TAG, "Slab '%s' is %u B in %s, requested %u B in %s", name,
+                     (unsigned)slab->size, REGION_CFG[slab->region].name,
+                     (unsigned)size, cfg->name);
+            return NULL;
+        }
+        memset(slab->ptr, 0, slab->size);
+        return slab->ptr;
+    }
+
+    if (s_arena.slab_count >= MEM_ARENA_MAX_SLABS) {
+        portEXIT_CRITICAL(&s_arena_lock);
+        ESP_LOGE(TAG, "Slab table full, '%s' not allocated", name);
+        return NULL;
+    }
+
+    region_t *r = &s_arena.regions[region];
+    uint8_t *ptr = NULL;
+    if (r->base && r->carved + size <= r->budget) {
+        ptr = r->base + r->carved;
+        r->carved += size;
+    }
+
+    // Claim the entry now so a concurrent acquire of the same name fails
+    slab = &s_arena.slabs[s_arena.slab_count++];
+    strncpy(slab->name, name, MEM_ARENA_NAME_LEN - 1);
+    slab->name[MEM_ARENA_NAME_LEN - 1] = '\0';
+    slab->ptr = ptr;
+    slab->size = size;
+    slab->region = region;
+    slab->overflow = (ptr == NULL);
+    r->slabs++;
+    if (ptr) mark_acquired(slab);
+    else slab->in_use = true;
+    portEXIT_CRITICAL(&s_arena_lock);
+
+    if (!ptr) {
+        ptr = heap_caps_aligned_alloc(cfg->align, size, cfg->caps);
+        if (ptr) {
+            ESP_LOGW(TAG, "'%s' (%u B) over the %s budget, from heap",
+                     name, (unsigned)size, cfg->name);
+        } else {
+            ESP_LOGE(TAG, "'%s' (%u B): out of %s memory", name, (unsigned)size, cfg->name);
+        }
+
+        portENTER_CRITICAL(&s_arena_lock);
+        slab->ptr = ptr;
+        if (ptr) {
+            r->overflow += size;
+            slab->in_use = false;
+            mark_acquired(slab);
+        } else {
+            // Unnamed tombstone: the name stays free for a retry
+            slab->name[0] = '\0';
+            slab->size = 0;
+            slab->in_use = false;
+            r->slabs--;
+        }
+        portEXIT_CRITICAL(&s_arena_lock);
+        if (!ptr) return NULL;
+    }
+
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void mem_arena_release(void *ptr)
+{
+    if (!ptr) return;
+
+    portENTER_CRITICAL(&s_arena_lock);
+    for (int i = 0; i < s_arena.slab_count; i++) {
+        slab_t *slab = &s_arena.slabs[i];
+        if (slab->ptr == ptr && slab->in_use) {
+            slab->in_use = false;
+            s_arena.regions[slab->region].in_use -= slab->size;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&s_arena_lock);
+}
+
+void mem_arena_get_stats(mem_region_t region, mem_arena_stats_t *out)
+{
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    if (region >= MEM_REGION_COUNT) return;
+
+    portENTER_CRITICAL(&s_arena_lock);
+    const region_t *r = &s_arena.regions[region];
+    out->budget = r->budget;
+    out->carved = r->carved;
+    out->in_use = r->in_use;
+    out->high_water = r->high_water;
+    out->overflow = r->overflow;
+    out->slabs = r->slabs;
+    portEXIT_CRITICAL(&s_arena_lock);
+}
+
+void mem_arena_log(void)
+{
+    ESP_LOGI(TAG, "  %-14s %8s %8s %8s %8s %8s", "region", "budget", "carved",
+             "in_use", "peak", "overflow");
+    for (int i = 0; i < MEM_REGION_COUNT; i++) {
+        mem_arena_stats_t st;
+        mem_arena_get_stats(i, &st);
+        ESP_LOGI(TAG, "  %-14s %8u %8u %8u %8u %8u", REGION_CFG[i].name,
+                 (unsigned)st.budget, (unsigned)st.carved, (unsigned)st.in_use,
+                 (unsigned)st.high_water, (unsigned)st.overflow);
+    }
+
+    for (int i = 0; i < MEM_ARENA_MAX_SLABS; i++) {
+        slab_t slab;
+        portENTER_CRITICAL(&s_arena_lock);
+        bool valid = i < s_arena.slab_count;
+        if (valid) slab = s_arena.slabs[i];
+        portEXIT_CRITICAL(&s_arena_lock);
+        if (!valid) break;
+        if (slab.size == 0) continue;
+
+        ESP_LOGI(TAG, "    %-15s %-14s %7u B %s%s", slab.name, REGION_CFG[slab.region].name,
+                 (unsigned)slab.size, slab.in_use ? "in use" : "free",
+                 slab.overflow ? " (heap)" : "");
+    }
+}
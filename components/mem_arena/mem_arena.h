@@ -0,0 +1,110 @@
+/**
+ * @file mem_arena.h
+ * @brief Boot-sized memory regions with named, reusable slabs
+ *
+ * Long-lived buffers come out of three regions that are reserved once at
+ * boot from the Kconfig memory budget, so internal RAM does not fragment
+ * as subsystems stop and start:
+ *
+ *   DMA            internal, DMA-capable (I2S staging, LED frames, AEC ref)
+ *   PSRAM          bulk (audio rings)
+ *   PSRAM_ALIGNED  cache-line aligned (LVGL strip buffers for DMA2D / PPA)
+ *
+ * Slabs are carved on first acquire and never returned to the heap: a
+ * released slab is handed back to the next acquire with the same name,
+ * so a restart (USB reconnect, pipeline re-init) reuses its memory.
+ *
+ *   acquire("mic_rx", n) ──► carve (first time) or reuse ──► zeroed slab
+ *   release(ptr)         ──► slab kept for the next acquire("mic_rx")
+ *
+ * A request that does not fit the region falls back to the heap with the
+ * region's capabilities and is counted as overflow (raise the budget).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define MEM_ARENA_MAX_SLABS     24
+#define MEM_ARENA_NAME_LEN      16
+
+/**
+ * @brief Memory regions
+ */
+typedef enum {
+    MEM_REGION_DMA = 0,         // Internal, DMA-capable
+    MEM_REGION_PSRAM,           // PSRAM bulk
+    MEM_REGION_PSRAM_ALIGNED,   // PSRAM, cache-line aligned
+    MEM_REGION_COUNT
+} mem_region_t;
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Region usage (bytes)
+ */
+typedef struct {
+    size_t budget;              // Reserved at boot
+    size_t carved;              // Handed out to slabs so far
+    size_t in_use;              // Slabs currently acquired
+    size_t high_water;          // Highest in_use
+    size_t overflow;            // Slabs that fell back to the heap
+    uint8_t slabs;
+} mem_arena_stats_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Reserve all regions (once, before the first acquire)
+ *
+ * A region that cannot be reserved is left empty; its slabs then come
+ * from the heap.
+ *
+ * @return ESP_OK, or ESP_ERR_NO_MEM if a region could not be reserved
+ */
+esp_err_t mem_arena_init(void);
+
+/**
+ * @brief Acquire a named slab (zeroed)
+ *
+ * @param region Region to carve from
+ * @param name   Unique slab name (copied, truncated to MEM_ARENA_NAME_LEN - 1)
+ * @param size   Bytes; must not exceed the size of an existing slab
+ * @return Slab, or NULL (out of memory, name in use or too small)
+ */
+void *mem_arena_acquire(mem_region_t region, const char *name, size_t size);
+
+/**
+ * @brief Release a slab for reuse by the next acquire of its name
+ * @param ptr Slab from mem_arena_acquire() (NULL is ignored)
+ */
+void mem_arena_release(void *ptr);
+
+/**
+ * @brief Copy a region's usage
+ */
+void mem_arena_get_stats(mem_region_t region, mem_arena_stats_t *out);
+
+/**
+ * @brief Log usage per region and the slab table
+ */
+void mem_arena_log(void);
+
+#ifdef __cplusplus
+}
+#endif
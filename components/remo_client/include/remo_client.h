@@ -6,9 +6,15 @@
  * Uses mDNS for auto-discovery and HTTP POST for IR signal transmission.
  *
  * Features:
- * - mDNS discovery of Nature Remo devices (_remo._tcp)
+ * - mDNS discovery of Nature Remo devices (_remo._tcp), cached in NVS and
+ *   refreshed in the background: boot never waits for discovery, and a
+ *   send that cannot reach the Remo starts an mDNS browse that picks up a
+ *   new DHCP address
  * - SPIFFS-based appliance configuration
  * - Offline operation (no cloud required)
+ * - Worker task with a persistent keep-alive connection: callers (UI,
+ *   voice commands) only enqueue, a press of a command that is still
+ *   pending is merged into it
  */
 
 #pragma once
@@ -65,6 +71,66 @@ typedef struct {
     int signal_count;
 } remo_appliance_t;
 
+/**
+ * @brief Outcome of one IR command
+ *
+ * The stages split the time so a slow Remo (IR emission) can be told
+ * apart from a slow network (connect).
+ */
+typedef struct {
+    esp_err_t result;                   // ESP_OK if the Remo answered 200
+    int http_status;                    // 0 if no response
+    bool reused_connection;             // Sent on the kept-alive connection
+    uint32_t queue_ms;                  // Enqueue -> worker picked it up
+    uint32_t connect_ms;                // TCP connect (0 when reused)
+    uint32_t response_ms;               // Request sent -> response headers
+    uint32_t total_ms;                  // Enqueue -> completion
+} remo_send_result_t;
+
+/**
+ * @brief Completion callback (runs on the Remo worker task)
+ *
+ * Must not block; take display_manager_lock() before touching LVGL.
+ */
+typedef void (*remo_send_cb_t)(const remo_send_result_t *result, void *user_ctx);
+
+/**
+ * @brief Latency of one stage (EWMA average)
+ */
+typedef struct {
+    uint32_t last_ms;
+    uint32_t avg_ms;
+    uint32_t max_ms;
+} remo_latency_t;
+
+/**
+ * @brief Worker statistics
+ */
+typedef struct {
+    uint32_t sent;                      // Answered 200
+    uint32_t failed;                    // Transport error or non-200
+    uint32_t coalesced;                 // Presses merged into a pending command
+    uint32_t dropped;                   // Rejected, queue full
+    uint32_t connections;               // TCP connections opened
+    uint32_t retries;                   // Retried on a fresh connection
+    uint8_t pending;                    // Currently queued or in flight
+    remo_latency_t queue;
+    remo_latency_t connect;             // Fresh connections only
+    remo_latency_t response;
+    remo_latency_t total;
+} remo_client_stats_t;
+
+/**
+ * @brief Where the current Remo address came from
+ */
+typedef enum {
+    REMO_ADDR_NONE = 0,
+    REMO_ADDR_HINT,                     // appliances.json remo_ip_hint
+    REMO_ADDR_CACHED,                   // NVS, from a previous boot
+    REMO_ADDR_MDNS,                     // Resolved this boot
+    REMO_ADDR_MANUAL,                   // remo_client_set_ip()
+} remo_addr_source_t;
+
 /**
  * @brief Remo client state
  */
@@ -73,6 +139,9 @@ typedef struct {
     bool remo_found;
     char remo_ip[16];                   // IP address of Nature Remo
     uint16_t remo_port;                 // HTTP port (usually 80)
+    remo_addr_source_t addr_source;
+    bool addr_verified;                 // A request reached the Remo at this address
+    bool discovering;                   // mDNS browse running
     remo_appliance_t appliances[REMO_MAX_APPLIANCES];
     int appliance_count;
 } remo_client_state_t;
@@ -84,7 +153,9 @@ typedef struct {
 /**
  * @brief Initialize Remo client
  *
- * Loads appliance configuration from SPIFFS and starts mDNS discovery.
+ * Loads appliance configuration from SPIFFS and uses the IP hint or the
+ * address cached in NVS right away. Without either, an mDNS browse runs
+ * in the background; this call never waits for discovery.
  *
  * @return ESP_OK on success
  */
@@ -99,7 +170,8 @@ void remo_client_deinit(void);
  * @brief Discover Nature Remo via mDNS
  *
  * Searches for _remo._tcp service on local network.
- * Blocks for up to timeout_ms milliseconds.
+ * Blocks for up to timeout_ms milliseconds. A found address is cached in
+ * NVS. Not needed normally: the client browses in the background.
  *
  * @param timeout_ms Discovery timeout in milliseconds
  * @return ESP_OK if found, ESP_ERR_NOT_FOUND otherwise
@@ -115,14 +187,48 @@ esp_err_t remo_client_discover(uint32_t timeout_ms);
  */
 esp_err_t remo_client_send_quick(const char *appliance_name, const char *signal_name);
 
+/**
+ * @brief Queue an IR signal by appliance / signal name
+ *
+ * Non-blocking; see remo_client_send_signal_async().
+ *
+ * @param appliance_name Name of the appliance
+ * @param signal_name Name of the signal
+ * @param cb Completion callback (may be NULL)
+ * @param user_ctx Passed to cb
+ * @return ESP_OK if queued or merged, ESP_ERR_NOT_FOUND for an unknown
+ *         appliance / signal, ESP_ERR_TIMEOUT if the queue is full
+ */
+esp_err_t remo_client_send_quick_async(const char *appliance_name, const char *signal_name,
+                                       remo_send_cb_t cb, void *user_ctx);
+
 /**
  * @brief Send raw IR signal by ID
  *
+ * Blocks until the Remo answers (up to CONFIG_REMO_HTTP_TIMEOUT_MS per
+ * attempt, after any queued commands). Do not call from the UI.
+ *
  * @param signal_id Signal ID from appliance configuration
  * @return ESP_OK on success
  */
 esp_err_t remo_client_send_signal(const char *signal_id);
 
+/**
+ * @brief Queue a raw IR signal by ID
+ *
+ * Returns immediately; the worker sends it over the kept-alive
+ * connection. If the same signal is still waiting in the queue (a
+ * repeated press), the press is merged into it: it is sent once and cb
+ * is not called for the merged press.
+ *
+ * @param signal_id Signal ID (copied)
+ * @param cb Completion callback (may be NULL)
+ * @param user_ctx Passed to cb
+ * @return ESP_OK if queued or merged, ESP_ERR_INVALID_STATE if no Remo,
+ *         ESP_ERR_TIMEOUT if the queue is full
+ */
+esp_err_t remo_client_send_signal_async(const char *signal_id, remo_send_cb_t cb, void *user_ctx);
+
 /**
  * @brief Get appliance by name
  *
@@ -156,13 +262,20 @@ void remo_client_get_state(remo_client_state_t *state);
 /**
  * @brief Manually set Remo IP address
  *
- * Use this if mDNS discovery fails.
+ * Use this if mDNS discovery fails. The address is cached in NVS.
  *
  * @param ip IP address string (e.g., "192.168.1.100")
  * @return ESP_OK on success
  */
 esp_err_t remo_client_set_ip(const char *ip);
 
+/**
+ * @brief Get worker statistics
+ *
+ * @param stats Output statistics
+ */
+void remo_client_get_stats(remo_client_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -4,14 +4,23 @@
  */
 
 #include "remo_client.h"
+#include "remo_db.h"
 #include <string.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "esp_http_client.h"
 #include "esp_spiffs.h"
+#include "esp_partition.h"
+#include "esp_heap_caps.h"
 #include "mdns.h"
+#include "nvs.h"
+#include "sdkconfig.h"
 #include "cJSON.h"
 
 static const char *TAG = "remo_client";
@@ -20,7 +29,93 @@ static const char *TAG = "remo_client";
 // Internal State
 // ============================================================================
 
-static remo_client_state_t s_remo = {0};
+#define REMO_APPLIANCES_PATH    "/spiffs/appliances.json"
+#define REMO_APPLIANCES_MAX_SIZE 32768
+#define REMO_DB_PARTITION       "appdb"
+#define REMO_NVS_NAMESPACE      "remo"
+#define REMO_NVS_KEY_IP         "ip"
+#define REMO_NVS_KEY_PORT       "port"
+#define REMO_MDNS_SERVICE       "_remo"
+#define REMO_MDNS_PROTO         "_tcp"
+
+typedef struct {
+    bool initialized;
+    bool remo_found;
+    char remo_ip[16];                   // IP address of Nature Remo
+    uint16_t remo_port;                 // HTTP port (usually 80)
+    remo_addr_source_t addr_source;
+    bool addr_verified;
+    mdns_browse_t *browse;              // Background re-discovery
+
+    // Appliance table: mmapped appdb image, or a heap copy without it
+    const remo_db_header_t *db;
+    esp_partition_mmap_handle_t db_mmap;
+    bool db_mapped;
+    remo_db_header_t *db_heap;
+} remo_client_ctx_t;
+
+static remo_client_ctx_t s_remo = {0};
+
+#define REMO_WORKER_STACK       4096
+#define REMO_WORKER_PRIORITY    3
+#define REMO_WORKER_CORE        ((CONFIG_TASK_CORE_HELPER < 0) ? tskNO_AFFINITY : CONFIG_TASK_CORE_HELPER)
+#define REMO_LATENCY_EWMA_SHIFT 3           // avg += (sample - avg) / 8
+
+typedef enum {
+    REMO_SLOT_FREE = 0,
+    REMO_SLOT_QUEUED,                       // Waiting; repeated presses merge here
+    REMO_SLOT_ACTIVE,                       // Owned by the worker
+} remo_slot_state_t;
+
+typedef struct {
+    remo_slot_state_t state;
+    char signal_id[REMO_MAX_SIGNAL_LEN];
+    remo_send_cb_t cb;
+    void *user_ctx;
+    int64_t enqueued_us;
+} remo_request_t;
+
+typedef struct {
+    QueueHandle_t queue;                    // Slot indices, FIFO (one entry per slot)
+    TaskHandle_t task;                      // Woken by task notification
+    SemaphoreHandle_t worker_done;
+    remo_request_t slots[CONFIG_REMO_QUEUE_DEPTH];
+    bool save_pending;                      // Address resolved, persist it
+    bool stop_pending;                      // Exit once the queue is drained
+
+    // Worker-only
+    esp_http_client_handle_t http;
+    char http_ip[16];                       // Endpoint the handle was built for
+    uint16_t http_port;
+    bool http_connected;                    // Handle holds an open connection
+    int64_t connected_us;                   // Per attempt, from the event handler
+    int64_t sent_us;
+    int64_t response_us;
+
+    remo_client_stats_t stats;
+
+    // Blocking sends share one completion
+    SemaphoreHandle_t sync_lock;
+    SemaphoreHandle_t sync_done;
+} remo_worker_t;
+
+static remo_worker_t s_worker = {0};
+static portMUX_TYPE s_worker_lock = portMUX_INITIALIZER_UNLOCKED;   // slots[].state, stats, address, *_pending
+
+/**
+ * @brief Ask the worker to persist the current address
+ * @return false if no worker is running
+ */
+static bool worker_request_save(void)
+{
+    portENTER_CRITICAL(&s_worker_lock);
+    TaskHandle_t task = s_worker.task;
+    if (task) s_worker.save_pending = true;
+    portEXIT_CRITICAL(&s_worker_lock);
+
+    if (task) xTaskNotifyGive(task);
+    return task != NULL;
+}
 
 // ============================================================================
 // SPIFFS Configuration Loader
@@ -54,131 +149,299 @@ static esp_err_t mount_spiffs(void)
     return ESP_OK;
 }
 
-static remo_appliance_type_t parse_type(const char *type_str)
+// ============================================================================
+// Appliance Database
+// ============================================================================
+
+static const remo_db_header_t *map_db(const esp_partition_t *part)
 {
-    if (!type_str) return REMO_TYPE_UNKNOWN;
-    if (strcmp(type_str, "LIGHT") == 0) return REMO_TYPE_LIGHT;
-    if (strcmp(type_str, "AC") == 0) return REMO_TYPE_AC;
-    if (strcmp(type_str, "TV") == 0) return REMO_TYPE_TV;
-    if (strcmp(type_str, "FAN") == 0) return REMO_TYPE_FAN;
-    return REMO_TYPE_OTHER;
+    const void *ptr = NULL;
+    if (esp_partition_mmap(part, 0, part->size, ESP_PARTITION_MMAP_DATA,
+                           &ptr, &s_remo.db_mmap) != ESP_OK) {
+        return NULL;
+    }
+    s_remo.db_mapped = true;
+    return (const remo_db_header_t *)ptr;
 }
 
-static esp_err_t load_appliances_from_spiffs(void)
+static void unmap_db(void)
 {
-    FILE *f = fopen("/spiffs/appliances.json", "r");
-    if (!f) {
-        ESP_LOGW(TAG, "appliances.json not found, using empty config");
-        return ESP_OK;
+    if (s_remo.db_mapped) {
+        esp_partition_munmap(s_remo.db_mmap);
+        s_remo.db_mapped = false;
     }
+    free(s_remo.db_heap);
+    s_remo.db_heap = NULL;
+    s_remo.db = NULL;
+}
 
-    // Get file size
-    fseek(f, 0, SEEK_END);
-    long fsize = ftell(f);
-    fseek(f, 0, SEEK_SET);
+/**
+ * @brief Write a packed image, header last so a torn write stays invalid
+ */
+static esp_err_t write_db(const esp_partition_t *part, const remo_db_header_t *db)
+{
+    if (db->image_size > part->size) return ESP_ERR_INVALID_SIZE;
 
-    if (fsize > 32768) {
+    size_t erase = (db->image_size + part->erase_size - 1) / part->erase_size * part->erase_size;
+    esp_err_t ret = esp_partition_erase_range(part, 0, erase);
+    if (ret == ESP_OK) {
+        ret = esp_partition_write(part, sizeof(*db), db + 1, db->image_size - sizeof(*db));
+    }
+    if (ret == ESP_OK) {
+        ret = esp_partition_write(part, 0, db, sizeof(*db));
+    }
+    return ret;
+}
+
+static void *json_psram_malloc(size_t size)
+{
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+}
+
+static esp_err_t rebuild_db(const esp_partition_t *part, uint32_t hash, uint32_t size)
+{
+    if (size > REMO_APPLIANCES_MAX_SIZE) {
         ESP_LOGE(TAG, "appliances.json too large");
-        fclose(f);
         return ESP_ERR_NO_MEM;
     }
 
-    char *json_str = malloc(fsize + 1);
+    FILE *f = fopen(REMO_APPLIANCES_PATH, "r");
+    if (!f) return ESP_ERR_NOT_FOUND;
+
+    // Source text and parse tree are transient: keep them out of internal RAM
+    char *json_str = heap_caps_malloc(size + 1, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
     if (!json_str) {
         fclose(f);
         return ESP_ERR_NO_MEM;
     }
 
-    fread(json_str, 1, fsize, f);
-    json_str[fsize] = '\0';
+    size_t n = fread(json_str, 1, size, f);
+    json_str[n] = '\0';
     fclose(f);
 
-    // Parse JSON
-    cJSON *root = cJSON_Parse(json_str);
-    free(json_str);
+    // The PSRAM hooks are global to cJSON: restore the default allocator as
+    // soon as the parse tree is gone
+    cJSON_Hooks hooks = { .malloc_fn = json_psram_malloc, .free_fn = heap_caps_free };
+    cJSON_InitHooks(&hooks);
+    remo_db_header_t *db = NULL;
+    esp_err_t ret = remo_db_build(json_str, hash, size, &db);
+    cJSON_InitHooks(NULL);
+    heap_caps_free(json_str);
+    if (ret != ESP_OK) return ret;
+
+    if (part && write_db(part, db) == ESP_OK) {
+        const remo_db_header_t *mapped = map_db(part);
+        if (mapped && remo_db_valid(mapped, part->size)) {
+            free(db);
+            s_remo.db = mapped;
+            return ESP_OK;
+        }
+        unmap_db();
+    }
+
+    // No usable partition: keep the image on the heap
+    ESP_LOGW(TAG, "Appliance image not persisted, using heap copy");
+    s_remo.db_heap = db;
+    s_remo.db = db;
+    return ESP_OK;
+}
 
-    if (!root) {
-        ESP_LOGE(TAG, "Failed to parse appliances.json");
-        return ESP_ERR_INVALID_ARG;
+/**
+ * @brief Load appliances, parsing appliances.json only when it changed
+ *
+ * The JSON is hashed in small chunks and compared with the hash recorded
+ * in the appdb image; on a match the image is used in place.
+ */
+static esp_err_t load_appliances(void)
+{
+    uint32_t hash = 0, size = 0;
+    if (remo_db_hash_file(REMO_APPLIANCES_PATH, &hash, &size) != ESP_OK) {
+        ESP_LOGW(TAG, "appliances.json not found, using empty config");
+        return ESP_OK;
+    }
+
+    const esp_partition_t *part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                           ESP_PARTITION_SUBTYPE_ANY,
+                                                           REMO_DB_PARTITION);
+    if (part) {
+        const remo_db_header_t *mapped = map_db(part);
+        if (mapped && remo_db_valid(mapped, part->size) &&
+            mapped->source_hash == hash && mapped->source_size == size) {
+            s_remo.db = mapped;
+        } else {
+            unmap_db();
+        }
+    } else {
+        ESP_LOGW(TAG, "No %s partition, appliance image kept in RAM", REMO_DB_PARTITION);
+    }
+
+    if (!s_remo.db) {
+        ESP_LOGI(TAG, "appliances.json changed, rebuilding image");
+        esp_err_t ret = rebuild_db(part, hash, size);
+        if (ret != ESP_OK) return ret;
     }
 
     // Check for IP hint
-    cJSON *ip_hint = cJSON_GetObjectItem(root, "remo_ip_hint");
-    if (ip_hint && cJSON_IsString(ip_hint) && strlen(ip_hint->valuestring) > 0) {
-        strncpy(s_remo.remo_ip, ip_hint->valuestring, sizeof(s_remo.remo_ip) - 1);
+    if (s_remo.db->remo_ip_hint[0]) {
+        strncpy(s_remo.remo_ip, s_remo.db->remo_ip_hint, sizeof(s_remo.remo_ip) - 1);
         s_remo.remo_port = 80;
         s_remo.remo_found = true;
+        s_remo.addr_source = REMO_ADDR_HINT;
         ESP_LOGI(TAG, "Using IP hint: %s", s_remo.remo_ip);
     }
 
-    // Parse appliances array
-    cJSON *appliances = cJSON_GetObjectItem(root, "appliances");
-    if (appliances && cJSON_IsArray(appliances)) {
-        int count = 0;
-        cJSON *app;
-        cJSON_ArrayForEach(app, appliances) {
-            if (count >= REMO_MAX_APPLIANCES) break;
+    ESP_LOGI(TAG, "Loaded %d appliances", s_remo.db->appliance_count);
+    return ESP_OK;
+}
 
-            remo_appliance_t *a = &s_remo.appliances[count];
+// ============================================================================
+// Address Cache
+// ============================================================================
 
-            cJSON *id = cJSON_GetObjectItem(app, "id");
-            cJSON *name = cJSON_GetObjectItem(app, "name");
-            cJSON *type = cJSON_GetObjectItem(app, "type");
-            cJSON *signals = cJSON_GetObjectItem(app, "signals");
+/**
+ * @brief Switch to a new Remo address (any task, including mDNS)
+ */
+static void set_address(const char *ip, uint16_t port, remo_addr_source_t source)
+{
+    portENTER_CRITICAL(&s_worker_lock);
+    bool changed = strcmp(s_remo.remo_ip, ip) != 0 || s_remo.remo_port != port;
+    strncpy(s_remo.remo_ip, ip, sizeof(s_remo.remo_ip) - 1);
+    s_remo.remo_port = port;
+    s_remo.remo_found = true;
+    s_remo.addr_source = source;
+    if (changed) s_remo.addr_verified = false;
+    portEXIT_CRITICAL(&s_worker_lock);
+}
 
-            if (id && cJSON_IsString(id)) {
-                strncpy(a->id, id->valuestring, REMO_MAX_NAME_LEN - 1);
-            }
-            if (name && cJSON_IsString(name)) {
-                strncpy(a->name, name->valuestring, REMO_MAX_NAME_LEN - 1);
-            }
-            if (type && cJSON_IsString(type)) {
-                a->type = parse_type(type->valuestring);
-            }
+static void get_address(char *ip, uint16_t *port)
+{
+    portENTER_CRITICAL(&s_worker_lock);
+    memcpy(ip, s_remo.remo_ip, sizeof(s_remo.remo_ip));
+    *port = s_remo.remo_port;
+    portEXIT_CRITICAL(&s_worker_lock);
+}
 
-            // Parse signals
-            if (signals && cJSON_IsObject(signals)) {
-                int sig_count = 0;
-                cJSON *sig;
-                cJSON_ArrayForEach(sig, signals) {
-                    if (sig_count >= REMO_MAX_SIGNALS) break;
-                    if (cJSON_IsString(sig)) {
-                        strncpy(a->signals[sig_count].name, sig->string, REMO_MAX_NAME_LEN - 1);
-                        strncpy(a->signals[sig_count].id, sig->valuestring, REMO_MAX_SIGNAL_LEN - 1);
-                        sig_count++;
-                    }
-                }
-                a->signal_count = sig_count;
-            }
+static bool load_cached_address(void)
+{
+    nvs_handle_t nvs;
+    if (nvs_open(REMO_NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) return false;
+
+    char ip[16] = {0};
+    size_t len = sizeof(ip);
+    uint16_t port = 80;
+    bool ok = nvs_get_str(nvs, REMO_NVS_KEY_IP, ip, &len) == ESP_OK && ip[0];
+    nvs_get_u16(nvs, REMO_NVS_KEY_PORT, &port);
+    nvs_close(nvs);
+
+    if (ok) set_address(ip, port, REMO_ADDR_CACHED);
+    return ok;
+}
 
-            count++;
+/**
+ * @brief Persist the current address (skipped if NVS already has it)
+ */
+static void save_cached_address(void)
+{
+    char ip[16];
+    uint16_t port;
+    get_address(ip, &port);
+
+    nvs_handle_t nvs;
+    if (nvs_open(REMO_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) return;
+
+    char old_ip[16] = {0};
+    size_t len = sizeof(old_ip);
+    uint16_t old_port = 0;
+    nvs_get_str(nvs, REMO_NVS_KEY_IP, old_ip, &len);
+    nvs_get_u16(nvs, REMO_NVS_KEY_PORT, &old_port);
+
+    if (strcmp(old_ip, ip) != 0 || old_port != port) {
+        if (nvs_set_str(nvs, REMO_NVS_KEY_IP, ip) == ESP_OK &&
+            nvs_set_u16(nvs, REMO_NVS_KEY_PORT, port) == ESP_OK) {
+            nvs_commit(nvs);
+            ESP_LOGI(TAG, "Cached Remo address %s:%d", ip, port);
         }
-        s_remo.appliance_count = count;
-        ESP_LOGI(TAG, "Loaded %d appliances", count);
     }
-
-    cJSON_Delete(root);
-    return ESP_OK;
+    nvs_close(nvs);
 }
 
 // ============================================================================
 // mDNS Discovery
 // ============================================================================
 
-esp_err_t remo_client_discover(uint32_t timeout_ms)
+static esp_err_t ensure_mdns(void)
 {
-    ESP_LOGI(TAG, "Discovering Nature Remo via mDNS...");
-
     // Initialize mDNS if not already done
     esp_err_t ret = mdns_init();
     if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
         ESP_LOGE(TAG, "mDNS init failed: %s", esp_err_to_name(ret));
         return ret;
     }
+    return ESP_OK;
+}
+
+/**
+ * @brief First IPv4 address in a result list
+ */
+static bool result_address(const mdns_result_t *results, char *ip, size_t ip_len, uint16_t *port)
+{
+    for (const mdns_result_t *r = results; r; r = r->next) {
+        for (const mdns_ip_addr_t *a = r->addr; a; a = a->next) {
+            if (a->addr.type == ESP_IPADDR_TYPE_V4) {
+                snprintf(ip, ip_len, IPSTR, IP2STR(&a->addr.u_addr.ip4));
+                *port = r->port ? r->port : 80;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Browse notifier (mDNS task): switch address, defer NVS to worker
+ */
+static void browse_notifier(mdns_result_t *results)
+{
+    char ip[16];
+    uint16_t port;
+    if (!result_address(results, ip, sizeof(ip), &port)) return;
+
+    ESP_LOGI(TAG, "Nature Remo resolved at %s:%d", ip, port);
+    set_address(ip, port, REMO_ADDR_MDNS);
+
+    worker_request_save();
+}
+
+static void start_browse(void)
+{
+    if (s_remo.browse || ensure_mdns() != ESP_OK) return;
+
+    s_remo.browse = mdns_browse_new(REMO_MDNS_SERVICE, REMO_MDNS_PROTO, browse_notifier);
+    if (s_remo.browse) {
+        ESP_LOGI(TAG, "Browsing for Nature Remo in background");
+    } else {
+        ESP_LOGW(TAG, "mDNS browse failed to start");
+    }
+}
+
+static void stop_browse(void)
+{
+    if (s_remo.browse) {
+        mdns_browse_delete(REMO_MDNS_SERVICE, REMO_MDNS_PROTO);
+        s_remo.browse = NULL;
+    }
+}
+
+esp_err_t remo_client_discover(uint32_t timeout_ms)
+{
+    ESP_LOGI(TAG, "Discovering Nature Remo via mDNS...");
+
+    esp_err_t ret = ensure_mdns();
+    if (ret != ESP_OK) return ret;
 
     // Search for _remo._tcp service
     mdns_result_t *results = NULL;
-    ret = mdns_query_ptr("_remo", "_tcp", timeout_ms, 5, &results);
+    ret = mdns_query_ptr(REMO_MDNS_SERVICE, REMO_MDNS_PROTO, timeout_ms, 5, &results);
 
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "mDNS query failed: %s", esp_err_to_name(ret));
@@ -190,72 +453,383 @@ esp_err_t remo_client_discover(uint32_t timeout_ms)
         return ESP_ERR_NOT_FOUND;
     }
 
-    // Use first result
-    mdns_result_t *r = results;
-    if (r->addr && r->addr->addr.type == ESP_IPADDR_TYPE_V4) {
-        snprintf(s_remo.remo_ip, sizeof(s_remo.remo_ip), IPSTR,
-                 IP2STR(&r->addr->addr.u_addr.ip4));
-        s_remo.remo_port = r->port ? r->port : 80;
-        s_remo.remo_found = true;
-
-        ESP_LOGI(TAG, "Found Nature Remo at %s:%d", s_remo.remo_ip, s_remo.remo_port);
-    }
-
+    char ip[16];
+    uint16_t port;
+    bool found = result_address(results, ip, sizeof(ip), &port);
     mdns_query_results_free(results);
-    return s_remo.remo_found ? ESP_OK : ESP_ERR_NOT_FOUND;
+    if (!found) return ESP_ERR_NOT_FOUND;
+
+    ESP_LOGI(TAG, "Found Nature Remo at %s:%d", ip, port);
+    set_address(ip, port, REMO_ADDR_MDNS);
+    save_cached_address();
+    return ESP_OK;
 }
 
 // ============================================================================
 // HTTP Client for IR Signal Transmission
 // ============================================================================
 
-esp_err_t remo_client_send_signal(const char *signal_id)
+static uint32_t us_to_ms(int64_t us)
 {
-    if (!s_remo.remo_found || !signal_id) {
-        return ESP_ERR_INVALID_STATE;
+    return (us > 0) ? (uint32_t)(us / 1000) : 0;
+}
+
+static void update_latency(remo_latency_t *l, uint32_t ms, bool first)
+{
+    l->last_ms = ms;
+    if (first) {
+        l->avg_ms = ms;
+    } else {
+        int32_t delta = (int32_t)ms - (int32_t)l->avg_ms;
+        l->avg_ms += delta / (1 << REMO_LATENCY_EWMA_SHIFT);
     }
+    if (ms > l->max_ms) l->max_ms = ms;
+}
 
-    char url[128];
-    snprintf(url, sizeof(url), "http://%s:%d/messages",
-             s_remo.remo_ip, s_remo.remo_port);
+static esp_err_t http_event_handler(esp_http_client_event_t *evt)
+{
+    int64_t now = esp_timer_get_time();
+
+    switch (evt->event_id) {
+        case HTTP_EVENT_ON_CONNECTED:
+            s_worker.http_connected = true;
+            s_worker.connected_us = now;
+            break;
+        case HTTP_EVENT_DISCONNECTED:
+            s_worker.http_connected = false;
+            break;
+        case HTTP_EVENT_HEADERS_SENT:
+            s_worker.sent_us = now;
+            break;
+        case HTTP_EVENT_ON_HEADER:
+            if (s_worker.response_us == 0) s_worker.response_us = now;
+            break;
+        default:
+            break;
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief (Re)build the HTTP handle when the Remo endpoint changed
+ */
+static esp_err_t ensure_http_client(void)
+{
+    char ip[16];
+    uint16_t port;
+    get_address(ip, &port);
+
+    if (s_worker.http && (strcmp(s_worker.http_ip, ip) != 0 || s_worker.http_port != port)) {
+        esp_http_client_cleanup(s_worker.http);
+        s_worker.http = NULL;
+        s_worker.http_connected = false;
+    }
+    if (s_worker.http) return ESP_OK;
 
-    ESP_LOGI(TAG, "Sending signal %s to %s", signal_id, url);
+    memcpy(s_worker.http_ip, ip, sizeof(s_worker.http_ip));
+    s_worker.http_port = port;
 
-    // Prepare POST body
-    char post_data[256];
-    snprintf(post_data, sizeof(post_data), "{\"id\":\"%s\"}", signal_id);
+    char url[128];
+    snprintf(url, sizeof(url), "http://%s:%d/messages", s_worker.http_ip, s_worker.http_port);
 
     esp_http_client_config_t config = {
         .url = url,
         .method = HTTP_METHOD_POST,
-        .timeout_ms = 5000,
+        .timeout_ms = CONFIG_REMO_HTTP_TIMEOUT_MS,
+        .keep_alive_enable = true,          // Detect a Remo that went away
+        .event_handler = http_event_handler,
     };
 
-    esp_http_client_handle_t client = esp_http_client_init(&config);
-    if (!client) {
+    s_worker.http = esp_http_client_init(&config);
+    if (!s_worker.http) {
         return ESP_ERR_NO_MEM;
     }
 
     // IMPORTANT: Nature Remo local API requires this header
-    esp_http_client_set_header(client, "X-Requested-With", "curl");
-    esp_http_client_set_header(client, "Content-Type", "application/json");
-    esp_http_client_set_post_field(client, post_data, strlen(post_data));
+    esp_http_client_set_header(s_worker.http, "X-Requested-With", "curl");
+    esp_http_client_set_header(s_worker.http, "Content-Type", "application/json");
+    return ESP_OK;
+}
 
-    esp_err_t ret = esp_http_client_perform(client);
-    if (ret == ESP_OK) {
-        int status = esp_http_client_get_status_code(client);
-        ESP_LOGI(TAG, "HTTP Status: %d", status);
-        if (status != 200) {
-            ret = ESP_FAIL;
+/**
+ * @brief POST one signal on the kept-alive connection
+ *
+ * A reused connection may have been closed by the Remo while idle; that
+ * shows up as a transport error, so the request is retried once on a
+ * fresh connection.
+ */
+static void perform_request(const char *signal_id, remo_send_result_t *res)
+{
+    res->result = ensure_http_client();
+    if (res->result != ESP_OK) return;
+
+    char post_data[REMO_MAX_SIGNAL_LEN + 16];
+    int len = snprintf(post_data, sizeof(post_data), "{\"id\":\"%s\"}", signal_id);
+
+    ESP_LOGI(TAG, "Sending signal %s to %s:%d", signal_id, s_worker.http_ip, s_worker.http_port);
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool had_connection = s_worker.http_connected;
+        s_worker.connected_us = 0;
+        s_worker.sent_us = 0;
+        s_worker.response_us = 0;
+        int64_t start = esp_timer_get_time();
+
+        esp_http_client_set_post_field(s_worker.http, post_data, len);
+        esp_err_t ret = esp_http_client_perform(s_worker.http);
+
+        res->reused_connection = had_connection && s_worker.connected_us == 0;
+        res->connect_ms = s_worker.connected_us ? us_to_ms(s_worker.connected_us - start) : 0;
+        if (s_worker.connected_us) {
+            portENTER_CRITICAL(&s_worker_lock);
+            s_worker.stats.connections++;
+            portEXIT_CRITICAL(&s_worker_lock);
+        }
+
+        if (ret == ESP_OK) {
+            int64_t done = s_worker.response_us ? s_worker.response_us : esp_timer_get_time();
+            res->response_ms = us_to_ms(done - (s_worker.sent_us ? s_worker.sent_us : start));
+            res->http_status = esp_http_client_get_status_code(s_worker.http);
+            res->result = (res->http_status == 200) ? ESP_OK : ESP_FAIL;
+            ESP_LOGI(TAG, "HTTP Status: %d (%s, %lu ms)", res->http_status,
+                     res->reused_connection ? "reused" : "new connection",
+                     (unsigned long)(res->connect_ms + res->response_ms));
+            return;
+        }
+
+        // Drop the connection so the next perform reconnects
+        esp_http_client_close(s_worker.http);
+        s_worker.http_connected = false;
+        res->result = ret;
+
+        if (!res->reused_connection) break;
+        portENTER_CRITICAL(&s_worker_lock);
+        s_worker.stats.retries++;
+        portEXIT_CRITICAL(&s_worker_lock);
+        ESP_LOGD(TAG, "Kept-alive connection failed (%s), reconnecting", esp_err_to_name(ret));
+    }
+
+    ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(res->result));
+}
+
+/**
+ * @brief Persist the address if a resolution asked for it
+ */
+static void worker_handle_save(void)
+{
+    portENTER_CRITICAL(&s_worker_lock);
+    bool save = s_worker.save_pending;
+    s_worker.save_pending = false;
+    portEXIT_CRITICAL(&s_worker_lock);
+
+    if (save) {
+        stop_browse();
+        save_cached_address();
+    }
+}
+
+static void remo_worker_task(void *arg)
+{
+    for (;;) {
+        worker_handle_save();
+
+        uint8_t idx;
+        if (xQueueReceive(s_worker.queue, &idx, 0) != pdTRUE) {
+            // Queue drained: queued callers always get their completion first
+            portENTER_CRITICAL(&s_worker_lock);
+            bool stop = s_worker.stop_pending;
+            portEXIT_CRITICAL(&s_worker_lock);
+            if (stop) break;
+
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        remo_request_t *req = &s_worker.slots[idx];
+
+        // From here on a repeated press is a new command
+        portENTER_CRITICAL(&s_worker_lock);
+        req->state = REMO_SLOT_ACTIVE;
+        portEXIT_CRITICAL(&s_worker_lock);
+
+        remo_send_result_t res = {0};
+        res.queue_ms = us_to_ms(esp_timer_get_time() - req->enqueued_us);
+        perform_request(req->signal_id, &res);
+        res.total_ms = us_to_ms(esp_timer_get_time() - req->enqueued_us);
+
+        if (res.http_status) {
+            // The address answered: cached / hinted addresses are now verified
+            portENTER_CRITICAL(&s_worker_lock);
+            s_remo.addr_verified = true;
+            portEXIT_CRITICAL(&s_worker_lock);
+        } else if (res.result != ESP_OK) {
+            // Unreachable: the DHCP lease may have moved, look it up again
+            start_browse();
+        }
+
+        remo_send_cb_t cb = req->cb;
+        void *user_ctx = req->user_ctx;
+
+        portENTER_CRITICAL(&s_worker_lock);
+        remo_client_stats_t *st = &s_worker.stats;
+        bool first = (st->sent + st->failed) == 0;
+        if (res.result == ESP_OK) {
+            st->sent++;
+        } else {
+            st->failed++;
+        }
+        update_latency(&st->queue, res.queue_ms, first);
+        update_latency(&st->total, res.total_ms, first);
+        if (res.http_status) {
+            update_latency(&st->response, res.response_ms, st->response.max_ms == 0);
+        }
+        if (!res.reused_connection && res.http_status) {
+            update_latency(&st->connect, res.connect_ms, st->connect.max_ms == 0);
+        }
+        req->state = REMO_SLOT_FREE;
+        portEXIT_CRITICAL(&s_worker_lock);
+
+        if (cb) cb(&res, user_ctx);
+    }
+
+    if (s_worker.http) {
+        esp_http_client_cleanup(s_worker.http);
+        s_worker.http = NULL;
+    }
+
+    xSemaphoreGive(s_worker.worker_done);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t enqueue_signal(const char *signal_id, remo_send_cb_t cb, void *user_ctx, bool merge)
+{
+    if (!s_worker.task || !s_remo.remo_found || !signal_id) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (strlen(signal_id) >= REMO_MAX_SIGNAL_LEN) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+
+    int64_t now = esp_timer_get_time();
+    int free_idx = -1;
+
+    portENTER_CRITICAL(&s_worker_lock);
+    for (int i = 0; i < CONFIG_REMO_QUEUE_DEPTH; i++) {
+        remo_request_t *req = &s_worker.slots[i];
+        if (merge && req->state == REMO_SLOT_QUEUED && strcmp(req->signal_id, signal_id) == 0) {
+            s_worker.stats.coalesced++;
+            portEXIT_CRITICAL(&s_worker_lock);
+            ESP_LOGD(TAG, "Signal %s already pending, merged", signal_id);
+            return ESP_OK;
         }
+        if (free_idx < 0 && req->state == REMO_SLOT_FREE) free_idx = i;
+    }
+
+    if (free_idx >= 0) {
+        remo_request_t *req = &s_worker.slots[free_idx];
+        req->state = REMO_SLOT_QUEUED;
+        strcpy(req->signal_id, signal_id);
+        req->cb = cb;
+        req->user_ctx = user_ctx;
+        req->enqueued_us = now;
     } else {
-        ESP_LOGE(TAG, "HTTP request failed: %s", esp_err_to_name(ret));
+        s_worker.stats.dropped++;
+    }
+    portEXIT_CRITICAL(&s_worker_lock);
+
+    if (free_idx < 0) {
+        ESP_LOGW(TAG, "Command queue full, dropping %s", signal_id);
+        return ESP_ERR_TIMEOUT;
     }
 
-    esp_http_client_cleanup(client);
+    // One queue entry per slot, so a full queue means a lost slot index:
+    // give the slot back rather than leave a caller waiting on it forever
+    uint8_t idx = (uint8_t)free_idx;
+    if (xQueueSend(s_worker.queue, &idx, 0) != pdTRUE) {
+        portENTER_CRITICAL(&s_worker_lock);
+        s_worker.slots[free_idx].state = REMO_SLOT_FREE;
+        s_worker.stats.dropped++;
+        portEXIT_CRITICAL(&s_worker_lock);
+        ESP_LOGW(TAG, "Command queue full, dropping %s", signal_id);
+        return ESP_ERR_TIMEOUT;
+    }
+    xTaskNotifyGive(s_worker.task);
+    return ESP_OK;
+}
+
+static void sync_done_cb(const remo_send_result_t *result, void *user_ctx)
+{
+    *(esp_err_t *)user_ctx = result->result;
+    xSemaphoreGive(s_worker.sync_done);
+}
+
+esp_err_t remo_client_send_signal(const char *signal_id)
+{
+    if (!s_worker.task || xTaskGetCurrentTaskHandle() == s_worker.task) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    xSemaphoreTake(s_worker.sync_lock, portMAX_DELAY);
+
+    // Not merged: the caller waits for its own completion
+    esp_err_t result = ESP_FAIL;
+    esp_err_t ret = enqueue_signal(signal_id, sync_done_cb, &result, false);
+    if (ret == ESP_OK) {
+        // Every request ends within its HTTP timeouts; never abandon result
+        xSemaphoreTake(s_worker.sync_done, portMAX_DELAY);
+        ret = result;
+    }
+
+    xSemaphoreGive(s_worker.sync_lock);
     return ret;
 }
 
+esp_err_t remo_client_send_signal_async(const char *signal_id, remo_send_cb_t cb, void *user_ctx)
+{
+    return enqueue_signal(signal_id, cb, user_ctx, true);
+}
+
+static void worker_stop(void)
+{
+    if (s_worker.task) {
+        portENTER_CRITICAL(&s_worker_lock);
+        s_worker.stop_pending = true;
+        portEXIT_CRITICAL(&s_worker_lock);
+        xTaskNotifyGive(s_worker.task);
+        xSemaphoreTake(s_worker.worker_done, portMAX_DELAY);
+    }
+
+    if (s_worker.queue) vQueueDelete(s_worker.queue);
+    if (s_worker.worker_done) vSemaphoreDelete(s_worker.worker_done);
+    if (s_worker.sync_lock) vSemaphoreDelete(s_worker.sync_lock);
+    if (s_worker.sync_done) vSemaphoreDelete(s_worker.sync_done);
+
+    memset(&s_worker, 0, sizeof(s_worker));
+}
+
+static esp_err_t worker_start(void)
+{
+    memset(&s_worker, 0, sizeof(s_worker));
+
+    s_worker.queue = xQueueCreate(CONFIG_REMO_QUEUE_DEPTH, sizeof(uint8_t));
+    s_worker.worker_done = xSemaphoreCreateBinary();
+    s_worker.sync_lock = xSemaphoreCreateMutex();
+    s_worker.sync_done = xSemaphoreCreateBinary();
+    if (!s_worker.queue || !s_worker.worker_done || !s_worker.sync_lock || !s_worker.sync_done) {
+        worker_stop();
+        return ESP_ERR_NO_MEM;
+    }
+
+    if (xTaskCreatePinnedToCore(remo_worker_task, "remo_worker", REMO_WORKER_STACK, NULL,
+                                REMO_WORKER_PRIORITY, &s_worker.task, REMO_WORKER_CORE) != pdPASS) {
+        s_worker.task = NULL;
+        worker_stop();
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
 // ============================================================================
 // Public API Implementation
 // ============================================================================
@@ -277,12 +851,26 @@ esp_err_t remo_client_init(void)
     if (ret != ESP_OK) {
         ESP_LOGW(TAG, "SPIFFS mount failed, continuing without config");
     } else {
-        load_appliances_from_spiffs();
+        load_appliances();
     }
 
-    // Try mDNS discovery if no IP hint was provided
+    // Without an IP hint, use the last known address; the first send
+    // verifies it and a failure starts re-discovery
+    if (!s_remo.remo_found && load_cached_address()) {
+        ESP_LOGI(TAG, "Using cached Remo address %s:%d", s_remo.remo_ip, s_remo.remo_port);
+    }
+
+    ret = worker_start();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start Remo worker");
+        unmap_db();
+        esp_vfs_spiffs_unregister("storage");
+        return ret;
+    }
+
+    // Nothing to try yet: discover in the background instead of blocking boot
     if (!s_remo.remo_found) {
-        remo_client_discover(3000);
+        start_browse();
     }
 
     s_remo.initialized = true;
@@ -296,53 +884,58 @@ void remo_client_deinit(void)
 {
     if (!s_remo.initialized) return;
 
+    stop_browse();
+    worker_stop();
+    unmap_db();
     esp_vfs_spiffs_unregister("storage");
     memset(&s_remo, 0, sizeof(s_remo));
 }
 
+static const char *find_signal_id(const char *appliance_name, const char *signal_name)
+{
+    const remo_appliance_t *app = remo_db_find_appliance(s_remo.db, appliance_name);
+    if (!app) {
+        ESP_LOGW(TAG, "Appliance '%s' not found", appliance_name);
+        return NULL;
+    }
+
+    const remo_signal_t *sig = remo_db_find_signal(s_remo.db, app, signal_name);
+    if (!sig) {
+        ESP_LOGW(TAG, "Signal '%s' not found in appliance '%s'", signal_name, appliance_name);
+        return NULL;
+    }
+    return sig->id;
+}
+
 esp_err_t remo_client_send_quick(const char *appliance_name, const char *signal_name)
 {
     if (!s_remo.initialized || !appliance_name || !signal_name) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    // Find appliance
-    const remo_appliance_t *app = remo_client_get_appliance(appliance_name);
-    if (!app) {
-        ESP_LOGW(TAG, "Appliance '%s' not found", appliance_name);
-        return ESP_ERR_NOT_FOUND;
-    }
+    const char *signal_id = find_signal_id(appliance_name, signal_name);
+    return signal_id ? remo_client_send_signal(signal_id) : ESP_ERR_NOT_FOUND;
+}
 
-    // Find signal
-    for (int i = 0; i < app->signal_count; i++) {
-        if (strcmp(app->signals[i].name, signal_name) == 0) {
-            return remo_client_send_signal(app->signals[i].id);
-        }
+esp_err_t remo_client_send_quick_async(const char *appliance_name, const char *signal_name,
+                                       remo_send_cb_t cb, void *user_ctx)
+{
+    if (!s_remo.initialized || !appliance_name || !signal_name) {
+        return ESP_ERR_INVALID_ARG;
     }
 
-    ESP_LOGW(TAG, "Signal '%s' not found in appliance '%s'", signal_name, appliance_name);
-    return ESP_ERR_NOT_FOUND;
+    const char *signal_id = find_signal_id(appliance_name, signal_name);
+    return signal_id ? remo_client_send_signal_async(signal_id, cb, user_ctx) : ESP_ERR_NOT_FOUND;
 }
 
 const remo_appliance_t *remo_client_get_appliance(const char *name)
 {
-    if (!name) return NULL;
-
-    for (int i = 0; i < s_remo.appliance_count; i++) {
-        if (strcmp(s_remo.appliances[i].id, name) == 0 ||
-            strcmp(s_remo.appliances[i].name, name) == 0) {
-            return &s_remo.appliances[i];
-        }
-    }
-    return NULL;
+    return remo_db_find_appliance(s_remo.db, name);
 }
 
 const remo_appliance_t *remo_client_get_appliances(int *count)
 {
-    if (count) {
-        *count = s_remo.appliance_count;
-    }
-    return s_remo.appliances;
+    return remo_db_appliances(s_remo.db, count);
 }
 
 bool remo_client_is_available(void)
@@ -352,21 +945,51 @@ bool remo_client_is_available(void)
 
 void remo_client_get_state(remo_client_state_t *state)
 {
-    if (state) {
-        memcpy(state, &s_remo, sizeof(remo_client_state_t));
-    }
+    if (!state) return;
+
+    memset(state, 0, sizeof(*state));
+    state->initialized = s_remo.initialized;
+    state->discovering = s_remo.browse != NULL;
+
+    portENTER_CRITICAL(&s_worker_lock);
+    state->remo_found = s_remo.remo_found;
+    memcpy(state->remo_ip, s_remo.remo_ip, sizeof(state->remo_ip));
+    state->remo_port = s_remo.remo_port;
+    state->addr_source = s_remo.addr_source;
+    state->addr_verified = s_remo.addr_verified;
+    portEXIT_CRITICAL(&s_worker_lock);
+
+    int count = 0;
+    const remo_appliance_t *apps = remo_db_appliances(s_remo.db, &count);
+    if (count) memcpy(state->appliances, apps, count * sizeof(remo_appliance_t));
+    state->appliance_count = count;
 }
 
 esp_err_t remo_client_set_ip(const char *ip)
 {
-    if (!ip || strlen(ip) == 0) {
+    if (!ip || strlen(ip) == 0 || strlen(ip) >= sizeof(s_remo.remo_ip)) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    strncpy(s_remo.remo_ip, ip, sizeof(s_remo.remo_ip) - 1);
-    s_remo.remo_port = 80;
-    s_remo.remo_found = true;
+    set_address(ip, 80, REMO_ADDR_MANUAL);
+    ESP_LOGI(TAG, "Remo IP manually set to: %s", ip);
 
-    ESP_LOGI(TAG, "Remo IP manually set to: %s", s_remo.remo_ip);
+    // The worker stops any browse and caches the address
+    if (!worker_request_save()) {
+        save_cached_address();
+    }
     return ESP_OK;
 }
+
+void remo_client_get_stats(remo_client_stats_t *stats)
+{
+    if (!stats) return;
+
+    portENTER_CRITICAL(&s_worker_lock);
+    *stats = s_worker.stats;
+    stats->pending = 0;
+    for (int i = 0; i < CONFIG_REMO_QUEUE_DEPTH; i++) {
+        if (s_worker.slots[i].state != REMO_SLOT_FREE) stats->pending++;
+    }
+    portEXIT_CRITICAL(&s_worker_lock);
+}
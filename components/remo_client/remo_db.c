@@ -0,0 +1,303 @@
+/**
+ * @file remo_db.c
+ * @brief Packed appliance database implementation
+ */
+
+#include "remo_db.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_rom_crc.h"
+#include "cJSON.h"
+
+static const char *TAG = "remo_db";
+
+#define FNV_OFFSET              0x811C9DC5u
+#define FNV_PRIME               0x01000193u
+#define SIGNAL_SEED_MUL         0x9E3779B1u     // Spreads appliance index
+#define MIN_BUCKETS             8
+
+// ============================================================================
+// Hashing
+// ============================================================================
+
+static uint32_t fnv1a(uint32_t h, const void *data, size_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+    for (size_t i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= FNV_PRIME;
+    }
+    return h;
+}
+
+static uint32_t hash_str(const char *s)
+{
+    return fnv1a(FNV_OFFSET, s, strlen(s));
+}
+
+static uint32_t hash_signal(int app, const char *name)
+{
+    return fnv1a(FNV_OFFSET ^ ((uint32_t)(app + 1) * SIGNAL_SEED_MUL), name, strlen(name));
+}
+
+static uint16_t bucket_count_for(int keys)
+{
+    uint16_t n = MIN_BUCKETS;
+    while (n < keys * 2) n <<= 1;
+    return n;
+}
+
+esp_err_t remo_db_hash_file(const char *path, uint32_t *hash, uint32_t *size)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) return ESP_ERR_NOT_FOUND;
+
+    uint8_t chunk[256];
+    uint32_t h = FNV_OFFSET, total = 0;
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) {
+        h = fnv1a(h, chunk, n);
+        total += n;
+    }
+    fclose(f);
+
+    *hash = h;
+    *size = total;
+    return ESP_OK;
+}
+
+// ============================================================================
+// Image Layout
+// ============================================================================
+
+static const remo_appliance_t *apps_of(const remo_db_header_t *db)
+{
+    return (const remo_appliance_t *)(db + 1);
+}
+
+static const uint16_t *app_buckets_of(const remo_db_header_t *db)
+{
+    return (const uint16_t *)(apps_of(db) + db->appliance_count);
+}
+
+static const uint16_t *sig_buckets_of(const remo_db_header_t *db)
+{
+    return app_buckets_of(db) + db->app_bucket_count;
+}
+
+static size_t image_size_for(int apps, uint16_t app_buckets, uint16_t sig_buckets)
+{
+    return sizeof(remo_db_header_t) + apps * sizeof(remo_appliance_t) +
+           (app_buckets + sig_buckets) * sizeof(uint16_t);
+}
+
+static void insert(uint16_t *buckets, uint16_t count, uint32_t hash, uint16_t value)
+{
+    uint16_t mask = count - 1;
+    for (uint16_t i = hash & mask; ; i = (i + 1) & mask) {
+        if (buckets[i] == 0) {
+            buckets[i] = value;
+            return;
+        }
+    }
+}
+
+// ============================================================================
+// JSON Conversion
+// ============================================================================
+
+static remo_appliance_type_t parse_type(const char *type_str)
+{
+    if (!type_str) return REMO_TYPE_UNKNOWN;
+    if (strcmp(type_str, "LIGHT") == 0) return REMO_TYPE_LIGHT;
+    if (strcmp(type_str, "AC") == 0) return REMO_TYPE_AC;
+    if (strcmp(type_str, "TV") == 0) return REMO_TYPE_TV;
+    if (strcmp(type_str, "FAN") == 0) return REMO_TYPE_FAN;
+    return REMO_TYPE_OTHER;
+}
+
+static int parse_appliances(cJSON *appliances, remo_appliance_t *out)
+{
+    int count = 0;
+    cJSON *app;
+    cJSON_ArrayForEach(app, appliances) {
+        if (count >= REMO_MAX_APPLIANCES) break;
+
+        remo_appliance_t *a = &out[count];
+
+        cJSON *id = cJSON_GetObjectItem(app, "id");
+        cJSON *name = cJSON_GetObjectItem(app, "name");
+        cJSON *type = cJSON_GetObjectItem(app, "type");
+        cJSON *signals = cJSON_GetObjectItem(app, "signals");
+
+        if (id && cJSON_IsString(id)) {
+            strncpy(a->id, id->valuestring, REMO_MAX_NAME_LEN - 1);
+        }
+        if (name && cJSON_IsString(name)) {
+            strncpy(a->name, name->valuestring, REMO_MAX_NAME_LEN - 1);
+        }
+        if (type && cJSON_IsString(type)) {
+            a->type = parse_type(type->valuestring);
+        }
+
+        // Parse signals
+        if (signals && cJSON_IsObject(signals)) {
+            int sig_count = 0;
+            cJSON *sig;
+            cJSON_ArrayForEach(sig, signals) {
+                if (sig_count >= REMO_MAX_SIGNALS) break;
+                if (cJSON_IsString(sig)) {
+                    strncpy(a->signals[sig_count].name, sig->string, REMO_MAX_NAME_LEN - 1);
+                    strncpy(a->signals[sig_count].id, sig->valuestring, REMO_MAX_SIGNAL_LEN - 1);
+                    sig_count++;
+                }
+            }
+            a->signal_count = sig_count;
+        }
+
+        count++;
+    }
+    return count;
+}
+
+esp_err_t remo_db_build(const char *json, uint32_t source_hash, uint32_t source_size,
+                        remo_db_header_t **out)
+{
+    *out = NULL;
+
+    cJSON *root = cJSON_Parse(json);
+    if (!root) {
+        ESP_LOGE(TAG, "Failed to parse appliances.json");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    // Worst case sizing first, so the image is one allocation
+    remo_appliance_t *apps = calloc(REMO_MAX_APPLIANCES, sizeof(remo_appliance_t));
+    if (!apps) {
+        cJSON_Delete(root);
+        return ESP_ERR_NO_MEM;
+    }
+
+    int count = 0;
+    cJSON *appliances = cJSON_GetObjectItem(root, "appliances");
+    if (appliances && cJSON_IsArray(appliances)) {
+        count = parse_appliances(appliances, apps);
+    }
+
+    char ip_hint[16] = {0};
+    cJSON *hint = cJSON_GetObjectItem(root, "remo_ip_hint");
+    if (hint && cJSON_IsString(hint)) {
+        strncpy(ip_hint, hint->valuestring, sizeof(ip_hint) - 1);
+    }
+    cJSON_Delete(root);
+
+    int signals = 0;
+    for (int i = 0; i < count; i++) signals += apps[i].signal_count;
+
+    uint16_t app_buckets = bucket_count_for(count * 2);
+    uint16_t sig_buckets = bucket_count_for(signals);
+    size_t size = image_size_for(count, app_buckets, sig_buckets);
+
+    remo_db_header_t *db = calloc(1, size);
+    if (!db) {
+        free(apps);
+        return ESP_ERR_NO_MEM;
+    }
+
+    db->magic = REMO_DB_MAGIC;
+    db->version = REMO_DB_VERSION;
+    db->appliance_size = sizeof(remo_appliance_t);
+    db->source_hash = source_hash;
+    db->source_size = source_size;
+    db->image_size = size;
+    db->appliance_count = count;
+    db->app_bucket_count = app_buckets;
+    db->sig_bucket_count = sig_buckets;
+    memcpy(db->remo_ip_hint, ip_hint, sizeof(db->remo_ip_hint));
+
+    memcpy((void *)apps_of(db), apps, count * sizeof(remo_appliance_t));
+    free(apps);
+
+    uint16_t *ab = (uint16_t *)app_buckets_of(db);
+    uint16_t *sb = (uint16_t *)sig_buckets_of(db);
+    const remo_appliance_t *a = apps_of(db);
+    for (int i = 0; i < count; i++) {
+        insert(ab, app_buckets, hash_str(a[i].id), i + 1);
+        if (strcmp(a[i].id, a[i].name) != 0) {
+            insert(ab, app_buckets, hash_str(a[i].name), i + 1);
+        }
+        for (int s = 0; s < a[i].signal_count; s++) {
+            insert(sb, sig_buckets, hash_signal(i, a[i].signals[s].name), ((i << 8) | s) + 1);
+        }
+    }
+
+    db->image_crc = esp_rom_crc32_le(0, (const uint8_t *)(db + 1), size - sizeof(*db));
+
+    ESP_LOGI(TAG, "Packed %d appliances, %d signals (%u bytes)", count, signals, (unsigned)size);
+    *out = db;
+    return ESP_OK;
+}
+
+// ============================================================================
+// Lookup
+// ============================================================================
+
+bool remo_db_valid(const remo_db_header_t *db, size_t avail)
+{
+    if (!db || avail < sizeof(*db)) return false;
+    if (db->magic != REMO_DB_MAGIC || db->version != REMO_DB_VERSION) return false;
+    if (db->appliance_size != sizeof(remo_appliance_t)) return false;
+    if (db->appliance_count > REMO_MAX_APPLIANCES) return false;
+
+    // Bucket counts must be powers of two or probing never terminates
+    uint16_t ab = db->app_bucket_count, sb = db->sig_bucket_count;
+    if (ab < MIN_BUCKETS || (ab & (ab - 1)) || sb < MIN_BUCKETS || (sb & (sb - 1))) return false;
+
+    size_t size = image_size_for(db->appliance_count, ab, sb);
+    if (db->image_size != size || size > avail) return false;
+
+    return esp_rom_crc32_le(0, (const uint8_t *)(db + 1), size - sizeof(*db)) == db->image_crc;
+}
+
+const remo_appliance_t *remo_db_appliances(const remo_db_header_t *db, int *count)
+{
+    if (count) *count = db ? db->appliance_count : 0;
+    return db ? apps_of(db) : NULL;
+}
+
+const remo_appliance_t *remo_db_find_appliance(const remo_db_header_t *db, const char *name)
+{
+    if (!db || !name) return NULL;
+
+    const remo_appliance_t *apps = apps_of(db);
+    const uint16_t *buckets = app_buckets_of(db);
+    uint16_t mask = db->app_bucket_count - 1;
+
+    for (uint16_t i = hash_str(name) & mask; buckets[i]; i = (i + 1) & mask) {
+        const remo_appliance_t *a = &apps[buckets[i] - 1];
+        if (strcmp(a->id, name) == 0 || strcmp(a->name, name) == 0) return a;
+    }
+    return NULL;
+}
+
+const remo_signal_t *remo_db_find_signal(const remo_db_header_t *db, const remo_appliance_t *app,
+                                         const char *signal_name)
+{
+    if (!db || !app || !signal_name) return NULL;
+
+    const remo_appliance_t *apps = apps_of(db);
+    int index = app - apps;
+    if (index < 0 || index >= db->appliance_count) return NULL;
+
+    const uint16_t *buckets = sig_buckets_of(db);
+    uint16_t mask = db->sig_bucket_count - 1;
+
+    for (uint16_t i = hash_signal(index, signal_name) & mask; buckets[i]; i = (i + 1) & mask) {
+        int a = (buckets[i] - 1) >> 8;
+        int s = (buckets[i] - 1) & 0xFF;
+        if (a == index && strcmp(app->signals[s].name, signal_name) == 0) return &app->signals[s];
+    }
+    return NULL;
+}
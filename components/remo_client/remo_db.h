@@ -0,0 +1,97 @@
+/**
+ * @file remo_db.h
+ * @brief Packed appliance database (internal to remo_client)
+ *
+ * appliances.json stays the source of truth. Its FNV-1a hash and size are
+ * recorded in the packed image; while they match, the image in the
+ * "appdb" partition is mmapped and used in place, with no parsing or heap.
+ * When the JSON changes, it is parsed once and the image is rebuilt.
+ *
+ * Layout (little-endian, built on the device so the struct layout matches):
+ *
+ *   remo_db_header_t
+ *   remo_appliance_t  appliances[appliance_count]
+ *   uint16_t          app_buckets[app_bucket_count]    appliance index + 1
+ *   uint16_t          sig_buckets[sig_bucket_count]    (app << 8 | sig) + 1
+ *
+ * Appliance buckets hold both the id and the name of every appliance;
+ * signal buckets are keyed by (appliance, signal name). Both tables are
+ * open-addressed (linear probing, load ≤ 50 %), so a lookup is one hash
+ * and usually one strcmp. On duplicate keys the first appliance wins, as
+ * with the old linear scan.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "remo_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define REMO_DB_MAGIC           0x31424452  // "RDB1"
+#define REMO_DB_VERSION         1
+
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t appliance_size;            // sizeof(remo_appliance_t) when packed
+    uint32_t source_hash;               // FNV-1a of appliances.json
+    uint32_t source_size;
+    uint32_t image_size;                // Including this header
+    uint32_t image_crc;                 // CRC32 of everything after the header
+    uint16_t appliance_count;
+    uint16_t app_bucket_count;          // Power of two
+    uint16_t sig_bucket_count;          // Power of two
+    uint16_t reserved;
+    char remo_ip_hint[16];
+} remo_db_header_t;
+
+/**
+ * @brief FNV-1a hash and size of a file, streamed in small chunks
+ */
+esp_err_t remo_db_hash_file(const char *path, uint32_t *hash, uint32_t *size);
+
+/**
+ * @brief Parse appliances.json and pack it
+ *
+ * @param json        JSON text (NUL-terminated)
+ * @param source_hash Recorded in the header
+ * @param source_size Recorded in the header
+ * @param out         Packed image (malloc'd, caller frees)
+ * @return ESP_OK, ESP_ERR_INVALID_ARG on a parse error, ESP_ERR_NO_MEM
+ */
+esp_err_t remo_db_build(const char *json, uint32_t source_hash, uint32_t source_size,
+                        remo_db_header_t **out);
+
+/**
+ * @brief Check magic, version, struct layout, bounds and CRC
+ *
+ * @param db    Image
+ * @param avail Bytes readable at db
+ */
+bool remo_db_valid(const remo_db_header_t *db, size_t avail);
+
+/**
+ * @brief Appliance array of an image (NULL db: empty)
+ */
+const remo_appliance_t *remo_db_appliances(const remo_db_header_t *db, int *count);
+
+/**
+ * @brief Find an appliance by id or name
+ */
+const remo_appliance_t *remo_db_find_appliance(const remo_db_header_t *db, const char *name);
+
+/**
+ * @brief Find a signal of an appliance by name
+ */
+const remo_signal_t *remo_db_find_signal(const remo_db_header_t *db, const remo_appliance_t *app,
+                                         const char *signal_name);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,140 @@
+/**
+ * @file sensor_history_test.c
+ * @brief Host test of the retained span of every sensor_history tier
+ *
+ * Builds sensor_history.c against the IDF shims in tools/host_bench and
+ * records a day more than the longest retention of snapshots at the
+ * default 5 s read interval, with read jitter, occasional sensor dropouts
+ * and one duplicated snapshot per read:
+ *
+ *   steady   temperature / humidity / pressure move slowly (1-byte deltas)
+ *   noisy    lux and CO2 jump across their full range every read, so
+ *            deltas and min / max spreads take multi-byte varints
+ *
+ * Every tier of every metric must still reach back over its configured
+ * retention (CONFIG_SENSOR_HISTORY_*), and its points must be in order.
+ *
+ * Usage (see tools/host_bench/CMakeLists.txt):
+ *   ./sensor_history_test        exit status 0 = pass
+ */
+
+#include "sensor_history.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+
+#define TEST_READ_US            (5LL * 1000000)
+#define TEST_DAYS               (CONFIG_SENSOR_HISTORY_15MIN_DAYS + 1)
+#define TEST_MAX_POINTS         8192
+
+static sensor_history_point_t s_points[TEST_MAX_POINTS];
+
+static uint32_t s_rng = 12345;
+
+static uint32_t rng_next(void)
+{
+    s_rng = s_rng * 1103515245u + 12345u;
+    return s_rng >> 8;
+}
+
+static float rng_range(float lo, float hi)
+{
+    return lo + (hi - lo) * (float)(rng_next() & 0xFFFF) / 65535.0f;
+}
+
+/**
+ * @brief One snapshot: every sensor valid except for rare dropouts
+ */
+static void make_snapshot(sensor_data_t *d, int64_t t, uint32_t i)
+{
+    memset(d, 0, sizeof(*d));
+    d->timestamp_us = t;
+
+    d->sht40_valid = (i % 97) != 0;
+    d->temperature = 22.0f + (float)(i % 200) * 0.01f;
+    d->humidity = 45.0f + (float)(i % 50) * 0.1f;
+    d->bmp388_valid = true;
+    d->pressure = 1013.0f + (float)(i % 30) * 0.01f;
+    d->scd41_valid = (i % 53) != 0;
+    d->co2 = (uint16_t)rng_range(400.0f, 5000.0f);
+    d->ens160_valid = true;
+    d->tvoc = (uint16_t)(i % 7);
+    d->eco2 = 400;
+    d->sgp40_valid = true;
+    d->voc_index = 100;
+    d->bh1750_valid = true;
+    d->lux = rng_range(0.0f, 65000.0f);
+}
+
+/**
+ * @brief Check that one tier of one metric covers [now - retention, now]
+ */
+static bool check_span(sensor_metric_t m, sensor_history_res_t res, int64_t now,
+                       int64_t retention_us)
+{
+    int n = sensor_history_query(m, res, 0, now, s_points, TEST_MAX_POINTS);
+    if (n <= 0) {
+        printf("FAIL %-12s res %d: no points\n", sensor_history_metric_name(m), res);
+        return false;
+    }
+    for (int i = 1; i < n; i++) {
+        if (s_points[i].timestamp_us <= s_points[i - 1].timestamp_us) {
+            printf("FAIL %-12s res %d: point %d out of order\n",
+                   sensor_history_metric_name(m), res, i);
+            return false;
+        }
+    }
+
+    int64_t oldest = s_points[0].timestamp_us;
+    int64_t span_s = (now - oldest) / 1000000;
+    bool ok = oldest <= now - retention_us;
+    printf("%s %-12s res %d: %5d points, %7lld s retained (need %lld s)\n",
+           ok ? "ok  " : "FAIL", sensor_history_metric_name(m), res, n,
+           (long long)span_s, (long long)(retention_us / 1000000));
+    return ok;
+}
+
+int main(void)
+{
+    if (sensor_history_init() != ESP_OK) {
+        printf("FAIL: sensor_history_init\n");
+        return 1;
+    }
+
+    const int64_t end = (int64_t)TEST_DAYS * 86400 * 1000000;
+    int64_t t = 1000000;
+    uint32_t i = 0;
+    sensor_data_t d;
+    while (t < end) {
+        make_snapshot(&d, t, i++);
+        sensor_history_record(&d);
+        sensor_history_record(&d);          // Same snapshot again: ignored
+
+        // Scheduling jitter around the read interval: some slots are missed
+        t += TEST_READ_US + (int64_t)(rng_next() % 1000000) - 400000;
+    }
+
+    const int64_t retention_us[SENSOR_HISTORY_RES_COUNT] = {
+        (int64_t)CONFIG_SENSOR_HISTORY_RAW_MINUTES * 60 * 1000000,
+        (int64_t)CONFIG_SENSOR_HISTORY_1MIN_HOURS * 3600 * 1000000,
+        (int64_t)CONFIG_SENSOR_HISTORY_15MIN_DAYS * 86400 * 1000000,
+    };
+
+    bool ok = true;
+    for (int res = 0; res < SENSOR_HISTORY_RES_COUNT; res++) {
+        for (int m = 0; m < SENSOR_METRIC_COUNT; m++) {
+            ok &= check_span((sensor_metric_t)m, (sensor_history_res_t)res, t,
+                             retention_us[res]);
+        }
+    }
+
+    sensor_history_stats_t stats;
+    sensor_history_get_stats(&stats);
+    printf("%u snapshots, store %u KB, %u blocks evicted\n", (unsigned)i,
+           (unsigned)(stats.bytes_total / 1024), (unsigned)stats.blocks_evicted);
+
+    sensor_history_deinit();
+    printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,387 @@
+/**
+ * @file i2c_queue.c
+ * @brief Asynchronous I2C transaction queue implementation
+ */
+
+#include "i2c_queue.h"
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "i2c_queue";
+
+#define I2C_QUEUE_STOP_DEV      (-1)        // Sentinel transaction: stop worker
+#define I2C_LATENCY_EWMA_SHIFT  3           // avg += (sample - avg) / 8
+#define I2C_QUEUE_CORE          ((CONFIG_TASK_CORE_HELPER < 0) ? tskNO_AFFINITY : CONFIG_TASK_CORE_HELPER)
+
+// ============================================================================
+// Internal State
+// ============================================================================
+
+typedef struct {
+    int dev;
+    uint8_t tx[I2C_QUEUE_MAX_XFER];
+    uint8_t tx_len;
+    uint8_t rx_len;
+    i2c_txn_cb_t cb;
+    void *arg;
+} i2c_txn_t;
+
+typedef struct {
+    const char *name;
+    uint16_t addr;
+    i2c_master_dev_handle_t handle;
+    i2c_dev_init_fn_t init;
+    int64_t retry_at_us;                // BACKOFF: next attempt allowed
+    int64_t probe_at_us;                // OFFLINE: next re-probe
+    i2c_dev_stats_t stats;
+} i2c_dev_t;
+
+typedef struct {
+    uint8_t *rx;
+    esp_err_t err;
+} i2c_sync_ctx_t;
+
+typedef struct {
+    i2c_master_bus_handle_t bus;
+    i2c_queue_config_t cfg;
+    QueueHandle_t queue;
+    TaskHandle_t worker;
+    SemaphoreHandle_t worker_done;
+
+    i2c_dev_t devs[I2C_QUEUE_MAX_DEVICES];
+    int dev_count;
+    uint32_t bus_resets;
+
+    // Blocking transfers share one completion (rare: init, calibration)
+    SemaphoreHandle_t sync_lock;
+    SemaphoreHandle_t sync_done;
+} i2c_queue_state_t;
+
+static i2c_queue_state_t s_q = {0};
+
+// ============================================================================
+// Device Health
+// ============================================================================
+
+static void set_offline(i2c_dev_t *d, int64_t now)
+{
+    d->stats.state = I2C_DEV_OFFLINE;
+    d->probe_at_us = now + (int64_t)s_q.cfg.reprobe_ms * 1000;
+}
+
+/**
+ * @brief Probe the address and run the init hook
+ */
+static bool probe_device(i2c_dev_t *d)
+{
+    if (i2c_master_probe(s_q.bus, d->addr, s_q.cfg.timeout_ms) != ESP_OK) return false;
+    if (d->init && d->init(d->handle) != ESP_OK) return false;
+    return true;
+}
+
+static void record_success(i2c_dev_t *d, uint32_t latency_us)
+{
+    d->stats.transactions++;
+    d->stats.consecutive_errors = 0;
+    d->stats.state = I2C_DEV_ONLINE;
+
+    if (d->stats.transactions == 1) {
+        d->stats.latency_avg_us = latency_us;
+    } else {
+        int32_t delta = (int32_t)latency_us - (int32_t)d->stats.latency_avg_us;
+        d->stats.latency_avg_us += delta / (1 << I2C_LATENCY_EWMA_SHIFT);
+    }
+    if (latency_us > d->stats.latency_max_us) d->stats.latency_max_us = latency_us;
+}
+
+static void record_failure(i2c_dev_t *d, esp_err_t err, int64_t now)
+{
+    d->stats.errors++;
+    d->stats.consecutive_errors++;
+
+    if (err == ESP_ERR_TIMEOUT) {
+        // A slave stretching SCL or holding SDA low wedges every device
+        // behind it; clock it out before the next transaction
+        d->stats.timeouts++;
+        i2c_master_bus_reset(s_q.bus);
+        s_q.bus_resets++;
+    }
+
+    if (d->stats.consecutive_errors >= s_q.cfg.max_failures) {
+        ESP_LOGW(TAG, "%s offline after %d failures (%s)", d->name,
+                 d->stats.consecutive_errors, esp_err_to_name(err));
+        set_offline(d, now);
+        return;
+    }
+
+    uint32_t shift = d->stats.consecutive_errors - 1;
+    uint32_t delay_ms = s_q.cfg.backoff_max_ms;
+    if (shift < 16 && (s_q.cfg.backoff_base_ms << shift) < s_q.cfg.backoff_max_ms) {
+        delay_ms = s_q.cfg.backoff_base_ms << shift;
+    }
+    d->stats.state = I2C_DEV_BACKOFF;
+    d->retry_at_us = now + (int64_t)delay_ms * 1000;
+}
+
+/**
+ * @brief Re-probe offline devices whose interval elapsed
+ * @return Time of the next pending re-probe (INT64_MAX if none)
+ */
+static int64_t reprobe_offline(int64_t now)
+{
+    int64_t next = INT64_MAX;
+
+    for (int i = 0; i < s_q.dev_count; i++) {
+        i2c_dev_t *d = &s_q.devs[i];
+        if (d->stats.state != I2C_DEV_OFFLINE) continue;
+
+        if (d->probe_at_us <= now) {
+            if (probe_device(d)) {
+                d->stats.state = I2C_DEV_ONLINE;
+                d->stats.consecutive_errors = 0;
+                d->stats.recoveries++;
+                ESP_LOGI(TAG, "%s back online", d->name);
+                continue;
+            }
+            d->probe_at_us = now + (int64_t)s_q.cfg.reprobe_ms * 1000;
+        }
+        if (d->probe_at_us < next) next = d->probe_at_us;
+    }
+
+    return next;
+}
+
+// ============================================================================
+// Worker
+// ============================================================================
+
+static void run_txn(const i2c_txn_t *txn)
+{
+    i2c_dev_t *d = &s_q.devs[txn->dev];
+    uint8_t rx[I2C_QUEUE_MAX_XFER];
+    i2c_txn_result_t res = {.err = ESP_OK, .rx = rx, .rx_len = txn->rx_len, .latency_us = 0};
+    int64_t now = esp_timer_get_time();
+
+    if (d->stats.state == I2C_DEV_OFFLINE ||
+        (d->stats.state == I2C_DEV_BACKOFF && now < d->retry_at_us)) {
+        d->stats.rejected++;
+        res.err = ESP_ERR_INVALID_STATE;
+        res.rx_len = 0;
+        if (txn->cb) txn->cb(txn->dev, &res, txn->arg);
+        return;
+    }
+
+    int timeout = (int)s_q.cfg.timeout_ms;
+    if (txn->tx_len && txn->rx_len) {
+        res.err = i2c_master_transmit_receive(d->handle, txn->tx, txn->tx_len, rx, txn->rx_len, timeout);
+    } else if (txn->tx_len) {
+        res.err = i2c_master_transmit(d->handle, txn->tx, txn->tx_len, timeout);
+    } else {
+        res.err = i2c_master_receive(d->handle, rx, txn->rx_len, timeout);
+    }
+
+    int64_t end = esp_timer_get_time();
+    res.latency_us = (uint32_t)(end - now);
+
+    if (res.err == ESP_OK) {
+        record_success(d, res.latency_us);
+    } else {
+        record_failure(d, res.err, end);
+        res.rx_len = 0;
+    }
+
+    if (txn->cb) txn->cb(txn->dev, &res, txn->arg);
+}
+
+static void i2c_queue_worker(void *pvParameters)
+{
+    i2c_txn_t txn;
+    int64_t next_probe = INT64_MAX;
+
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        if (next_probe != INT64_MAX) {
+            int64_t wait_us = next_probe - esp_timer_get_time();
+            wait = (wait_us > 0) ? pdMS_TO_TICKS((wait_us + 999) / 1000) + 1 : 0;
+        }
+
+        if (xQueueReceive(s_q.queue, &txn, wait) == pdTRUE) {
+            if (txn.dev == I2C_QUEUE_STOP_DEV) break;
+            run_txn(&txn);
+        }
+
+        next_probe = reprobe_offline(esp_timer_get_time());
+    }
+
+    xSemaphoreGive(s_q.worker_done);
+    vTaskDelete(NULL);
+}
+
+static void sync_done_cb(int dev, const i2c_txn_result_t *result, void *arg)
+{
+    i2c_sync_ctx_t *ctx = (i2c_sync_ctx_t *)arg;
+    ctx->err = result->err;
+    if (result->err == ESP_OK && ctx->rx && result->rx_len) {
+        memcpy(ctx->rx, result->rx, result->rx_len);
+    }
+    xSemaphoreGive(s_q.sync_done);
+}
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+esp_err_t i2c_queue_init(i2c_master_bus_handle_t bus, const i2c_queue_config_t *cfg)
+{
+    if (!bus || !cfg || cfg->max_failures == 0) return ESP_ERR_INVALID_ARG;
+    if (s_q.worker) return ESP_ERR_INVALID_STATE;
+
+    memset(&s_q, 0, sizeof(s_q));
+    s_q.bus = bus;
+    s_q.cfg = *cfg;
+
+    s_q.queue = xQueueCreate(I2C_QUEUE_DEPTH, sizeof(i2c_txn_t));
+    s_q.worker_done = xSemaphoreCreateBinary();
+    s_q.sync_lock = xSemaphoreCreateMutex();
+    s_q.sync_done = xSemaphoreCreateBinary();
+    if (!s_q.queue || !s_q.worker_done || !s_q.sync_lock || !s_q.sync_done) {
+        i2c_queue_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Above the sensor scheduler so completions are never starved
+    if (xTaskCreatePinnedToCore(i2c_queue_worker, "i2c_queue", 3072, NULL, 4,
+                                &s_q.worker, I2C_QUEUE_CORE) != pdPASS) {
+        s_q.worker = NULL;
+        i2c_queue_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+
+    return ESP_OK;
+}
+
+void i2c_queue_deinit(void)
+{
+    if (s_q.worker) {
+        i2c_txn_t stop = {.dev = I2C_QUEUE_STOP_DEV};
+        xQueueSend(s_q.queue, &stop, portMAX_DELAY);
+        xSemaphoreTake(s_q.worker_done, portMAX_DELAY);
+    }
+
+    for (int i = 0; i < s_q.dev_count; i++) {
+        if (s_q.devs[i].handle) i2c_master_bus_rm_device(s_q.devs[i].handle);
+    }
+
+    if (s_q.queue) vQueueDelete(s_q.queue);
+    if (s_q.worker_done) vSemaphoreDelete(s_q.worker_done);
+    if (s_q.sync_lock) vSemaphoreDelete(s_q.sync_lock);
+    if (s_q.sync_done) vSemaphoreDelete(s_q.sync_done);
+
+    memset(&s_q, 0, sizeof(s_q));
+}
+
+int i2c_queue_add_device(const char *name, uint16_t addr, uint32_t scl_hz, i2c_dev_init_fn_t init)
+{
+    if (!s_q.worker || s_q.dev_count >= I2C_QUEUE_MAX_DEVICES) return -1;
+
+    i2c_device_config_t dev_config = {
+        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
+        .device_address = addr,
+        .scl_speed_hz = scl_hz,
+    };
+
+    i2c_dev_t *d = &s_q.devs[s_q.dev_count];
+    memset(d, 0, sizeof(*d));
+    d->name = name;
+    d->addr = addr;
+    d->init = init;
+    if (i2c_master_bus_add_device(s_q.bus, &dev_config, &d->handle) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to add %s", name);
+        return -1;
+    }
+
+    // Not visible to the worker until dev_count is bumped, so probing
+    // here cannot race a re-probe
+    if (probe_device(d)) {
+        d->stats.state = I2C_DEV_ONLINE;
+        ESP_LOGI(TAG, "%s found at 0x%02X", name, addr);
+    } else {
+        set_offline(d, esp_timer_get_time());
+        ESP_LOGW(TAG, "%s not responding at 0x%02X, will re-probe", name, addr);
+    }
+
+    return s_q.dev_count++;
+}
+
+esp_err_t i2c_queue_submit(int dev, const uint8_t *tx, size_t tx_len, size_t rx_len,
+                           i2c_txn_cb_t cb, void *arg)
+{
+    if (!s_q.worker) return ESP_ERR_INVALID_STATE;
+    if (dev < 0 || dev >= s_q.dev_count || tx_len > I2C_QUEUE_MAX_XFER ||
+        rx_len > I2C_QUEUE_MAX_XFER || (tx_len == 0 && rx_len == 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    i2c_txn_t txn = {
+        .dev = dev,
+        .tx_len = (uint8_t)tx_len,
+        .rx_len = (uint8_t)rx_len,
+        .cb = cb,
+        .arg = arg,
+    };
+    if (tx_len) memcpy(txn.tx, tx, tx_len);
+
+    return (xQueueSend(s_q.queue, &txn, 0) == pdTRUE) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t i2c_queue_transfer(int dev, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
+{
+    if (!s_q.worker) return ESP_ERR_INVALID_STATE;
+
+    xSemaphoreTake(s_q.sync_lock, portMAX_DELAY);
+
+    i2c_sync_ctx_t ctx = {.rx = rx, .err = ESP_FAIL};
+    esp_err_t ret = i2c_queue_submit(dev, tx, tx_len, rx_len, sync_done_cb, &ctx);
+    if (ret == ESP_OK) {
+        // Every transaction completes within its bus timeout, so this is
+        // bounded by the queue depth; never abandon ctx while it is queued
+        xSemaphoreTake(s_q.sync_done, portMAX_DELAY);
+        ret = ctx.err;
+    }
+
+    xSemaphoreGive(s_q.sync_lock);
+    return ret;
+}
+
+bool i2c_queue_device_online(int dev)
+{
+    if (dev < 0 || dev >= s_q.dev_count) return false;
+    return s_q.devs[dev].stats.state == I2C_DEV_ONLINE;
+}
+
+bool i2c_queue_device_present(int dev)
+{
+    if (dev < 0 || dev >= s_q.dev_count) return false;
+    return s_q.devs[dev].stats.state != I2C_DEV_OFFLINE;
+}
+
+void i2c_queue_get_stats(int dev, i2c_dev_stats_t *stats)
+{
+    if (!stats) return;
+    if (dev < 0 || dev >= s_q.dev_count) {
+        memset(stats, 0, sizeof(*stats));
+        stats->state = I2C_DEV_OFFLINE;
+        return;
+    }
+    *stats = s_q.devs[dev].stats;
+}
+
+uint32_t i2c_queue_bus_resets(void)
+{
+    return s_q.bus_resets;
+}
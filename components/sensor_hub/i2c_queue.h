@@ -0,0 +1,163 @@
+/**
+ * @file i2c_queue.h
+ * @brief Asynchronous I2C transaction queue with per-device fault isolation
+ *
+ * One worker task owns the master bus and runs queued transactions in
+ * order, so a slow or wedged device costs at most one timeout:
+ *
+ *   submit() ──► [ queue ] ──► worker ──► i2c_master_* ──► callback
+ *                                 │
+ *                                 └── per device: ONLINE ──fail──► BACKOFF
+ *                                          ▲   (exponential, capped)  │
+ *                                          │                    N fails
+ *                                       re-probe ◄──── OFFLINE ◄──────┘
+ *
+ *   - Transactions for a device in backoff / offline complete at once
+ *     with ESP_ERR_INVALID_STATE and never touch the bus
+ *   - A timeout resets the bus (clocks out a slave holding SDA low)
+ *   - Offline devices are re-probed periodically; the device init hook
+ *     runs again on recovery (and on hot-plug of a device absent at boot)
+ *   - Callbacks run on the worker task and must not block
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/i2c_master.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define I2C_QUEUE_MAX_DEVICES   8
+#define I2C_QUEUE_MAX_XFER      16          // Max TX / RX bytes per transaction
+#define I2C_QUEUE_DEPTH         16
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Device link state
+ */
+typedef enum {
+    I2C_DEV_ONLINE = 0,
+    I2C_DEV_BACKOFF,            // Recent failure; retried after a delay
+    I2C_DEV_OFFLINE,            // Disabled; re-probed periodically
+} i2c_dev_state_t;
+
+/**
+ * @brief Per-device counters
+ */
+typedef struct {
+    i2c_dev_state_t state;
+    uint32_t transactions;      // Completed on the bus
+    uint32_t errors;            // Failed on the bus
+    uint32_t timeouts;          // Failures that timed out
+    uint32_t rejected;          // Completed without bus access (backoff / offline)
+    uint32_t recoveries;        // Brought back online by re-probe
+    uint16_t consecutive_errors;
+    uint32_t latency_avg_us;    // Smoothed, successful transactions
+    uint32_t latency_max_us;
+} i2c_dev_stats_t;
+
+/**
+ * @brief Transaction result passed to the callback
+ */
+typedef struct {
+    esp_err_t err;
+    const uint8_t *rx;          // Valid during the callback only
+    size_t rx_len;
+    uint32_t latency_us;
+} i2c_txn_result_t;
+
+typedef void (*i2c_txn_cb_t)(int dev, const i2c_txn_result_t *result, void *arg);
+
+/**
+ * @brief Device init hook, run after a successful probe (boot and recovery)
+ */
+typedef esp_err_t (*i2c_dev_init_fn_t)(i2c_master_dev_handle_t dev);
+
+/**
+ * @brief Queue configuration
+ */
+typedef struct {
+    uint32_t timeout_ms;        // Per-transaction bus timeout
+    uint32_t backoff_base_ms;   // First retry delay (doubles per failure)
+    uint32_t backoff_max_ms;
+    uint16_t max_failures;      // Consecutive failures before going offline
+    uint32_t reprobe_ms;        // Offline re-probe interval
+} i2c_queue_config_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Start the queue worker on an existing master bus
+ */
+esp_err_t i2c_queue_init(i2c_master_bus_handle_t bus, const i2c_queue_config_t *cfg);
+
+/**
+ * @brief Stop the worker and remove all devices (the bus is not deleted)
+ */
+void i2c_queue_deinit(void);
+
+/**
+ * @brief Add a device, probe it and run its init hook
+ *
+ * A device that does not answer is added OFFLINE and re-probed later.
+ *
+ * @param name   Name for logs
+ * @param addr   7-bit address
+ * @param scl_hz Bus speed for this device
+ * @param init   Init hook (NULL if none)
+ * @return Device index, or -1 on failure
+ */
+int i2c_queue_add_device(const char *name, uint16_t addr, uint32_t scl_hz, i2c_dev_init_fn_t init);
+
+/**
+ * @brief Queue a transaction
+ *
+ * tx only = write, rx only = read, both = write-then-read (repeated start).
+ *
+ * @return ESP_OK if queued, ESP_ERR_TIMEOUT if the queue is full
+ */
+esp_err_t i2c_queue_submit(int dev, const uint8_t *tx, size_t tx_len, size_t rx_len,
+                           i2c_txn_cb_t cb, void *arg);
+
+/**
+ * @brief Queue a transaction and wait for it (not from a callback)
+ */
+esp_err_t i2c_queue_transfer(int dev, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len);
+
+/**
+ * @brief Device is online (not in backoff or offline)
+ */
+bool i2c_queue_device_online(int dev);
+
+/**
+ * @brief Device is reachable at all (online or in backoff)
+ */
+bool i2c_queue_device_present(int dev);
+
+/**
+ * @brief Get per-device counters
+ */
+void i2c_queue_get_stats(int dev, i2c_dev_stats_t *stats);
+
+/**
+ * @brief Number of bus resets after timeouts
+ */
+uint32_t i2c_queue_bus_resets(void);
+
+#ifdef __cplusplus
+}
+#endif
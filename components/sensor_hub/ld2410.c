@@ -0,0 +1,181 @@
+/**
+ * @file ld2410.c
+ * @brief LD2410 streaming parser implementation
+ */
+
+#include "ld2410.h"
+#include <string.h>
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+static const uint8_t REPORT_HEADER[4] = {0xF4, 0xF3, 0xF2, 0xF1};
+static const uint8_t REPORT_FOOTER[4] = {0xF8, 0xF7, 0xF6, 0xF5};
+static const uint8_t CMD_HEADER[4] = {0xFD, 0xFC, 0xFB, 0xFA};
+static const uint8_t CMD_FOOTER[4] = {0x04, 0x03, 0x02, 0x01};
+
+#define TYPE_ENGINEERING        0x01
+#define TYPE_BASIC              0x02
+#define PAYLOAD_HEAD            0xAA
+#define PAYLOAD_TAIL            0x55
+#define TARGET_LEN              9
+#define BASIC_PAYLOAD_LEN       (2 + TARGET_LEN + 2)
+
+typedef enum {
+    PARSE_HEADER = 0,
+    PARSE_LEN_LO,
+    PARSE_LEN_HI,
+    PARSE_PAYLOAD,
+    PARSE_FOOTER,
+} parse_state_t;
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static uint16_t get_le16(const uint8_t *b)
+{
+    return (uint16_t)(b[0] | (b[1] << 8));
+}
+
+static uint8_t clamp_energy(uint8_t e)
+{
+    return (e > 100) ? 100 : e;
+}
+
+/**
+ * @brief Decode a payload whose length and framing already checked out
+ */
+static bool decode_payload(const uint8_t *pl, uint16_t len, ld2410_report_t *r)
+{
+    if (len < BASIC_PAYLOAD_LEN) return false;
+    if (pl[0] != TYPE_BASIC && pl[0] != TYPE_ENGINEERING) return false;
+    if (pl[1] != PAYLOAD_HEAD || pl[len - 2] != PAYLOAD_TAIL) return false;
+
+    const uint8_t *t = &pl[2];
+    memset(r, 0, sizeof(*r));
+    r->target = (ld2410_target_t)(t[0] & 0x03);
+    r->moving_distance_cm = get_le16(&t[1]);
+    r->moving_energy = clamp_energy(t[3]);
+    r->stationary_distance_cm = get_le16(&t[4]);
+    r->stationary_energy = clamp_energy(t[6]);
+    r->detection_distance_cm = get_le16(&t[7]);
+
+    if (pl[0] == TYPE_ENGINEERING) {
+        // max moving gate N, max stationary gate M, N+1 + M+1 energies
+        const uint8_t *e = &t[TARGET_LEN];
+        const uint8_t *end = &pl[len - 2];
+        if (e + 2 > end) return false;
+
+        uint8_t n = e[0], m = e[1];
+        if (n >= LD2410_MAX_GATES || m >= LD2410_MAX_GATES) return false;
+        if (e + 2 + (n + 1) + (m + 1) > end) return false;
+
+        r->engineering = true;
+        r->max_moving_gate = n;
+        r->max_stationary_gate = m;
+        for (int g = 0; g <= n; g++) r->moving_gate_energy[g] = clamp_energy(e[2 + g]);
+        for (int g = 0; g <= m; g++) r->stationary_gate_energy[g] = clamp_energy(e[3 + n + g]);
+    }
+
+    return true;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+void ld2410_parser_reset(ld2410_parser_t *p)
+{
+    p->state = PARSE_HEADER;
+    p->match = 0;
+    p->len = 0;
+    p->pos = 0;
+}
+
+bool ld2410_parser_feed(ld2410_parser_t *p, uint8_t byte, ld2410_report_t *report)
+{
+    switch (p->state) {
+        case PARSE_HEADER:
+            if (byte == REPORT_HEADER[p->match]) {
+                if (++p->match == sizeof(REPORT_HEADER)) {
+                    p->match = 0;
+                    p->state = PARSE_LEN_LO;
+                }
+            } else {
+                // The header has no repeated bytes, so a mismatch can only
+                // restart on a fresh F4
+                p->match = (byte == REPORT_HEADER[0]) ? 1 : 0;
+            }
+            return false;
+
+        case PARSE_LEN_LO:
+            p->len = byte;
+            p->state = PARSE_LEN_HI;
+            return false;
+
+        case PARSE_LEN_HI:
+            p->len |= (uint16_t)byte << 8;
+            if (p->len < BASIC_PAYLOAD_LEN || p->len > LD2410_MAX_PAYLOAD) {
+                p->errors++;
+                ld2410_parser_reset(p);
+                return false;
+            }
+            p->pos = 0;
+            p->state = PARSE_PAYLOAD;
+            return false;
+
+        case PARSE_PAYLOAD:
+            p->payload[p->pos++] = byte;
+            if (p->pos == p->len) {
+                p->match = 0;
+                p->state = PARSE_FOOTER;
+            }
+            return false;
+
+        case PARSE_FOOTER:
+            if (byte != REPORT_FOOTER[p->match]) {
+                p->errors++;
+                ld2410_parser_reset(p);
+                if (byte == REPORT_HEADER[0]) p->match = 1;
+                return false;
+            }
+            if (++p->match < sizeof(REPORT_FOOTER)) return false;
+
+            uint16_t len = p->len;
+            ld2410_parser_reset(p);
+            if (!decode_payload(p->payload, len, report)) {
+                p->errors++;
+                return false;
+            }
+            p->frames++;
+            return true;
+
+        default:
+            ld2410_parser_reset(p);
+            return false;
+    }
+}
+
+size_t ld2410_build_command(uint16_t cmd, const uint8_t *value, size_t value_len, uint8_t *out)
+{
+    size_t body = 2 + value_len;
+    size_t total = sizeof(CMD_HEADER) + 2 + body + sizeof(CMD_FOOTER);
+    if (total > LD2410_CMD_MAX_LEN) return 0;
+
+    uint8_t *w = out;
+    memcpy(w, CMD_HEADER, sizeof(CMD_HEADER));
+    w += sizeof(CMD_HEADER);
+    *w++ = body & 0xFF;
+    *w++ = body >> 8;
+    *w++ = cmd & 0xFF;
+    *w++ = cmd >> 8;
+    if (value_len) {
+        memcpy(w, value, value_len);
+        w += value_len;
+    }
+    memcpy(w, CMD_FOOTER, sizeof(CMD_FOOTER));
+
+    return total;
+}
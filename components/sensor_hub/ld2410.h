@@ -0,0 +1,113 @@
+/**
+ * @file ld2410.h
+ * @brief Streaming parser for the Hi-Link LD2410 radar UART protocol
+ *
+ * Report frame (little-endian):
+ *
+ *   F4 F3 F2 F1 | len(2) | type | AA | target(9) [engineering] | 55 | 00 | F8 F7 F6 F5
+ *
+ *   type 0x02 = basic, 0x01 = engineering (adds per-gate energies)
+ *   target    = state, moving dist(2) + energy, stationary dist(2) + energy,
+ *               detection dist(2)
+ *
+ * The parser is a byte-at-a-time state machine over a caller-owned struct:
+ * frames may be split across reads at any point, nothing is allocated,
+ * and command ACK frames (FD FC FB FA ... 04 03 02 01) are skipped.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define LD2410_MAX_PAYLOAD      64
+#define LD2410_MAX_GATES        9           // Gates 0-8 (0.75 m each)
+#define LD2410_CMD_MAX_LEN      24
+
+// Commands (sent inside FD FC FB FA ... 04 03 02 01)
+#define LD2410_CMD_ENABLE_CONFIG        0x00FF
+#define LD2410_CMD_END_CONFIG           0x00FE
+#define LD2410_CMD_ENGINEERING_ON       0x0062
+#define LD2410_CMD_ENGINEERING_OFF      0x0063
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Target state field
+ */
+typedef enum {
+    LD2410_TARGET_NONE = 0,
+    LD2410_TARGET_MOVING = 1,
+    LD2410_TARGET_STATIONARY = 2,
+    LD2410_TARGET_BOTH = 3,
+} ld2410_target_t;
+
+/**
+ * @brief Decoded report frame
+ */
+typedef struct {
+    ld2410_target_t target;
+    uint16_t moving_distance_cm;
+    uint8_t moving_energy;              // 0-100
+    uint16_t stationary_distance_cm;
+    uint8_t stationary_energy;          // 0-100
+    uint16_t detection_distance_cm;
+
+    // Engineering mode only
+    bool engineering;
+    uint8_t max_moving_gate;
+    uint8_t max_stationary_gate;
+    uint8_t moving_gate_energy[LD2410_MAX_GATES];
+    uint8_t stationary_gate_energy[LD2410_MAX_GATES];
+} ld2410_report_t;
+
+/**
+ * @brief Parser state (caller-owned)
+ */
+typedef struct {
+    uint8_t state;
+    uint8_t match;                      // Header / footer bytes matched
+    uint16_t len;
+    uint16_t pos;
+    uint8_t payload[LD2410_MAX_PAYLOAD];
+
+    uint32_t frames;                    // Valid report frames
+    uint32_t errors;                    // Bad length, footer or payload
+} ld2410_parser_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Reset parser state (counters are kept)
+ */
+void ld2410_parser_reset(ld2410_parser_t *p);
+
+/**
+ * @brief Feed one byte
+ * @return true when a complete, valid report has been written to *report
+ */
+bool ld2410_parser_feed(ld2410_parser_t *p, uint8_t byte, ld2410_report_t *report);
+
+/**
+ * @brief Build a command frame
+ * @param out Buffer of at least LD2410_CMD_MAX_LEN bytes
+ * @return Frame length, 0 if value does not fit
+ */
+size_t ld2410_build_command(uint16_t cmd, const uint8_t *value, size_t value_len, uint8_t *out);
+
+#ifdef __cplusplus
+}
+#endif
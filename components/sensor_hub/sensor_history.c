@@ -0,0 +1,513 @@
+/**
+ * @file sensor_history.c
+ * @brief Multi-resolution sensor time-series store implementation
+ */
+
+#include "sensor_history.h"
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "sensor_history";
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define HIST_BLOCK_BYTES        192
+#define HIST_RAW_BLOCK_POINTS   128
+#define HIST_ROLLUP_BLOCK_POINTS 64
+#define HIST_RAW_POINT_BYTES    5           // One 5-byte varint (worst case)
+#define HIST_ROLLUP_POINT_BYTES 15          // Three 5-byte varints
+#define HIST_MAX_GAP_BYTES      2           // Marker plus a skip count < 128
+#define HIST_GAP_MARKER         0           // Mean tokens are zigzag(delta) + 1
+
+_Static_assert(HIST_RAW_BLOCK_POINTS <= 128 && HIST_ROLLUP_BLOCK_POINTS <= 128,
+               "skip counts must fit one varint byte");
+
+#define US_PER_S                1000000LL
+
+// ============================================================================
+// Internal Types
+// ============================================================================
+
+typedef struct {
+    int64_t first_slot;                 // Slot (time / period) of the first point
+    uint16_t count;                     // Slots spanned, including skipped ones
+    uint16_t points;                    // Slots actually holding a point
+    uint16_t len;                       // Encoded bytes
+    int32_t last_mean;                  // Delta base for the next append
+    uint8_t data[HIST_BLOCK_BYTES];
+} hist_block_t;
+
+typedef struct {
+    hist_block_t *blocks;
+    uint16_t cap;
+    uint16_t oldest;
+    uint16_t count;
+} hist_ring_t;
+
+typedef struct {
+    int64_t period_us;
+    uint32_t retention_slots;
+    uint16_t block_points;              // Slots one block may span
+    uint8_t point_bytes;                // Worst-case encoded point
+    bool rollup;
+} hist_tier_t;
+
+typedef struct {
+    int64_t slot;
+    int64_t sum;
+    int32_t min;
+    int32_t max;
+    uint32_t count;                     // 0 = empty
+} hist_acc_t;
+
+typedef struct {
+    bool initialized;
+    SemaphoreHandle_t mutex;
+    hist_block_t *pool;
+    size_t pool_blocks;
+
+    hist_tier_t tiers[SENSOR_HISTORY_RES_COUNT];
+    hist_ring_t rings[SENSOR_HISTORY_RES_COUNT][SENSOR_METRIC_COUNT];
+    hist_acc_t acc[SENSOR_HISTORY_RES_COUNT][SENSOR_METRIC_COUNT];     // Rollup tiers only
+    int64_t last_raw_slot[SENSOR_METRIC_COUNT];
+    int64_t last_timestamp_us;          // Last snapshot folded into the rollups
+
+    uint32_t blocks_evicted;
+} sensor_history_state_t;
+
+static sensor_history_state_t s_hist = {0};
+
+/**
+ * @brief Metric names and fixed-point scale (stored = value × scale)
+ */
+static const struct {
+    const char *name;
+    float scale;
+} METRICS[SENSOR_METRIC_COUNT] = {
+    [SENSOR_METRIC_TEMPERATURE] = {"temperature", 100.0f},
+    [SENSOR_METRIC_HUMIDITY]    = {"humidity",    10.0f},
+    [SENSOR_METRIC_PRESSURE]    = {"pressure",    100.0f},
+    [SENSOR_METRIC_CO2]         = {"co2",         1.0f},
+    [SENSOR_METRIC_TVOC]        = {"tvoc",        1.0f},
+    [SENSOR_METRIC_ECO2]        = {"eco2",        1.0f},
+    [SENSOR_METRIC_VOC_INDEX]   = {"voc_index",   1.0f},
+    [SENSOR_METRIC_LUX]         = {"lux",         10.0f},
+};
+
+// ============================================================================
+// Encoding Helpers
+// ============================================================================
+
+static inline uint32_t zigzag(int32_t v)
+{
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t u)
+{
+    return (int32_t)(u >> 1) ^ -(int32_t)(u & 1);
+}
+
+static size_t put_varint(uint8_t *p, uint32_t v)
+{
+    size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    p[n++] = (uint8_t)v;
+    return n;
+}
+
+static size_t get_varint(const uint8_t *p, size_t avail, uint32_t *v)
+{
+    uint32_t result = 0;
+    for (size_t n = 0; n < avail && n < 5; n++) {
+        result |= (uint32_t)(p[n] & 0x7F) << (7 * n);
+        if (!(p[n] & 0x80)) {
+            *v = result;
+            return n + 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Extract a metric as a scaled integer
+ * @return false if the sensor reading is not valid
+ */
+static bool metric_sample(const sensor_data_t *d, sensor_metric_t m, int32_t *v)
+{
+    float x;
+    switch (m) {
+        case SENSOR_METRIC_TEMPERATURE: if (!d->sht40_valid) return false;  x = d->temperature; break;
+        case SENSOR_METRIC_HUMIDITY:    if (!d->sht40_valid) return false;  x = d->humidity; break;
+        case SENSOR_METRIC_PRESSURE:    if (!d->bmp388_valid) return false; x = d->pressure; break;
+        case SENSOR_METRIC_CO2:         if (!d->scd41_valid) return false;  x = d->co2; break;
+        case SENSOR_METRIC_TVOC:        if (!d->ens160_valid) return false; x = d->tvoc; break;
+        case SENSOR_METRIC_ECO2:        if (!d->ens160_valid) return false; x = d->eco2; break;
+        case SENSOR_METRIC_VOC_INDEX:   if (!d->sgp40_valid) return false;  x = (float)d->voc_index; break;
+        case SENSOR_METRIC_LUX:         if (!d->bh1750_valid) return false; x = d->lux; break;
+        default:                        return false;
+    }
+    *v = (int32_t)lroundf(x * METRICS[m].scale);
+    return true;
+}
+
+// ============================================================================
+// Block Rings
+// ============================================================================
+
+static hist_block_t *ring_at(const hist_ring_t *r, uint16_t i)
+{
+    return &r->blocks[(r->oldest + i) % r->cap];
+}
+
+static hist_block_t *ring_newest(const hist_ring_t *r)
+{
+    return r->count ? ring_at(r, r->count - 1) : NULL;
+}
+
+/**
+ * @brief Open a new block, dropping the oldest when the ring is full
+ */
+static hist_block_t *ring_open(hist_ring_t *r, int64_t slot)
+{
+    if (r->count == r->cap) {
+        r->oldest = (r->oldest + 1) % r->cap;
+        r->count--;
+        s_hist.blocks_evicted++;
+    }
+    hist_block_t *b = ring_at(r, r->count++);
+    b->first_slot = slot;
+    b->count = 0;
+    b->points = 0;
+    b->len = 0;
+    b->last_mean = 0;
+    return b;
+}
+
+/**
+ * @brief Append one point to a tier
+ */
+static void tier_append(sensor_history_res_t res, sensor_metric_t m, int64_t slot,
+                        int32_t mean, int32_t min, int32_t max)
+{
+    const hist_tier_t *t = &s_hist.tiers[res];
+    hist_ring_t *r = &s_hist.rings[res][m];
+    hist_block_t *b = ring_newest(r);
+
+    // Missed slots (read jitter, sensor dropouts) are recorded in-block as a
+    // skip marker instead of closing the block early
+    int64_t next = b ? b->first_slot + b->count : 0;
+    if (!b || slot < next || slot - b->first_slot >= t->block_points ||
+        b->len + HIST_MAX_GAP_BYTES + t->point_bytes > HIST_BLOCK_BYTES) {
+        b = ring_open(r, slot);
+        next = slot;
+    }
+
+    if (slot > next) {
+        b->data[b->len++] = HIST_GAP_MARKER;
+        b->len += put_varint(&b->data[b->len], (uint32_t)(slot - next));
+        b->count += (uint16_t)(slot - next);
+    }
+
+    b->len += put_varint(&b->data[b->len], zigzag(mean - b->last_mean) + 1);
+    if (t->rollup) {
+        b->len += put_varint(&b->data[b->len], (uint32_t)(mean - min));
+        b->len += put_varint(&b->data[b->len], (uint32_t)(max - mean));
+    }
+    b->last_mean = mean;
+    b->count++;
+    b->points++;
+}
+
+static void acc_flush(sensor_history_res_t res, sensor_metric_t m)
+{
+    hist_acc_t *a = &s_hist.acc[res][m];
+    if (a->count == 0) return;
+
+    int32_t mean = (int32_t)(a->sum / (int64_t)a->count);
+    tier_append(res, m, a->slot, mean, a->min, a->max);
+    a->count = 0;
+}
+
+static void acc_add(sensor_history_res_t res, sensor_metric_t m, int64_t slot, int32_t v)
+{
+    hist_acc_t *a = &s_hist.acc[res][m];
+    if (a->count && a->slot != slot) acc_flush(res, m);
+
+    if (a->count == 0) {
+        a->slot = slot;
+        a->sum = 0;
+        a->min = v;
+        a->max = v;
+    }
+    a->sum += v;
+    if (v < a->min) a->min = v;
+    if (v > a->max) a->max = v;
+    a->count++;
+}
+
+static void emit_point(sensor_history_point_t *p, int64_t slot, int64_t period_us,
+                       sensor_metric_t m, int32_t mean, int32_t min, int32_t max)
+{
+    float scale = METRICS[m].scale;
+    p->timestamp_us = slot * period_us;
+    p->mean = (float)mean / scale;
+    p->min = (float)min / scale;
+    p->max = (float)max / scale;
+}
+
+/**
+ * @brief Finest tier whose history reaches back to from_us
+ */
+static sensor_history_res_t pick_resolution(sensor_metric_t m, int64_t from_us)
+{
+    for (int res = 0; res < SENSOR_HISTORY_RES_COUNT; res++) {
+        const hist_ring_t *r = &s_hist.rings[res][m];
+        if (r->count == 0) {
+            if (res == SENSOR_HISTORY_RAW) return SENSOR_HISTORY_RAW;
+            continue;
+        }
+        if (ring_at(r, 0)->first_slot * s_hist.tiers[res].period_us <= from_us) {
+            return (sensor_history_res_t)res;
+        }
+    }
+    return SENSOR_HISTORY_15MIN;
+}
+
+// ============================================================================
+// Public API Implementation
+// ============================================================================
+
+esp_err_t sensor_history_init(void)
+{
+    if (s_hist.initialized) return ESP_OK;
+
+    hist_tier_t *t = s_hist.tiers;
+    t[SENSOR_HISTORY_RAW] = (hist_tier_t){
+        .period_us = CONFIG_SENSOR_HISTORY_RAW_PERIOD_S * US_PER_S,
+        .retention_slots = CONFIG_SENSOR_HISTORY_RAW_MINUTES * 60 / CONFIG_SENSOR_HISTORY_RAW_PERIOD_S,
+        .block_points = HIST_RAW_BLOCK_POINTS,
+        .point_bytes = HIST_RAW_POINT_BYTES,
+        .rollup = false,
+    };
+    t[SENSOR_HISTORY_1MIN] = (hist_tier_t){
+        .period_us = 60 * US_PER_S,
+        .retention_slots = CONFIG_SENSOR_HISTORY_1MIN_HOURS * 60,
+        .block_points = HIST_ROLLUP_BLOCK_POINTS,
+        .point_bytes = HIST_ROLLUP_POINT_BYTES,
+        .rollup = true,
+    };
+    t[SENSOR_HISTORY_15MIN] = (hist_tier_t){
+        .period_us = 15 * 60 * US_PER_S,
+        .retention_slots = CONFIG_SENSOR_HISTORY_15MIN_DAYS * 24 * 4,
+        .block_points = HIST_ROLLUP_BLOCK_POINTS,
+        .point_bytes = HIST_ROLLUP_POINT_BYTES,
+        .rollup = true,
+    };
+
+    // Enough blocks for the retention when every point takes its worst-case
+    // size, plus the partially filled newest block and one being evicted.
+    // A block closes once the next point might not fit, so it holds at
+    // least span points; a skip marker costs 2 bytes but covers >= 2 slots,
+    // so gaps only lengthen a block.
+    uint16_t caps[SENSOR_HISTORY_RES_COUNT];
+    s_hist.pool_blocks = 0;
+    for (int res = 0; res < SENSOR_HISTORY_RES_COUNT; res++) {
+        uint32_t span = (HIST_BLOCK_BYTES - HIST_MAX_GAP_BYTES - t[res].point_bytes) /
+                        t[res].point_bytes + 1;
+        if (span > t[res].block_points) span = t[res].block_points;
+        caps[res] = (uint16_t)((t[res].retention_slots + span - 1) / span + 2);
+        s_hist.pool_blocks += (size_t)caps[res] * SENSOR_METRIC_COUNT;
+    }
+
+    s_hist.pool = heap_caps_calloc(s_hist.pool_blocks, sizeof(hist_block_t), MALLOC_CAP_SPIRAM);
+    s_hist.mutex = xSemaphoreCreateMutex();
+    if (!s_hist.pool || !s_hist.mutex) {
+        ESP_LOGE(TAG, "Failed to allocate history store");
+        sensor_history_deinit();
+        return ESP_ERR_NO_MEM;
+    }
+
+    hist_block_t *next = s_hist.pool;
+    for (int res = 0; res < SENSOR_HISTORY_RES_COUNT; res++) {
+        for (int m = 0; m < SENSOR_METRIC_COUNT; m++) {
+            s_hist.rings[res][m] = (hist_ring_t){.blocks = next, .cap = caps[res]};
+            next += caps[res];
+        }
+    }
+    for (int m = 0; m < SENSOR_METRIC_COUNT; m++) {
+        s_hist.last_raw_slot[m] = -1;
+    }
+
+    s_hist.initialized = true;
+    ESP_LOGI(TAG, "History store: %u blocks, %u KB PSRAM",
+             (unsigned)s_hist.pool_blocks,
+             (unsigned)(s_hist.pool_blocks * sizeof(hist_block_t) / 1024));
+    return ESP_OK;
+}
+
+void sensor_history_deinit(void)
+{
+    if (s_hist.pool) heap_caps_free(s_hist.pool);
+    if (s_hist.mutex) vSemaphoreDelete(s_hist.mutex);
+    memset(&s_hist, 0, sizeof(s_hist));
+}
+
+void sensor_history_record(const sensor_data_t *data)
+{
+    if (!s_hist.initialized || !data) return;
+
+    int64_t now = data->timestamp_us ? data->timestamp_us : esp_timer_get_time();
+    int64_t raw_slot = now / s_hist.tiers[SENSOR_HISTORY_RAW].period_us;
+
+    xSemaphoreTake(s_hist.mutex, portMAX_DELAY);
+
+    // The same snapshot handed in twice must not be counted twice in the
+    // rollup means
+    if (data->timestamp_us && data->timestamp_us == s_hist.last_timestamp_us) {
+        xSemaphoreGive(s_hist.mutex);
+        return;
+    }
+    s_hist.last_timestamp_us = data->timestamp_us;
+
+    for (int m = 0; m < SENSOR_METRIC_COUNT; m++) {
+        int32_t v;
+        if (!metric_sample(data, (sensor_metric_t)m, &v)) continue;
+
+        if (raw_slot != s_hist.last_raw_slot[m]) {
+            tier_append(SENSOR_HISTORY_RAW, (sensor_metric_t)m, raw_slot, v, v, v);
+            s_hist.last_raw_slot[m] = raw_slot;
+        }
+
+        for (int res = SENSOR_HISTORY_1MIN; res < SENSOR_HISTORY_RES_COUNT; res++) {
+            acc_add((sensor_history_res_t)res, (sensor_metric_t)m,
+                    now / s_hist.tiers[res].period_us, v);
+        }
+    }
+
+    xSemaphoreGive(s_hist.mutex);
+}
+
+int sensor_history_query(sensor_metric_t metric, sensor_history_res_t res,
+                         int64_t from_us, int64_t to_us,
+                         sensor_history_point_t *out, int max_points)
+{
+    if (!s_hist.initialized || metric < 0 || metric >= SENSOR_METRIC_COUNT ||
+        !out || max_points <= 0 || to_us < from_us) {
+        return -1;
+    }
+
+    xSemaphoreTake(s_hist.mutex, portMAX_DELAY);
+
+    if (res == SENSOR_HISTORY_AUTO) res = pick_resolution(metric, from_us);
+    if (res < 0 || res >= SENSOR_HISTORY_RES_COUNT) {
+        xSemaphoreGive(s_hist.mutex);
+        return -1;
+    }
+
+    const hist_tier_t *t = &s_hist.tiers[res];
+    const hist_ring_t *r = &s_hist.rings[res][metric];
+    int64_t from_slot = (from_us + t->period_us - 1) / t->period_us;
+    int64_t to_slot = to_us / t->period_us;
+    int n = 0;
+
+    for (uint16_t i = 0; i < r->count && n < max_points; i++) {
+        const hist_block_t *b = ring_at(r, i);
+        if (b->first_slot + b->count <= from_slot) continue;
+        if (b->first_slot > to_slot) break;
+
+        size_t pos = 0;
+        int32_t mean = 0;
+        int64_t slot = b->first_slot;
+        while (pos < b->len && n < max_points) {
+            uint32_t u, lo = 0, hi = 0;
+            size_t used = get_varint(&b->data[pos], b->len - pos, &u);
+            if (used == 0) break;
+            pos += used;
+            if (u == HIST_GAP_MARKER) {
+                used = get_varint(&b->data[pos], b->len - pos, &u);
+                if (used == 0) break;
+                pos += used;
+                slot += u;
+                continue;
+            }
+            if (t->rollup) {
+                used = get_varint(&b->data[pos], b->len - pos, &lo);
+                if (used == 0) break;
+                pos += used;
+                used = get_varint(&b->data[pos], b->len - pos, &hi);
+                if (used == 0) break;
+                pos += used;
+            }
+            mean += unzigzag(u - 1);
+
+            int64_t point_slot = slot++;
+            if (point_slot < from_slot) continue;
+            if (point_slot > to_slot) break;
+            emit_point(&out[n++], point_slot, t->period_us, metric,
+                       mean, mean - (int32_t)lo, mean + (int32_t)hi);
+        }
+    }
+
+    // Bucket still accumulating
+    const hist_acc_t *a = &s_hist.acc[res][metric];
+    if (t->rollup && a->count && n < max_points &&
+        a->slot >= from_slot && a->slot <= to_slot) {
+        emit_point(&out[n++], a->slot, t->period_us, metric,
+                   (int32_t)(a->sum / (int64_t)a->count), a->min, a->max);
+    }
+
+    xSemaphoreGive(s_hist.mutex);
+    return n;
+}
+
+int64_t sensor_history_period_us(sensor_history_res_t res)
+{
+    if (res < 0 || res >= SENSOR_HISTORY_RES_COUNT) return 0;
+    if (!s_hist.initialized) {
+        static const int64_t defaults[SENSOR_HISTORY_RES_COUNT] = {
+            CONFIG_SENSOR_HISTORY_RAW_PERIOD_S * US_PER_S, 60 * US_PER_S, 15 * 60 * US_PER_S,
+        };
+        return defaults[res];
+    }
+    return s_hist.tiers[res].period_us;
+}
+
+void sensor_history_get_stats(sensor_history_stats_t *stats)
+{
+    if (!stats) return;
+    memset(stats, 0, sizeof(*stats));
+    if (!s_hist.initialized) return;
+
+    xSemaphoreTake(s_hist.mutex, portMAX_DELAY);
+    for (int res = 0; res < SENSOR_HISTORY_RES_COUNT; res++) {
+        for (int m = 0; m < SENSOR_METRIC_COUNT; m++) {
+            const hist_ring_t *r = &s_hist.rings[res][m];
+            for (uint16_t i = 0; i < r->count; i++) {
+                const hist_block_t *b = ring_at(r, i);
+                stats->points[res] += b->points;
+                stats->bytes_used[res] += b->len;
+            }
+        }
+    }
+    stats->bytes_total = (uint32_t)(s_hist.pool_blocks * sizeof(hist_block_t));
+    stats->blocks_evicted = s_hist.blocks_evicted;
+    xSemaphoreGive(s_hist.mutex);
+}
+
+const char *sensor_history_metric_name(sensor_metric_t metric)
+{
+    if (metric < 0 || metric >= SENSOR_METRIC_COUNT) return "unknown";
+    return METRICS[metric].name;
+}
@@ -0,0 +1,142 @@
+/**
+ * @file sensor_history.h
+ * @brief Multi-resolution sensor time-series store (PSRAM)
+ *
+ * Three tiers per metric, each a ring of delta-encoded blocks:
+ *
+ *   raw    every CONFIG_SENSOR_HISTORY_RAW_PERIOD_S, last
+ *          CONFIG_SENSOR_HISTORY_RAW_MINUTES
+ *   1 min  min / max / mean, last CONFIG_SENSOR_HISTORY_1MIN_HOURS
+ *   15 min min / max / mean, last CONFIG_SENSOR_HISTORY_15MIN_DAYS
+ *
+ * Values are stored as scaled integers (e.g. 0.01 °C). A block spans up
+ * to 128 (raw) or 64 slots: zigzag varint of (mean - previous mean) + 1,
+ * plus (mean - min) and (max - mean) for rollups, so a steady reading
+ * costs 1 byte per raw point and ~3 per rollup. A missing or invalid
+ * sample is a 0 marker followed by the skipped slot count; gaps are
+ * simply absent from query results. Rings are sized for the retention
+ * at worst-case point sizes; when one is full the oldest block is dropped.
+ *
+ * Rollups are fed from every recorded sample, not from the raw tier; a
+ * snapshot recorded twice (same timestamp_us) is counted once.
+ * Timestamps are esp_timer time (µs since boot), as in sensor_data_t.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "sensor_hub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Recorded metrics
+ */
+typedef enum {
+    SENSOR_METRIC_TEMPERATURE = 0,  // °C (SHT40)
+    SENSOR_METRIC_HUMIDITY,         // %RH (SHT40)
+    SENSOR_METRIC_PRESSURE,         // hPa (BMP388)
+    SENSOR_METRIC_CO2,              // ppm (SCD41)
+    SENSOR_METRIC_TVOC,             // ppb (ENS160)
+    SENSOR_METRIC_ECO2,             // ppm (ENS160)
+    SENSOR_METRIC_VOC_INDEX,        // 0-500 (SGP40)
+    SENSOR_METRIC_LUX,              // lux (BH1750)
+    SENSOR_METRIC_COUNT
+} sensor_metric_t;
+
+/**
+ * @brief Query resolution
+ */
+typedef enum {
+    SENSOR_HISTORY_RAW = 0,
+    SENSOR_HISTORY_1MIN,
+    SENSOR_HISTORY_15MIN,
+    SENSOR_HISTORY_RES_COUNT,
+    SENSOR_HISTORY_AUTO = -1,       // Finest tier that still covers from_us
+} sensor_history_res_t;
+
+/**
+ * @brief One point (raw points have min == max == mean)
+ */
+typedef struct {
+    int64_t timestamp_us;           // Start of the slot
+    float mean;
+    float min;
+    float max;
+} sensor_history_point_t;
+
+/**
+ * @brief Store usage
+ */
+typedef struct {
+    uint32_t points[SENSOR_HISTORY_RES_COUNT];      // Stored, all metrics
+    uint32_t bytes_used[SENSOR_HISTORY_RES_COUNT];  // Encoded payload
+    uint32_t bytes_total;                           // PSRAM allocated
+    uint32_t blocks_evicted;
+} sensor_history_stats_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Allocate the store in PSRAM
+ */
+esp_err_t sensor_history_init(void);
+
+/**
+ * @brief Free the store
+ */
+void sensor_history_deinit(void);
+
+/**
+ * @brief Record a reading (invalid sensors are skipped)
+ *
+ * Call at any rate; the raw tier keeps the first sample of each raw slot,
+ * rollups average every sample.
+ */
+void sensor_history_record(const sensor_data_t *data);
+
+/**
+ * @brief Read points in [from_us, to_us], oldest first
+ *
+ * Rollup queries include the bucket still being filled.
+ *
+ * @param metric     Metric
+ * @param res        Resolution (or SENSOR_HISTORY_AUTO)
+ * @param from_us    Start time (esp_timer µs)
+ * @param to_us      End time
+ * @param out        Output points
+ * @param max_points Capacity of out
+ * @return Number of points written, or -1 on error
+ */
+int sensor_history_query(sensor_metric_t metric, sensor_history_res_t res,
+                         int64_t from_us, int64_t to_us,
+                         sensor_history_point_t *out, int max_points);
+
+/**
+ * @brief Slot period of a resolution in µs
+ */
+int64_t sensor_history_period_us(sensor_history_res_t res);
+
+/**
+ * @brief Get store usage
+ */
+void sensor_history_get_stats(sensor_history_stats_t *stats);
+
+/**
+ * @brief Metric name ("temperature", ...)
+ */
+const char *sensor_history_metric_name(sensor_metric_t metric);
+
+#ifdef __cplusplus
+}
+#endif
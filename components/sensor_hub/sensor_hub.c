@@ -5,12 +5,17 @@
 
 #include "sensor_hub.h"
 #include <string.h>
+#include <stddef.h>
+#include <stdatomic.h>
 #include <math.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#include "freertos/queue.h"
 #include "driver/i2c_master.h"
 #include "driver/uart.h"
+#include "i2c_queue.h"
+#include "ld2410.h"
 #include "esp_log.h"
 #include "esp_timer.h"
 #include "sdkconfig.h"
@@ -59,76 +64,223 @@ static const char *TAG = "sensor_hub";
 // SGP40 commands
 #define SGP40_CMD_MEASURE_RAW       0x260F
 
+// Conversion times (datasheet maximum, rounded up)
+#define SHT40_CONVERSION_MS         10      // High repeatability: 8.3ms
+#define SGP40_CONVERSION_MS         30
+#define SCD41_CONVERSION_MS         1       // read_measurement execution time
+
 // BH1750 commands
 #define BH1750_CMD_POWER_ON         0x01
 #define BH1750_CMD_CONTINUOUS_HIGH  0x10
 
+// ============================================================================
+// Acquisition Scheduler Types
+// ============================================================================
+
+/**
+ * @brief Scheduled I2C sensor
+ *
+ * trigger() fills the command that starts a conversion (NULL for
+ * free-running devices); the collect transaction (optional register
+ * address + collect_len bytes) is queued conversion_ms later and parse()
+ * decodes it. init() runs on every successful probe, including recovery.
+ */
+typedef struct {
+    const char *name;
+    uint16_t addr;
+    uint32_t period_ms;                         // Native sampling period
+    uint32_t conversion_ms;                     // trigger → collect
+    uint32_t startup_ms;                        // First sample after init
+    i2c_dev_init_fn_t init;
+    size_t (*trigger)(const sensor_data_t *work, uint8_t *tx);
+    int16_t collect_reg;                        // Register to read, -1 for a plain read
+    uint8_t collect_len;
+    void (*parse)(const uint8_t *rx, sensor_data_t *work);
+    size_t valid_offset;                        // offsetof(sensor_data_t, *_valid)
+} sensor_sched_desc_t;
+
+typedef enum {
+    SCHED_IDLE = 0,                             // Waiting for due_us to trigger
+    SCHED_TRIGGERING,                           // Trigger transaction queued
+    SCHED_CONVERTING,                           // Waiting for due_us to collect
+    SCHED_COLLECTING,                           // Collect transaction queued
+} sensor_sched_phase_t;
+
+typedef struct {
+    int64_t due_us;
+    int64_t period_start_us;                    // Trigger time of this period
+    sensor_sched_phase_t phase;
+} sensor_sched_state_t;
+
+/**
+ * @brief Transaction completion, posted from the I2C queue worker
+ */
+typedef struct {
+    int8_t id;                                  // sensor_i2c_device_t, -1 = wake only
+    esp_err_t err;
+    uint8_t rx_len;
+    uint8_t rx[I2C_QUEUE_MAX_XFER];
+} sensor_sched_event_t;
+
+// One transaction in flight per sensor, plus wake-ups
+#define SENSOR_SCHED_EVENT_DEPTH    (SENSOR_I2C_DEVICE_COUNT + 2)
+
+// Placement profile: helpers float unless a core is kept free for audio/UI
+#define SENSOR_TASK_CORE    ((CONFIG_TASK_CORE_HELPER < 0) ? tskNO_AFFINITY : CONFIG_TASK_CORE_HELPER)
+
 // ============================================================================
 // Internal State
 // ============================================================================
 
 typedef struct {
     i2c_master_bus_handle_t i2c_bus;
-    i2c_master_dev_handle_t dev_sht40;
-    i2c_master_dev_handle_t dev_bmp388;
-    i2c_master_dev_handle_t dev_scd41;
-    i2c_master_dev_handle_t dev_ens160;
-    i2c_master_dev_handle_t dev_sgp40;
-    i2c_master_dev_handle_t dev_bh1750;
-
-    QueueHandle_t ld2410_queue;
+    int i2c_dev[SENSOR_I2C_DEVICE_COUNT];       // i2c_queue device index
+
+    QueueHandle_t ld2410_queue;         // UART driver events
     QueueHandle_t sen0540_queue;
 
+    // LD2410 presence (UART task writes, readers copy under s_presence_lock)
+    ld2410_parser_t ld2410_parser;      // UART task only
+    ld2410_report_t ld2410_report;
+    presence_state_t presence;
+    uint16_t presence_distance;
+    uint8_t presence_energy;
+    int64_t ld2410_last_frame_us;
+    sensor_presence_cb_t presence_cb;
+    void *presence_ctx;
+
     sensor_status_t status;
-    SemaphoreHandle_t mutex;
+    SemaphoreHandle_t mutex;            // Serializes calibration
     bool initialized;
+
+    // Acquisition scheduler
+    TaskHandle_t acq_task;
+    SemaphoreHandle_t acq_done;
+    QueueHandle_t acq_events;
+    volatile bool acq_running;
+    volatile bool scd41_hold;           // Calibration owns the SCD41
+    volatile bool scd41_resync;         // Restart SCD41 schedule after calibration
+    sensor_sched_state_t sched[SENSOR_I2C_DEVICE_COUNT];
+    sensor_data_t work;                 // Scheduler-owned working copy
+
+    // Double-buffered snapshot: the scheduler writes snapshot[(seq + 1) & 1]
+    // and then bumps seq; readers copy snapshot[seq & 1] and retry if seq moved
+    sensor_data_t snapshot[2];
+    _Atomic uint32_t snapshot_seq;
 } sensor_hub_state_t;
 
 static sensor_hub_state_t s_hub = {0};
 
 // ============================================================================
-// I2C Helper Functions
+// Device Init Hooks
 // ============================================================================
+//
+// Called by the I2C queue with the raw device handle, at boot and whenever
+// an offline device answers a re-probe.
 
-static esp_err_t i2c_write_cmd(i2c_master_dev_handle_t dev, uint16_t cmd)
+#define SENSOR_INIT_TIMEOUT_MS      50
+
+static esp_err_t init_write_cmd(i2c_master_dev_handle_t dev, uint16_t cmd)
 {
     uint8_t data[2] = {cmd >> 8, cmd & 0xFF};
-    return i2c_master_transmit(dev, data, 2, 100);
+    return i2c_master_transmit(dev, data, 2, SENSOR_INIT_TIMEOUT_MS);
 }
 
-static esp_err_t i2c_write_reg(i2c_master_dev_handle_t dev, uint8_t reg, uint8_t value)
+static esp_err_t init_write_reg(i2c_master_dev_handle_t dev, uint8_t reg, uint8_t value)
 {
     uint8_t data[2] = {reg, value};
-    return i2c_master_transmit(dev, data, 2, 100);
+    return i2c_master_transmit(dev, data, 2, SENSOR_INIT_TIMEOUT_MS);
 }
 
-static esp_err_t i2c_read_reg(i2c_master_dev_handle_t dev, uint8_t reg, uint8_t *buf, size_t len)
+static esp_err_t init_read_reg(i2c_master_dev_handle_t dev, uint8_t reg, uint8_t *buf, size_t len)
 {
-    return i2c_master_transmit_receive(dev, &reg, 1, buf, len, 100);
+    return i2c_master_transmit_receive(dev, &reg, 1, buf, len, SENSOR_INIT_TIMEOUT_MS);
 }
 
-// ============================================================================
-// Individual Sensor Drivers
-// ============================================================================
-
 /**
- * @brief Read SHT40 temperature and humidity
+ * @brief Verify BMP388 chip ID and enter normal mode
  */
-static esp_err_t read_sht40(sensor_data_t *data)
+static esp_err_t init_bmp388(i2c_master_dev_handle_t dev)
 {
-    if (!s_hub.dev_sht40) return ESP_ERR_INVALID_STATE;
+    uint8_t chip_id;
+    esp_err_t ret = init_read_reg(dev, BMP388_REG_CHIP_ID, &chip_id, 1);
+    if (ret != ESP_OK) return ret;
+    if (chip_id != BMP388_CHIP_ID) return ESP_ERR_NOT_FOUND;
 
-    uint8_t cmd = SHT40_CMD_MEASURE_HIGH;
-    uint8_t buf[6];
+    // Normal mode, pressure + temperature enabled
+    return init_write_reg(dev, BMP388_REG_PWR_CTRL, 0x33);
+}
 
-    esp_err_t ret = i2c_master_transmit(s_hub.dev_sht40, &cmd, 1, 100);
+/**
+ * @brief Start SCD41 periodic measurement
+ */
+static esp_err_t init_scd41(i2c_master_dev_handle_t dev)
+{
+    // NACKed while periodic measurement is already running (recovery from
+    // a bus fault); the probe has already shown the device is there
+    init_write_cmd(dev, SCD41_CMD_START_MEASUREMENT);
+    return ESP_OK;
+}
+
+/**
+ * @brief Verify ENS160 part ID and enter standard operation mode
+ */
+static esp_err_t init_ens160(i2c_master_dev_handle_t dev)
+{
+    uint8_t part_id[2];
+    esp_err_t ret = init_read_reg(dev, ENS160_REG_PART_ID, part_id, 2);
     if (ret != ESP_OK) return ret;
+    if ((part_id[0] | (part_id[1] << 8)) != ENS160_PART_ID) return ESP_ERR_NOT_FOUND;
 
-    vTaskDelay(pdMS_TO_TICKS(10));  // Measurement time
+    return init_write_reg(dev, ENS160_REG_OPMODE, 0x02);
+}
 
-    ret = i2c_master_receive(s_hub.dev_sht40, buf, 6, 100);
+/**
+ * @brief Power on BH1750 in continuous high-res mode
+ */
+static esp_err_t init_bh1750(i2c_master_dev_handle_t dev)
+{
+    uint8_t cmd = BH1750_CMD_POWER_ON;
+    esp_err_t ret = i2c_master_transmit(dev, &cmd, 1, SENSOR_INIT_TIMEOUT_MS);
     if (ret != ESP_OK) return ret;
 
+    cmd = BH1750_CMD_CONTINUOUS_HIGH;
+    return i2c_master_transmit(dev, &cmd, 1, SENSOR_INIT_TIMEOUT_MS);
+}
+
+// ============================================================================
+// Individual Sensor Drivers (trigger / parse halves)
+// ============================================================================
+
+/**
+ * @brief Sensirion CRC-8 (poly 0x31, init 0xFF)
+ */
+static uint8_t sensirion_crc8(const uint8_t *data, size_t len)
+{
+    uint8_t crc = 0xFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int b = 0; b < 8; b++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x31) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * @brief Start SHT40 high-repeatability measurement
+ */
+static size_t trigger_sht40(const sensor_data_t *work, uint8_t *tx)
+{
+    tx[0] = SHT40_CMD_MEASURE_HIGH;
+    return 1;
+}
+
+/**
+ * @brief Parse SHT40 temperature and humidity
+ */
+static void parse_sht40(const uint8_t *buf, sensor_data_t *data)
+{
     // Parse temperature (skip CRC at buf[2])
     uint16_t t_raw = (buf[0] << 8) | buf[1];
     data->temperature = -45.0f + 175.0f * ((float)t_raw / 65535.0f);
@@ -140,55 +292,38 @@ static esp_err_t read_sht40(sensor_data_t *data)
     // Clamp humidity
     if (data->humidity < 0) data->humidity = 0;
     if (data->humidity > 100) data->humidity = 100;
-
-    data->sht40_valid = true;
-    return ESP_OK;
 }
 
 /**
- * @brief Read BMP388 pressure
+ * @brief Parse BMP388 pressure (free-running in normal mode)
  */
-static esp_err_t read_bmp388(sensor_data_t *data)
+static void parse_bmp388(const uint8_t *buf, sensor_data_t *data)
 {
-    if (!s_hub.dev_bmp388) return ESP_ERR_INVALID_STATE;
-
-    uint8_t buf[6];
-    esp_err_t ret = i2c_read_reg(s_hub.dev_bmp388, BMP388_REG_DATA, buf, 6);
-    if (ret != ESP_OK) return ret;
-
     // Parse pressure (24-bit)
     uint32_t p_raw = buf[0] | (buf[1] << 8) | (buf[2] << 16);
 
-    // Parse temperature (24-bit)
-    uint32_t t_raw = buf[3] | (buf[4] << 8) | (buf[5] << 16);
-
     // Simplified calculation (should use calibration data)
     data->pressure = (float)p_raw / 256.0f / 100.0f;  // hPa
 
     // Calculate altitude from pressure (ISA formula)
     data->altitude = 44330.0f * (1.0f - powf(data->pressure / 1013.25f, 0.1903f));
-
-    data->bmp388_valid = true;
-    return ESP_OK;
 }
 
 /**
- * @brief Read SCD41 CO2
+ * @brief Request SCD41 measurement readout (periodic mode, new data every 5s)
  */
-static esp_err_t read_scd41(sensor_data_t *data)
+static size_t trigger_scd41(const sensor_data_t *work, uint8_t *tx)
 {
-    if (!s_hub.dev_scd41) return ESP_ERR_INVALID_STATE;
-
-    // Send read measurement command
-    esp_err_t ret = i2c_write_cmd(s_hub.dev_scd41, SCD41_CMD_READ_MEASUREMENT);
-    if (ret != ESP_OK) return ret;
-
-    vTaskDelay(pdMS_TO_TICKS(1));
-
-    uint8_t buf[9];
-    ret = i2c_master_receive(s_hub.dev_scd41, buf, 9, 100);
-    if (ret != ESP_OK) return ret;
+    tx[0] = SCD41_CMD_READ_MEASUREMENT >> 8;
+    tx[1] = SCD41_CMD_READ_MEASUREMENT & 0xFF;
+    return 2;
+}
 
+/**
+ * @brief Parse SCD41 CO2
+ */
+static void parse_scd41(const uint8_t *buf, sensor_data_t *data)
+{
     // Parse CO2 (skip CRC bytes)
     data->co2 = (buf[0] << 8) | buf[1];
 
@@ -199,94 +334,438 @@ static esp_err_t read_scd41(sensor_data_t *data)
     // Parse humidity
     uint16_t h_raw = (buf[6] << 8) | buf[7];
     data->scd41_humidity = 100.0f * ((float)h_raw / 65535.0f);
+}
 
-    data->scd41_valid = true;
-    return ESP_OK;
+/**
+ * @brief Parse ENS160 air quality (AQI, TVOC, eCO2 in one burst)
+ */
+static void parse_ens160(const uint8_t *buf, sensor_data_t *data)
+{
+    // DATA_AQI (0x21), DATA_TVOC (0x22-23), DATA_ECO2 (0x24-25) are contiguous
+    data->aqi = (air_quality_level_t)(buf[0] & 0x07);
+    data->tvoc = buf[ENS160_REG_DATA_TVOC - ENS160_REG_DATA_AQI] |
+                 (buf[ENS160_REG_DATA_TVOC - ENS160_REG_DATA_AQI + 1] << 8);
+    data->eco2 = buf[ENS160_REG_DATA_ECO2 - ENS160_REG_DATA_AQI] |
+                 (buf[ENS160_REG_DATA_ECO2 - ENS160_REG_DATA_AQI + 1] << 8);
 }
 
 /**
- * @brief Read ENS160 air quality
+ * @brief Start SGP40 raw measurement
+ *
+ * Uses the latest SHT40 reading for humidity / temperature compensation
+ * (falls back to the datasheet defaults: 50 %RH, 25 °C).
  */
-static esp_err_t read_ens160(sensor_data_t *data)
+static size_t trigger_sgp40(const sensor_data_t *work, uint8_t *tx)
 {
-    if (!s_hub.dev_ens160) return ESP_ERR_INVALID_STATE;
+    uint16_t rh_ticks = 0x8000;
+    uint16_t t_ticks = 0x6666;
+    if (work->sht40_valid) {
+        rh_ticks = (uint16_t)(work->humidity * 65535.0f / 100.0f);
+        t_ticks = (uint16_t)((work->temperature + 45.0f) * 65535.0f / 175.0f);
+    }
 
-    uint8_t buf[5];
+    tx[0] = SGP40_CMD_MEASURE_RAW >> 8;
+    tx[1] = SGP40_CMD_MEASURE_RAW & 0xFF;
+    tx[2] = rh_ticks >> 8;
+    tx[3] = rh_ticks & 0xFF;
+    tx[4] = sensirion_crc8(&tx[2], 2);
+    tx[5] = t_ticks >> 8;
+    tx[6] = t_ticks & 0xFF;
+    tx[7] = sensirion_crc8(&tx[5], 2);
+    return 8;
+}
 
-    // Read AQI
-    esp_err_t ret = i2c_read_reg(s_hub.dev_ens160, ENS160_REG_DATA_AQI, buf, 1);
-    if (ret != ESP_OK) return ret;
-    data->aqi = (air_quality_level_t)(buf[0] & 0x07);
+/**
+ * @brief Parse SGP40 VOC index
+ */
+static void parse_sgp40(const uint8_t *buf, sensor_data_t *data)
+{
+    data->voc_raw = (buf[0] << 8) | buf[1];
 
-    // Read TVOC
-    ret = i2c_read_reg(s_hub.dev_ens160, ENS160_REG_DATA_TVOC, buf, 2);
-    if (ret != ESP_OK) return ret;
-    data->tvoc = buf[0] | (buf[1] << 8);
+    // VOC index algorithm (simplified - should use Sensirion's algorithm)
+    // Map raw signal to 0-500 index
+    data->voc_index = (data->voc_raw * 500) / 65535;
+}
 
-    // Read eCO2
-    ret = i2c_read_reg(s_hub.dev_ens160, ENS160_REG_DATA_ECO2, buf, 2);
-    if (ret != ESP_OK) return ret;
-    data->eco2 = buf[0] | (buf[1] << 8);
+/**
+ * @brief Parse BH1750 ambient light (continuous high-res mode)
+ */
+static void parse_bh1750(const uint8_t *buf, sensor_data_t *data)
+{
+    uint16_t raw = (buf[0] << 8) | buf[1];
+    data->lux = (float)raw / 1.2f;  // Default mode resolution
+}
 
-    data->ens160_valid = true;
-    return ESP_OK;
+// ============================================================================
+// Acquisition Scheduler
+// ============================================================================
+//
+// Every due sensor's trigger is queued at once and each collect is queued
+// when its own conversion deadline passes, so conversions overlap instead
+// of adding up (SHT40 10ms + SGP40 30ms + SCD41 1ms → ~30ms of wall time).
+// The task never touches the bus: it queues transactions, sleeps until the
+// earliest deadline or a completion, and folds results into the working
+// copy. A sensor in backoff has its transactions rejected without bus time;
+// an offline sensor is skipped until the queue re-probes it.
+
+static const sensor_sched_desc_t SENSOR_SCHEDULE[SENSOR_I2C_DEVICE_COUNT] = {
+    [SENSOR_I2C_SHT40] = {
+        .name = "SHT40", .addr = SHT40_ADDR,
+        .period_ms = CONFIG_SENSOR_CLIMATE_INTERVAL_MS, .conversion_ms = SHT40_CONVERSION_MS,
+        .trigger = trigger_sht40, .collect_reg = -1, .collect_len = 6, .parse = parse_sht40,
+        .valid_offset = offsetof(sensor_data_t, sht40_valid),
+    },
+    [SENSOR_I2C_BMP388] = {
+        .name = "BMP388", .addr = BMP388_ADDR, .init = init_bmp388,
+        .period_ms = CONFIG_SENSOR_CLIMATE_INTERVAL_MS,
+        .collect_reg = BMP388_REG_DATA, .collect_len = 6, .parse = parse_bmp388,
+        .valid_offset = offsetof(sensor_data_t, bmp388_valid),
+    },
+    [SENSOR_I2C_SCD41] = {
+        .name = "SCD41", .addr = SCD41_ADDR, .init = init_scd41,
+        .period_ms = CONFIG_SENSOR_SCD41_INTERVAL_MS, .conversion_ms = SCD41_CONVERSION_MS,
+        .startup_ms = CONFIG_SENSOR_SCD41_INTERVAL_MS,
+        .trigger = trigger_scd41, .collect_reg = -1, .collect_len = 9, .parse = parse_scd41,
+        .valid_offset = offsetof(sensor_data_t, scd41_valid),
+    },
+    [SENSOR_I2C_ENS160] = {
+        .name = "ENS160", .addr = ENS160_ADDR, .init = init_ens160,
+        .period_ms = CONFIG_SENSOR_ENS160_INTERVAL_MS,
+        .collect_reg = ENS160_REG_DATA_AQI, .collect_len = 5, .parse = parse_ens160,
+        .valid_offset = offsetof(sensor_data_t, ens160_valid),
+    },
+    [SENSOR_I2C_SGP40] = {
+        .name = "SGP40", .addr = SGP40_ADDR,
+        .period_ms = CONFIG_SENSOR_SGP40_INTERVAL_MS, .conversion_ms = SGP40_CONVERSION_MS,
+        .trigger = trigger_sgp40, .collect_reg = -1, .collect_len = 3, .parse = parse_sgp40,
+        .valid_offset = offsetof(sensor_data_t, sgp40_valid),
+    },
+    [SENSOR_I2C_BH1750] = {
+        .name = "BH1750", .addr = BH1750_ADDR, .init = init_bh1750,
+        .period_ms = CONFIG_SENSOR_LIGHT_INTERVAL_MS,
+        .collect_reg = -1, .collect_len = 2, .parse = parse_bh1750,
+        .valid_offset = offsetof(sensor_data_t, bh1750_valid),
+    },
+};
+
+static bool *sensor_valid_flag(sensor_i2c_device_t id)
+{
+    return (bool *)((uint8_t *)&s_hub.work + SENSOR_SCHEDULE[id].valid_offset);
+}
+
+static bool sched_in_flight(const sensor_sched_state_t *st)
+{
+    return st->phase == SCHED_TRIGGERING || st->phase == SCHED_COLLECTING;
 }
 
 /**
- * @brief Read SGP40 VOC index
+ * @brief Publish the working copy to the reader side
  */
-static esp_err_t read_sgp40(sensor_data_t *data)
+static void publish_snapshot(void)
 {
-    if (!s_hub.dev_sgp40) return ESP_ERR_INVALID_STATE;
+    uint32_t seq = atomic_load_explicit(&s_hub.snapshot_seq, memory_order_relaxed);
+    s_hub.work.timestamp_us = esp_timer_get_time();
+    s_hub.snapshot[(seq + 1) & 1] = s_hub.work;
+    atomic_store_explicit(&s_hub.snapshot_seq, seq + 1, memory_order_release);
+}
 
-    // Send measure command with default humidity/temp compensation
-    uint8_t cmd[] = {0x26, 0x0F, 0x80, 0x00, 0xA2, 0x66, 0x66, 0x93};
-    esp_err_t ret = i2c_master_transmit(s_hub.dev_sgp40, cmd, sizeof(cmd), 100);
-    if (ret != ESP_OK) return ret;
+/**
+ * @brief Copy the latest snapshot (never blocks on the bus)
+ */
+static void read_snapshot(sensor_data_t *data)
+{
+    uint32_t seq;
+    do {
+        seq = atomic_load_explicit(&s_hub.snapshot_seq, memory_order_acquire);
+        *data = s_hub.snapshot[seq & 1];
+        atomic_thread_fence(memory_order_acquire);
+    } while (atomic_load_explicit(&s_hub.snapshot_seq, memory_order_relaxed) != seq);
+}
 
-    vTaskDelay(pdMS_TO_TICKS(30));  // Measurement time
+/**
+ * @brief Wake the acquisition task (deinit, calibration done)
+ */
+static void sched_wake(void)
+{
+    sensor_sched_event_t ev = {.id = -1};
+    xQueueSend(s_hub.acq_events, &ev, 0);
+}
 
-    uint8_t buf[3];
-    ret = i2c_master_receive(s_hub.dev_sgp40, buf, 3, 100);
-    if (ret != ESP_OK) return ret;
+/**
+ * @brief I2C queue callback: hand the result to the acquisition task
+ */
+static void sched_txn_done(int dev, const i2c_txn_result_t *result, void *arg)
+{
+    sensor_sched_event_t ev = {
+        .id = (int8_t)(intptr_t)arg,
+        .err = result->err,
+        .rx_len = (uint8_t)result->rx_len,
+    };
+    if (result->rx_len) memcpy(ev.rx, result->rx, result->rx_len);
 
-    data->voc_raw = (buf[0] << 8) | buf[1];
+    // Cannot overflow: at most one transaction per sensor is in flight
+    xQueueSend(s_hub.acq_events, &ev, portMAX_DELAY);
+}
 
-    // VOC index algorithm (simplified - should use Sensirion's algorithm)
-    // Map raw signal to 0-500 index
-    data->voc_index = (data->voc_raw * 500) / 65535;
+/**
+ * @brief Schedule the next period, keeping the cadence without catching up
+ */
+static void sched_next_period(const sensor_sched_desc_t *desc, sensor_sched_state_t *st, int64_t now)
+{
+    int64_t period_us = (int64_t)desc->period_ms * 1000;
+    st->phase = SCHED_IDLE;
+    st->due_us = st->period_start_us + period_us;
+    if (st->due_us <= now) st->due_us = now + period_us;
+}
 
-    data->sgp40_valid = true;
-    return ESP_OK;
+/**
+ * @brief Queue the next transaction of a sensor whose deadline has passed
+ */
+static void sched_start(sensor_i2c_device_t id, int64_t now)
+{
+    const sensor_sched_desc_t *desc = &SENSOR_SCHEDULE[id];
+    sensor_sched_state_t *st = &s_hub.sched[id];
+    uint8_t tx[I2C_QUEUE_MAX_XFER];
+    size_t tx_len = 0;
+    size_t rx_len = 0;
+    sensor_sched_phase_t next;
+
+    if (st->phase == SCHED_IDLE) {
+        st->period_start_us = now;
+    }
+
+    if (st->phase == SCHED_IDLE && desc->trigger) {
+        tx_len = desc->trigger(&s_hub.work, tx);
+        next = SCHED_TRIGGERING;
+    } else {
+        if (desc->collect_reg >= 0) tx[tx_len++] = (uint8_t)desc->collect_reg;
+        rx_len = desc->collect_len;
+        next = SCHED_COLLECTING;
+    }
+
+    if (i2c_queue_submit(s_hub.i2c_dev[id], tx, tx_len, rx_len,
+                         sched_txn_done, (void *)(intptr_t)id) == ESP_OK) {
+        st->phase = next;
+    } else {
+        st->due_us = now + 10000;       // Queue full; retry shortly
+    }
 }
 
 /**
- * @brief Read BH1750 ambient light
+ * @brief Fold a completed transaction into the working copy
+ * @return true if the working copy changed
  */
-static esp_err_t read_bh1750(sensor_data_t *data)
+static bool sched_complete(const sensor_sched_event_t *ev, int64_t now)
 {
-    if (!s_hub.dev_bh1750) return ESP_ERR_INVALID_STATE;
+    sensor_i2c_device_t id = (sensor_i2c_device_t)ev->id;
+    const sensor_sched_desc_t *desc = &SENSOR_SCHEDULE[id];
+    sensor_sched_state_t *st = &s_hub.sched[id];
+    bool *valid = sensor_valid_flag(id);
+
+    if (ev->err == ESP_OK && st->phase == SCHED_TRIGGERING) {
+        st->phase = SCHED_CONVERTING;
+        st->due_us = now + (int64_t)desc->conversion_ms * 1000;
+        return false;
+    }
 
-    uint8_t buf[2];
-    esp_err_t ret = i2c_master_receive(s_hub.dev_bh1750, buf, 2, 100);
-    if (ret != ESP_OK) return ret;
+    bool changed;
+    if (ev->err == ESP_OK) {
+        desc->parse(ev->rx, &s_hub.work);
+        *valid = true;
+        s_hub.status.read_count++;
+        changed = true;
+    } else {
+        // Rejected in backoff: no bus time spent, already counted
+        if (ev->err != ESP_ERR_INVALID_STATE) s_hub.status.i2c_errors++;
+        changed = *valid;
+        *valid = false;
+    }
 
-    uint16_t raw = (buf[0] << 8) | buf[1];
-    data->lux = (float)raw / 1.2f;  // Default mode resolution
+    sched_next_period(desc, st, now);
+    return changed;
+}
 
-    data->bh1750_valid = true;
-    return ESP_OK;
+/**
+ * @brief Acquisition task: queue due transactions, sleep, fold completions
+ */
+static void sensor_acq_task(void *pvParameters)
+{
+    const int64_t start = esp_timer_get_time();
+    for (int i = 0; i < SENSOR_I2C_DEVICE_COUNT; i++) {
+        s_hub.sched[i].phase = SCHED_IDLE;
+        s_hub.sched[i].due_us = start + (int64_t)SENSOR_SCHEDULE[i].startup_ms * 1000;
+    }
+
+    while (s_hub.acq_running) {
+        int64_t now = esp_timer_get_time();
+        int64_t next = now + 1000000;
+        bool changed = false;
+
+        if (s_hub.scd41_resync) {
+            s_hub.scd41_resync = false;
+            s_hub.sched[SENSOR_I2C_SCD41].phase = SCHED_IDLE;
+            s_hub.sched[SENSOR_I2C_SCD41].due_us = now + (int64_t)CONFIG_SENSOR_SCD41_INTERVAL_MS * 1000;
+        }
+
+        for (int i = 0; i < SENSOR_I2C_DEVICE_COUNT; i++) {
+            sensor_sched_state_t *st = &s_hub.sched[i];
+            if (sched_in_flight(st)) continue;
+            if (i == SENSOR_I2C_SCD41 && s_hub.scd41_hold) continue;
+
+            if (!i2c_queue_device_present(s_hub.i2c_dev[i])) {
+                // Offline: drop the stale value, restart from a trigger
+                // once the queue has re-probed the device
+                bool *valid = sensor_valid_flag((sensor_i2c_device_t)i);
+                changed |= *valid;
+                *valid = false;
+                st->phase = SCHED_IDLE;
+                continue;
+            }
+
+            if (st->due_us <= now) {
+                sched_start((sensor_i2c_device_t)i, now);
+            }
+            if (!sched_in_flight(st) && st->due_us < next) next = st->due_us;
+        }
+
+        if (changed) publish_snapshot();
+
+        // Sleep until the earliest deadline or the next completion
+        TickType_t wait = 0;
+        int64_t wait_us = next - esp_timer_get_time();
+        if (wait_us > 0) {
+            wait = pdMS_TO_TICKS((wait_us + 999) / 1000);
+            if (wait == 0) wait = 1;
+        }
+
+        sensor_sched_event_t ev;
+        if (xQueueReceive(s_hub.acq_events, &ev, wait) == pdTRUE) {
+            changed = false;
+            do {
+                if (ev.id >= 0) changed |= sched_complete(&ev, esp_timer_get_time());
+            } while (xQueueReceive(s_hub.acq_events, &ev, 0) == pdTRUE);
+            if (changed) publish_snapshot();
+        }
+    }
+
+    xSemaphoreGive(s_hub.acq_done);
+    vTaskDelete(NULL);
 }
 
 // ============================================================================
 // UART Sensor Handlers
 // ============================================================================
 
+#define LD2410_RX_BUF_SIZE          512
+#define LD2410_EVENT_QUEUE_LEN      16
+#define LD2410_RX_TIMEOUT_SYMBOLS   3           // Idle gap that ends a burst
+#define LD2410_RX_FULL_THRESHOLD    64
+#define LD2410_FRAME_TIMEOUT_US     1000000     // Radar reports at ~10 Hz
+
+static portMUX_TYPE s_presence_lock = portMUX_INITIALIZER_UNLOCKED;
+
+/**
+ * @brief Map a radar report to presence state, distance and energy
+ */
+static presence_state_t presence_from_report(const ld2410_report_t *r,
+                                             uint16_t *distance, uint8_t *energy)
+{
+    switch (r->target) {
+        case LD2410_TARGET_MOVING:
+        case LD2410_TARGET_BOTH:
+            *distance = r->moving_distance_cm;
+            *energy = r->moving_energy;
+            return PRESENCE_MOVING;
+        case LD2410_TARGET_STATIONARY:
+            *distance = r->stationary_distance_cm;
+            *energy = r->stationary_energy;
+            return PRESENCE_STATIONARY;
+        default:
+            *distance = 0;
+            *energy = 0;
+            return PRESENCE_NONE;
+    }
+}
+
+/**
+ * @brief Store a decoded report and fire the presence callback on change
+ */
+static void ld2410_handle_report(const ld2410_report_t *report)
+{
+    sensor_presence_event_t ev = {.timestamp_us = esp_timer_get_time()};
+    ev.state = presence_from_report(report, &ev.distance, &ev.energy);
+
+    portENTER_CRITICAL(&s_presence_lock);
+    ev.previous = s_hub.presence;
+    s_hub.presence = ev.state;
+    s_hub.presence_distance = ev.distance;
+    s_hub.presence_energy = ev.energy;
+    s_hub.ld2410_report = *report;
+    s_hub.ld2410_last_frame_us = ev.timestamp_us;
+    sensor_presence_cb_t cb = s_hub.presence_cb;
+    void *ctx = s_hub.presence_ctx;
+    portEXIT_CRITICAL(&s_presence_lock);
+
+    if (ev.state != ev.previous && cb) {
+        cb(&ev, ctx);
+    }
+}
+
+static bool ld2410_alive(int64_t last_frame_us)
+{
+    return last_frame_us != 0 &&
+           (esp_timer_get_time() - last_frame_us) < LD2410_FRAME_TIMEOUT_US;
+}
+
+/**
+ * @brief Copy the latest presence fields into a reading
+ */
+static void read_presence(sensor_data_t *data)
+{
+    portENTER_CRITICAL(&s_presence_lock);
+    data->presence = s_hub.presence;
+    data->presence_distance = s_hub.presence_distance;
+    data->presence_energy = s_hub.presence_energy;
+    int64_t last = s_hub.ld2410_last_frame_us;
+    portEXIT_CRITICAL(&s_presence_lock);
+
+    data->ld2410_valid = ld2410_alive(last);
+}
+
+#if CONFIG_LD2410_ENGINEERING_MODE
+/**
+ * @brief Switch the radar to engineering mode (per-gate energies)
+ */
+static void ld2410_enable_engineering(void)
+{
+    static const uint8_t enable_value[2] = {0x01, 0x00};
+    uint8_t frame[LD2410_CMD_MAX_LEN];
+    size_t len;
+
+    len = ld2410_build_command(LD2410_CMD_ENABLE_CONFIG, enable_value, sizeof(enable_value), frame);
+    uart_write_bytes(CONFIG_LD2410_UART_PORT, frame, len);
+    vTaskDelay(pdMS_TO_TICKS(50));
+
+    len = ld2410_build_command(LD2410_CMD_ENGINEERING_ON, NULL, 0, frame);
+    uart_write_bytes(CONFIG_LD2410_UART_PORT, frame, len);
+    vTaskDelay(pdMS_TO_TICKS(50));
+
+    len = ld2410_build_command(LD2410_CMD_END_CONFIG, NULL, 0, frame);
+    uart_write_bytes(CONFIG_LD2410_UART_PORT, frame, len);
+}
+#endif
+
 /**
  * @brief LD2410 UART receive task
+ *
+ * Event driven: the driver posts UART_DATA when the RX FIFO reaches its
+ * threshold or the line has been idle for a few symbols, which is right
+ * after a frame's footer. Bytes go through the streaming parser as they
+ * arrive, so a presence change is published within one frame time.
  */
 static void ld2410_rx_task(void *pvParameters)
 {
+    const uart_port_t port = CONFIG_LD2410_UART_PORT;
     uart_config_t uart_config = {
         .baud_rate = CONFIG_LD2410_UART_BAUD,
         .data_bits = UART_DATA_8_BITS,
@@ -295,24 +774,67 @@ static void ld2410_rx_task(void *pvParameters)
         .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
     };
 
-    uart_param_config(CONFIG_LD2410_UART_PORT, &uart_config);
-    uart_set_pin(CONFIG_LD2410_UART_PORT,
+    uart_param_config(port, &uart_config);
+    uart_set_pin(port,
                  CONFIG_LD2410_UART_TX_GPIO,
                  CONFIG_LD2410_UART_RX_GPIO,
                  UART_PIN_NO_CHANGE,
                  UART_PIN_NO_CHANGE);
-    uart_driver_install(CONFIG_LD2410_UART_PORT, 256, 0, 0, NULL, 0);
+    if (uart_driver_install(port, LD2410_RX_BUF_SIZE, 0, LD2410_EVENT_QUEUE_LEN,
+                            &s_hub.ld2410_queue, 0) != ESP_OK) {
+        ESP_LOGE(TAG, "LD2410 UART init failed");
+        vTaskDelete(NULL);
+        return;
+    }
+    uart_set_rx_timeout(port, LD2410_RX_TIMEOUT_SYMBOLS);
+    uart_set_rx_full_threshold(port, LD2410_RX_FULL_THRESHOLD);
+
+#if CONFIG_LD2410_ENGINEERING_MODE
+    ld2410_enable_engineering();
+#endif
 
-    s_hub.status.ld2410_present = true;
+    ld2410_parser_reset(&s_hub.ld2410_parser);
 
     uint8_t buf[64];
+    ld2410_report_t report;
+    uart_event_t event;
     while (1) {
-        int len = uart_read_bytes(CONFIG_LD2410_UART_PORT, buf, sizeof(buf),
-                                  pdMS_TO_TICKS(100));
-        if (len > 0) {
-            // Parse LD2410 protocol
-            // Frame format: F4 F3 F2 F1 [header] [data] F8 F7 F6 F5
-            // TODO: Implement full protocol parsing
+        if (xQueueReceive(s_hub.ld2410_queue, &event, portMAX_DELAY) != pdTRUE) continue;
+
+        switch (event.type) {
+            case UART_DATA: {
+                size_t pending = event.size;
+                while (pending > 0) {
+                    size_t chunk = pending < sizeof(buf) ? pending : sizeof(buf);
+                    int len = uart_read_bytes(port, buf, chunk, 0);
+                    if (len <= 0) break;
+                    pending -= len;
+
+                    for (int i = 0; i < len; i++) {
+                        if (ld2410_parser_feed(&s_hub.ld2410_parser, buf[i], &report)) {
+                            ld2410_handle_report(&report);
+                        }
+                    }
+                }
+                break;
+            }
+
+            case UART_FIFO_OVF:
+            case UART_BUFFER_FULL:
+                // Bytes were lost: drop everything and resync on the next header
+                s_hub.status.uart_errors++;
+                uart_flush_input(port);
+                xQueueReset(s_hub.ld2410_queue);
+                ld2410_parser_reset(&s_hub.ld2410_parser);
+                break;
+
+            case UART_FRAME_ERR:
+            case UART_PARITY_ERR:
+                s_hub.status.uart_errors++;
+                break;
+
+            default:
+                break;
         }
     }
 }
@@ -384,93 +906,65 @@ esp_err_t sensor_hub_init(void)
     esp_err_t ret = i2c_new_master_bus(&i2c_config, &s_hub.i2c_bus);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to create I2C bus: %s", esp_err_to_name(ret));
+        vSemaphoreDelete(s_hub.mutex);
+        s_hub.mutex = NULL;
         return ret;
     }
 
-    // Probe and initialize each I2C sensor
-    i2c_device_config_t dev_config = {
-        .dev_addr_length = I2C_ADDR_BIT_LEN_7,
-        .scl_speed_hz = CONFIG_SENSOR_I2C_FREQ_HZ,
+    // Transaction queue: per-device timeout, backoff and re-probe
+    i2c_queue_config_t queue_config = {
+        .timeout_ms = CONFIG_SENSOR_I2C_TIMEOUT_MS,
+        .backoff_base_ms = CONFIG_SENSOR_I2C_BACKOFF_BASE_MS,
+        .backoff_max_ms = CONFIG_SENSOR_I2C_BACKOFF_MAX_MS,
+        .max_failures = CONFIG_SENSOR_I2C_MAX_FAILURES,
+        .reprobe_ms = CONFIG_SENSOR_I2C_REPROBE_MS,
     };
-
-    // SHT40
-    dev_config.device_address = SHT40_ADDR;
-    if (i2c_master_bus_add_device(s_hub.i2c_bus, &dev_config, &s_hub.dev_sht40) == ESP_OK) {
-        s_hub.status.sht40_present = true;
-        ESP_LOGI(TAG, "SHT40 found at 0x%02X", SHT40_ADDR);
-    }
-
-    // BMP388
-    dev_config.device_address = BMP388_ADDR;
-    if (i2c_master_bus_add_device(s_hub.i2c_bus, &dev_config, &s_hub.dev_bmp388) == ESP_OK) {
-        // Verify chip ID
-        uint8_t chip_id;
-        if (i2c_read_reg(s_hub.dev_bmp388, BMP388_REG_CHIP_ID, &chip_id, 1) == ESP_OK) {
-            if (chip_id == BMP388_CHIP_ID) {
-                s_hub.status.bmp388_present = true;
-                // Configure for normal mode
-                i2c_write_reg(s_hub.dev_bmp388, BMP388_REG_PWR_CTRL, 0x33);
-                ESP_LOGI(TAG, "BMP388 found at 0x%02X", BMP388_ADDR);
-            }
-        }
-    }
-
-    // SCD41
-    dev_config.device_address = SCD41_ADDR;
-    if (i2c_master_bus_add_device(s_hub.i2c_bus, &dev_config, &s_hub.dev_scd41) == ESP_OK) {
-        // Start periodic measurement
-        if (i2c_write_cmd(s_hub.dev_scd41, SCD41_CMD_START_MEASUREMENT) == ESP_OK) {
-            s_hub.status.scd41_present = true;
-            ESP_LOGI(TAG, "SCD41 found at 0x%02X", SCD41_ADDR);
-        }
-    }
-
-    // ENS160
-    dev_config.device_address = ENS160_ADDR;
-    if (i2c_master_bus_add_device(s_hub.i2c_bus, &dev_config, &s_hub.dev_ens160) == ESP_OK) {
-        // Verify part ID
-        uint8_t part_id[2];
-        if (i2c_read_reg(s_hub.dev_ens160, ENS160_REG_PART_ID, part_id, 2) == ESP_OK) {
-            if ((part_id[0] | (part_id[1] << 8)) == ENS160_PART_ID) {
-                s_hub.status.ens160_present = true;
-                // Set to standard operation mode
-                i2c_write_reg(s_hub.dev_ens160, ENS160_REG_OPMODE, 0x02);
-                ESP_LOGI(TAG, "ENS160 found at 0x%02X", ENS160_ADDR);
-            }
-        }
+    ret = i2c_queue_init(s_hub.i2c_bus, &queue_config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start I2C queue: %s", esp_err_to_name(ret));
+        i2c_del_master_bus(s_hub.i2c_bus);
+        s_hub.i2c_bus = NULL;
+        vSemaphoreDelete(s_hub.mutex);
+        s_hub.mutex = NULL;
+        return ret;
     }
 
-    // SGP40
-    dev_config.device_address = SGP40_ADDR;
-    if (i2c_master_bus_add_device(s_hub.i2c_bus, &dev_config, &s_hub.dev_sgp40) == ESP_OK) {
-        s_hub.status.sgp40_present = true;
-        ESP_LOGI(TAG, "SGP40 found at 0x%02X", SGP40_ADDR);
+    // Probe and initialize each I2C sensor (absent ones are re-probed later)
+    int i2c_found = 0;
+    for (int i = 0; i < SENSOR_I2C_DEVICE_COUNT; i++) {
+        const sensor_sched_desc_t *desc = &SENSOR_SCHEDULE[i];
+        s_hub.i2c_dev[i] = i2c_queue_add_device(desc->name, desc->addr,
+                                                CONFIG_SENSOR_I2C_FREQ_HZ, desc->init);
+        i2c_found += i2c_queue_device_present(s_hub.i2c_dev[i]);
     }
 
-    // BH1750
-    dev_config.device_address = BH1750_ADDR;
-    if (i2c_master_bus_add_device(s_hub.i2c_bus, &dev_config, &s_hub.dev_bh1750) == ESP_OK) {
-        // Power on and set continuous high-res mode
-        uint8_t cmd = BH1750_CMD_POWER_ON;
-        i2c_master_transmit(s_hub.dev_bh1750, &cmd, 1, 100);
-        cmd = BH1750_CMD_CONTINUOUS_HIGH;
-        if (i2c_master_transmit(s_hub.dev_bh1750, &cmd, 1, 100) == ESP_OK) {
-            s_hub.status.bh1750_present = true;
-            ESP_LOGI(TAG, "BH1750 found at 0x%02X", BH1750_ADDR);
-        }
+    // Start I2C acquisition scheduler
+    atomic_store(&s_hub.snapshot_seq, 0);
+    s_hub.acq_done = xSemaphoreCreateBinary();
+    s_hub.acq_events = xQueueCreate(SENSOR_SCHED_EVENT_DEPTH, sizeof(sensor_sched_event_t));
+    s_hub.acq_running = true;
+    if (!s_hub.acq_done || !s_hub.acq_events ||
+        xTaskCreatePinnedToCore(sensor_acq_task, "sensor_acq", 4096, NULL, 3,
+                                &s_hub.acq_task, SENSOR_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to start acquisition task");
+        s_hub.acq_running = false;
+        if (s_hub.acq_done) vSemaphoreDelete(s_hub.acq_done);
+        if (s_hub.acq_events) vQueueDelete(s_hub.acq_events);
+        i2c_queue_deinit();
+        i2c_del_master_bus(s_hub.i2c_bus);
+        vSemaphoreDelete(s_hub.mutex);
+        memset(&s_hub, 0, sizeof(s_hub));
+        return ESP_ERR_NO_MEM;
     }
 
     // Start UART sensor tasks
-    xTaskCreate(ld2410_rx_task, "ld2410", 2048, NULL, 2, NULL);
-    xTaskCreate(sen0540_rx_task, "sen0540", 2048, NULL, 2, NULL);
+    xTaskCreatePinnedToCore(ld2410_rx_task, "ld2410", 2048, NULL, 2, NULL, SENSOR_TASK_CORE);
+    xTaskCreatePinnedToCore(sen0540_rx_task, "sen0540", 2048, NULL, 2, NULL, SENSOR_TASK_CORE);
 
     s_hub.initialized = true;
 
     ESP_LOGI(TAG, "Sensor hub initialized. I2C: %d/%d, UART: 2",
-             s_hub.status.sht40_present + s_hub.status.bmp388_present +
-             s_hub.status.scd41_present + s_hub.status.ens160_present +
-             s_hub.status.sgp40_present + s_hub.status.bh1750_present,
-             6);
+             i2c_found, SENSOR_I2C_DEVICE_COUNT);
 
     return ESP_OK;
 }
@@ -479,7 +973,21 @@ void sensor_hub_deinit(void)
 {
     if (!s_hub.initialized) return;
 
+    // Stop the scheduler before tearing down the bus
+    if (s_hub.acq_task) {
+        s_hub.acq_running = false;
+        sched_wake();
+        xSemaphoreTake(s_hub.acq_done, portMAX_DELAY);
+    }
+    if (s_hub.acq_done) {
+        vSemaphoreDelete(s_hub.acq_done);
+    }
+    if (s_hub.acq_events) {
+        vQueueDelete(s_hub.acq_events);
+    }
+
     // Clean up I2C devices
+    i2c_queue_deinit();
     if (s_hub.i2c_bus) {
         i2c_del_master_bus(s_hub.i2c_bus);
     }
@@ -501,49 +1009,35 @@ esp_err_t sensor_hub_read_all(sensor_data_t *data)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (xSemaphoreTake(s_hub.mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        return ESP_ERR_TIMEOUT;
-    }
-
-    memset(data, 0, sizeof(sensor_data_t));
-    data->timestamp_us = esp_timer_get_time();
-
-    // Read all sensors (ignore individual errors)
-    if (s_hub.status.sht40_present) {
-        if (read_sht40(data) != ESP_OK) s_hub.status.i2c_errors++;
-    }
-
-    if (s_hub.status.bmp388_present) {
-        if (read_bmp388(data) != ESP_OK) s_hub.status.i2c_errors++;
-    }
-
-    if (s_hub.status.scd41_present) {
-        if (read_scd41(data) != ESP_OK) s_hub.status.i2c_errors++;
-    }
-
-    if (s_hub.status.ens160_present) {
-        if (read_ens160(data) != ESP_OK) s_hub.status.i2c_errors++;
-    }
-
-    if (s_hub.status.sgp40_present) {
-        if (read_sgp40(data) != ESP_OK) s_hub.status.i2c_errors++;
-    }
-
-    if (s_hub.status.bh1750_present) {
-        if (read_bh1750(data) != ESP_OK) s_hub.status.i2c_errors++;
-    }
-
-    s_hub.status.read_count++;
-    xSemaphoreGive(s_hub.mutex);
-
+    read_snapshot(data);
+    read_presence(data);
     return ESP_OK;
 }
 
 void sensor_hub_get_status(sensor_status_t *status)
 {
-    if (status) {
-        memcpy(status, &s_hub.status, sizeof(sensor_status_t));
+    if (!status) return;
+
+    memcpy(status, &s_hub.status, sizeof(sensor_status_t));
+    if (!s_hub.initialized) return;
+
+    for (int i = 0; i < SENSOR_I2C_DEVICE_COUNT; i++) {
+        i2c_queue_get_stats(s_hub.i2c_dev[i], &status->i2c_devices[i]);
     }
+    status->sht40_present = i2c_queue_device_present(s_hub.i2c_dev[SENSOR_I2C_SHT40]);
+    status->bmp388_present = i2c_queue_device_present(s_hub.i2c_dev[SENSOR_I2C_BMP388]);
+    status->scd41_present = i2c_queue_device_present(s_hub.i2c_dev[SENSOR_I2C_SCD41]);
+    status->ens160_present = i2c_queue_device_present(s_hub.i2c_dev[SENSOR_I2C_ENS160]);
+    status->sgp40_present = i2c_queue_device_present(s_hub.i2c_dev[SENSOR_I2C_SGP40]);
+    status->bh1750_present = i2c_queue_device_present(s_hub.i2c_dev[SENSOR_I2C_BH1750]);
+    status->i2c_bus_resets = i2c_queue_bus_resets();
+
+    portENTER_CRITICAL(&s_presence_lock);
+    int64_t last = s_hub.ld2410_last_frame_us;
+    portEXIT_CRITICAL(&s_presence_lock);
+    status->ld2410_present = ld2410_alive(last);
+    status->ld2410_frames = s_hub.ld2410_parser.frames;
+    status->ld2410_frame_errors = s_hub.ld2410_parser.errors;
 }
 
 int sensor_hub_to_json(const sensor_data_t *data, char *json_buf, size_t buf_len)
@@ -609,22 +1103,10 @@ esp_err_t sensor_hub_read_climate(sensor_data_t *data)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (xSemaphoreTake(s_hub.mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        return ESP_ERR_TIMEOUT;
-    }
-
-    memset(data, 0, sizeof(sensor_data_t));
-    data->timestamp_us = esp_timer_get_time();
-
-    // Read climate sensors only
-    if (s_hub.status.sht40_present) {
-        read_sht40(data);
-    }
-    if (s_hub.status.bmp388_present) {
-        read_bmp388(data);
-    }
-
-    xSemaphoreGive(s_hub.mutex);
+    // Climate sensors only
+    read_snapshot(data);
+    data->scd41_valid = data->ens160_valid = data->sgp40_valid = false;
+    data->bh1750_valid = data->ld2410_valid = data->sen0540_valid = false;
     return ESP_OK;
 }
 
@@ -634,25 +1116,10 @@ esp_err_t sensor_hub_read_air_quality(sensor_data_t *data)
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (xSemaphoreTake(s_hub.mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        return ESP_ERR_TIMEOUT;
-    }
-
-    memset(data, 0, sizeof(sensor_data_t));
-    data->timestamp_us = esp_timer_get_time();
-
-    // Read air quality sensors only
-    if (s_hub.status.scd41_present) {
-        read_scd41(data);
-    }
-    if (s_hub.status.ens160_present) {
-        read_ens160(data);
-    }
-    if (s_hub.status.sgp40_present) {
-        read_sgp40(data);
-    }
-
-    xSemaphoreGive(s_hub.mutex);
+    // Air quality sensors only
+    read_snapshot(data);
+    data->sht40_valid = data->bmp388_valid = false;
+    data->bh1750_valid = data->ld2410_valid = data->sen0540_valid = false;
     return ESP_OK;
 }
 
@@ -665,65 +1132,98 @@ esp_err_t sensor_hub_read_presence(sensor_data_t *data)
     // LD2410 data is updated asynchronously via UART task
     memset(data, 0, sizeof(sensor_data_t));
     data->timestamp_us = esp_timer_get_time();
-    data->ld2410_valid = s_hub.status.ld2410_present;
+    read_presence(data);
 
     return ESP_OK;
 }
 
-esp_err_t sensor_hub_read_light(sensor_data_t *data)
+esp_err_t sensor_hub_read_radar(ld2410_report_t *report)
 {
-    if (!s_hub.initialized || !data) {
+    if (!s_hub.initialized || !report) {
         return ESP_ERR_INVALID_STATE;
     }
 
-    if (xSemaphoreTake(s_hub.mutex, pdMS_TO_TICKS(100)) != pdTRUE) {
-        return ESP_ERR_TIMEOUT;
-    }
+    portENTER_CRITICAL(&s_presence_lock);
+    *report = s_hub.ld2410_report;
+    int64_t last = s_hub.ld2410_last_frame_us;
+    portEXIT_CRITICAL(&s_presence_lock);
 
-    memset(data, 0, sizeof(sensor_data_t));
-    data->timestamp_us = esp_timer_get_time();
+    return ld2410_alive(last) ? ESP_OK : ESP_ERR_TIMEOUT;
+}
 
-    if (s_hub.status.bh1750_present) {
-        read_bh1750(data);
+void sensor_hub_set_presence_callback(sensor_presence_cb_t cb, void *user_ctx)
+{
+    portENTER_CRITICAL(&s_presence_lock);
+    s_hub.presence_cb = cb;
+    s_hub.presence_ctx = user_ctx;
+    portEXIT_CRITICAL(&s_presence_lock);
+}
+
+esp_err_t sensor_hub_read_light(sensor_data_t *data)
+{
+    if (!s_hub.initialized || !data) {
+        return ESP_ERR_INVALID_STATE;
     }
 
-    xSemaphoreGive(s_hub.mutex);
+    read_snapshot(data);
+    data->sht40_valid = data->bmp388_valid = data->scd41_valid = false;
+    data->ens160_valid = data->sgp40_valid = false;
+    data->ld2410_valid = data->sen0540_valid = false;
     return ESP_OK;
 }
 
 esp_err_t sensor_hub_calibrate_co2(uint16_t reference_co2)
 {
-    if (!s_hub.initialized || !s_hub.dev_scd41) {
+    int dev = s_hub.i2c_dev[SENSOR_I2C_SCD41];
+    if (!s_hub.initialized || !i2c_queue_device_present(dev)) {
         return ESP_ERR_INVALID_STATE;
     }
 
     ESP_LOGI(TAG, "Calibrating CO2 sensor with reference: %d ppm", reference_co2);
 
-    // Stop periodic measurement first
-    esp_err_t ret = i2c_write_cmd(s_hub.dev_scd41, SCD41_CMD_STOP_MEASUREMENT);
-    if (ret != ESP_OK) return ret;
-
-    vTaskDelay(pdMS_TO_TICKS(500));
+    if (xSemaphoreTake(s_hub.mutex, pdMS_TO_TICKS(1000)) != pdTRUE) {
+        return ESP_ERR_TIMEOUT;
+    }
 
-    // Send forced recalibration command (0x362F) followed by reference value
-    uint8_t cmd[5];
-    cmd[0] = 0x36;
-    cmd[1] = 0x2F;
-    cmd[2] = (reference_co2 >> 8) & 0xFF;
-    cmd[3] = reference_co2 & 0xFF;
-    cmd[4] = 0x00;  // CRC placeholder
+    // Take the SCD41 out of the schedule (the other sensors keep running)
+    // and let an in-flight readout finish
+    s_hub.scd41_hold = true;
+    for (int i = 0; i < 10 && sched_in_flight(&s_hub.sched[SENSOR_I2C_SCD41]); i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
 
-    ret = i2c_master_transmit(s_hub.dev_scd41, cmd, 5, 100);
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "CO2 calibration failed");
-        return ret;
+    // Stop periodic measurement first
+    uint8_t cmd[5] = {SCD41_CMD_STOP_MEASUREMENT >> 8, SCD41_CMD_STOP_MEASUREMENT & 0xFF};
+    esp_err_t ret = i2c_queue_transfer(dev, cmd, 2, NULL, 0);
+    if (ret == ESP_OK) {
+        vTaskDelay(pdMS_TO_TICKS(500));
+
+        // Forced recalibration (0x362F) followed by the reference value
+        cmd[0] = 0x36;
+        cmd[1] = 0x2F;
+        cmd[2] = (reference_co2 >> 8) & 0xFF;
+        cmd[3] = reference_co2 & 0xFF;
+        cmd[4] = sensirion_crc8(&cmd[2], 2);
+        ret = i2c_queue_transfer(dev, cmd, 5, NULL, 0);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "CO2 calibration failed");
+        }
+        vTaskDelay(pdMS_TO_TICKS(400));
     }
 
-    vTaskDelay(pdMS_TO_TICKS(400));
+    // Restart periodic measurement (first new sample after one period)
+    cmd[0] = SCD41_CMD_START_MEASUREMENT >> 8;
+    cmd[1] = SCD41_CMD_START_MEASUREMENT & 0xFF;
+    esp_err_t start_ret = i2c_queue_transfer(dev, cmd, 2, NULL, 0);
+    if (ret == ESP_OK) ret = start_ret;
 
-    // Restart periodic measurement
-    ret = i2c_write_cmd(s_hub.dev_scd41, SCD41_CMD_START_MEASUREMENT);
+    s_hub.scd41_resync = true;
+    s_hub.scd41_hold = false;
+    sched_wake();
+    xSemaphoreGive(s_hub.mutex);
 
-    ESP_LOGI(TAG, "CO2 calibration complete");
+    if (ret == ESP_OK) {
+        ESP_LOGI(TAG, "CO2 calibration complete");
+    }
     return ret;
 }
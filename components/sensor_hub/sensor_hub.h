@@ -14,6 +14,19 @@
  *   UART:
  *     - LD2410: mmWave Presence Radar (Hi-Link)
  *     - SEN0540: Offline Voice Recognition (DFRobot)
+ *
+ * I2C sensors are sampled by an internal acquisition task at their own
+ * rates (CONFIG_SENSOR_*_INTERVAL_MS): due sensors are triggered together
+ * and collected at their conversion deadlines. Readers copy the latest
+ * double-buffered snapshot and never wait on the bus.
+ *
+ * Bus traffic goes through an asynchronous transaction queue (i2c_queue.h)
+ * with per-device timeouts: a failing sensor backs off exponentially,
+ * goes offline after CONFIG_SENSOR_I2C_MAX_FAILURES and is re-probed,
+ * without stalling the others. Per-device counters are in sensor_status_t.
+ *
+ * LD2410 frames are parsed as the bytes stream in (UART events, no
+ * polling); presence changes are pushed to sensor_hub_set_presence_callback().
  */
 
 #pragma once
@@ -21,6 +34,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "esp_err.h"
+#include "i2c_queue.h"
+#include "ld2410.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -50,6 +65,19 @@ typedef enum {
     PRESENCE_MOVING          // Person present, moving
 } presence_state_t;
 
+/**
+ * @brief I2C sensor index (sensor_status_t.i2c_devices)
+ */
+typedef enum {
+    SENSOR_I2C_SHT40 = 0,
+    SENSOR_I2C_BMP388,
+    SENSOR_I2C_SCD41,
+    SENSOR_I2C_ENS160,
+    SENSOR_I2C_SGP40,
+    SENSOR_I2C_BH1750,
+    SENSOR_I2C_DEVICE_COUNT
+} sensor_i2c_device_t;
+
 /**
  * @brief Aggregated sensor data structure
  */
@@ -117,8 +145,28 @@ typedef struct {
     uint32_t i2c_errors;
     uint32_t uart_errors;
     uint32_t read_count;
+
+    // Per-device bus health (state, errors, latency), by sensor_i2c_device_t
+    i2c_dev_stats_t i2c_devices[SENSOR_I2C_DEVICE_COUNT];
+    uint32_t i2c_bus_resets;
+
+    uint32_t ld2410_frames;             // Valid radar reports
+    uint32_t ld2410_frame_errors;       // Dropped (length / footer / payload)
 } sensor_status_t;
 
+/**
+ * @brief Presence change event (LD2410)
+ */
+typedef struct {
+    presence_state_t state;
+    presence_state_t previous;
+    uint16_t distance;           // cm
+    uint8_t energy;              // 0-100%
+    int64_t timestamp_us;        // Completion of the frame that carried it
+} sensor_presence_event_t;
+
+typedef void (*sensor_presence_cb_t)(const sensor_presence_event_t *event, void *user_ctx);
+
 // ============================================================================
 // Public API
 // ============================================================================
@@ -138,10 +186,11 @@ esp_err_t sensor_hub_init(void);
 void sensor_hub_deinit(void);
 
 /**
- * @brief Read all sensors
+ * @brief Get the latest readings of all sensors
  *
- * Reads all connected sensors and populates the data structure.
- * Invalid sensors will have their valid flags set to false.
+ * Copies the most recent snapshot published by the acquisition task
+ * (non-blocking). timestamp_us is the time of the last update; sensors
+ * that are absent or whose last read failed have their valid flags false.
  *
  * @param data Pointer to sensor data structure
  * @return ESP_OK on success (even if some sensors fail)
@@ -149,15 +198,36 @@ void sensor_hub_deinit(void);
 esp_err_t sensor_hub_read_all(sensor_data_t *data);
 
 /**
- * @brief Read specific sensor group
+ * @brief Get the latest readings of a specific sensor group
+ *
+ * Same snapshot as sensor_hub_read_all(), with the valid flags of the
+ * other groups cleared.
  */
 esp_err_t sensor_hub_read_climate(sensor_data_t *data);
 esp_err_t sensor_hub_read_air_quality(sensor_data_t *data);
 esp_err_t sensor_hub_read_presence(sensor_data_t *data);
 esp_err_t sensor_hub_read_light(sensor_data_t *data);
 
+/**
+ * @brief Get the latest raw LD2410 report (engineering gates if enabled)
+ * @return ESP_OK, or ESP_ERR_TIMEOUT if no frame arrived recently
+ */
+esp_err_t sensor_hub_read_radar(ld2410_report_t *report);
+
+/**
+ * @brief Register a presence change callback (NULL to remove)
+ *
+ * Called from the LD2410 UART task on every state change, as soon as the
+ * frame carrying it has been parsed. Keep it short; it must not block.
+ */
+void sensor_hub_set_presence_callback(sensor_presence_cb_t cb, void *user_ctx);
+
 /**
  * @brief Get sensor status for diagnostics
+ *
+ * *_present for I2C sensors is true while the device is online or in
+ * backoff, false once it has been taken offline. ld2410_present is true
+ * while radar frames keep arriving.
  */
 void sensor_hub_get_status(sensor_status_t *status);
 
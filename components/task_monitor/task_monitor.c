@@ -0,0 +1,375 @@
+/**
+ * @file task_monitor.c
+ * @brief Task / loop / ring instrumentation implementation
+ */
+
+#include "task_monitor.h"
+#include <string.h>
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+static const char *TAG = "task_mon";
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+#define TASK_MONITOR_CPU    1
+#else
+#define TASK_MONITOR_CPU    0
+#endif
+
+static const char *const LOOP_NAMES[TASK_MONITOR_LOOP_COUNT] = {
+    [TASK_MONITOR_LOOP_AUDIO]   = "audio",
+    [TASK_MONITOR_LOOP_DISPLAY] = "display",
+};
+
+static const char *const RING_NAMES[TASK_MONITOR_RING_COUNT] = {
+    [TASK_MONITOR_RING_OUTPUT] = "output",
+    [TASK_MONITOR_RING_INPUT]  = "input",
+};
+
+// ============================================================================
+// State
+// ============================================================================
+
+typedef struct {
+    int64_t start_us;           // Owner task only
+    uint64_t sum_us;
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t max_ever_us;
+} loop_acc_t;
+
+typedef struct {
+    uint32_t samples;
+    uint32_t hist[TASK_MONITOR_HIST_BUCKETS];
+    uint8_t max;
+} ring_acc_t;
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+typedef struct {
+    TaskHandle_t handle;
+    configRUN_TIME_COUNTER_TYPE runtime;
+} runtime_mark_t;
+#endif
+
+typedef struct {
+    bool initialized;
+
+    // Open window (lock)
+    loop_acc_t loops[TASK_MONITOR_LOOP_COUNT];
+    ring_acc_t rings[TASK_MONITOR_RING_COUNT];
+
+    // Last closed window (lock)
+    task_monitor_task_t tasks[TASK_MONITOR_MAX_TASKS];
+    int task_count;
+    task_monitor_loop_stats_t loop_stats[TASK_MONITOR_LOOP_COUNT];
+    task_monitor_ring_stats_t ring_stats[TASK_MONITOR_RING_COUNT];
+    task_monitor_summary_t summary;
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    // Scratch and CPU baseline (task_monitor_update() caller only)
+    TaskStatus_t status[TASK_MONITOR_MAX_TASKS];
+    runtime_mark_t marks[TASK_MONITOR_MAX_TASKS];
+    int mark_count;
+    configRUN_TIME_COUNTER_TYPE total_runtime;
+#endif
+} task_monitor_state_t;
+
+static task_monitor_state_t s_tm = {0};
+static portMUX_TYPE s_tm_lock = portMUX_INITIALIZER_UNLOCKED;
+
+// ============================================================================
+// Task Table
+// ============================================================================
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+static configRUN_TIME_COUNTER_TYPE previous_runtime(TaskHandle_t handle)
+{
+    for (int i = 0; i < s_tm.mark_count; i++) {
+        if (s_tm.marks[i].handle == handle) return s_tm.marks[i].runtime;
+    }
+    // Created during the window: all of its run time is new
+    return 0;
+}
+
+/**
+ * @brief Snapshot all tasks into out[]; updates the CPU baseline
+ * @return Task count (0 if the table was too small)
+ */
+static int sample_tasks(task_monitor_task_t *out, uint16_t *core_load)
+{
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t n = uxTaskGetSystemState(s_tm.status, TASK_MONITOR_MAX_TASKS, &total);
+    if (n == 0) {
+        ESP_LOGW(TAG, "More than %d tasks, table skipped", TASK_MONITOR_MAX_TASKS);
+        return 0;
+    }
+
+    configRUN_TIME_COUNTER_TYPE elapsed = total - s_tm.total_runtime;
+
+    for (UBaseType_t i = 0; i < n; i++) {
+        const TaskStatus_t *st = &s_tm.status[i];
+        task_monitor_task_t *t = &out[i];
+
+        strlcpy(t->name, st->pcTaskName, sizeof(t->name));
+        BaseType_t core = xTaskGetCoreID(st->xHandle);
+        t->core = (core == tskNO_AFFINITY) ? -1 : (int8_t)core;
+        t->priority = (uint8_t)st->uxCurrentPriority;
+        t->stack_free = st->usStackHighWaterMark;   // StackType_t is a byte on ESP-IDF
+
+        t->cpu_permille = 0;
+#if TASK_MONITOR_CPU
+        if (elapsed > 0) {
+            configRUN_TIME_COUNTER_TYPE run = st->ulRunTimeCounter - previous_runtime(st->xHandle);
+            uint64_t permille = (uint64_t)run * 1000 / elapsed;
+            t->cpu_permille = (permille > 1000) ? 1000 : (uint16_t)permille;
+        }
+#endif
+    }
+
+#if TASK_MONITOR_CPU
+    // Core load is whatever its idle task did not get
+    for (int c = 0; c < TASK_MONITOR_MAX_CORES; c++) {
+        core_load[c] = 0;
+        if (c >= portNUM_PROCESSORS) continue;
+        TaskHandle_t idle = xTaskGetIdleTaskHandleForCore(c);
+        for (UBaseType_t i = 0; i < n; i++) {
+            if (s_tm.status[i].xHandle == idle) {
+                core_load[c] = 1000 - out[i].cpu_permille;
+                break;
+            }
+        }
+    }
+#else
+    (void)elapsed;
+    (void)core_load;
+#endif
+
+    // New baseline
+    for (UBaseType_t i = 0; i < n; i++) {
+        s_tm.marks[i].handle = s_tm.status[i].xHandle;
+        s_tm.marks[i].runtime = s_tm.status[i].ulRunTimeCounter;
+    }
+    s_tm.mark_count = n;
+    s_tm.total_runtime = total;
+
+    return n;
+}
+#endif
+
+// ============================================================================
+// Window Statistics
+// ============================================================================
+
+static void close_loop(const loop_acc_t *acc, task_monitor_loop_stats_t *out)
+{
+    out->count = acc->count;
+    out->avg_us = acc->count ? (uint32_t)(acc->sum_us / acc->count) : 0;
+    out->max_us = acc->max_us;
+    out->max_ever_us = acc->max_ever_us;
+}
+
+/**
+ * @brief Upper bound (%) of the bucket holding the given share of samples
+ */
+static uint8_t ring_percentile(const ring_acc_t *acc, uint32_t permille)
+{
+    if (acc->samples == 0) return 0;
+
+    uint32_t target = ((uint64_t)acc->samples * permille + 999) / 1000;
+    uint32_t seen = 0;
+    for (int b = 0; b < TASK_MONITOR_HIST_BUCKETS; b++) {
+        seen += acc->hist[b];
+        if (seen >= target) return (uint8_t)((b + 1) * (100 / TASK_MONITOR_HIST_BUCKETS));
+    }
+    return 100;
+}
+
+static void close_ring(const ring_acc_t *acc, task_monitor_ring_stats_t *out)
+{
+    out->samples = acc->samples;
+    memcpy(out->hist, acc->hist, sizeof(out->hist));
+    out->p50 = ring_percentile(acc, 500);
+    out->p95 = ring_percentile(acc, 950);
+    out->max = acc->max;
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+esp_err_t task_monitor_init(void)
+{
+    if (s_tm.initialized) return ESP_OK;
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    // Baseline, so the first window's CPU shares start now
+    sample_tasks(s_tm.tasks, s_tm.summary.core_load_permille);
+#endif
+
+#if !TASK_MONITOR_CPU
+    ESP_LOGW(TAG, "FreeRTOS run-time stats disabled, no CPU share");
+#endif
+
+    s_tm.initialized = true;
+    return ESP_OK;
+}
+
+void task_monitor_loop_begin(task_monitor_loop_t loop)
+{
+    if (loop >= TASK_MONITOR_LOOP_COUNT) return;
+    s_tm.loops[loop].start_us = esp_timer_get_time();
+}
+
+void task_monitor_loop_end(task_monitor_loop_t loop)
+{
+    if (loop >= TASK_MONITOR_LOOP_COUNT) return;
+
+    loop_acc_t *acc = &s_tm.loops[loop];
+    if (acc->start_us == 0) return;
+    uint32_t us = (uint32_t)(esp_timer_get_time() - acc->start_us);
+    acc->start_us = 0;
+
+    portENTER_CRITICAL(&s_tm_lock);
+    acc->sum_us += us;
+    acc->count++;
+    if (us > acc->max_us) acc->max_us = us;
+    if (us > acc->max_ever_us) acc->max_ever_us = us;
+    portEXIT_CRITICAL(&s_tm_lock);
+}
+
+void task_monitor_ring_sample(task_monitor_ring_t ring, uint8_t percent)
+{
+    if (ring >= TASK_MONITOR_RING_COUNT) return;
+    if (percent > 100) percent = 100;
+
+    int bucket = percent / (100 / TASK_MONITOR_HIST_BUCKETS);
+    if (bucket >= TASK_MONITOR_HIST_BUCKETS) bucket = TASK_MONITOR_HIST_BUCKETS - 1;
+
+    ring_acc_t *acc = &s_tm.rings[ring];
+    portENTER_CRITICAL(&s_tm_lock);
+    acc->hist[bucket]++;
+    acc->samples++;
+    if (percent > acc->max) acc->max = percent;
+    portEXIT_CRITICAL(&s_tm_lock);
+}
+
+void task_monitor_update(void)
+{
+    if (!s_tm.initialized) return;
+
+    // Task table first, outside the lock (uxTaskGetSystemState suspends
+    // the scheduler)
+    static task_monitor_task_t tasks[TASK_MONITOR_MAX_TASKS];
+    uint16_t core_load[TASK_MONITOR_MAX_CORES] = {0};
+    int task_count = 0;
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+    task_count = sample_tasks(tasks, core_load);
+#endif
+
+    uint32_t min_stack = UINT32_MAX;
+    for (int i = 0; i < task_count; i++) {
+        if (tasks[i].stack_free < min_stack) min_stack = tasks[i].stack_free;
+    }
+
+    portENTER_CRITICAL(&s_tm_lock);
+    for (int i = 0; i < TASK_MONITOR_LOOP_COUNT; i++) {
+        close_loop(&s_tm.loops[i], &s_tm.loop_stats[i]);
+        s_tm.loops[i].sum_us = 0;
+        s_tm.loops[i].count = 0;
+        s_tm.loops[i].max_us = 0;
+    }
+    for (int i = 0; i < TASK_MONITOR_RING_COUNT; i++) {
+        close_ring(&s_tm.rings[i], &s_tm.ring_stats[i]);
+        memset(&s_tm.rings[i], 0, sizeof(s_tm.rings[i]));
+    }
+
+    if (task_count > 0) {
+        memcpy(s_tm.tasks, tasks, task_count * sizeof(tasks[0]));
+        s_tm.task_count = task_count;
+    }
+
+    task_monitor_summary_t *sum = &s_tm.summary;
+    sum->cpu_valid = TASK_MONITOR_CPU && task_count > 0;
+    memcpy(sum->core_load_permille, core_load, sizeof(core_load));
+    for (int i = 0; i < TASK_MONITOR_LOOP_COUNT; i++) {
+        sum->loop_max_us[i] = s_tm.loop_stats[i].max_us;
+    }
+    sum->min_stack_free = (task_count > 0) ? min_stack : 0;
+    for (int i = 0; i < TASK_MONITOR_RING_COUNT; i++) {
+        sum->ring_p95[i] = s_tm.ring_stats[i].p95;
+        sum->ring_max[i] = s_tm.ring_stats[i].max;
+    }
+    portEXIT_CRITICAL(&s_tm_lock);
+}
+
+void task_monitor_log(void)
+{
+    // Printed from a copy: logging inside the critical section is not allowed
+    static task_monitor_task_t tasks[TASK_MONITOR_MAX_TASKS];
+    task_monitor_summary_t sum;
+    task_monitor_loop_stats_t loops[TASK_MONITOR_LOOP_COUNT];
+    task_monitor_ring_stats_t rings[TASK_MONITOR_RING_COUNT];
+
+    int n = task_monitor_get_tasks(tasks, TASK_MONITOR_MAX_TASKS);
+    portENTER_CRITICAL(&s_tm_lock);
+    sum = s_tm.summary;
+    memcpy(loops, s_tm.loop_stats, sizeof(loops));
+    memcpy(rings, s_tm.ring_stats, sizeof(rings));
+    portEXIT_CRITICAL(&s_tm_lock);
+
+    if (sum.cpu_valid) {
+        ESP_LOGI(TAG, "CPU: core0 %u.%u%%, core1 %u.%u%%",
+                 sum.core_load_permille[0] / 10, sum.core_load_permille[0] % 10,
+                 sum.core_load_permille[1] / 10, sum.core_load_permille[1] % 10);
+    }
+
+    for (int i = 0; i < n; i++) {
+        const task_monitor_task_t *t = &tasks[i];
+        char core[4] = "-";
+        if (t->core >= 0) snprintf(core, sizeof(core), "%d", t->core);
+        ESP_LOGI(TAG, "  %-16s core %s  prio %2u  cpu %3u.%u%%  stack free %lu",
+                 t->name, core, t->priority, t->cpu_permille / 10, t->cpu_permille % 10,
+                 (unsigned long)t->stack_free);
+    }
+
+    for (int i = 0; i < TASK_MONITOR_LOOP_COUNT; i++) {
+        ESP_LOGI(TAG, "Loop %-8s n=%lu avg %lu us, max %lu us (ever %lu us)", LOOP_NAMES[i],
+                 (unsigned long)loops[i].count, (unsigned long)loops[i].avg_us,
+                 (unsigned long)loops[i].max_us, (unsigned long)loops[i].max_ever_us);
+    }
+
+    for (int i = 0; i < TASK_MONITOR_RING_COUNT; i++) {
+        const task_monitor_ring_stats_t *r = &rings[i];
+        char hist[TASK_MONITOR_HIST_BUCKETS * 4 + 1];
+        int pos = 0;
+        for (int b = 0; b < TASK_MONITOR_HIST_BUCKETS; b++) {
+            // Per-bucket share in percent (two digits; 100 shows as 99)
+            uint32_t pct = r->samples ? (r->hist[b] * 100) / r->samples : 0;
+            if (pct > 99) pct = 99;
+            pos += snprintf(hist + pos, sizeof(hist) - pos, " %2lu", (unsigned long)pct);
+        }
+        ESP_LOGI(TAG, "Ring %-8s p50 %u%%, p95 %u%%, max %u%% | hist%%:%s", RING_NAMES[i],
+                 r->p50, r->p95, r->max, hist);
+    }
+}
+
+void task_monitor_get_summary(task_monitor_summary_t *out)
+{
+    if (!out) return;
+    portENTER_CRITICAL(&s_tm_lock);
+    *out = s_tm.summary;
+    portEXIT_CRITICAL(&s_tm_lock);
+}
+
+int task_monitor_get_tasks(task_monitor_task_t *out, int max)
+{
+    if (!out || max <= 0) return 0;
+    portENTER_CRITICAL(&s_tm_lock);
+    int n = (s_tm.task_count < max) ? s_tm.task_count : max;
+    memcpy(out, s_tm.tasks, n * sizeof(out[0]));
+    portEXIT_CRITICAL(&s_tm_lock);
+    return n;
+}
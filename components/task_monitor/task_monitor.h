@@ -0,0 +1,157 @@
+/**
+ * @file task_monitor.h
+ * @brief Per-task CPU, loop latency, stack and buffer fill instrumentation
+ *
+ * Collects the numbers needed before tuning task placement:
+ *
+ *   uxTaskGetSystemState() ──► CPU share per task / core, stack high-water
+ *   loop_begin() / loop_end() ──► avg / worst loop time (audio, display)
+ *   ring_sample(percent) ──► fill histogram (10% buckets)
+ *
+ * Loops and rings record continuously; task_monitor_update() closes a
+ * report window (CPU shares are deltas since the previous window, loop and
+ * ring statistics restart) and task_monitor_log() prints it. The window
+ * summary is also exported through the system telemetry fields.
+ *
+ * CPU share is a share of one core and needs
+ * CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS; without it only stacks,
+ * loops and rings are reported.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define TASK_MONITOR_MAX_TASKS      32
+#define TASK_MONITOR_NAME_LEN       16
+#define TASK_MONITOR_MAX_CORES      2
+#define TASK_MONITOR_HIST_BUCKETS   10      // 0-9%, 10-19%, ... 90-100%
+
+/**
+ * @brief Instrumented task loops
+ */
+typedef enum {
+    TASK_MONITOR_LOOP_AUDIO = 0,
+    TASK_MONITOR_LOOP_DISPLAY,
+    TASK_MONITOR_LOOP_COUNT
+} task_monitor_loop_t;
+
+/**
+ * @brief Sampled ring buffers
+ */
+typedef enum {
+    TASK_MONITOR_RING_OUTPUT = 0,   // DAC stream rings (fullest)
+    TASK_MONITOR_RING_INPUT,        // Processed mic ring
+    TASK_MONITOR_RING_COUNT
+} task_monitor_ring_t;
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief One task in the last window
+ */
+typedef struct {
+    char name[TASK_MONITOR_NAME_LEN];
+    int8_t core;                // Pinned core, -1 = no affinity
+    uint8_t priority;
+    uint16_t cpu_permille;      // Share of one core
+    uint32_t stack_free;        // Lowest free stack so far (bytes)
+} task_monitor_task_t;
+
+/**
+ * @brief Loop latency in the last window
+ */
+typedef struct {
+    uint32_t count;
+    uint32_t avg_us;
+    uint32_t max_us;
+    uint32_t max_ever_us;
+} task_monitor_loop_stats_t;
+
+/**
+ * @brief Ring fill distribution in the last window
+ */
+typedef struct {
+    uint32_t samples;
+    uint32_t hist[TASK_MONITOR_HIST_BUCKETS];
+    uint8_t p50;                // Bucket upper bounds (%)
+    uint8_t p95;
+    uint8_t max;                // Highest sample (%)
+} task_monitor_ring_stats_t;
+
+/**
+ * @brief Compact window summary (telemetry)
+ */
+typedef struct {
+    bool cpu_valid;             // Run-time stats available
+    uint16_t core_load_permille[TASK_MONITOR_MAX_CORES];
+    uint32_t loop_max_us[TASK_MONITOR_LOOP_COUNT];
+    uint32_t min_stack_free;    // Over all tasks (bytes)
+    uint8_t ring_p95[TASK_MONITOR_RING_COUNT];
+    uint8_t ring_max[TASK_MONITOR_RING_COUNT];
+} task_monitor_summary_t;
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+/**
+ * @brief Initialize (takes the CPU share baseline)
+ */
+esp_err_t task_monitor_init(void);
+
+/**
+ * @brief Mark the start of one loop iteration (calling task only)
+ */
+void task_monitor_loop_begin(task_monitor_loop_t loop);
+
+/**
+ * @brief Mark the end of the iteration started by task_monitor_loop_begin()
+ */
+void task_monitor_loop_end(task_monitor_loop_t loop);
+
+/**
+ * @brief Add a ring fill sample
+ * @param percent Fill level 0-100
+ */
+void task_monitor_ring_sample(task_monitor_ring_t ring, uint8_t percent);
+
+/**
+ * @brief Close the current report window
+ */
+void task_monitor_update(void);
+
+/**
+ * @brief Log the last window (tasks, loops, rings)
+ */
+void task_monitor_log(void);
+
+/**
+ * @brief Copy the last window's summary (any task)
+ */
+void task_monitor_get_summary(task_monitor_summary_t *out);
+
+/**
+ * @brief Copy the last window's per-task table
+ * @param out Output array
+ * @param max Capacity of out
+ * @return Tasks copied
+ */
+int task_monitor_get_tasks(task_monitor_task_t *out, int max);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,396 @@
+/**
+ * @file telemetry.c
+ * @brief Change-only telemetry encoder implementation
+ */
+
+#include "telemetry.h"
+#include <string.h>
+#include <math.h>
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_timer.h"
+#include "task_monitor.h"
+
+// ============================================================================
+// Field Tables
+// ============================================================================
+
+typedef enum {
+    SENSOR_FIELD_TEMPERATURE = 0,
+    SENSOR_FIELD_HUMIDITY,
+    SENSOR_FIELD_PRESSURE,
+    SENSOR_FIELD_ALTITUDE,
+    SENSOR_FIELD_CO2,
+    SENSOR_FIELD_TVOC,
+    SENSOR_FIELD_ECO2,
+    SENSOR_FIELD_AQI,
+    SENSOR_FIELD_VOC_INDEX,
+    SENSOR_FIELD_LUX,
+    SENSOR_FIELD_PRESENCE,
+    SENSOR_FIELD_PRESENCE_DISTANCE,
+    SENSOR_FIELD_COUNT
+} sensor_field_t;
+
+// Deadbands sit just above each sensor's noise floor
+static const telemetry_field_t SENSOR_FIELDS[SENSOR_FIELD_COUNT] = {
+    [SENSOR_FIELD_TEMPERATURE]       = {"temperature",       1,  2, 5,   0},    // 0.05 °C
+    [SENSOR_FIELD_HUMIDITY]          = {"humidity",          2,  1, 5,   0},    // 0.5 %RH
+    [SENSOR_FIELD_PRESSURE]          = {"pressure",          3,  2, 10,  0},    // 0.1 hPa
+    [SENSOR_FIELD_ALTITUDE]          = {"altitude",          4,  1, 10,  0},    // 1 m
+    [SENSOR_FIELD_CO2]               = {"co2",               5,  0, 10,  0},    // ppm
+    [SENSOR_FIELD_TVOC]              = {"tvoc",              6,  0, 5,   0},    // ppb
+    [SENSOR_FIELD_ECO2]              = {"eco2",              7,  0, 10,  0},    // ppm
+    [SENSOR_FIELD_AQI]               = {"aqi",               8,  0, 0,   0},
+    [SENSOR_FIELD_VOC_INDEX]         = {"voc_index",         9,  0, 2,   0},
+    [SENSOR_FIELD_LUX]               = {"lux",               10, 1, 10,  50},   // 1 lx or 5 %
+    [SENSOR_FIELD_PRESENCE]          = {"presence",          11, 0, 0,   0},
+    [SENSOR_FIELD_PRESENCE_DISTANCE] = {"presence_distance", 12, 0, 25,  0},    // cm
+};
+
+static const telemetry_field_t SYSTEM_FIELDS[TELEMETRY_SYS_FIELD_COUNT] = {
+    [TELEMETRY_SYS_UPTIME]           = {"uptime",              1,  0, 60,   0},    // s
+    [TELEMETRY_SYS_FREE_HEAP]        = {"free_heap",           2,  0, 1024, 50},   // bytes
+    [TELEMETRY_SYS_MIN_FREE_HEAP]    = {"min_free_heap",       3,  0, 0,    0},
+    [TELEMETRY_SYS_FREE_PSRAM]       = {"free_psram",          4,  0, 4096, 50},
+    [TELEMETRY_SYS_CPU0_LOAD]        = {"cpu0_load",           5,  1, 20,   0},    // 2 %
+    [TELEMETRY_SYS_CPU1_LOAD]        = {"cpu1_load",           6,  1, 20,   0},
+    [TELEMETRY_SYS_AUDIO_LOOP_MAX]   = {"audio_loop_max_us",   7,  0, 100,  100},  // 100 µs or 10 %
+    [TELEMETRY_SYS_DISPLAY_LOOP_MAX] = {"display_loop_max_us", 8,  0, 500,  100},
+    [TELEMETRY_SYS_MIN_STACK_FREE]   = {"min_stack_free",      9,  0, 64,   0},    // bytes
+    [TELEMETRY_SYS_OUTPUT_RING_P95]  = {"output_ring_p95",     10, 0, 0,    0},    // % (10 % buckets)
+    [TELEMETRY_SYS_INPUT_RING_P95]   = {"input_ring_p95",      11, 0, 0,    0},
+};
+
+const telemetry_field_t *telemetry_sensor_fields(uint8_t *count)
+{
+    if (count) *count = SENSOR_FIELD_COUNT;
+    return SENSOR_FIELDS;
+}
+
+const telemetry_field_t *telemetry_system_fields(uint8_t *count)
+{
+    if (count) *count = TELEMETRY_SYS_FIELD_COUNT;
+    return SYSTEM_FIELDS;
+}
+
+static int32_t scaled(float v, uint8_t decimals)
+{
+    static const float POW10[] = {1.0f, 10.0f, 100.0f, 1000.0f};
+    return (int32_t)lroundf(v * POW10[decimals]);
+}
+
+uint32_t telemetry_sensor_values(const sensor_data_t *d, int32_t *v)
+{
+    uint32_t valid = 0;
+
+    if (d->sht40_valid) {
+        v[SENSOR_FIELD_TEMPERATURE] = scaled(d->temperature, 2);
+        v[SENSOR_FIELD_HUMIDITY] = scaled(d->humidity, 1);
+        valid |= (1u << SENSOR_FIELD_TEMPERATURE) | (1u << SENSOR_FIELD_HUMIDITY);
+    }
+    if (d->bmp388_valid) {
+        v[SENSOR_FIELD_PRESSURE] = scaled(d->pressure, 2);
+        v[SENSOR_FIELD_ALTITUDE] = scaled(d->altitude, 1);
+        valid |= (1u << SENSOR_FIELD_PRESSURE) | (1u << SENSOR_FIELD_ALTITUDE);
+    }
+    if (d->scd41_valid) {
+        v[SENSOR_FIELD_CO2] = d->co2;
+        valid |= 1u << SENSOR_FIELD_CO2;
+    }
+    if (d->ens160_valid) {
+        v[SENSOR_FIELD_TVOC] = d->tvoc;
+        v[SENSOR_FIELD_ECO2] = d->eco2;
+        v[SENSOR_FIELD_AQI] = d->aqi;
+        valid |= (1u << SENSOR_FIELD_TVOC) | (1u << SENSOR_FIELD_ECO2) | (1u << SENSOR_FIELD_AQI);
+    }
+    if (d->sgp40_valid) {
+        v[SENSOR_FIELD_VOC_INDEX] = d->voc_index;
+        valid |= 1u << SENSOR_FIELD_VOC_INDEX;
+    }
+    if (d->bh1750_valid) {
+        v[SENSOR_FIELD_LUX] = scaled(d->lux, 1);
+        valid |= 1u << SENSOR_FIELD_LUX;
+    }
+    if (d->ld2410_valid) {
+        v[SENSOR_FIELD_PRESENCE] = d->presence;
+        v[SENSOR_FIELD_PRESENCE_DISTANCE] = d->presence_distance;
+        valid |= (1u << SENSOR_FIELD_PRESENCE) | (1u << SENSOR_FIELD_PRESENCE_DISTANCE);
+    }
+
+    return valid;
+}
+
+uint32_t telemetry_system_values(int32_t *v)
+{
+    v[TELEMETRY_SYS_UPTIME] = (int32_t)(esp_timer_get_time() / 1000000);
+    v[TELEMETRY_SYS_FREE_HEAP] = (int32_t)esp_get_free_heap_size();
+    v[TELEMETRY_SYS_MIN_FREE_HEAP] = (int32_t)esp_get_minimum_free_heap_size();
+    v[TELEMETRY_SYS_FREE_PSRAM] = (int32_t)heap_caps_get_free_size(MALLOC_CAP_SPIRAM);
+    uint32_t valid = (1u << TELEMETRY_SYS_CPU0_LOAD) - 1;
+
+    task_monitor_summary_t tm;
+    task_monitor_get_summary(&tm);
+    if (tm.cpu_valid) {
+        v[TELEMETRY_SYS_CPU0_LOAD] = tm.core_load_permille[0];
+        v[TELEMETRY_SYS_CPU1_LOAD] = tm.core_load_permille[1];
+        valid |= (1u << TELEMETRY_SYS_CPU0_LOAD) | (1u << TELEMETRY_SYS_CPU1_LOAD);
+    }
+    v[TELEMETRY_SYS_AUDIO_LOOP_MAX] = (int32_t)tm.loop_max_us[TASK_MONITOR_LOOP_AUDIO];
+    v[TELEMETRY_SYS_DISPLAY_LOOP_MAX] = (int32_t)tm.loop_max_us[TASK_MONITOR_LOOP_DISPLAY];
+    v[TELEMETRY_SYS_OUTPUT_RING_P95] = tm.ring_p95[TASK_MONITOR_RING_OUTPUT];
+    v[TELEMETRY_SYS_INPUT_RING_P95] = tm.ring_p95[TASK_MONITOR_RING_INPUT];
+    valid |= (1u << TELEMETRY_SYS_AUDIO_LOOP_MAX) | (1u << TELEMETRY_SYS_DISPLAY_LOOP_MAX) |
+             (1u << TELEMETRY_SYS_OUTPUT_RING_P95) | (1u << TELEMETRY_SYS_INPUT_RING_P95);
+    if (tm.min_stack_free > 0) {
+        v[TELEMETRY_SYS_MIN_STACK_FREE] = (int32_t)tm.min_stack_free;
+        valid |= 1u << TELEMETRY_SYS_MIN_STACK_FREE;
+    }
+    return valid;
+}
+
+// ============================================================================
+// Output Writer
+// ============================================================================
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t pos;
+    bool overflow;
+} writer_t;
+
+static void put(writer_t *w, const void *data, size_t n)
+{
+    if (w->overflow || w->pos + n > w->len) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(&w->buf[w->pos], data, n);
+    w->pos += n;
+}
+
+static void put_byte(writer_t *w, uint8_t b)
+{
+    put(w, &b, 1);
+}
+
+static void put_str(writer_t *w, const char *s)
+{
+    put(w, s, strlen(s));
+}
+
+// JSON ----------------------------------------------------------------------
+
+/**
+ * @brief Write a fixed-point decimal ("-12.05") without printf
+ */
+static void json_number(writer_t *w, int64_t v, uint8_t decimals)
+{
+    char tmp[24];
+    int n = 0;
+    bool neg = v < 0;
+    uint64_t u = neg ? (uint64_t)(-v) : (uint64_t)v;
+
+    // Digits in reverse, inserting the decimal point after `decimals`
+    for (int i = 0; u > 0 || i <= decimals; i++) {
+        if (decimals && i == decimals) tmp[n++] = '.';
+        tmp[n++] = (char)('0' + (u % 10));
+        u /= 10;
+    }
+    if (neg) tmp[n++] = '-';
+
+    while (n > 0) put_byte(w, (uint8_t)tmp[--n]);
+}
+
+static void json_key(writer_t *w, const char *name, bool *first)
+{
+    if (!*first) put_byte(w, ',');
+    *first = false;
+    put_byte(w, '"');
+    put_str(w, name);
+    put_str(w, "\":");
+}
+
+// CBOR (RFC 8949) ------------------------------------------------------------
+
+#define CBOR_UINT       0
+#define CBOR_NEGINT     1
+#define CBOR_ARRAY      4
+#define CBOR_MAP        5
+#define CBOR_TAG        6
+#define CBOR_NULL       0xF6
+#define CBOR_TAG_DECIMAL_FRACTION   4
+
+static void cbor_head(writer_t *w, uint8_t major, uint64_t v)
+{
+    uint8_t hdr[9];
+    size_t n;
+    major <<= 5;
+
+    if (v < 24) {
+        hdr[0] = major | (uint8_t)v;
+        n = 1;
+    } else if (v <= 0xFF) {
+        hdr[0] = major | 24;
+        hdr[1] = (uint8_t)v;
+        n = 2;
+    } else if (v <= 0xFFFF) {
+        hdr[0] = major | 25;
+        hdr[1] = (uint8_t)(v >> 8);
+        hdr[2] = (uint8_t)v;
+        n = 3;
+    } else if (v <= 0xFFFFFFFFu) {
+        hdr[0] = major | 26;
+        for (int i = 0; i < 4; i++) hdr[1 + i] = (uint8_t)(v >> (24 - 8 * i));
+        n = 5;
+    } else {
+        hdr[0] = major | 27;
+        for (int i = 0; i < 8; i++) hdr[1 + i] = (uint8_t)(v >> (56 - 8 * i));
+        n = 9;
+    }
+    put(w, hdr, n);
+}
+
+static void cbor_int(writer_t *w, int64_t v)
+{
+    if (v >= 0) {
+        cbor_head(w, CBOR_UINT, (uint64_t)v);
+    } else {
+        cbor_head(w, CBOR_NEGINT, (uint64_t)(-(v + 1)));
+    }
+}
+
+static void cbor_number(writer_t *w, int32_t v, uint8_t decimals)
+{
+    if (decimals == 0) {
+        cbor_int(w, v);
+        return;
+    }
+    // 4([-decimals, mantissa])
+    cbor_head(w, CBOR_TAG, CBOR_TAG_DECIMAL_FRACTION);
+    cbor_head(w, CBOR_ARRAY, 2);
+    cbor_int(w, -(int64_t)decimals);
+    cbor_int(w, v);
+}
+
+// ============================================================================
+// Encoder
+// ============================================================================
+
+void telemetry_encoder_init(telemetry_encoder_t *enc, const telemetry_field_t *fields,
+                            uint8_t count, uint16_t full_every)
+{
+    memset(enc, 0, sizeof(*enc));
+    enc->fields = fields;
+    enc->count = (count > TELEMETRY_MAX_FIELDS) ? TELEMETRY_MAX_FIELDS : count;
+    enc->full_every = full_every;
+    enc->force_full = true;
+}
+
+void telemetry_encoder_force_full(telemetry_encoder_t *enc)
+{
+    enc->force_full = true;
+}
+
+static bool beyond_deadband(const telemetry_field_t *f, int32_t last, int32_t v)
+{
+    int64_t diff = (int64_t)v - last;
+    if (diff < 0) diff = -diff;
+    if (f->deadband == 0 && f->deadband_permille == 0) return diff != 0;
+
+    int64_t band = f->deadband;
+    if (f->deadband_permille) {
+        int64_t rel = ((int64_t)(last < 0 ? -(int64_t)last : last) * f->deadband_permille) / 1000;
+        if (rel > band) band = rel;
+    }
+    return diff > band;
+}
+
+int telemetry_encode(telemetry_encoder_t *enc, const int32_t *values, uint32_t valid_mask,
+                     int64_t timestamp_ms, telemetry_format_t format,
+                     uint8_t *buf, size_t buf_len)
+{
+    if (!enc || !enc->fields || !values || !buf || buf_len == 0) return -1;
+
+    bool full = enc->force_full || (enc->full_every && enc->since_full + 1 >= enc->full_every);
+
+    // Fields to emit: changed values, and valid → invalid transitions (null)
+    uint32_t emit = 0;
+    for (int i = 0; i < enc->count; i++) {
+        uint32_t bit = 1u << i;
+        bool valid = valid_mask & bit;
+        bool was_sent = enc->sent_mask & bit;
+
+        if (valid) {
+            if (full || !was_sent || beyond_deadband(&enc->fields[i], enc->last[i], values[i])) {
+                emit |= bit;
+            }
+        } else if (was_sent) {
+            emit |= bit;
+        }
+    }
+    if (!emit && !full) {
+        enc->since_full++;
+        return 0;
+    }
+
+    writer_t w = {.buf = buf, .len = buf_len};
+    int entries = __builtin_popcount(emit) + 1;
+
+    if (format == TELEMETRY_FORMAT_CBOR) {
+        cbor_head(&w, CBOR_MAP, (uint64_t)entries);
+        cbor_head(&w, CBOR_UINT, TELEMETRY_KEY_TIMESTAMP);
+        cbor_int(&w, timestamp_ms);
+    } else {
+        bool first = true;
+        put_byte(&w, '{');
+        json_key(&w, "ts", &first);
+        json_number(&w, timestamp_ms, 0);
+    }
+
+    for (int i = 0; i < enc->count; i++) {
+        uint32_t bit = 1u << i;
+        if (!(emit & bit)) continue;
+        const telemetry_field_t *f = &enc->fields[i];
+        bool valid = valid_mask & bit;
+
+        if (format == TELEMETRY_FORMAT_CBOR) {
+            cbor_head(&w, CBOR_UINT, f->key);
+            if (valid) {
+                cbor_number(&w, values[i], f->decimals);
+            } else {
+                put_byte(&w, CBOR_NULL);
+            }
+        } else {
+            bool first = false;
+            json_key(&w, f->name, &first);
+            if (valid) {
+                json_number(&w, values[i], f->decimals);
+            } else {
+                put_str(&w, "null");
+            }
+        }
+    }
+
+    if (format != TELEMETRY_FORMAT_CBOR) {
+        put_byte(&w, '}');
+        put_byte(&w, '\0');
+    }
+    if (w.overflow) return -1;
+
+    // Commit only what was actually sent
+    for (int i = 0; i < enc->count; i++) {
+        uint32_t bit = 1u << i;
+        if (!(emit & bit)) continue;
+        if (valid_mask & bit) {
+            enc->last[i] = values[i];
+            enc->sent_mask |= bit;
+        } else {
+            enc->sent_mask &= ~bit;
+        }
+    }
+    enc->force_full = false;
+    enc->since_full = full ? 0 : enc->since_full + 1;
+
+    return (int)((format == TELEMETRY_FORMAT_CBOR) ? w.pos : w.pos - 1);
+}
@@ -0,0 +1,163 @@
+/**
+ * @file telemetry.h
+ * @brief Change-only telemetry encoder (JSON / CBOR)
+ *
+ * Each field is a fixed-point integer (value × 10^decimals) with a
+ * deadband. telemetry_encode() emits only the fields that moved beyond
+ * their deadband since they were last sent (plus fields that became
+ * invalid, as null), so an idle room costs nothing on the air:
+ *
+ *   JSON: {"ts":123456,"temperature":22.51,"co2":640}
+ *   CBOR: A3 00 1A 0001E240  01 C4 82 21 19 08CB  05 19 0280
+ *         map  ts(ms)          temp = 2251e-2      co2 = 640
+ *
+ * CBOR maps use the field's numeric key (0 = timestamp) and encode
+ * decimals as tag 4 decimal fractions, so values stay exact and small.
+ * Numbers are formatted with integer arithmetic (no printf / %f), the
+ * output goes into the caller's buffer and nothing is allocated.
+ *
+ * The encoder state (last sent values) is caller-owned; one encoder per
+ * stream. A periodic full frame (full_every) lets late subscribers and
+ * receivers that missed a frame resynchronize.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sensor_hub.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// Constants
+// ============================================================================
+
+#define TELEMETRY_MAX_FIELDS        32
+#define TELEMETRY_KEY_TIMESTAMP     0
+
+// ============================================================================
+// Data Structures
+// ============================================================================
+
+/**
+ * @brief Output format
+ */
+typedef enum {
+    TELEMETRY_FORMAT_JSON = 0,
+    TELEMETRY_FORMAT_CBOR,
+} telemetry_format_t;
+
+/**
+ * @brief Field descriptor
+ *
+ * A field is sent when |value - last_sent| exceeds
+ * max(deadband, |last_sent| × deadband_permille / 1000).
+ */
+typedef struct {
+    const char *name;           // JSON key
+    uint8_t key;                // CBOR key (1-255)
+    uint8_t decimals;           // Fixed-point decimals of the value
+    int32_t deadband;           // Absolute, in scaled units (0 = any change)
+    uint16_t deadband_permille; // Relative, for wide-range values (lux)
+} telemetry_field_t;
+
+/**
+ * @brief Encoder state (caller-owned)
+ */
+typedef struct {
+    const telemetry_field_t *fields;
+    uint8_t count;
+    uint16_t full_every;        // Full frame every N encodes (0 = never)
+    uint16_t since_full;
+    bool force_full;
+    uint32_t sent_mask;         // Fields whose last sent value was valid
+    int32_t last[TELEMETRY_MAX_FIELDS];
+} telemetry_encoder_t;
+
+/**
+ * @brief System telemetry sample
+ */
+typedef enum {
+    TELEMETRY_SYS_UPTIME = 0,
+    TELEMETRY_SYS_FREE_HEAP,
+    TELEMETRY_SYS_MIN_FREE_HEAP,
+    TELEMETRY_SYS_FREE_PSRAM,
+    TELEMETRY_SYS_CPU0_LOAD,            // task_monitor window summary
+    TELEMETRY_SYS_CPU1_LOAD,
+    TELEMETRY_SYS_AUDIO_LOOP_MAX,
+    TELEMETRY_SYS_DISPLAY_LOOP_MAX,
+    TELEMETRY_SYS_MIN_STACK_FREE,
+    TELEMETRY_SYS_OUTPUT_RING_P95,
+    TELEMETRY_SYS_INPUT_RING_P95,
+    TELEMETRY_SYS_FIELD_COUNT
+} telemetry_sys_field_t;
+
+// ============================================================================
+// Field Tables
+// ============================================================================
+
+/**
+ * @brief Sensor fields (same keys as sensor_hub_to_json()); count in *count
+ */
+const telemetry_field_t *telemetry_sensor_fields(uint8_t *count);
+
+/**
+ * @brief System fields (uptime, heap, PSRAM, task monitor); count in *count
+ */
+const telemetry_field_t *telemetry_system_fields(uint8_t *count);
+
+/**
+ * @brief Convert a sensor reading to telemetry_sensor_fields() values
+ * @param values Output, one per field
+ * @return Valid mask (bit i = values[i] valid)
+ */
+uint32_t telemetry_sensor_values(const sensor_data_t *data, int32_t *values);
+
+/**
+ * @brief Sample telemetry_system_fields() values
+ * @return Valid mask
+ */
+uint32_t telemetry_system_values(int32_t *values);
+
+// ============================================================================
+// Encoder API
+// ============================================================================
+
+/**
+ * @brief Initialize an encoder (the first encode is a full frame)
+ */
+void telemetry_encoder_init(telemetry_encoder_t *enc, const telemetry_field_t *fields,
+                            uint8_t count, uint16_t full_every);
+
+/**
+ * @brief Make the next encode a full frame (e.g. after reconnect)
+ */
+void telemetry_encoder_force_full(telemetry_encoder_t *enc);
+
+/**
+ * @brief Encode changed fields
+ *
+ * State is only committed when the frame fits, so a failed encode can be
+ * retried with a larger buffer.
+ *
+ * @param enc          Encoder
+ * @param values       One scaled value per field
+ * @param valid_mask   Bit i set if values[i] is valid
+ * @param timestamp_ms Frame timestamp
+ * @param format       JSON or CBOR
+ * @param buf          Output buffer
+ * @param buf_len      Buffer size
+ * @return Bytes written (JSON is NUL-terminated, not counted), 0 if
+ *         nothing changed, -1 if the buffer is too small
+ */
+int telemetry_encode(telemetry_encoder_t *enc, const int32_t *values, uint32_t valid_mask,
+                     int64_t timestamp_ms, telemetry_format_t format,
+                     uint8_t *buf, size_t buf_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -4,6 +4,13 @@
  *
  * Uses the espressif/usb_host_uac component (UAC 1.0 Host Driver)
  * to receive audio from USB microphones like ReSpeaker USB Mic Array.
+ *
+ * A second USB host client shares the device to read the ReSpeaker DSP's
+ * direction of arrival and voice activity over vendor control requests:
+ *
+ *   uac_host (audio iso IN) ──► data_cb
+ *   beam poller (EP0 vendor IN, every CONFIG_AUDIO_USB_BEAM_POLL_MS)
+ *                           ──► usb_audio_input_get_beam()
  */
 
 #include "usb_audio_input.h"
@@ -14,12 +21,17 @@
 #include "freertos/event_groups.h"
 #include "esp_log.h"
 #include "esp_check.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "usb/usb_host.h"
 #include "usb_host_uac.h"
 
 static const char *TAG = "usb_audio_in";
 
+#ifndef CONFIG_AUDIO_USB_BEAM_POLL_MS
+#define CONFIG_AUDIO_USB_BEAM_POLL_MS   50
+#endif
+
 // ============================================================================
 // ESP32-P4 Function EV Board USB VBUS Power Control
 // ============================================================================
@@ -74,6 +86,79 @@ static void usb_vbus_power_disable(void)
     ESP_LOGI(TAG, "USB VBUS power disabled");
 }
 
+// ============================================================================
+// Known Device Layouts
+// ============================================================================
+
+/**
+ * @brief Vendor control protocol of the mic array DSP
+ */
+typedef enum {
+    BEAM_PROTO_NONE = 0,
+    BEAM_PROTO_XVF3000,                 // Mic Array v2.0 tuning parameters
+    BEAM_PROTO_XVF3800,                 // XVF3800 resource / command ids
+} beam_proto_t;
+
+/**
+ * @brief Channel layout of one firmware (keyed by PID and channel count)
+ */
+typedef struct {
+    uint16_t pid;
+    uint8_t channels;
+    int8_t asr_channel;
+    usb_audio_channel_role_t roles[USB_AUDIO_MAX_CHANNELS];
+} device_layout_t;
+
+static const device_layout_t KNOWN_LAYOUTS[] = {
+    // Mic Array v2.0, 6-channel firmware: processed beam, 4 raw mics, playback
+    { RESPEAKER_PID, 6, 0, { USB_AUDIO_CH_ASR, USB_AUDIO_CH_MIC, USB_AUDIO_CH_MIC,
+                             USB_AUDIO_CH_MIC, USB_AUDIO_CH_MIC, USB_AUDIO_CH_REFERENCE } },
+    // Mic Array v2.0, 1-channel firmware: processed beam only
+    { RESPEAKER_PID, 1, 0, { USB_AUDIO_CH_ASR } },
+    // XVF3800, default output routing: left = comms beam, right = ASR beam
+    { RESPEAKER_XVF3800_PID, 2, 1, { USB_AUDIO_CH_COMMS, USB_AUDIO_CH_ASR } },
+};
+
+static const char *const ROLE_NAMES[] = {
+    [USB_AUDIO_CH_UNKNOWN]   = "?",
+    [USB_AUDIO_CH_MIC]       = "mic",
+    [USB_AUDIO_CH_ASR]       = "asr",
+    [USB_AUDIO_CH_COMMS]     = "comms",
+    [USB_AUDIO_CH_REFERENCE] = "ref",
+};
+
+/**
+ * @brief Fill in delivered channels and their roles
+ *
+ * @param info      Device info with vid/pid/device_channels set
+ * @param preferred Channels to deliver (0 = all)
+ * @return Control protocol for beam metadata
+ */
+static beam_proto_t describe_layout(usb_audio_input_info_t *info, uint8_t preferred)
+{
+    info->channels = (preferred && preferred < info->device_channels) ? preferred : info->device_channels;
+    info->asr_channel = -1;
+    memset(info->channel_role, 0, sizeof(info->channel_role));
+
+    if (info->vid != RESPEAKER_VID) return BEAM_PROTO_NONE;
+
+    for (size_t i = 0; i < sizeof(KNOWN_LAYOUTS) / sizeof(KNOWN_LAYOUTS[0]); i++) {
+        const device_layout_t *layout = &KNOWN_LAYOUTS[i];
+        if (layout->pid != info->pid || layout->channels != info->device_channels) continue;
+
+        for (uint8_t c = 0; c < info->channels && c < USB_AUDIO_MAX_CHANNELS; c++) {
+            info->channel_role[c] = layout->roles[c];
+        }
+        if (layout->asr_channel < info->channels) info->asr_channel = layout->asr_channel;
+        break;
+    }
+
+    // The control interface does not depend on the audio firmware variant
+    if (info->pid == RESPEAKER_PID) return BEAM_PROTO_XVF3000;
+    if (info->pid == RESPEAKER_XVF3800_PID) return BEAM_PROTO_XVF3800;
+    return BEAM_PROTO_NONE;
+}
+
 // ============================================================================
 // Internal State
 // ============================================================================
@@ -99,6 +184,7 @@ typedef struct {
     uac_host_device_handle_t uac_device_handle;
     uint8_t device_addr;
     uint8_t iface_num;
+    beam_proto_t beam_proto;
 
     // Synchronization
     SemaphoreHandle_t mutex;
@@ -115,6 +201,9 @@ static usb_audio_ctx_t s_usb_audio = {0};
 #define USB_DEVICE_CONNECTED    BIT1
 #define USB_DEVICE_DISCONNECTED BIT2
 
+// Frames repacked per callback when fewer channels are delivered (1ms at 48kHz)
+#define USB_REPACK_FRAMES       48
+
 // ============================================================================
 // USB Host Library Task
 // ============================================================================
@@ -144,18 +233,252 @@ static void usb_host_lib_task(void *arg)
 }
 
 // ============================================================================
-// Audio Downsampling Buffer (48kHz stereo → 16kHz mono)
+// Beam Metadata (vendor control interface)
 // ============================================================================
 
-// Static buffer for downsampled audio
-// Max USB packet ~1024 bytes, after 1/6 reduction = ~170 samples
-#define DOWNSAMPLE_BUFFER_SIZE      1024
-static int16_t s_downsample_buffer[DOWNSAMPLE_BUFFER_SIZE];
+#define BEAM_POLL_STACK         3072
+#define BEAM_POLL_PRIORITY      3
+#define BEAM_CTRL_MAX_DATA      16
+#define BEAM_EVENT_WAIT_MS      100
+
+// Mic Array v2.0 tuning: wValue = 0x80 | offset (| 0x40 for int), wIndex = id,
+// reply is an int32 value and an int32 exponent
+#define XVF3000_READ_INT            (0x80 | 0x40)
+#define XVF3000_DOAANGLE_ID         21
+#define XVF3000_DOAANGLE_OFFSET     0
+#define XVF3000_VOICEACTIVITY_ID    19
+#define XVF3000_VOICEACTIVITY_OFFSET 32
+#define XVF3000_REPLY_LEN           8
+
+// XVF3800: wValue = 0x80 | command, wIndex = resource, reply is a status
+// byte then the values; DOA_VALUE is {uint16 angle, uint16 speech}
+#define XVF3800_READ                0x80
+#define XVF3800_RESID_AEC           20
+#define XVF3800_CMD_DOA_VALUE       18
+#define XVF3800_REPLY_LEN           (1 + 2 * sizeof(uint16_t))
+#define XVF3800_STATUS_OK           0
+
+typedef struct {
+    TaskHandle_t task;
+    volatile bool running;
+    usb_host_client_handle_t client;
+    usb_device_handle_t dev;
+    usb_transfer_t *transfer;
+    volatile bool xfer_done;
+    volatile bool dev_gone;
+
+    usb_audio_input_beam_t latest;
+    bool valid;
+} beam_poller_t;
+
+static beam_poller_t s_beam = {0};
+static portMUX_TYPE s_beam_lock = portMUX_INITIALIZER_UNLOCKED;   // latest, valid
+
+static void beam_invalidate(void)
+{
+    portENTER_CRITICAL(&s_beam_lock);
+    s_beam.valid = false;
+    portEXIT_CRITICAL(&s_beam_lock);
+}
+
+/**
+ * @brief Client events (runs in usb_host_client_handle_events, poller task)
+ */
+static void beam_client_event_cb(const usb_host_client_event_msg_t *msg, void *arg)
+{
+    if (msg->event == USB_HOST_CLIENT_EVENT_DEV_GONE && s_beam.dev &&
+        msg->dev_gone.dev_hdl == s_beam.dev) {
+        s_beam.dev_gone = true;
+    }
+}
+
+static void beam_transfer_cb(usb_transfer_t *transfer)
+{
+    s_beam.xfer_done = true;
+}
+
+/**
+ * @brief Vendor IN control request to the device
+ *
+ * @param data Output: reply payload (valid until the next request)
+ */
+static esp_err_t beam_ctrl_read(uint16_t value, uint16_t index, uint16_t len, const uint8_t **data)
+{
+    usb_transfer_t *t = s_beam.transfer;
+    usb_setup_packet_t *setup = (usb_setup_packet_t *)t->data_buffer;
+    setup->bmRequestType = USB_BM_REQUEST_TYPE_DIR_IN | USB_BM_REQUEST_TYPE_TYPE_VENDOR |
+                           USB_BM_REQUEST_TYPE_RECIP_DEVICE;
+    setup->bRequest = 0;
+    setup->wValue = value;
+    setup->wIndex = index;
+    setup->wLength = len;
+
+    t->device_handle = s_beam.dev;
+    t->bEndpointAddress = 0;
+    t->callback = beam_transfer_cb;
+    t->context = NULL;
+    t->num_bytes = sizeof(usb_setup_packet_t) + len;
+    s_beam.xfer_done = false;
+
+    esp_err_t ret = usb_host_transfer_submit_control(s_beam.client, t);
+    if (ret != ESP_OK) return ret;
+
+    // Completes with an error status if the device goes away meanwhile
+    while (!s_beam.xfer_done) {
+        usb_host_client_handle_events(s_beam.client, pdMS_TO_TICKS(BEAM_EVENT_WAIT_MS));
+    }
+
+    if (t->status != USB_TRANSFER_STATUS_COMPLETED ||
+        t->actual_num_bytes < (int)(sizeof(usb_setup_packet_t) + len)) {
+        return ESP_FAIL;
+    }
+    *data = t->data_buffer + sizeof(usb_setup_packet_t);
+    return ESP_OK;
+}
+
+static esp_err_t beam_read_xvf3000(usb_audio_input_beam_t *beam)
+{
+    const uint8_t *reply;
+    int32_t doa, voice;
+
+    esp_err_t ret = beam_ctrl_read(XVF3000_READ_INT | XVF3000_DOAANGLE_OFFSET, XVF3000_DOAANGLE_ID,
+                                   XVF3000_REPLY_LEN, &reply);
+    if (ret != ESP_OK) return ret;
+    memcpy(&doa, reply, sizeof(doa));
+
+    ret = beam_ctrl_read(XVF3000_READ_INT | XVF3000_VOICEACTIVITY_OFFSET, XVF3000_VOICEACTIVITY_ID,
+                         XVF3000_REPLY_LEN, &reply);
+    if (ret != ESP_OK) return ret;
+    memcpy(&voice, reply, sizeof(voice));
+
+    beam->doa_deg = (uint16_t)(((doa % 360) + 360) % 360);
+    beam->voice = voice != 0;
+    return ESP_OK;
+}
+
+static esp_err_t beam_read_xvf3800(usb_audio_input_beam_t *beam)
+{
+    const uint8_t *reply;
+    uint16_t values[2];
+
+    esp_err_t ret = beam_ctrl_read(XVF3800_READ | XVF3800_CMD_DOA_VALUE, XVF3800_RESID_AEC,
+                                   XVF3800_REPLY_LEN, &reply);
+    if (ret != ESP_OK) return ret;
+    if (reply[0] != XVF3800_STATUS_OK) return ESP_ERR_INVALID_RESPONSE;
+    memcpy(values, reply + 1, sizeof(values));
+
+    beam->doa_deg = values[0] % 360;
+    beam->voice = values[1] != 0;
+    return ESP_OK;
+}
+
+static void beam_close(void)
+{
+    if (!s_beam.dev) return;
+
+    usb_host_device_close(s_beam.client, s_beam.dev);
+    s_beam.dev = NULL;
+    beam_invalidate();
+}
+
+/**
+ * @brief Beam poller: shares the UAC device as a second USB host client
+ */
+static void beam_poll_task(void *arg)
+{
+    const usb_host_client_config_t client_config = {
+        .is_synchronous = false,
+        .max_num_event_msg = 4,
+        .async = {
+            .client_event_callback = beam_client_event_cb,
+            .callback_arg = NULL,
+        },
+    };
+
+    if (usb_host_client_register(&client_config, &s_beam.client) != ESP_OK ||
+        usb_host_transfer_alloc(sizeof(usb_setup_packet_t) + BEAM_CTRL_MAX_DATA, 0,
+                                &s_beam.transfer) != ESP_OK) {
+        ESP_LOGE(TAG, "Beam poller: USB client setup failed");
+        s_beam.running = false;
+    }
+
+    uint32_t failures = 0;
+    TickType_t last_wake = xTaskGetTickCount();
+    while (s_beam.running) {
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CONFIG_AUDIO_USB_BEAM_POLL_MS));
+        usb_host_client_handle_events(s_beam.client, 0);
+
+        beam_proto_t proto = s_usb_audio.beam_proto;
+        bool present = s_usb_audio.state >= USB_AUDIO_INPUT_STATE_CONNECTED && proto != BEAM_PROTO_NONE;
+        if (s_beam.dev && (!present || s_beam.dev_gone)) beam_close();
+        if (!present) continue;
+
+        if (!s_beam.dev) {
+            if (usb_host_device_open(s_beam.client, s_usb_audio.device_addr, &s_beam.dev) != ESP_OK) {
+                s_beam.dev = NULL;
+                continue;
+            }
+            s_beam.dev_gone = false;
+            failures = 0;
+            ESP_LOGI(TAG, "Beam metadata: polling DOA/VAD every %d ms", CONFIG_AUDIO_USB_BEAM_POLL_MS);
+        }
+
+        usb_audio_input_beam_t beam = { .timestamp_us = esp_timer_get_time() };
+        esp_err_t ret = (proto == BEAM_PROTO_XVF3000) ? beam_read_xvf3000(&beam)
+                                                      : beam_read_xvf3800(&beam);
+        if (ret == ESP_OK) {
+            portENTER_CRITICAL(&s_beam_lock);
+            s_beam.latest = beam;
+            s_beam.valid = true;
+            portEXIT_CRITICAL(&s_beam_lock);
+        } else if (failures++ == 0) {
+            ESP_LOGW(TAG, "Beam metadata read failed: %s", esp_err_to_name(ret));
+        }
+    }
+
+    beam_close();
+    if (s_beam.transfer) usb_host_transfer_free(s_beam.transfer);
+    if (s_beam.client) usb_host_client_deregister(s_beam.client);
+    s_beam.transfer = NULL;
+    s_beam.client = NULL;
+
+    s_beam.task = NULL;
+    vTaskDelete(NULL);
+}
 
 // ============================================================================
 // UAC Host Callbacks
 // ============================================================================
 
+/**
+ * @brief Hand received PCM to the user, keeping the delivered channels only
+ */
+static void deliver_audio(const uint8_t *data, size_t len)
+{
+    const uint8_t keep = s_usb_audio.device_info.channels;
+    const uint8_t stride = s_usb_audio.device_info.device_channels;
+    if (keep == stride || keep == 0) {
+        s_usb_audio.data_cb(data, len, s_usb_audio.user_ctx);
+        return;
+    }
+
+    // First `keep` channels of every frame, in whole-frame pieces
+    int16_t packed[USB_REPACK_FRAMES * USB_AUDIO_MAX_CHANNELS];
+    const int16_t *in = (const int16_t *)data;
+    size_t frames = len / (sizeof(int16_t) * stride);
+    while (frames > 0) {
+        size_t n = (frames > USB_REPACK_FRAMES) ? USB_REPACK_FRAMES : frames;
+        for (size_t i = 0; i < n; i++) {
+            for (uint8_t c = 0; c < keep; c++) {
+                packed[i * keep + c] = in[i * stride + c];
+            }
+        }
+        s_usb_audio.data_cb((const uint8_t *)packed, n * keep * sizeof(int16_t), s_usb_audio.user_ctx);
+        in += n * stride;
+        frames -= n;
+    }
+}
+
 /**
  * @brief UAC device event callback
  */
@@ -169,33 +492,10 @@ static void uac_device_callback(uac_host_device_handle_t uac_device_handle,
             uac_host_transfer_t transfer = {0};
             esp_err_t ret = uac_host_get_rx_transfer(uac_device_handle, &transfer);
             if (ret == ESP_OK && transfer.data && transfer.actual_num_bytes > 0) {
-                // --- Downsampling: 48kHz stereo → 16kHz mono ---
-                uint32_t in_rate = s_usb_audio.device_info.sample_rate;
-                uint32_t channels = s_usb_audio.device_info.channels;
-
-                if (in_rate == 48000 && s_usb_audio.data_cb) {
-                    const int16_t *in_samples = (const int16_t *)transfer.data;
-                    size_t num_frames = transfer.actual_num_bytes / (sizeof(int16_t) * channels);
-                    size_t out_idx = 0;
-
-                    // Take every 3rd frame (48kHz / 3 = 16kHz)
-                    for (size_t i = 0; i < num_frames; i += 3) {
-                        if (channels >= 2) {
-                            // Stereo: use left channel only
-                            s_downsample_buffer[out_idx++] = in_samples[i * 2];
-                        } else {
-                            // Mono: simple decimation
-                            s_downsample_buffer[out_idx++] = in_samples[i];
-                        }
-                    }
-
-                    size_t out_bytes = out_idx * sizeof(int16_t);
-                    s_usb_audio.data_cb((const uint8_t *)s_downsample_buffer,
-                                        out_bytes, s_usb_audio.user_ctx);
-                } else if (s_usb_audio.data_cb) {
-                    // Non-48kHz: pass through unchanged
-                    s_usb_audio.data_cb(transfer.data, transfer.actual_num_bytes,
-                                        s_usb_audio.user_ctx);
+                // Native-format PCM: filtering/decimation is done by the consumer
+                // (audio_pipeline), which also keeps the full-rate raw stream
+                if (s_usb_audio.data_cb) {
+                    deliver_audio(transfer.data, transfer.actual_num_bytes);
                 }
             }
             break;
@@ -214,6 +514,7 @@ static void uac_device_callback(uac_host_device_handle_t uac_device_handle,
             s_usb_audio.state = USB_AUDIO_INPUT_STATE_WAITING;
             s_usb_audio.streaming = false;
             s_usb_audio.uac_device_handle = NULL;
+            beam_invalidate();
 
             if (s_usb_audio.connect_cb) {
                 s_usb_audio.connect_cb(false, NULL, s_usb_audio.user_ctx);
@@ -265,11 +566,16 @@ static void uac_driver_callback(uint8_t addr, uint8_t iface_num,
             if (ret == ESP_OK) {
                 s_usb_audio.device_info.vid = dev_info.VID;
                 s_usb_audio.device_info.pid = dev_info.PID;
-                s_usb_audio.device_info.sample_rate = 48000;  // Default, will be updated
-                s_usb_audio.device_info.channels = dev_info.channels;
+                s_usb_audio.device_info.sample_rate = 48000;  // Until the interface is set
+                s_usb_audio.device_info.drift_ppm = 0;
+                s_usb_audio.device_info.device_channels = dev_info.channels;
                 s_usb_audio.device_info.bit_depth = dev_info.bit_resolution;
-                s_usb_audio.device_info.is_respeaker =
-                    (dev_info.VID == RESPEAKER_VID && dev_info.PID == RESPEAKER_PID);
+                s_usb_audio.device_info.is_respeaker = dev_info.VID == RESPEAKER_VID &&
+                    (dev_info.PID == RESPEAKER_PID || dev_info.PID == RESPEAKER_XVF3800_PID);
+                s_usb_audio.beam_proto = describe_layout(&s_usb_audio.device_info,
+                                                         s_usb_audio.preferred_channels);
+                s_usb_audio.device_info.has_beam = s_beam.running &&
+                    s_usb_audio.beam_proto != BEAM_PROTO_NONE;
 
                 ESP_LOGI(TAG, "Device: VID=0x%04X, PID=0x%04X, %d ch, %d-bit",
                          dev_info.VID, dev_info.PID,
@@ -278,6 +584,16 @@ static void uac_driver_callback(uint8_t addr, uint8_t iface_num,
                 if (s_usb_audio.device_info.is_respeaker) {
                     ESP_LOGI(TAG, "ReSpeaker USB Mic Array detected!");
                 }
+
+                char layout[USB_AUDIO_MAX_CHANNELS * 7] = "";
+                for (uint8_t c = 0; c < s_usb_audio.device_info.channels; c++) {
+                    size_t used = strlen(layout);
+                    snprintf(layout + used, sizeof(layout) - used, "%s%s", c ? " " : "",
+                             ROLE_NAMES[s_usb_audio.device_info.channel_role[c]]);
+                }
+                ESP_LOGI(TAG, "Delivering %d of %d ch [%s], ASR channel %d",
+                         s_usb_audio.device_info.channels, dev_info.channels, layout,
+                         s_usb_audio.device_info.asr_channel);
             }
 
             // Set sample rate
@@ -410,6 +726,16 @@ esp_err_t usb_audio_input_init(const usb_audio_input_config_t *config)
         return ret;
     }
 
+    // DOA/VAD poller (idles until a ReSpeaker connects)
+    if (CONFIG_AUDIO_USB_BEAM_POLL_MS > 0) {
+        s_beam.running = true;
+        if (xTaskCreatePinnedToCore(beam_poll_task, "usb_beam", BEAM_POLL_STACK, NULL,
+                                    BEAM_POLL_PRIORITY, &s_beam.task, 0) != pdPASS) {
+            ESP_LOGW(TAG, "Failed to create beam poller, no DOA/VAD metadata");
+            s_beam.running = false;
+        }
+    }
+
     s_usb_audio.state = USB_AUDIO_INPUT_STATE_WAITING;
 
     ESP_LOGI(TAG, "USB Audio Input initialized");
@@ -430,6 +756,12 @@ void usb_audio_input_deinit(void)
     // Stop streaming
     usb_audio_input_stop();
 
+    // Beam poller deregisters its USB client before the host goes away
+    s_beam.running = false;
+    for (int i = 0; i < 50 && s_beam.task; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
     // Close device if open
     if (s_usb_audio.uac_device_handle) {
         uac_host_device_close(s_usb_audio.uac_device_handle);
@@ -461,6 +793,7 @@ void usb_audio_input_deinit(void)
     }
 
     memset(&s_usb_audio, 0, sizeof(s_usb_audio));
+    memset(&s_beam, 0, sizeof(s_beam));
     ESP_LOGI(TAG, "USB Audio Input deinitialized");
 }
 
@@ -540,6 +873,29 @@ esp_err_t usb_audio_input_get_info(usb_audio_input_info_t *info)
     return ESP_OK;
 }
 
+void usb_audio_input_set_drift_ppm(float ppm)
+{
+    s_usb_audio.device_info.drift_ppm = ppm;
+}
+
+esp_err_t usb_audio_input_get_beam(usb_audio_input_beam_t *beam)
+{
+    if (!beam) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (s_usb_audio.state < USB_AUDIO_INPUT_STATE_CONNECTED || !s_usb_audio.device_info.has_beam) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    portENTER_CRITICAL(&s_beam_lock);
+    bool valid = s_beam.valid;
+    if (valid) *beam = s_beam.latest;
+    portEXIT_CRITICAL(&s_beam_lock);
+
+    return valid ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
 bool usb_audio_input_is_ready(void)
 {
     return s_usb_audio.state == USB_AUDIO_INPUT_STATE_STREAMING;
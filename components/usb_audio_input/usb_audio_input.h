@@ -8,12 +8,17 @@
  *
  * Supported Devices:
  *   - ReSpeaker USB Mic Array v2.0 (VID: 0x2886, PID: 0x0018)
+ *   - ReSpeaker XVF3800 USB 4-Mic Array (VID: 0x2886, PID: 0x001A)
  *   - Any UAC 1.0 compatible USB microphone
  *
  * Audio Format:
  *   - Sample Rate: 16kHz - 48kHz (device dependent)
  *   - Bit Depth: 16-bit
- *   - Channels: Mono/Stereo (device dependent)
+ *   - Channels: the device's full layout, or its first N channels
+ *
+ * Known ReSpeaker layouts are reported per channel (processed ASR beam,
+ * raw mics, playback reference), and their DSP's direction of arrival and
+ * voice activity are polled over the vendor control interface.
  */
 
 #pragma once
@@ -31,6 +36,9 @@ extern "C" {
 // ============================================================================
 #define RESPEAKER_VID           0x2886
 #define RESPEAKER_PID           0x0018
+#define RESPEAKER_XVF3800_PID   0x001A
+
+#define USB_AUDIO_MAX_CHANNELS  8
 
 // ============================================================================
 // Data Types
@@ -47,21 +55,51 @@ typedef enum {
     USB_AUDIO_INPUT_STATE_ERROR         // Error state
 } usb_audio_input_state_t;
 
+/**
+ * @brief What a device channel carries
+ */
+typedef enum {
+    USB_AUDIO_CH_UNKNOWN = 0,           // Layout not identified
+    USB_AUDIO_CH_MIC,                   // Unprocessed microphone
+    USB_AUDIO_CH_ASR,                   // Device-processed, tuned for speech recognition
+    USB_AUDIO_CH_COMMS,                 // Device-processed, tuned for calls
+    USB_AUDIO_CH_REFERENCE,             // Playback loopback (echo reference)
+} usb_audio_channel_role_t;
+
 /**
  * @brief USB Audio device information
  */
 typedef struct {
     uint16_t vid;                       // Vendor ID
     uint16_t pid;                       // Product ID
-    uint32_t sample_rate;               // Current sample rate (Hz)
-    uint8_t channels;                   // Number of channels
+    uint32_t sample_rate;               // Nominal sample rate (Hz)
+    uint8_t channels;                   // Channels delivered to the data callback
+    uint8_t device_channels;            // Channels the device streams
     uint8_t bit_depth;                  // Bits per sample
     bool is_respeaker;                  // True if ReSpeaker device
+    bool has_beam;                      // DOA/VAD available (usb_audio_input_get_beam)
+    int8_t asr_channel;                 // Device-processed ASR channel, -1 = none
+    usb_audio_channel_role_t channel_role[USB_AUDIO_MAX_CHANNELS];  // Per delivered channel
+    float drift_ppm;                    // Device clock vs local clock (+ = fast),
+                                        // measured by the consumer
 } usb_audio_input_info_t;
 
+/**
+ * @brief Beam metadata from the mic array DSP (latest poll)
+ */
+typedef struct {
+    uint16_t doa_deg;                   // Direction of arrival (0-359)
+    bool voice;                         // Device voice activity
+    int64_t timestamp_us;               // esp_timer time of the poll
+} usb_audio_input_beam_t;
+
 /**
  * @brief Audio data callback function type
  *
+ * Data is delivered in the device's native format (interleaved 16-bit PCM at
+ * usb_audio_input_info_t::sample_rate / ::channels); no resampling is applied.
+ * Runs in the UAC driver task: queue the data and process it elsewhere.
+ *
  * @param data Pointer to audio data (16-bit PCM samples)
  * @param len Length of data in bytes
  * @param user_ctx User context pointer
@@ -85,7 +123,7 @@ typedef struct {
     usb_audio_input_connect_cb_t connect_cb; // Connection status callback (optional)
     void *user_ctx;                          // User context for callbacks
     uint32_t preferred_sample_rate;          // Preferred sample rate (0 = auto)
-    uint8_t preferred_channels;              // Preferred channels (0 = auto)
+    uint8_t preferred_channels;              // Deliver the first N channels (0 = full layout)
 } usb_audio_input_config_t;
 
 // ============================================================================
@@ -142,6 +180,29 @@ usb_audio_input_state_t usb_audio_input_get_state(void);
  */
 esp_err_t usb_audio_input_get_info(usb_audio_input_info_t *info);
 
+/**
+ * @brief Record the device clock drift measured by the consumer
+ *
+ * The nominal rate is all the device reports; the consumer, which sees
+ * the stream against the local clock, publishes the measured offset here
+ * for usb_audio_input_get_info().
+ *
+ * @param ppm Device clock offset (+ = device runs fast)
+ */
+void usb_audio_input_set_drift_ppm(float ppm);
+
+/**
+ * @brief Get the latest beam metadata (ReSpeaker DOA / voice activity)
+ *
+ * Polled every CONFIG_AUDIO_USB_BEAM_POLL_MS while a device with a known
+ * control interface is connected; check timestamp_us for freshness.
+ *
+ * @param beam Pointer to store the metadata
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if the device has no beam metadata,
+ *         ESP_ERR_INVALID_STATE if none was read yet
+ */
+esp_err_t usb_audio_input_get_beam(usb_audio_input_beam_t *beam);
+
 /**
  * @brief Check if USB Audio Input is ready
  *
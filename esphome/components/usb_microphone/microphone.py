@@ -13,6 +13,8 @@ AUTO_LOAD = []
 # Specify this component only works with ESP-IDF
 CODEOWNERS = ["@98kuwa036"]
 
+CONF_VAD_GATE = "vad_gate"
+
 USBMicrophone = usb_microphone_ns.class_(
     "USBMicrophone", microphone.Microphone, cg.Component
 )
@@ -21,6 +23,8 @@ CONFIG_SCHEMA = cv.All(
     microphone.MICROPHONE_SCHEMA.extend(
         {
             cv.GenerateID(): cv.declare_id(USBMicrophone),
+            # Skip silence: only stream while the pipeline VAD hears speech
+            cv.Optional(CONF_VAD_GATE, default=False): cv.boolean,
         }
     ).extend(cv.COMPONENT_SCHEMA),
     cv.only_with_esp_idf,
@@ -32,6 +36,8 @@ async def to_code(config):
     await cg.register_component(var, config)
     await microphone.register_microphone(var, config)
 
+    cg.add(var.set_vad_gate(config[CONF_VAD_GATE]))
+
     # Add ESP-IDF component include paths
     cg.add_build_flag("-I../../../components/usb_audio_input")
     cg.add_build_flag("-I../../../components/audio_hal")
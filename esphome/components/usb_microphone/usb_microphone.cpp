@@ -9,11 +9,19 @@
 #include "usb_microphone.h"
 #include "esphome/core/log.h"
 
+#include <algorithm>
+#include <cstring>
+
 namespace esphome {
 namespace usb_microphone {
 
 static const char *const TAG = "usb_microphone";
 
+// Audio kept while gated, so the lead-in before the VAD triggered (its
+// attack time, plus quiet onsets) still reaches STT: 16kHz mono 16-bit
+static const size_t VAD_GATE_KEEP_MS = 300;
+static const size_t VAD_GATE_KEEP_BYTES = VAD_GATE_KEEP_MS * 16 * sizeof(int16_t);
+
 void USBMicrophone::setup() {
   ESP_LOGCONFIG(TAG, "Setting up USB Microphone...");
 
@@ -80,21 +88,54 @@ void USBMicrophone::stop() {
 #endif
 }
 
-size_t USBMicrophone::read(int16_t *buf, size_t len) {
+size_t USBMicrophone::acquire(const int16_t **samples) {
+  *samples = nullptr;
   if (!this->is_running_) {
     return 0;
   }
 
 #ifdef USE_ESP_IDF
-  // Read processed (16kHz mono) audio from pipeline buffer
-  // audio_pipeline_read returns processed audio suitable for ESPHome
-  size_t bytes_read = audio_pipeline_read((uint8_t *)buf, len * sizeof(int16_t), 100);
+  // Gated: drop silence instead of streaming it upstream
+  if (this->vad_gate_ && !audio_pipeline_voice_detected()) {
+    audio_pipeline_discard_processed(VAD_GATE_KEEP_BYTES);
+    return 0;
+  }
 
-  return bytes_read / sizeof(int16_t);
+  const uint8_t *span;
+  size_t span_len;
+  if (audio_pipeline_acquire_processed(&span, &span_len) != ESP_OK || span_len == 0) {
+    return 0;
+  }
+  // The ring only ever holds whole samples
+  *samples = reinterpret_cast<const int16_t *>(span);
+  return span_len / sizeof(int16_t);
 #else
   return 0;
 #endif
 }
 
+void USBMicrophone::release(size_t samples) {
+#ifdef USE_ESP_IDF
+  audio_pipeline_release_processed(samples * sizeof(int16_t));
+#endif
+}
+
+size_t USBMicrophone::read(int16_t *buf, size_t len) {
+  // At most two spans (before/after the wrap point), each copied once
+  size_t copied = 0;
+  while (copied < len) {
+    const int16_t *span;
+    size_t n = this->acquire(&span);
+    if (n == 0) {
+      break;
+    }
+    n = std::min(n, len - copied);
+    memcpy(buf + copied, span, n * sizeof(int16_t));
+    this->release(n);
+    copied += n;
+  }
+  return copied;
+}
+
 }  // namespace usb_microphone
 }  // namespace esphome
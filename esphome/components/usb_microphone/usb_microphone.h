@@ -30,11 +30,27 @@ class USBMicrophone : public microphone::Microphone, public Component {
   void start() override;
   void stop() override;
 
+  /// Copies into @p buf: ESPHome's microphone interface owns the buffer.
+  /// Consumers that can work in place use acquire() / release() instead.
   size_t read(int16_t *buf, size_t len) override;
 
+  /// Zero-copy read: points @p samples at processed 16kHz mono audio inside
+  /// the pipeline ring (no copy). The span stays valid until release().
+  /// Returns the span length in samples; 0 when stopped, gated or empty
+  /// (no release needed then). A wrapped ring takes two acquire/release
+  /// rounds.
+  size_t acquire(const int16_t **samples);
+
+  /// Consume @p samples (<= the acquired length) and end the span
+  void release(size_t samples);
+
+  /// Only deliver audio while the pipeline VAD reports speech
+  void set_vad_gate(bool gate) { this->vad_gate_ = gate; }
+
  protected:
   bool is_running_{false};
   bool usb_initialized_{false};
+  bool vad_gate_{false};
 };
 
 }  // namespace usb_microphone
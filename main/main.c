@@ -9,12 +9,14 @@
  *   ┌─────────────────────────────────────────────────────────────┐
  *   │                      app_main()                              │
  *   ├─────────────────────────────────────────────────────────────┤
- *   │  1. System Init (NVS, Event Loop, Network)                  │
- *   │  2. Audio Pipeline Init (I2S0: DAC, I2S1: Mic)             │
- *   │  3. Display Init (MIPI-DSI + LVGL)                          │
- *   │  4. Sensor Hub Init (I2C + UART sensors)                    │
- *   │  5. LED Effect Init (WS2812B via RMT)                       │
- *   │  6. Start FreeRTOS Tasks                                    │
+ *   │  1. Start the boot graph (stages run as deps allow):        │
+ *   │       NVS ─► Wi-Fi ─► Remo ◄─ Command Cache                 │
+ *   │       Memory ─► Audio (I2S0: DAC, I2S1/USB: Mic)            │
+ *   │       Memory ─► Display (MIPI-DSI + LVGL) ─► UI             │
+ *   │       Memory ─► LED Effect (WS2812B)                        │
+ *   │       Sensor Hub (I2C + UART)                               │
+ *   │  2. Start FreeRTOS Tasks (each waits for its stage)         │
+ *   │  3. Log voice-path ready time and the boot timeline         │
  *   └─────────────────────────────────────────────────────────────┘
  *
  * Task Priority Layout:
@@ -24,6 +26,9 @@
  *   Priority 2: Sensor Task
  *   Priority 1: MQTT/Network Task
  *
+ * Core placement follows the Kconfig TASK_PLACEMENT profile (default:
+ * audio on core 1, everything else on core 0).
+ *
  * @author Omni-P4 Project
  * @date 2024
  */
@@ -45,11 +50,17 @@
 
 // Component headers
 #include "sensor_hub.h"
+#include "sensor_history.h"
+#include "telemetry.h"
 #include "audio_pipeline.h"
+#include "audio_player.h"
 #include "led_effect.h"
 #include "display_manager.h"
 #include "command_cache.h"
 #include "remo_client.h"
+#include "task_monitor.h"
+#include "init_graph.h"
+#include "mem_arena.h"
 
 static const char *TAG = "omni_p4";
 
@@ -95,6 +106,50 @@ typedef struct {
 static system_state_t s_system_state = {0};
 static SemaphoreHandle_t s_state_mutex = NULL;
 
+// ============================================================================
+// Telemetry
+// ============================================================================
+
+#if CONFIG_OMNI_P4_SENSORS_ENABLED
+#define TELEMETRY_FULL_EVERY        60      // Sensor reads between full frames
+#define TELEMETRY_BUF_SIZE          384
+
+static telemetry_encoder_t s_sensor_telemetry;
+static telemetry_encoder_t s_system_telemetry;
+static uint8_t s_telemetry_buf[TELEMETRY_BUF_SIZE];
+
+#if CONFIG_TELEMETRY_FORMAT_CBOR
+#define TELEMETRY_FORMAT            TELEMETRY_FORMAT_CBOR
+#else
+#define TELEMETRY_FORMAT            TELEMETRY_FORMAT_JSON
+#endif
+#endif
+
+// ============================================================================
+// Boot Stages
+// ============================================================================
+
+typedef enum {
+    BOOT_NVS = 0,
+    BOOT_EVENT_LOOP,
+    BOOT_MEMORY,
+    BOOT_CMD_CACHE,
+    BOOT_WIFI,
+    BOOT_REMO,
+    BOOT_AUDIO,
+    BOOT_PLAYER,
+    BOOT_DISPLAY,
+    BOOT_UI,
+    BOOT_SENSORS,
+    BOOT_LED,
+    BOOT_STAGE_COUNT
+} boot_stage_id_t;
+
+// First voice response needs the mic/DAC, TTS playback, the command matcher and Remo
+#define BOOT_VOICE_PATH     (INIT_STAGE_BIT(BOOT_AUDIO) | INIT_STAGE_BIT(BOOT_PLAYER) | \
+                             INIT_STAGE_BIT(BOOT_CMD_CACHE) | INIT_STAGE_BIT(BOOT_REMO))
+#define BOOT_ALL            (INIT_STAGE_BIT(BOOT_STAGE_COUNT) - 1)
+
 // ============================================================================
 // Forward Declarations
 // ============================================================================
@@ -102,6 +157,9 @@ static SemaphoreHandle_t s_state_mutex = NULL;
 static void audio_task(void *pvParameters);
 static void display_task(void *pvParameters);
 static void sensor_task(void *pvParameters);
+#if CONFIG_OMNI_P4_SENSORS_ENABLED
+static void publish_telemetry(const sensor_data_t *data);
+#endif
 static void led_task(void *pvParameters);
 static void network_task(void *pvParameters);
 static void system_monitor_task(void *pvParameters);
@@ -172,16 +230,23 @@ static void print_system_info(void)
  * @brief Audio processing task (highest priority)
  *
  * Handles:
- * - I2S data streaming (DAC output)
- * - Mic input processing (from ReSpeaker)
- * - Voice activity detection
- * - Audio buffer management
+ * - Voice activity edges -> LED feedback (one notify per segment start/end)
+ * - Pipeline housekeeping
+ *
+ * DAC streaming runs in the pipeline's own DMA-paced output task and mic
+ * input in its capture task/callback.
  */
 static void audio_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Audio task started");
 
 #if CONFIG_OMNI_P4_AUDIO_ENABLED
+    if (!init_graph_wait(INIT_STAGE_BIT(BOOT_AUDIO), portMAX_DELAY)) {
+        ESP_LOGE(TAG, "Audio pipeline unavailable");
+        vTaskDelete(NULL);
+        return;
+    }
+
     // Wait for audio pipeline to be ready
     audio_pipeline_wait_ready(portMAX_DELAY);
 
@@ -189,19 +254,23 @@ static void audio_task(void *pvParameters)
     ESP_LOGI(TAG, "Audio pipeline ready");
 
     while (1) {
+        // Sleeps until the VAD opens or closes a speech segment; audio
+        // timing itself is driven by DMA events
+        uint32_t events = audio_pipeline_wait_vad_event(100);
+        task_monitor_loop_begin(TASK_MONITOR_LOOP_AUDIO);
+
         // Process audio data
         audio_pipeline_process();
 
-        // Check for voice activity
-        if (audio_pipeline_voice_detected()) {
-            // Notify LED task for visual feedback
-            if (s_led_task_handle) {
-                xTaskNotify(s_led_task_handle, LED_NOTIFY_VOICE_ACTIVE, eSetBits);
-            }
+        if (events && s_led_task_handle) {
+            // A segment may both end and restart between waits: report the
+            // latest state
+            bool active = audio_pipeline_voice_detected();
+            xTaskNotify(s_led_task_handle,
+                        active ? LED_NOTIFY_VOICE_ACTIVE : LED_NOTIFY_VOICE_DONE,
+                        eSetBits);
         }
-
-        // Small delay to prevent CPU hogging
-        vTaskDelay(pdMS_TO_TICKS(5));
+        task_monitor_loop_end(TASK_MONITOR_LOOP_AUDIO);
     }
 #else
     ESP_LOGW(TAG, "Audio disabled in config");
@@ -222,10 +291,9 @@ static void display_task(void *pvParameters)
     ESP_LOGI(TAG, "Display task started");
 
 #if CONFIG_OMNI_P4_DISPLAY_ENABLED
-    // Initialize display
-    esp_err_t ret = display_manager_init();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Display init failed: %s", esp_err_to_name(ret));
+    // Panel, LVGL and the UI come up in their boot stages
+    if (!init_graph_wait(INIT_STAGE_BIT(BOOT_UI), portMAX_DELAY)) {
+        ESP_LOGE(TAG, "Display unavailable");
         vTaskDelete(NULL);
         return;
     }
@@ -233,12 +301,34 @@ static void display_task(void *pvParameters)
     xEventGroupSetBits(s_system_event_group, DISPLAY_READY_BIT);
     ESP_LOGI(TAG, "Display ready");
 
+#if CONFIG_AUDIO_ANALYZER
+    uint8_t shown_bands[AUDIO_ANALYZER_BANDS] = {0};
+#endif
+
     // LVGL main loop
     while (1) {
+        task_monitor_loop_begin(TASK_MONITOR_LOOP_DISPLAY);
+
+#if CONFIG_AUDIO_ANALYZER
+        // Spectrum bars: the user while they talk, otherwise the speaker
+        audio_analysis_t analysis;
+        audio_tap_t tap = audio_pipeline_voice_detected() ? AUDIO_TAP_MIC : AUDIO_TAP_OUTPUT;
+        if (audio_pipeline_get_analysis(tap, &analysis) == ESP_OK &&
+            memcmp(analysis.bands, shown_bands, sizeof(shown_bands)) != 0) {
+            float spectrum[AUDIO_ANALYZER_BANDS];
+            for (int i = 0; i < AUDIO_ANALYZER_BANDS; i++) {
+                spectrum[i] = analysis.bands[i] / 255.0f;
+            }
+            display_manager_update_spectrum(spectrum, AUDIO_ANALYZER_BANDS);
+            memcpy(shown_bands, analysis.bands, sizeof(shown_bands));
+        }
+#endif
+
         // Lock LVGL mutex and call timer handler
         display_manager_lock(-1);
         uint32_t delay_ms = display_manager_timer_handler();
         display_manager_unlock();
+        task_monitor_loop_end(TASK_MONITOR_LOOP_DISPLAY);
 
         // Wait for next LVGL tick
         if (delay_ms > 0) {
@@ -253,6 +343,21 @@ static void display_task(void *pvParameters)
 #endif
 }
 
+#if CONFIG_OMNI_P4_SENSORS_ENABLED
+/**
+ * @brief Presence change from the radar (LD2410 UART task context)
+ *
+ * Wakes the screen directly instead of waiting for the next sensor sweep.
+ */
+static void on_presence_changed(const sensor_presence_event_t *event, void *user_ctx)
+{
+    if (event->previous == PRESENCE_NONE && event->state != PRESENCE_NONE &&
+        (xEventGroupGetBits(s_system_event_group) & DISPLAY_READY_BIT)) {
+        display_manager_set_power(true);
+    }
+}
+#endif
+
 /**
  * @brief Sensor reading task
  *
@@ -266,10 +371,8 @@ static void sensor_task(void *pvParameters)
     ESP_LOGI(TAG, "Sensor task started");
 
 #if CONFIG_OMNI_P4_SENSORS_ENABLED
-    // Initialize sensor hub
-    esp_err_t ret = sensor_hub_init();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Sensor hub init failed: %s", esp_err_to_name(ret));
+    if (!init_graph_wait(INIT_STAGE_BIT(BOOT_SENSORS), portMAX_DELAY)) {
+        ESP_LOGE(TAG, "Sensor hub unavailable");
         vTaskDelete(NULL);
         return;
     }
@@ -277,12 +380,18 @@ static void sensor_task(void *pvParameters)
     xEventGroupSetBits(s_system_event_group, SENSORS_READY_BIT);
     ESP_LOGI(TAG, "Sensor hub ready");
 
+    uint8_t field_count;
+    const telemetry_field_t *fields = telemetry_sensor_fields(&field_count);
+    telemetry_encoder_init(&s_sensor_telemetry, fields, field_count, TELEMETRY_FULL_EVERY);
+    fields = telemetry_system_fields(&field_count);
+    telemetry_encoder_init(&s_system_telemetry, fields, field_count, TELEMETRY_FULL_EVERY);
+
     sensor_data_t sensor_data;
     TickType_t last_wake = xTaskGetTickCount();
 
     while (1) {
         // Read all sensors
-        ret = sensor_hub_read_all(&sensor_data);
+        esp_err_t ret = sensor_hub_read_all(&sensor_data);
         if (ret == ESP_OK) {
             // Log sensor data (debug)
             ESP_LOGD(TAG, "Temp: %.1f°C, Hum: %.1f%%, CO2: %d ppm",
@@ -290,16 +399,16 @@ static void sensor_task(void *pvParameters)
                      sensor_data.humidity,
                      sensor_data.co2);
 
-            // Update display if ready
+            sensor_history_record(&sensor_data);
+
+            // Post to the display (UI bus, never waits for LVGL)
             EventBits_t bits = xEventGroupGetBits(s_system_event_group);
             if (bits & DISPLAY_READY_BIT) {
                 display_manager_update_sensors(&sensor_data);
             }
 
-            // Publish to MQTT if connected
-            if (bits & MQTT_CONNECTED_BIT) {
-                // sensor_hub_publish_mqtt(&sensor_data);
-            }
+            // Telemetry frame (changed fields only)
+            publish_telemetry(&sensor_data);
         }
 
         // Wait for next reading interval
@@ -311,6 +420,76 @@ static void sensor_task(void *pvParameters)
 #endif
 }
 
+#if CONFIG_OMNI_P4_SENSORS_ENABLED
+/**
+ * @brief Write one encoded frame to the debug log
+ *
+ * DEBUG level: a frame per read must not flood the console (and its UART
+ * time) at the default INFO level.
+ */
+static void emit_telemetry(const char *topic, int len)
+{
+#if CONFIG_TELEMETRY_FORMAT_CBOR
+    ESP_LOGD(TAG, "%s (%d B CBOR)", topic, len);
+    ESP_LOG_BUFFER_HEX_LEVEL(TAG, s_telemetry_buf, len, ESP_LOG_DEBUG);
+#else
+    ESP_LOGD(TAG, "%s (%d B): %s", topic, len, (const char *)s_telemetry_buf);
+#endif
+}
+
+/**
+ * @brief Encode changed sensor / system fields and emit them
+ *
+ * Frames go to the debug log under their topic name; a full frame is sent every
+ * TELEMETRY_FULL_EVERY reads so a late listener catches up.
+ */
+static void publish_telemetry(const sensor_data_t *data)
+{
+    int32_t values[TELEMETRY_MAX_FIELDS];
+    int64_t now_ms = data->timestamp_us / 1000;
+
+    uint32_t valid = telemetry_sensor_values(data, values);
+    int len = telemetry_encode(&s_sensor_telemetry, values, valid, now_ms,
+                               TELEMETRY_FORMAT, s_telemetry_buf, sizeof(s_telemetry_buf));
+    if (len > 0) {
+        emit_telemetry("omni_p4/sensors", len);
+    } else if (len < 0) {
+        ESP_LOGW(TAG, "Sensor telemetry exceeds %d bytes", TELEMETRY_BUF_SIZE);
+    }
+
+    valid = telemetry_system_values(values);
+    len = telemetry_encode(&s_system_telemetry, values, valid, now_ms,
+                           TELEMETRY_FORMAT, s_telemetry_buf, sizeof(s_telemetry_buf));
+    if (len > 0) {
+        emit_telemetry("omni_p4/system", len);
+    } else if (len < 0) {
+        ESP_LOGW(TAG, "System telemetry exceeds %d bytes", TELEMETRY_BUF_SIZE);
+    }
+}
+#endif
+
+#if CONFIG_OMNI_P4_LED_ENABLED && CONFIG_AUDIO_ANALYZER
+/**
+ * @brief Feed the audio-reactive LED modes from the pipeline taps
+ *
+ * LISTENING follows the mic, SPEAKING the DAC mix. RMS is mapped from
+ * AUDIO_ANALYZER_FLOOR_DB..0 dBFS to 0.0-1.0.
+ */
+static void led_feed_audio(void)
+{
+    led_mode_t mode = led_effect_get_mode();
+    if (mode != LED_MODE_LISTENING && mode != LED_MODE_SPEAKING) return;
+
+    audio_analysis_t analysis;
+    audio_tap_t tap = (mode == LED_MODE_SPEAKING) ? AUDIO_TAP_OUTPUT : AUDIO_TAP_MIC;
+    if (audio_pipeline_get_analysis(tap, &analysis) != ESP_OK) return;
+
+    const int32_t floor_q8 = AUDIO_VAD_DB_Q8(AUDIO_ANALYZER_FLOOR_DB);
+    led_effect_set_audio_level((float)(analysis.rms_db_q8 - floor_q8) / -floor_q8);
+    led_effect_set_audio_bands(analysis.bands, AUDIO_ANALYZER_BANDS);
+}
+#endif
+
 /**
  * @brief LED effect task (WS2812B ring)
  *
@@ -324,23 +503,19 @@ static void led_task(void *pvParameters)
     ESP_LOGI(TAG, "LED task started");
 
 #if CONFIG_OMNI_P4_LED_ENABLED
-    // Initialize LED strip
-    esp_err_t ret = led_effect_init();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "LED init failed: %s", esp_err_to_name(ret));
+    if (!init_graph_wait(INIT_STAGE_BIT(BOOT_LED), portMAX_DELAY)) {
+        ESP_LOGE(TAG, "LED strip unavailable");
         vTaskDelete(NULL);
         return;
     }
 
     ESP_LOGI(TAG, "LED strip ready");
 
-    // Set initial effect (breathing)
-    led_effect_set_mode(LED_MODE_BREATHING);
-
     uint32_t notify_value;
     while (1) {
-        // Check for notifications from other tasks
-        if (xTaskNotifyWait(0, ULONG_MAX, &notify_value, pdMS_TO_TICKS(20))) {
+        // Check for notifications from other tasks (long wait while static)
+        if (xTaskNotifyWait(0, ULONG_MAX, &notify_value,
+                            pdMS_TO_TICKS(led_effect_frame_interval_ms()))) {
             if (notify_value & LED_NOTIFY_VOICE_ACTIVE) {
                 led_effect_set_mode(LED_MODE_LISTENING);
             } else if (notify_value & LED_NOTIFY_VOICE_PROCESSING) {
@@ -352,6 +527,10 @@ static void led_task(void *pvParameters)
             }
         }
 
+#if CONFIG_AUDIO_ANALYZER
+        led_feed_audio();
+#endif
+
         // Update LED animation
         led_effect_update();
     }
@@ -373,17 +552,11 @@ static void network_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "Network task started");
 
-    // TODO: Implement WiFi and MQTT initialization
-    // For now, just mark as placeholder
-
-    // Initialize Nature Remo client
-    // This will mount SPIFFS and attempt mDNS discovery
-    esp_err_t remo_ret = remo_client_init();
-    if (remo_ret == ESP_OK) {
+    // Wi-Fi and Remo come up in their boot stages; state upkeep runs
+    // either way
+    if (init_graph_wait(INIT_STAGE_BIT(BOOT_REMO), portMAX_DELAY)) {
         ESP_LOGI(TAG, "Remo client initialized, available: %s",
                  remo_client_is_available() ? "yes" : "no");
-    } else {
-        ESP_LOGW(TAG, "Remo client init failed: %s", esp_err_to_name(remo_ret));
     }
 
     while (1) {
@@ -404,31 +577,192 @@ static void network_task(void *pvParameters)
  *
  * Handles:
  * - Memory monitoring
- * - Watchdog feeding
+ * - Audio ring fill sampling (histograms)
+ * - Task / loop statistics windows
  * - Status logging
  */
 static void system_monitor_task(void *pvParameters)
 {
     ESP_LOGI(TAG, "System monitor started");
 
+    const uint32_t samples_per_report =
+        (CONFIG_TASK_MONITOR_REPORT_S * 1000) / CONFIG_TASK_MONITOR_SAMPLE_MS;
+    uint32_t samples = 0;
     TickType_t last_wake = xTaskGetTickCount();
 
     while (1) {
-        // Log system status every 30 seconds
-        ESP_LOGI(TAG, "System: Heap=%lu, PSRAM=%zu, Uptime=%lus",
-                 (unsigned long)esp_get_free_heap_size(),
-                 heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
-                 (unsigned long)(esp_timer_get_time() / 1000000));
-
-        // Check for low memory
-        if (esp_get_free_heap_size() < 50000) {
-            ESP_LOGW(TAG, "Low heap warning!");
+#if CONFIG_OMNI_P4_AUDIO_ENABLED
+        uint8_t output_level, input_level;
+        audio_pipeline_get_buffer_levels(&output_level, &input_level);
+        task_monitor_ring_sample(TASK_MONITOR_RING_OUTPUT, output_level);
+        task_monitor_ring_sample(TASK_MONITOR_RING_INPUT, input_level);
+#endif
+
+        if (++samples >= samples_per_report) {
+            samples = 0;
+
+            ESP_LOGI(TAG, "System: Heap=%lu, PSRAM=%zu, Uptime=%lus",
+                     (unsigned long)esp_get_free_heap_size(),
+                     heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+                     (unsigned long)(esp_timer_get_time() / 1000000));
+
+            // Check for low memory
+            if (esp_get_free_heap_size() < 50000) {
+                ESP_LOGW(TAG, "Low heap warning!");
+            }
+
+            // Close the window; the summary goes out with the system telemetry
+            task_monitor_update();
+            task_monitor_log();
         }
 
-        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(30000));
+        vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(CONFIG_TASK_MONITOR_SAMPLE_MS));
+    }
+}
+
+// ============================================================================
+// Boot Stages (init_graph workers)
+// ============================================================================
+
+static esp_err_t stage_nvs(void)
+{
+    return init_nvs();
+}
+
+static esp_err_t stage_event_loop(void)
+{
+    return esp_event_loop_create_default();
+}
+
+static esp_err_t stage_memory(void)
+{
+    init_memory();
+
+    // Long-lived audio / UI / LED buffers come from the boot-time budget;
+    // a region that cannot be reserved (no PSRAM) falls back to the heap,
+    // so its dependents still start
+    mem_arena_init();
+    return ESP_OK;
+}
+
+static esp_err_t stage_cmd_cache(void)
+{
+    if (!cmd_cache_init()) return ESP_FAIL;
+    ESP_LOGI(TAG, "Command cache initialized with %d commands", cmd_cache_get_count());
+    return ESP_OK;
+}
+
+static esp_err_t stage_wifi(void)
+{
+    // TODO: Wi-Fi station + MQTT client; Remo and HA publishing wait here
+    return ESP_OK;
+}
+
+static esp_err_t stage_remo(void)
+{
+    // Mounts SPIFFS, loads appliances; discovery continues in the background
+    esp_err_t ret = remo_client_init();
+    if (ret != ESP_OK) return ret;
+
+    // Appliance names become {appliance} slot values in the command cache
+    int appliance_count = 0;
+    const remo_appliance_t *appliances = remo_client_get_appliances(&appliance_count);
+    const char *names[REMO_MAX_APPLIANCES];
+    for (int i = 0; i < appliance_count && i < REMO_MAX_APPLIANCES; i++) {
+        names[i] = appliances[i].name;
+    }
+    cmd_cache_set_appliances(names, appliance_count);
+    return ESP_OK;
+}
+
+static esp_err_t stage_audio(void)
+{
+#if CONFIG_OMNI_P4_AUDIO_ENABLED
+    esp_err_t ret = audio_pipeline_init();
+    s_system_state.audio_enabled = (ret == ESP_OK);
+    return ret;
+#else
+    return ESP_OK;
+#endif
+}
+
+static esp_err_t stage_player(void)
+{
+#if CONFIG_OMNI_P4_AUDIO_ENABLED
+    // Skipped with the pipeline; a failure leaves the mic path and music running
+    return audio_player_init();
+#else
+    return ESP_OK;
+#endif
+}
+
+static esp_err_t stage_display(void)
+{
+#if CONFIG_OMNI_P4_DISPLAY_ENABLED
+    return display_manager_init();
+#else
+    return ESP_OK;
+#endif
+}
+
+static esp_err_t stage_ui(void)
+{
+#if CONFIG_OMNI_P4_DISPLAY_ENABLED
+    return display_manager_start_ui();
+#else
+    return ESP_OK;
+#endif
+}
+
+static esp_err_t stage_sensors(void)
+{
+#if CONFIG_OMNI_P4_SENSORS_ENABLED
+    esp_err_t ret = sensor_hub_init();
+    if (ret != ESP_OK) return ret;
+
+    sensor_hub_set_presence_callback(on_presence_changed, NULL);
+
+    // History is optional: charts and backfill degrade, readings continue
+    if (sensor_history_init() != ESP_OK) {
+        ESP_LOGW(TAG, "Sensor history unavailable");
     }
+#endif
+    return ESP_OK;
 }
 
+static esp_err_t stage_led(void)
+{
+#if CONFIG_OMNI_P4_LED_ENABLED
+    esp_err_t ret = led_effect_init();
+    if (ret != ESP_OK) return ret;
+
+    // Set initial effect (breathing)
+    led_effect_set_mode(LED_MODE_BREATHING);
+#endif
+    return ESP_OK;
+}
+
+// Voice path first: its workers outrank the UI and the sensors
+_Static_assert(BOOT_STAGE_COUNT <= INIT_GRAPH_MAX_STAGES, "too many boot stages for init_graph");
+
+static const init_stage_t BOOT_STAGES[BOOT_STAGE_COUNT] = {
+    [BOOT_NVS]        = {"nvs",       stage_nvs,        0, 3072, 4},
+    [BOOT_EVENT_LOOP] = {"event_loop", stage_event_loop, 0, 3072, 4},
+    [BOOT_MEMORY]     = {"memory",    stage_memory,     0, 3072, 4},
+    [BOOT_CMD_CACHE]  = {"cmd_cache", stage_cmd_cache,  0, 4096, 4},
+    [BOOT_WIFI]       = {"wifi",      stage_wifi,
+                         INIT_STAGE_BIT(BOOT_NVS) | INIT_STAGE_BIT(BOOT_EVENT_LOOP), 4096, 4},
+    [BOOT_REMO]       = {"remo",      stage_remo,
+                         INIT_STAGE_BIT(BOOT_NVS) | INIT_STAGE_BIT(BOOT_WIFI) |
+                         INIT_STAGE_BIT(BOOT_CMD_CACHE), 6144, 4},
+    [BOOT_AUDIO]      = {"audio",     stage_audio,      INIT_STAGE_BIT(BOOT_MEMORY), 6144, 4},
+    [BOOT_PLAYER]     = {"player",    stage_player,     INIT_STAGE_BIT(BOOT_AUDIO), 4096, 4},
+    [BOOT_DISPLAY]    = {"display",   stage_display,    INIT_STAGE_BIT(BOOT_MEMORY), 8192, 3},
+    [BOOT_UI]         = {"ui",        stage_ui,         INIT_STAGE_BIT(BOOT_DISPLAY), 8192, 3},
+    [BOOT_SENSORS]    = {"sensors",   stage_sensors,    0, 4096, 2},
+    [BOOT_LED]        = {"led",       stage_led,        INIT_STAGE_BIT(BOOT_MEMORY), 4096, 2},
+};
+
 // ============================================================================
 // Application Entry Point
 // ============================================================================
@@ -438,44 +772,25 @@ void app_main(void)
     // Print boot banner
     print_system_info();
 
-    // Initialize memory and NVS
-    init_memory();
-    ESP_ERROR_CHECK(init_nvs());
-
     // Create event group and mutex
     s_system_event_group = xEventGroupCreate();
     s_state_mutex = xSemaphoreCreateMutex();
     assert(s_system_event_group != NULL);
     assert(s_state_mutex != NULL);
 
-    // Initialize default event loop
-    ESP_ERROR_CHECK(esp_event_loop_create_default());
-
-    // Initialize command cache for voice commands
-    cmd_cache_init();
-    ESP_LOGI(TAG, "Command cache initialized with %d commands", cmd_cache_get_count());
-
     // ========================================================================
-    // Initialize Audio Pipeline (before starting tasks)
+    // Bring Up Subsystems (concurrently, in dependency order)
     // ========================================================================
-#if CONFIG_OMNI_P4_AUDIO_ENABLED
-    ESP_LOGI(TAG, "Initializing audio pipeline...");
-    esp_err_t ret = audio_pipeline_init();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Audio pipeline init failed: %s", esp_err_to_name(ret));
-        s_system_state.audio_enabled = false;
-    } else {
-        s_system_state.audio_enabled = true;
-    }
-#endif
+    ESP_ERROR_CHECK(init_graph_start(BOOT_STAGES, BOOT_STAGE_COUNT));
 
     // ========================================================================
     // Create FreeRTOS Tasks
     // ========================================================================
 
     ESP_LOGI(TAG, "Creating FreeRTOS tasks...");
+    task_monitor_init();
 
-    // Audio task (highest priority, pinned to core 1)
+    // Audio task (highest priority)
     xTaskCreatePinnedToCore(
         audio_task,
         "audio",
@@ -483,10 +798,10 @@ void app_main(void)
         NULL,
         5,  // Highest priority
         &s_audio_task_handle,
-        1   // Core 1
+        CONFIG_TASK_CORE_AUDIO
     );
 
-    // Display task (high priority, pinned to core 0)
+    // Display task (high priority)
     xTaskCreatePinnedToCore(
         display_task,
         "display",
@@ -494,7 +809,7 @@ void app_main(void)
         NULL,
         4,
         &s_display_task_handle,
-        0   // Core 0
+        CONFIG_TASK_CORE_DISPLAY
     );
 
     // LED effect task
@@ -505,7 +820,7 @@ void app_main(void)
         NULL,
         3,
         &s_led_task_handle,
-        0
+        CONFIG_TASK_CORE_SYSTEM
     );
 
     // Sensor task
@@ -516,7 +831,7 @@ void app_main(void)
         NULL,
         2,
         &s_sensor_task_handle,
-        0
+        CONFIG_TASK_CORE_SYSTEM
     );
 
     // Network task
@@ -527,19 +842,28 @@ void app_main(void)
         NULL,
         1,
         &s_network_task_handle,
-        0
+        CONFIG_TASK_CORE_SYSTEM
     );
 
     // System monitor (lowest priority)
-    xTaskCreate(
+    xTaskCreatePinnedToCore(
         system_monitor_task,
         "sysmon",
-        2048,
+        4096,
         NULL,
         0,  // Lowest priority
-        NULL
+        NULL,
+        (CONFIG_TASK_CORE_HELPER < 0) ? tskNO_AFFINITY : CONFIG_TASK_CORE_HELPER
     );
 
+    // Time to first voice response is bounded by this
+    init_graph_wait(BOOT_VOICE_PATH, portMAX_DELAY);
+    ESP_LOGI(TAG, "Voice path ready at %lld ms", init_graph_done_us(BOOT_VOICE_PATH) / 1000);
+
+    init_graph_wait(BOOT_ALL, portMAX_DELAY);
+    init_graph_log_timeline();
+    mem_arena_log();
+
     // Mark system as initialized
     xEventGroupSetBits(s_system_event_group, SYSTEM_INIT_COMPLETE_BIT);
 
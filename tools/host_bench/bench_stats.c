@@ -0,0 +1,77 @@
+/**
+ * @file bench_stats.c
+ * @brief Latency samples and percentiles implementation
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "bench_stats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+uint64_t bench_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void bench_stats_init(bench_stats_t *st)
+{
+    memset(st, 0, sizeof(*st));
+}
+
+void bench_stats_free(bench_stats_t *st)
+{
+    free(st->ns);
+    memset(st, 0, sizeof(*st));
+}
+
+void bench_stats_add(bench_stats_t *st, uint64_t ns)
+{
+    if (st->count == st->capacity) {
+        size_t cap = st->capacity ? st->capacity * 2 : 1024;
+        uint64_t *grown = realloc(st->ns, cap * sizeof(uint64_t));
+        if (!grown) return;
+        st->ns = grown;
+        st->capacity = cap;
+    }
+    st->ns[st->count++] = ns;
+    st->total += ns;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint64_t rank(const bench_stats_t *st, unsigned pct)
+{
+    size_t i = (st->count * pct + 99) / 100;
+    return st->ns[i ? i - 1 : 0];
+}
+
+void bench_stats_summary(bench_stats_t *st, bench_summary_t *out)
+{
+    memset(out, 0, sizeof(*out));
+    if (st->count == 0) return;
+
+    qsort(st->ns, st->count, sizeof(uint64_t), cmp_u64);
+    out->count = st->count;
+    out->avg = st->total / st->count;
+    out->p50 = rank(st, 50);
+    out->p90 = rank(st, 90);
+    out->p99 = rank(st, 99);
+    out->max = st->ns[st->count - 1];
+}
+
+void bench_stats_print(bench_stats_t *st, const char *label)
+{
+    bench_summary_t s;
+    bench_stats_summary(st, &s);
+    printf("  %-22s n=%-7zu avg %8.2f us   p50 %8.2f   p90 %8.2f   p99 %8.2f   max %8.2f\n",
+           label, s.count, s.avg / 1000.0, s.p50 / 1000.0, s.p90 / 1000.0,
+           s.p99 / 1000.0, s.max / 1000.0);
+}
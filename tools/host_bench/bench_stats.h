@@ -0,0 +1,58 @@
+/**
+ * @file bench_stats.h
+ * @brief Latency samples and percentiles for the host benches
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Growable set of latency samples (ns)
+ */
+typedef struct {
+    uint64_t *ns;
+    size_t count;
+    size_t capacity;
+    uint64_t total;
+} bench_stats_t;
+
+/**
+ * @brief Summary of a sample set (all in ns)
+ */
+typedef struct {
+    size_t count;
+    uint64_t avg;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    uint64_t max;
+} bench_summary_t;
+
+/**
+ * @brief Monotonic clock in ns
+ */
+uint64_t bench_now_ns(void);
+
+void bench_stats_init(bench_stats_t *st);
+void bench_stats_free(bench_stats_t *st);
+void bench_stats_add(bench_stats_t *st, uint64_t ns);
+
+/**
+ * @brief Sort the samples and compute percentiles (nearest rank)
+ */
+void bench_stats_summary(bench_stats_t *st, bench_summary_t *out);
+
+/**
+ * @brief Print "<label>: n, avg, p50/p90/p99/max" in microseconds
+ */
+void bench_stats_print(bench_stats_t *st, const char *label);
+
+#ifdef __cplusplus
+}
+#endif
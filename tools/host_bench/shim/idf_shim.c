@@ -0,0 +1,253 @@
+/**
+ * @file idf_shim.c
+ * @brief Single-threaded host implementations of the idf_shim.h API
+ */
+
+#define _POSIX_C_SOURCE 200809L
+#include "idf_shim.h"
+#include <stdarg.h>
+#include <time.h>
+
+esp_log_level_t idf_shim_log_level = ESP_LOG_WARN;
+
+// ============================================================================
+// Error / Log
+// ============================================================================
+
+const char *esp_err_to_name(esp_err_t code)
+{
+    switch (code) {
+        case ESP_OK:                return "ESP_OK";
+        case ESP_FAIL:              return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:        return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:   return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE: return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:  return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:     return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED: return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:       return "ESP_ERR_TIMEOUT";
+        default:                    return "UNKNOWN ERROR";
+    }
+}
+
+void idf_shim_log(esp_log_level_t level, const char *tag, const char *fmt, ...)
+{
+    static const char LETTER[] = "-EWIDV";
+    if (level > idf_shim_log_level) return;
+
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "%c (%lld) %s: ", LETTER[level], (long long)(esp_timer_get_time() / 1000), tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    va_end(ap);
+}
+
+// ============================================================================
+// Timer / Heap
+// ============================================================================
+
+int64_t esp_timer_get_time(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+void *heap_caps_malloc(size_t size, uint32_t caps)
+{
+    (void)caps;
+    return malloc(size);
+}
+
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+{
+    (void)caps;
+    return calloc(n, size);
+}
+
+void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps)
+{
+    (void)caps;
+    void *ptr = NULL;
+    if (alignment < sizeof(void *)) alignment = sizeof(void *);
+    return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+}
+
+void heap_caps_free(void *ptr)
+{
+    free(ptr);
+}
+
+// ============================================================================
+// Tasks (recorded, never run)
+// ============================================================================
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack,
+                                   void *arg, UBaseType_t prio, TaskHandle_t *handle,
+                                   BaseType_t core)
+{
+    (void)fn; (void)stack; (void)arg; (void)prio; (void)core;
+    // Any non-NULL handle; the task body is driven by the bench instead
+    if (handle) *handle = (TaskHandle_t)name;
+    ESP_LOGD("idf_shim", "Task '%s' not started (host)", name);
+    return pdPASS;
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+    (void)task;
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+    (void)ticks;
+}
+
+TickType_t xTaskGetTickCount(void)
+{
+    return (TickType_t)(esp_timer_get_time() / (1000 * portTICK_PERIOD_MS));
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+    (void)task;
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken)
+{
+    (void)task;
+    if (woken) *woken = pdFALSE;
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait)
+{
+    (void)clear; (void)wait;
+    return 0;
+}
+
+// ============================================================================
+// Semaphores / Event Groups
+// ============================================================================
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    return calloc(1, sizeof(int));
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait)
+{
+    (void)sem; (void)wait;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem)
+{
+    (void)sem;
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem)
+{
+    free(sem);
+}
+
+EventGroupHandle_t xEventGroupCreate(void)
+{
+    return calloc(1, sizeof(EventBits_t));
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    return *(EventBits_t *)group |= bits;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits)
+{
+    EventBits_t prev = *(EventBits_t *)group;
+    *(EventBits_t *)group = prev & ~bits;
+    return prev;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group)
+{
+    return *(EventBits_t *)group;
+}
+
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear,
+                                BaseType_t all, TickType_t wait)
+{
+    // Nothing else can set bits while we wait: report the current state
+    (void)all; (void)wait;
+    EventBits_t cur = *(EventBits_t *)group;
+    if (clear) *(EventBits_t *)group = cur & ~bits;
+    return cur;
+}
+
+void vEventGroupDelete(EventGroupHandle_t group)
+{
+    free(group);
+}
+
+// ============================================================================
+// I2S (accepts everything, moves no data)
+// ============================================================================
+
+static int s_i2s_channels[4];
+
+esp_err_t i2s_new_channel(const i2s_chan_config_t *cfg, i2s_chan_handle_t *tx, i2s_chan_handle_t *rx)
+{
+    if (!cfg || cfg->id < 0 || cfg->id > 1) return ESP_ERR_INVALID_ARG;
+    if (tx) *tx = &s_i2s_channels[cfg->id * 2];
+    if (rx) *rx = &s_i2s_channels[cfg->id * 2 + 1];
+    return ESP_OK;
+}
+
+esp_err_t i2s_del_channel(i2s_chan_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t handle, const i2s_std_config_t *cfg)
+{
+    (void)handle; (void)cfg;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_enable(i2s_chan_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_disable(i2s_chan_handle_t handle)
+{
+    (void)handle;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_read(i2s_chan_handle_t handle, void *dest, size_t size,
+                           size_t *bytes_read, uint32_t timeout_ms)
+{
+    (void)handle; (void)dest; (void)size; (void)timeout_ms;
+    if (bytes_read) *bytes_read = 0;
+    return ESP_ERR_TIMEOUT;
+}
+
+esp_err_t i2s_channel_write(i2s_chan_handle_t handle, const void *src, size_t size,
+                            size_t *bytes_written, uint32_t timeout_ms)
+{
+    (void)handle; (void)src; (void)timeout_ms;
+    if (bytes_written) *bytes_written = size;
+    return ESP_OK;
+}
+
+esp_err_t i2s_channel_register_event_callback(i2s_chan_handle_t handle,
+                                              const i2s_event_callbacks_t *callbacks,
+                                              void *user_data)
+{
+    (void)handle; (void)callbacks; (void)user_data;
+    return ESP_OK;
+}
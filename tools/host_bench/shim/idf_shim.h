@@ -0,0 +1,293 @@
+/**
+ * @file idf_shim.h
+ * @brief Minimal ESP-IDF / FreeRTOS surface for host builds
+ *
+ * Just enough of the IDF API for the audio_hal and mem_arena sources to
+ * compile and run single-threaded on a PC:
+ *
+ *   - Tasks are recorded and never started; the bench drives the
+ *     processing functions itself
+ *   - portMUX critical sections are no-ops (one thread)
+ *   - Event groups are plain bitmasks, mutexes always succeed
+ *   - esp_timer / tick count come from CLOCK_MONOTONIC
+ *   - I2S calls succeed and move no data
+ *   - I2C master handles exist as types only (sensor_hub headers)
+ *
+ * The individual IDF header names (esp_log.h, freertos/task.h, ...) in
+ * this directory all forward here.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ============================================================================
+// esp_err.h / esp_check.h
+// ============================================================================
+
+typedef int esp_err_t;
+
+#define ESP_OK                      0
+#define ESP_FAIL                    -1
+#define ESP_ERR_NO_MEM              0x101
+#define ESP_ERR_INVALID_ARG         0x102
+#define ESP_ERR_INVALID_STATE       0x103
+#define ESP_ERR_INVALID_SIZE        0x104
+#define ESP_ERR_NOT_FOUND           0x105
+#define ESP_ERR_NOT_SUPPORTED       0x106
+#define ESP_ERR_TIMEOUT             0x107
+
+const char *esp_err_to_name(esp_err_t code);
+
+#define ESP_ERROR_CHECK(x) do {                                             \
+        esp_err_t err_rc_ = (x);                                            \
+        if (err_rc_ != ESP_OK) {                                            \
+            fprintf(stderr, "ESP_ERROR_CHECK failed: %s at %s:%d\n",        \
+                    esp_err_to_name(err_rc_), __FILE__, __LINE__);           \
+            abort();                                                        \
+        }                                                                   \
+    } while (0)
+
+#define ESP_RETURN_ON_ERROR(x, tag, fmt, ...) do {                          \
+        esp_err_t err_rc_ = (x);                                            \
+        if (err_rc_ != ESP_OK) {                                            \
+            ESP_LOGE(tag, "%s(%d): " fmt, __func__, __LINE__, ##__VA_ARGS__); \
+            return err_rc_;                                                 \
+        }                                                                   \
+    } while (0)
+
+#define ESP_RETURN_ON_FALSE(a, err_code, tag, fmt, ...) do {                \
+        if (!(a)) {                                                         \
+            ESP_LOGE(tag, "%s(%d): " fmt, __func__, __LINE__, ##__VA_ARGS__); \
+            return err_code;                                                \
+        }                                                                   \
+    } while (0)
+
+// ============================================================================
+// esp_log.h
+// ============================================================================
+
+typedef enum {
+    ESP_LOG_NONE = 0,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+/** Messages above this level are dropped (bench default: warnings) */
+extern esp_log_level_t idf_shim_log_level;
+
+void idf_shim_log(esp_log_level_t level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+
+#define ESP_LOGE(tag, fmt, ...) idf_shim_log(ESP_LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) idf_shim_log(ESP_LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) idf_shim_log(ESP_LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) idf_shim_log(ESP_LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) idf_shim_log(ESP_LOG_VERBOSE, tag, fmt, ##__VA_ARGS__)
+
+// ============================================================================
+// esp_attr.h / esp_bit_defs.h
+// ============================================================================
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define EXT_RAM_BSS_ATTR
+
+#define BIT(n)      (1u << (n))
+#define BIT0        BIT(0)
+#define BIT1        BIT(1)
+#define BIT2        BIT(2)
+#define BIT3        BIT(3)
+#define BIT4        BIT(4)
+#define BIT5        BIT(5)
+#define BIT6        BIT(6)
+#define BIT7        BIT(7)
+#define BIT8        BIT(8)
+
+// ============================================================================
+// esp_timer.h / esp_heap_caps.h
+// ============================================================================
+
+int64_t esp_timer_get_time(void);
+
+#define MALLOC_CAP_DMA          (1 << 0)
+#define MALLOC_CAP_INTERNAL     (1 << 1)
+#define MALLOC_CAP_SPIRAM       (1 << 2)
+#define MALLOC_CAP_8BIT         (1 << 3)
+#define MALLOC_CAP_32BIT        (1 << 4)
+#define MALLOC_CAP_DEFAULT      (1 << 5)
+
+void *heap_caps_malloc(size_t size, uint32_t caps);
+void *heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+void *heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps);
+void heap_caps_free(void *ptr);
+
+// ============================================================================
+// FreeRTOS
+// ============================================================================
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t EventBits_t;
+typedef void *TaskHandle_t;
+typedef void *SemaphoreHandle_t;
+typedef void *EventGroupHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+#define pdTRUE                  1
+#define pdFALSE                 0
+#define pdPASS                  1
+#define pdFAIL                  0
+#define portMAX_DELAY           ((TickType_t)0xffffffffu)
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portYIELD_FROM_ISR(x)   (void)(x)
+#define tskNO_AFFINITY          0x7fffffff
+
+typedef struct { int unused; } portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+#define portENTER_CRITICAL(mux)         (void)(mux)
+#define portEXIT_CRITICAL(mux)          (void)(mux)
+#define portENTER_CRITICAL_ISR(mux)     (void)(mux)
+#define portEXIT_CRITICAL_ISR(mux)      (void)(mux)
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack,
+                                   void *arg, UBaseType_t prio, TaskHandle_t *handle,
+                                   BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t wait);
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t wait);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+EventGroupHandle_t xEventGroupCreate(void);
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits);
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group);
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear,
+                                BaseType_t all, TickType_t wait);
+void vEventGroupDelete(EventGroupHandle_t group);
+
+// ============================================================================
+// driver/gpio.h / driver/i2s_std.h
+// ============================================================================
+
+typedef int gpio_num_t;
+#define GPIO_NUM_NC     (-1)
+
+typedef void *i2s_chan_handle_t;
+typedef int i2s_port_t;
+typedef int i2s_data_bit_width_t;
+typedef int i2s_slot_mode_t;
+
+typedef struct {
+    void *dma_buf;
+    size_t size;
+} i2s_event_data_t;
+
+typedef bool (*i2s_isr_callback_t)(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx);
+
+typedef struct {
+    i2s_isr_callback_t on_recv;
+    i2s_isr_callback_t on_recv_q_ovf;
+    i2s_isr_callback_t on_sent;
+    i2s_isr_callback_t on_send_q_ovf;
+} i2s_event_callbacks_t;
+
+typedef struct {
+    i2s_port_t id;
+    int role;
+    uint32_t dma_desc_num;
+    uint32_t dma_frame_num;
+    bool auto_clear;
+    bool auto_clear_before_cb;
+    int intr_priority;
+} i2s_chan_config_t;
+
+typedef struct {
+    uint32_t sample_rate_hz;
+    int clk_src;
+    int mclk_multiple;
+} i2s_std_clk_config_t;
+
+typedef struct {
+    int data_bit_width;
+    int slot_bit_width;
+    int slot_mode;
+    int slot_mask;
+} i2s_std_slot_config_t;
+
+typedef struct {
+    gpio_num_t mclk, bclk, ws, dout, din;
+    struct { bool mclk_inv, bclk_inv, ws_inv; } invert_flags;
+} i2s_std_gpio_config_t;
+
+typedef struct {
+    i2s_std_clk_config_t clk_cfg;
+    i2s_std_slot_config_t slot_cfg;
+    i2s_std_gpio_config_t gpio_cfg;
+} i2s_std_config_t;
+
+#define I2S_NUM_0                   0
+#define I2S_NUM_1                   1
+#define I2S_ROLE_MASTER             0
+#define I2S_ROLE_SLAVE              1
+#define I2S_DATA_BIT_WIDTH_16BIT    16
+#define I2S_DATA_BIT_WIDTH_24BIT    24
+#define I2S_DATA_BIT_WIDTH_32BIT    32
+#define I2S_SLOT_MODE_MONO          1
+#define I2S_SLOT_MODE_STEREO        2
+#define I2S_STD_SLOT_LEFT           (1 << 0)
+#define I2S_STD_SLOT_RIGHT          (1 << 1)
+#define I2S_STD_SLOT_BOTH           (I2S_STD_SLOT_LEFT | I2S_STD_SLOT_RIGHT)
+#define I2S_MCLK_MULTIPLE_256       256
+#define I2S_MCLK_MULTIPLE_384       384
+
+#define I2S_CHANNEL_DEFAULT_CONFIG(i2s_num, i2s_role)  { .id = (i2s_num), .role = (i2s_role), .dma_desc_num = 6, .dma_frame_num = 240 }
+#define I2S_STD_CLK_DEFAULT_CONFIG(rate)                { .sample_rate_hz = (rate), .mclk_multiple = I2S_MCLK_MULTIPLE_256 }
+#define I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(bits, mode) { .data_bit_width = (bits), .slot_bit_width = (bits), .slot_mode = (mode), .slot_mask = I2S_STD_SLOT_BOTH }
+#define I2S_STD_MSB_SLOT_DEFAULT_CONFIG(bits, mode)     I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(bits, mode)
+
+esp_err_t i2s_new_channel(const i2s_chan_config_t *cfg, i2s_chan_handle_t *tx, i2s_chan_handle_t *rx);
+esp_err_t i2s_del_channel(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_init_std_mode(i2s_chan_handle_t handle, const i2s_std_config_t *cfg);
+esp_err_t i2s_channel_enable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_disable(i2s_chan_handle_t handle);
+esp_err_t i2s_channel_read(i2s_chan_handle_t handle, void *dest, size_t size,
+                           size_t *bytes_read, uint32_t timeout_ms);
+esp_err_t i2s_channel_write(i2s_chan_handle_t handle, const void *src, size_t size,
+                            size_t *bytes_written, uint32_t timeout_ms);
+esp_err_t i2s_channel_register_event_callback(i2s_chan_handle_t handle,
+                                              const i2s_event_callbacks_t *callbacks,
+                                              void *user_data);
+
+// ============================================================================
+// driver/i2c_master.h
+// ============================================================================
+
+typedef void *i2c_master_bus_handle_t;
+typedef void *i2c_master_dev_handle_t;
+
+#ifdef __cplusplus
+}
+#endif
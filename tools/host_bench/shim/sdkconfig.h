@@ -0,0 +1,101 @@
+/**
+ * @file sdkconfig.h
+ * @brief Host bench configuration (I2S input, Kconfig defaults)
+ *
+ * Mirrors the defaults of main/Kconfig.projbuild for an I2S microphone
+ * build. Every value can be overridden from CMake, e.g.
+ *   cmake -DBENCH_DEFINES="CONFIG_MIC_CHANNELS=2;CONFIG_AUDIO_VAD_FIXED=1"
+ * Options that are off by default are left undefined; the two that are on
+ * by default are turned off with BENCH_NO_AEC / BENCH_NO_VAD_SPECTRAL
+ * (CMake options BENCH_AEC / BENCH_VAD_SPECTRAL).
+ */
+
+#pragma once
+
+// Microphone (I2S1)
+#define CONFIG_AUDIO_INPUT_I2S              1
+#ifndef CONFIG_MIC_SAMPLE_RATE
+#define CONFIG_MIC_SAMPLE_RATE              48000
+#endif
+#ifndef CONFIG_MIC_CHANNELS
+#define CONFIG_MIC_CHANNELS                 1
+#endif
+#ifndef CONFIG_PROCESSED_SAMPLE_RATE
+#define CONFIG_PROCESSED_SAMPLE_RATE        16000
+#endif
+#define CONFIG_I2S1_BCK_GPIO                15
+#define CONFIG_I2S1_WS_GPIO                 16
+#define CONFIG_I2S1_DIN_GPIO                17
+
+// DAC (I2S0)
+#define CONFIG_I2S0_BCK_GPIO                12
+#define CONFIG_I2S0_WS_GPIO                 13
+#define CONFIG_I2S0_DOUT_GPIO               14
+#define CONFIG_I2S0_MCLK_GPIO               11
+#ifndef CONFIG_I2S0_SAMPLE_RATE
+#define CONFIG_I2S0_SAMPLE_RATE             48000
+#endif
+#ifndef CONFIG_I2S0_BIT_WIDTH
+#define CONFIG_I2S0_BIT_WIDTH               32
+#endif
+#define CONFIG_AUDIO_OUTPUT_PRELOAD         1
+#ifndef CONFIG_AUDIO_OUTPUT_PRELOAD_DESC
+#define CONFIG_AUDIO_OUTPUT_PRELOAD_DESC    6
+#endif
+
+// Audio DSP
+#define CONFIG_AUDIO_MIXER_AUTO_DUCK        1
+#ifndef CONFIG_AUDIO_MIXER_DUCK_LEVEL
+#define CONFIG_AUDIO_MIXER_DUCK_LEVEL       25
+#endif
+#define CONFIG_AUDIO_CAPTURE_SESSIONS       1
+#ifndef CONFIG_AUDIO_PREROLL_MS
+#define CONFIG_AUDIO_PREROLL_MS             500
+#endif
+#ifndef CONFIG_AUDIO_VAD_THRESHOLD_DB
+#define CONFIG_AUDIO_VAD_THRESHOLD_DB       9
+#endif
+#ifndef CONFIG_AUDIO_VAD_FIXED_LEVEL_DB
+#define CONFIG_AUDIO_VAD_FIXED_LEVEL_DB     (-40)
+#endif
+#ifndef CONFIG_AUDIO_VAD_ATTACK_MS
+#define CONFIG_AUDIO_VAD_ATTACK_MS          30
+#endif
+#ifndef CONFIG_AUDIO_VAD_HANGOVER_MS
+#define CONFIG_AUDIO_VAD_HANGOVER_MS        300
+#endif
+#ifndef BENCH_NO_VAD_SPECTRAL
+#define CONFIG_AUDIO_VAD_SPECTRAL           1
+#endif
+#ifndef BENCH_NO_AEC
+#define CONFIG_AUDIO_AEC                    1
+#endif
+#ifndef CONFIG_AUDIO_AEC_TAIL_MS
+#define CONFIG_AUDIO_AEC_TAIL_MS            32
+#endif
+#ifndef CONFIG_AUDIO_AEC_DELAY_MS
+#define CONFIG_AUDIO_AEC_DELAY_MS           12
+#endif
+#define CONFIG_AUDIO_ANALYZER               1
+
+// Core placement
+#define CONFIG_TASK_CORE_AUDIO              0
+
+// Sensor history
+#ifndef CONFIG_SENSOR_HISTORY_RAW_PERIOD_S
+#define CONFIG_SENSOR_HISTORY_RAW_PERIOD_S  5
+#endif
+#ifndef CONFIG_SENSOR_HISTORY_RAW_MINUTES
+#define CONFIG_SENSOR_HISTORY_RAW_MINUTES   60
+#endif
+#ifndef CONFIG_SENSOR_HISTORY_1MIN_HOURS
+#define CONFIG_SENSOR_HISTORY_1MIN_HOURS    24
+#endif
+#ifndef CONFIG_SENSOR_HISTORY_15MIN_DAYS
+#define CONFIG_SENSOR_HISTORY_15MIN_DAYS    7
+#endif
+
+// Static memory regions
+#define CONFIG_MEM_ARENA_DMA_KB             16
+#define CONFIG_MEM_ARENA_PSRAM_KB           448
+#define CONFIG_MEM_ARENA_PSRAM_ALIGNED_KB   208
@@ -0,0 +1,92 @@
+/**
+ * @file wav_reader.c
+ * @brief Minimal RIFF/WAVE reader implementation
+ */
+
+#include "wav_reader.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WAVE_FORMAT_PCM         0x0001
+#define WAVE_FORMAT_EXTENSIBLE  0xFFFE
+
+static uint16_t le16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t le32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+bool wav_load(const char *path, wav_file_t *out)
+{
+    memset(out, 0, sizeof(*out));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+
+    uint8_t hdr[12];
+    if (fread(hdr, 1, 12, f) != 12 || memcmp(hdr, "RIFF", 4) || memcmp(hdr + 8, "WAVE", 4)) {
+        fprintf(stderr, "%s: not a RIFF/WAVE file\n", path);
+        fclose(f);
+        return false;
+    }
+
+    bool have_fmt = false;
+    uint16_t bits = 0;
+    uint8_t chunk[8];
+    while (fread(chunk, 1, 8, f) == 8) {
+        uint32_t size = le32(chunk + 4);
+
+        if (memcmp(chunk, "fmt ", 4) == 0) {
+            uint8_t fmt[40] = {0};
+            size_t want = size < sizeof(fmt) ? size : sizeof(fmt);
+            if (size < 16 || fread(fmt, 1, want, f) != want) break;
+            if (size > want) fseek(f, (long)(size - want), SEEK_CUR);
+
+            uint16_t tag = le16(fmt);
+            if (tag == WAVE_FORMAT_EXTENSIBLE && size >= 26) tag = le16(fmt + 24);
+            out->channels = le16(fmt + 2);
+            out->rate = le32(fmt + 4);
+            bits = le16(fmt + 14);
+            if (tag != WAVE_FORMAT_PCM || bits != 16 || out->channels == 0) {
+                fprintf(stderr, "%s: need 16-bit PCM (format %u, %u bits, %u ch)\n",
+                        path, tag, bits, out->channels);
+                break;
+            }
+            have_fmt = true;
+        } else if (memcmp(chunk, "data", 4) == 0 && have_fmt) {
+            size_t frame_bytes = sizeof(int16_t) * out->channels;
+            out->frames = size / frame_bytes;
+            out->samples = malloc(out->frames * frame_bytes + 1);
+            if (!out->samples) break;
+
+            // A truncated recording keeps what was written
+            size_t got = fread(out->samples, frame_bytes, out->frames, f);
+            out->frames = got;
+            fclose(f);
+            return true;
+        } else {
+            fseek(f, (long)(size + (size & 1)), SEEK_CUR);
+        }
+    }
+
+    if (!have_fmt || !out->samples) {
+        fprintf(stderr, "%s: no usable fmt/data chunks\n", path);
+    }
+    fclose(f);
+    wav_free(out);
+    return false;
+}
+
+void wav_free(wav_file_t *wav)
+{
+    free(wav->samples);
+    memset(wav, 0, sizeof(*wav));
+}
@@ -0,0 +1,43 @@
+/**
+ * @file wav_reader.h
+ * @brief Minimal RIFF/WAVE reader (16-bit PCM, any channel count)
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Decoded file: interleaved samples owned by the struct
+ */
+typedef struct {
+    int16_t *samples;
+    size_t frames;
+    uint32_t rate;
+    uint16_t channels;
+} wav_file_t;
+
+/**
+ * @brief Load a PCM16 WAV file
+ *
+ * Unknown chunks (LIST, fact, ...) are skipped. WAVE_FORMAT_EXTENSIBLE
+ * is accepted when its subformat is PCM.
+ *
+ * @return true on success; prints the reason to stderr otherwise
+ */
+bool wav_load(const char *path, wav_file_t *out);
+
+/**
+ * @brief Release the samples
+ */
+void wav_free(wav_file_t *wav);
+
+#ifdef __cplusplus
+}
+#endif